@@ -0,0 +1,190 @@
+namespace eval render_audio {
+
+set_help_text render_audio \
+{Records sound (e.g. the soundtrack of a game) as fast as possible instead of
+in real time.
+
+Usage:
+  render_audio [<options>] [<device> [<channels>] ...]
+  render_audio stop
+  render_audio status
+
+The devices and channels are specified like for 'record_channels', each channel
+is written to its own wav file in the soundlogs directory. When no channels are
+given, the mixed sound output is recorded instead (like 'record -audioonly').
+The output is always wav, because those are the recorders that are used. For a
+raw PCM stream (e.g. a pipe to an encoder) use 'record start -raw', that also
+writes the video and runs in real time.
+
+Options:
+  -time <seconds>             stop after this much emulated time
+  -stop_on_silence <seconds>  stop once the sound has been silent for this
+                              long (only after something was heard)
+  -mix                        also record the mixed sound output
+  -prefix <prefix>            prefix for the file names
+
+While rendering, 'throttle' is turned off and the sound output to the host is
+muted (the sound driver doesn't play anything). The original settings are
+restored when rendering stops. Because the sound devices are still emulated
+in sync with the rest of the machine, the result is identical to recording in
+real time.
+
+To render without a window, start openMSX with e.g.:
+  openmsx -setting <file> -command "set renderer none" -command "render_audio -time 60 all"
+
+Examples:
+  render_audio -time 120 all                  all channels, 2 minutes
+  render_audio -stop_on_silence 2 PSG SCC     until the song has ended
+  render_audio -time 30 -mix -prefix intro    only the mixed output
+}
+
+variable active false
+variable start_time
+variable time_limit
+variable silence_limit
+variable record_mix
+variable record_channels
+variable old_throttle
+variable old_mute
+variable poll_id
+
+set_tabcompletion_proc render_audio [namespace code tab_render_audio]
+proc tab_render_audio {args} {
+	return [concat [machine_info sounddevice] \
+		"all stop status -time -stop_on_silence -mix -prefix"]
+}
+
+proc render_audio {args} {
+	variable active
+	switch [lindex $args 0] {
+		stop   {return [stop]}
+		status {return [status]}
+	}
+	if {$active} {
+		error "Already rendering, use 'render_audio stop' first."
+	}
+
+	set time 0
+	set silence 0
+	set mix false
+	set prefix ""
+	set channel_args [list]
+	while {[llength $args]} {
+		set args [lassign $args arg]
+		switch -- $arg {
+			-time            {set args [lassign $args time]}
+			-stop_on_silence {set args [lassign $args silence]}
+			-mix             {set mix true}
+			-prefix          {set args [lassign $args prefix]}
+			default          {lappend channel_args $arg}
+		}
+	}
+	if {![string is double -strict $time] || $time < 0} {
+		error "Invalid time: $time"
+	}
+	if {![string is double -strict $silence] || $silence < 0} {
+		error "Invalid silence duration: $silence"
+	}
+	if {![llength $channel_args]} {
+		set mix true
+	}
+
+	set result ""
+	if {[llength $channel_args]} {
+		set start_args $channel_args
+		if {$prefix ne ""} {
+			lappend start_args -prefix $prefix
+		}
+		append result [record_channels start {*}$start_args]
+	}
+	if {$mix} {
+		if {[catch {
+			if {$prefix ne ""} {
+				append result [record start -audioonly -prefix $prefix] "\n"
+			} else {
+				append result [record start -audioonly] "\n"
+			}
+		} msg]} {
+			if {[llength $channel_args]} {record_channels stop {*}$channel_args}
+			error $msg
+		}
+	}
+
+	variable start_time [machine_info time]
+	variable time_limit $time
+	variable silence_limit $silence
+	variable record_mix $mix
+	variable record_channels $channel_args
+	variable old_throttle $::throttle
+	variable old_mute $::mute
+	set ::throttle off
+	set ::mute on
+	set active true
+	poll
+	return $result
+}
+
+proc poll {} {
+	variable active
+	variable start_time
+	variable time_limit
+	variable silence_limit
+	variable poll_id
+	if {!$active} return
+
+	set now [machine_info time]
+	set silence [machine_info sound_silence]
+	if {($time_limit > 0) && ($now - $start_time >= $time_limit)} {
+		stop
+		return
+	}
+	# don't stop during the silence before the first sound
+	if {($silence_limit > 0) && ($silence >= $silence_limit) &&
+	    ($now - $silence > $start_time)} {
+		stop
+		return
+	}
+	set poll_id [after time 0.1 [namespace code poll]]
+}
+
+proc stop {} {
+	variable active
+	variable record_mix
+	variable record_channels
+	variable old_throttle
+	variable old_mute
+	variable poll_id
+	if {!$active} {
+		return "Not rendering."
+	}
+	set active false
+	catch {after cancel $poll_id}
+
+	set result ""
+	if {[llength $record_channels]} {
+		append result [record_channels stop {*}$record_channels]
+	}
+	if {$record_mix} {
+		append result [record stop] "\n"
+	}
+	set ::throttle $old_throttle
+	set ::mute $old_mute
+	return $result
+}
+
+proc status {} {
+	variable active
+	variable start_time
+	if {!$active} {
+		return "Not rendering."
+	}
+	format "Rendered %.1f seconds (silent for %.1f seconds)." \
+		[expr {[machine_info time] - $start_time}] \
+		[machine_info sound_silence]
+}
+
+namespace export render_audio
+
+} ;# namespace render_audio
+
+namespace import render_audio::*
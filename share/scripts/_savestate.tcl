@@ -19,7 +19,12 @@ proc savestate {{name ""}} {
 		catch {file delete -- $png}
 	}
 	set currentID [machine]
-	store_machine $currentID $fullname
+	set options [list]
+	if {$::savestate_binary} {
+		lappend options -binary
+		if {[file exists $png]} {lappend options -thumbnail $png}
+	}
+	store_machine {*}$options $currentID $fullname
 	return $fullname
 }
 
@@ -100,6 +105,8 @@ Create a snapshot of the current emulated MSX machine.
 
 Optionally you can specify a name for the savestate. If you omit this the default name 'quicksave' will be taken.
 
+When the 'savestate_binary' setting is enabled, the faster binary format is used. Such savestates can only be loaded by the same openMSX version.
+
 See also 'loadstate', 'list_savestates', 'delete_savestate'.
 }
 set_tabcompletion_proc savestate [namespace code savestate_tab]
@@ -144,6 +151,8 @@ namespace export loadstate
 namespace export delete_savestate
 namespace export list_savestates
 
+user_setting create boolean savestate_binary "Use the binary savestate format: much faster to save and load, but only loadable by the same openMSX version" false
+
 } ;# namespace savestate
 
 namespace import savestate::*
@@ -0,0 +1,161 @@
+namespace eval v9990_cmd_benchmark {
+
+set_help_text v9990_cmd_benchmark \
+{Replays a recorded stream of V9990 commands and reports how much (host) time
+it took to execute them. This is meant to measure the speed of the V9990
+command engine emulation, e.g. before and after a change.
+
+Usage:
+  v9990_cmd_benchmark <trace-file> [<repeat>] [<device>]
+
+The trace file uses the format of the 'v9990cmdtrace' setting, so a stream
+can be recorded by running openMSX with stderr redirected to a file and
+executing 'set v9990cmdtrace on'. Lines that don't describe a command are
+ignored.
+
+The commands are executed with 'cmdtiming' set to 'broken', so a command
+doesn't take any emulated time. It is executed the first time the command
+engine is synchronized at a later emulated time. So after starting a command,
+the emulation runs for a moment, then the first register write of the next
+command executes it. Only those writes are timed. For this to work, nothing
+else may access the V9990 during the replay (e.g. run it at the BASIC prompt).
+The V9990 screen mode is not part of the trace, set it up before replaying
+(e.g. by loading a savestate of the recorded software).
+
+<repeat> is the number of times the whole stream is replayed (default 1),
+<device> is the name of the V9990 (default "Sunrise GFX9000").
+
+The result is printed when all commands are done. It is an error if the
+commands didn't change the VRAM.
+
+Note: this overwrites the VRAM and command registers of the V9990.
+}
+
+variable debuggable
+variable vram_debuggable
+variable commands
+variable remaining
+variable elapsed
+variable vram_before
+variable old_timing
+variable old_throttle
+
+proc parse_trace {filename} {
+	set f [open $filename]
+	set commands [list]
+	while {[gets $f line] >= 0} {
+		if {![regexp {V9990Cmd \S+ SX=(\d+) SY=(\d+) DX=(\d+) DY=(\d+) NX=(\d+) NY=(\d+) ARG=([0-9a-f]+) LOG=([0-9a-f]+) WM=([0-9a-f]+) FC=([0-9a-f]+) BC=([0-9a-f]+) CMD=([0-9a-f]+)} \
+		          $line -> sx sy dx dy nx ny arg log wm fc bc cmd]} continue
+		# the values of registers 32-52
+		set regs [list]
+		foreach v [list $sx $sy $dx $dy $nx $ny] {
+			lappend regs [expr {$v & 0xff}] [expr {$v >> 8}]
+		}
+		lappend regs 0x$arg 0x$log
+		foreach v [list 0x$wm 0x$fc 0x$bc] {
+			lappend regs [expr {$v & 0xff}] [expr {$v >> 8}]
+		}
+		lappend regs 0x$cmd
+		lappend commands $regs
+	}
+	close $f
+	return $commands
+}
+
+proc v9990_cmd_benchmark {filename {repeat 1} {device "Sunrise GFX9000"}} {
+	variable debuggable "$device regs"
+	variable vram_debuggable "$device VRAM"
+	variable commands
+	variable remaining
+	variable elapsed 0
+	variable vram_before
+	variable old_timing
+	variable old_throttle
+
+	if {$debuggable ni [debug list]} {
+		error "No V9990 named \"$device\" in the current machine."
+	}
+	set trace [parse_trace $filename]
+	if {[llength $trace] == 0} {
+		error "No V9990 commands found in $filename."
+	}
+	set commands [list]
+	for {set i 0} {$i < $repeat} {incr i} {
+		lappend commands {*}$trace
+	}
+	set remaining $commands
+	set vram_before [debug read_block $vram_debuggable 0 [debug size $vram_debuggable]]
+
+	set old_timing $::cmdtiming
+	set old_throttle $::throttle
+	set ::cmdtiming broken
+	set ::throttle off
+	start_command
+	return "Replaying [llength $commands] commands..."
+}
+
+# Executes the previous command (if any), starts the next one.
+proc start_command {} {
+	variable debuggable
+	variable remaining
+	variable elapsed
+
+	set regs [lindex $remaining 0]
+	set remaining [lrange $remaining 1 end]
+	set reg 32
+	foreach value $regs {
+		if {$reg == 32} {
+			# this write synchronizes the command engine at a later
+			# time than the start of the previous command
+			set start [clock microseconds]
+			debug write $debuggable $reg $value
+			incr elapsed [expr {[clock microseconds] - $start}]
+		} else {
+			# writing register 52 starts the command
+			debug write $debuggable $reg $value
+		}
+		incr reg
+	}
+	# let the emulated time advance a bit
+	set next [expr {([llength $remaining] != 0) ? "start_command" : "finish"}]
+	after time 0.00001 [namespace code $next]
+}
+
+proc finish {} {
+	variable debuggable
+	variable vram_debuggable
+	variable commands
+	variable elapsed
+	variable vram_before
+	variable old_timing
+	variable old_throttle
+
+	# execute the last command: rewrite SX low with its current value
+	set start [clock microseconds]
+	debug write $debuggable 32 [lindex $commands end 0]
+	incr elapsed [expr {[clock microseconds] - $start}]
+
+	set ::cmdtiming $old_timing
+	set ::throttle $old_throttle
+
+	if {[debug read_block $vram_debuggable 0 [debug size $vram_debuggable]] eq $vram_before} {
+		message "v9990_cmd_benchmark: the commands didn't change the VRAM" error
+		return
+	}
+	set num [llength $commands]
+	message [format "v9990_cmd_benchmark: %d commands in %.3f ms (%.2f us per command)" \
+		$num [expr {$elapsed / 1000.0}] [expr {double($elapsed) / $num}]]
+}
+
+set_tabcompletion_proc v9990_cmd_benchmark [namespace code tab_v9990_cmd_benchmark]
+proc tab_v9990_cmd_benchmark {args} {
+	if {[llength $args] == 2} {
+		return [utils::file_completion {*}$args]
+	}
+}
+
+namespace export v9990_cmd_benchmark
+
+} ;# namespace v9990_cmd_benchmark
+
+namespace import v9990_cmd_benchmark::*
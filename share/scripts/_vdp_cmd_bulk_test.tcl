@@ -0,0 +1,173 @@
+namespace eval vdp_cmd_bulk_test {
+
+set_help_text vdp_cmd_bulk_test \
+{Checks that the VDP command engine gives the same result when it executes
+(parts of) a command in bulk as when it executes each VRAM access at its exact
+moment in time.
+
+The command engine only executes in bulk when the renderer doesn't observe the
+written VRAM, e.g. when drawing in a page that is not displayed. So each test
+command (HMMV, LMMV, HMMM, LMMM, YMMM) draws in page 0 twice, both times
+starting from the same savestate: once with page 0 displayed (per access) and
+once with page 1 displayed (in bulk). The VRAM, the command registers, the
+command engine status (S#2) and the moment the command finishes must be the
+same.
+
+This needs an MSX2 (or newer) machine and a renderer other than 'none'. It
+overwrites the VDP registers and the VRAM, so reset the MSX afterwards. The
+result is printed when all commands are done.
+}
+
+# name, SX, SY, DX, DY, NX, NY, CLR, ARG, CMD
+# Graphic 4 (SCREEN 5): the sources are in page 2 (from line 512), except for
+# YMMM which copies within page 0.
+variable commands {
+	{"HMMV"              0   0  10  20 100  50 0x5a 0x00 0xc0}
+	{"HMMV left, up"     0   0 200 150  64  30 0x3c 0x0c 0xc0}
+	{"LMMV XOR"          0   0   7  33  97  41 0x07 0x00 0x83}
+	{"LMMV TIMP left"    0   0 250  90 111  17 0x05 0x04 0x88}
+	{"HMMM"              3 519  11  60 120  40 0x00 0x00 0xd0}
+	{"HMMM up"          30 700  50 240 150  70 0x00 0x08 0xd0}
+	{"LMMM TIMP"         5 521  13 100 121  33 0x00 0x00 0x98}
+	{"LMMM AND left"   200 600 201 130  77  25 0x00 0x04 0x91}
+	{"YMMM"              0 100  40  30   0  60 0x00 0x00 0xe0}
+	{"YMMM left, up"     0 200 100 180   0  20 0x00 0x0c 0xe0}
+}
+
+variable state_file
+variable vram_init
+variable first_result
+variable finish_time
+variable failures
+
+# Pseudo random VRAM content for pages 0-2.
+proc init_vram {} {
+	set x 12345
+	set bytes [list]
+	for {set i 0} {$i < 0x18000} {incr i} {
+		set x [expr {($x * 1103515245 + 12345) & 0x7fffffff}]
+		lappend bytes [expr {($x >> 16) & 0xff}]
+	}
+	binary format c* $bytes
+}
+
+proc vdp_cmd_bulk_test {} {
+	variable commands
+	variable state_file
+	variable vram_init
+	variable failures [list]
+
+	if {$::renderer eq "none"} {
+		error "The renderer doesn't observe the VRAM, select another one."
+	}
+	close [file tempfile state_file .oms]
+	set vram_init [init_vram]
+
+	# Graphic 4, display page 0, no interrupts, sprites disabled and their
+	# tables in page 3.
+	foreach {reg value} {0 0x06 1 0x40 2 0x1f 5 0xf7 6 0x3f 8 0x0a 9 0x00 11 0x03 13 0x00} {
+		debug write "VDP regs" $reg $value
+	}
+	# the new display mode becomes active at the next line
+	after time 0.001 [namespace code [list start_command 0]]
+	return "Running [llength $commands] commands..."
+}
+
+proc start_command {idx} {
+	variable commands
+	variable state_file
+	variable vram_init
+
+	debug write_block VRAM 0 $vram_init
+	lassign [lindex $commands $idx] name sx sy dx dy nx ny clr arg
+	set reg 32
+	foreach value [list $sx $sy $dx $dy $nx $ny] {
+		debug write "VDP regs" $reg [expr {$value & 0xff}]
+		debug write "VDP regs" [expr {$reg + 1}] [expr {$value >> 8}]
+		incr reg 2
+	}
+	debug write "VDP regs" 44 $clr
+	debug write "VDP regs" 45 $arg
+
+	store_machine [machine] $state_file
+	run $idx 1
+}
+
+# Continue from the savestate, then start the command. First with page 0
+# displayed, then with page 1 displayed.
+proc run {idx pass} {
+	variable commands
+	variable state_file
+
+	set oldID [machine]
+	set newID [restore_machine $state_file]
+	delete_machine $oldID
+	activate_machine $newID
+
+	debug write "VDP regs" 2 [expr {($pass == 1) ? 0x1f : 0x3f}]
+	debug probe set_bp VDP.commandExecuting -once \
+		{![debug probe read VDP.commandExecuting]} \
+		[namespace code [list finished $idx $pass]]
+	debug write "VDP regs" 46 [lindex $commands $idx 9]
+}
+
+proc finished {idx pass} {
+	variable finish_time [machine_info time]
+	# the command engine is still busy finishing the command
+	after time 0.001 [namespace code [list collect $idx $pass]]
+}
+
+proc collect {idx pass} {
+	variable commands
+	variable state_file
+	variable first_result
+	variable finish_time
+	variable failures
+
+	set result [list $finish_time \
+	                 [debug read_block "VDP regs" 32 15] \
+	                 [expr {[debug read "VDP status regs" 2] & 0x91}] \
+	                 [debug read_block VRAM 0 0x8000]]
+	if {$pass == 1} {
+		set first_result $result
+		run $idx 2
+		return
+	}
+
+	set name [lindex $commands $idx 0]
+	lassign $first_result time1 regs1 status1 vram1
+	lassign $result       time2 regs2 status2 vram2
+	if {$time1 != $time2} {
+		lappend failures [format "%s: finished %d VDP cycles later in bulk" $name \
+			[expr {round(($time2 - $time1) * 21477270)}]]
+	}
+	if {$regs1 ne $regs2} {
+		binary scan $regs1 cu* r1
+		binary scan $regs2 cu* r2
+		lappend failures "$name: command registers differ: $r1 vs $r2"
+	}
+	if {$status1 != $status2} {
+		lappend failures [format "%s: S#2 differs: 0x%02x vs 0x%02x" $name $status1 $status2]
+	}
+	if {$vram1 ne $vram2} {
+		lappend failures "$name: VRAM differs"
+	}
+
+	incr idx
+	if {$idx < [llength $commands]} {
+		start_command $idx
+		return
+	}
+	file delete -- $state_file
+	if {[llength $failures] == 0} {
+		message "vdp_cmd_bulk_test: all [llength $commands] commands OK"
+	} else {
+		message "vdp_cmd_bulk_test: [join $failures {; }]" error
+	}
+}
+
+namespace export vdp_cmd_bulk_test
+
+} ;# namespace vdp_cmd_bulk_test
+
+namespace import vdp_cmd_bulk_test::*
@@ -0,0 +1,189 @@
+namespace eval vdp_line_reuse_test {
+
+set_help_text vdp_line_reuse_test \
+{Checks that the renderer draws a static screen again after a VDP register
+change that moves the display or changes the sprites.
+
+The renderer copies the display lines whose input didn't change from the
+previous frame. For each tested change (vertical set-adjust, number of display
+lines, sprite table bases, sprite size and magnification) a static screen with
+sprites is shown for a few frames, then the register is changed and after a
+few more frames a (raw) screenshot is taken. That screenshot must differ from
+the one before the change and it must be the same as the screenshot of a fresh
+machine (restored from a savestate taken after the change), which draws all
+lines from scratch.
+
+This needs an MSX2 (or newer) machine and a renderer other than 'none'. It
+overwrites the VDP registers, the VRAM and the CPU state, so reset the MSX
+afterwards. The result is printed when all changes are tested.
+}
+
+# name, register, new value
+variable changes {
+	{"vertical set-adjust"              18 0x30}
+	{"number of display lines"           9 0x00}
+	{"sprite attribute table base"       5 0xcf}
+	{"sprite attribute table base high" 11 0x00}
+	{"sprite pattern table base"         6 0x1b}
+	{"sprite magnification"              1 0x43}
+	{"sprite size"                       1 0x40}
+}
+
+# Frames to wait till the renderer copies lines from the previous frame.
+variable settle_frames 4
+
+variable init_file
+variable state_file
+variable before_file
+variable after_file
+variable fresh_file
+variable failures
+
+proc vdp_line_reuse_test {} {
+	variable init_file
+	variable state_file
+	variable before_file
+	variable after_file
+	variable fresh_file
+	variable failures [list]
+
+	if {$::renderer eq "none"} {
+		error "This test needs a renderer, select another one."
+	}
+	close [file tempfile init_file .oms]
+	close [file tempfile state_file .oms]
+	close [file tempfile before_file .png]
+	close [file tempfile after_file .png]
+	close [file tempfile fresh_file .png]
+
+	# Keep the CPU away from the VDP: di; jr $
+	debug write_block memory 0xc000 [binary format c* {0xf3 0x18 0xfe}]
+	reg PC 0xc000
+
+	# Graphic 4, display page 0 (pseudo random content), 16x16 sprites. The
+	# sprite tables are in page 1: two attribute tables (0xf600 and
+	# 0xe600) with 8 sprites at different positions and two pattern tables
+	# (0xd000 and 0xd800) with different patterns.
+	set x 12345
+	set bytes [list]
+	for {set i 0} {$i < 0x8000} {incr i} {
+		set x [expr {($x * 1103515245 + 12345) & 0x7fffffff}]
+		lappend bytes [expr {($x >> 16) & 0xff}]
+	}
+	debug write_block VRAM 0x0000 [binary format c* $bytes]
+	debug write_block VRAM 0x8000 [string repeat \x00 0x8000]
+	debug write_block VRAM 0xd000 [string repeat \xff 0x800]
+	debug write_block VRAM 0xd800 [string repeat \xaa 0x800]
+	debug write_block VRAM 0xf400 [string repeat \x0f 0x80]
+	debug write_block VRAM 0xe400 [string repeat \x0f 0x80]
+	for {set i 0} {$i < 8} {incr i} {
+		debug write_block VRAM [expr {0xf600 + 4 * $i}] \
+			[binary format c4 [list [expr {40 + 20 * $i}] [expr {30 + 25 * $i}] [expr {4 * $i}] 0]]
+		debug write_block VRAM [expr {0xe600 + 4 * $i}] \
+			[binary format c4 [list [expr {60 + 15 * $i}] [expr {100 + 10 * $i}] [expr {4 * $i}] 0]]
+	}
+	debug write VRAM 0xf620 216
+	debug write VRAM 0xe620 216
+
+	foreach {reg value} {0 0x06 1 0x42 2 0x1f 5 0xef 6 0x1a 7 0x00 8 0x08
+	                     9 0x80 11 0x01 13 0x00 18 0x00 23 0x00} {
+		debug write "VDP regs" $reg $value
+	}
+
+	store_machine [machine] $init_file
+	test_change 0
+	return "Testing..."
+}
+
+proc wait_frames {n args} {
+	if {$n == 0} {
+		{*}$args
+	} else {
+		after frame [namespace code [list wait_frames [expr {$n - 1}] {*}$args]]
+	}
+}
+
+# Continue from a savestate, in a new machine.
+proc switch_machine {file} {
+	set oldID [machine]
+	set newID [restore_machine $file]
+	delete_machine $oldID
+	activate_machine $newID
+}
+
+proc read_file {name} {
+	set f [open $name rb]
+	set data [read $f]
+	close $f
+	return $data
+}
+
+proc test_change {idx} {
+	variable init_file
+	variable settle_frames
+
+	switch_machine $init_file
+	wait_frames $settle_frames change_register $idx
+}
+
+proc change_register {idx} {
+	variable changes
+	variable settle_frames
+	variable before_file
+
+	openmsx::internal_screenshot -raw $before_file
+	lassign [lindex $changes $idx] name reg value
+	debug write "VDP regs" $reg $value
+	wait_frames $settle_frames changed $idx
+}
+
+proc changed {idx} {
+	variable settle_frames
+	variable state_file
+	variable after_file
+
+	openmsx::internal_screenshot -raw $after_file
+	store_machine [machine] $state_file
+	switch_machine $state_file
+	wait_frames $settle_frames compare $idx
+}
+
+proc compare {idx} {
+	variable changes
+	variable init_file
+	variable state_file
+	variable before_file
+	variable after_file
+	variable fresh_file
+	variable failures
+
+	openmsx::internal_screenshot -raw $fresh_file
+	set name [lindex $changes $idx 0]
+	set before [read_file $before_file]
+	set after  [read_file $after_file]
+	if {$after eq $before} {
+		lappend failures "$name: screen didn't change"
+	} elseif {$after ne [read_file $fresh_file]} {
+		lappend failures "$name: screen differs from a fresh machine"
+	}
+
+	incr idx
+	if {$idx < [llength $changes]} {
+		test_change $idx
+		return
+	}
+	foreach f [list $init_file $state_file $before_file $after_file $fresh_file] {
+		file delete -- $f
+	}
+	if {[llength $failures] == 0} {
+		message "vdp_line_reuse_test: all [llength $changes] changes OK"
+	} else {
+		message "vdp_line_reuse_test: [join $failures {; }]" error
+	}
+}
+
+namespace export vdp_line_reuse_test
+
+} ;# namespace vdp_line_reuse_test
+
+namespace import vdp_line_reuse_test::*
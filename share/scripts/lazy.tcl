@@ -34,6 +34,7 @@ register_lazy "_record_channels.tcl" {
 register_lazy "_record_chunks.tcl" {
 	record_chunks record_chunks_on_framerate_changes}
 register_lazy "_reg_log.tcl" reg_log
+register_lazy "_render_audio.tcl" render_audio
 register_lazy "_reverse.tcl" {
 	reverse_prev reverse_next goto_time_delta go_back_one_step
 	go_forward_one_step reverse_bookmarks
@@ -74,12 +75,15 @@ register_lazy "_utils.tcl" {
 	format_time_subseconds format_time_hours_and_subseconds
 	get_machine_total_ram get_ordered_machine_list get_random_number clip
 	file_completion filename_clean get_next_numbered_filename}
+register_lazy "_v9990_cmd_benchmark.tcl" v9990_cmd_benchmark
 register_lazy "_vdp.tcl" {
 	getcolor setcolor get_screen_mode get_screen_mode_number vdpreg vdpregs
 	v9990regs vpeek vpoke palette vdpvramaddress vdpstatus
 	get_frame_duration}
 register_lazy "_vdp_access_test.tcl" toggle_vdp_access_test
 register_lazy "_vdp_busy.tcl" toggle_vdp_busy
+register_lazy "_vdp_cmd_bulk_test.tcl" vdp_cmd_bulk_test
+register_lazy "_vdp_line_reuse_test.tcl" vdp_line_reuse_test
 register_lazy "_vdrive.tcl" vdrive
 register_lazy "_vgmrecorder.tcl" {vgm_rec vgm_rec_next vgm_rec_end}
 register_lazy "_tcl_bridge.tcl" tcl_bridge
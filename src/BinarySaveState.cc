@@ -0,0 +1,173 @@
+#include "BinarySaveState.hh"
+
+#include "File.hh"
+#include "HardwareConfig.hh"
+#include "MSXException.hh"
+#include "MSXMotherBoard.hh"
+#include "TclObject.hh"
+#include "Version.hh"
+#include "serialize.hh"
+#include "serialize_stl.hh"
+
+#include "Date.hh"
+#include "MemBuffer.hh"
+#include "ranges.hh"
+#include "xxhash.hh"
+
+#include "build-info.hh"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <ctime>
+
+#include <zlib.h>
+
+namespace openmsx::BinarySaveState {
+
+static constexpr std::array<uint8_t, 8> MAGIC = {
+	'o', 'M', 'S', 'X', 'b', 'i', 'n', 0x1a,
+};
+
+// Way more than any (emulated) machine needs, but it stops a corrupt header
+// from allocating an arbitrary amount of memory.
+static constexpr uint64_t MAX_STATE_SIZE = 1024 * 1024 * 1024;
+
+std::string buildId()
+{
+	return strCat(Version::full(), ' ', TARGET_PLATFORM, '-', TARGET_CPU);
+}
+
+[[nodiscard]] static uint32_t checksum(std::span<const uint8_t> data)
+{
+	return xxhash(std::string_view(std::bit_cast<const char*>(data.data()), data.size()));
+}
+
+bool isBinarySaveState(const std::string& filename)
+{
+	try {
+		File file(filename, "rb"); // don't transparently uncompress
+		if (file.getSize() < MAGIC.size()) return false;
+		std::array<uint8_t, MAGIC.size()> buf;
+		file.read(buf);
+		return buf == MAGIC;
+	} catch (MSXException&) {
+		return false;
+	}
+}
+
+void save(const MSXMotherBoard& board, const std::string& filename,
+          std::span<const uint8_t> thumbnail)
+{
+	Header header;
+	header.dateTime = Date::toString(time(nullptr));
+	header.machine = board.getMachineName();
+	for (const auto& ext : board.getExtensions()) {
+		header.extensions.push_back(ext->getName());
+	}
+	for (const auto& [name, provider] : board.getMediaProviders()) {
+		TclObject info;
+		provider->getMediaInfo(info);
+		header.media.push_back({std::string(name), std::string(info.getString())});
+	}
+	header.thumbnail.assign(thumbnail.begin(), thumbnail.end());
+
+	MemOutputArchive stateOut;
+	stateOut.serialize("machine", board);
+	auto state = std::move(stateOut).releaseBuffer();
+
+	auto compressedSize = compressBound(uLong(state.size()));
+	MemBuffer<uint8_t> compressed(compressedSize);
+	if (compress2(compressed.data(), &compressedSize,
+	              state.data(), uLong(state.size()), Z_BEST_SPEED) != Z_OK) {
+		throw MSXException("Error while compressing savestate.");
+	}
+	header.stateSize = state.size();
+	header.compressedSize = compressedSize;
+
+	MemOutputArchive headerOut;
+	headerOut.serialize("header", header);
+	auto headerBuf = std::move(headerOut).releaseBuffer();
+	uint64_t headerSize = headerBuf.size();
+	uint32_t headerSum = checksum(headerBuf);
+
+	auto id = buildId();
+	File file(filename, File::OpenMode::TRUNCATE);
+	file.write(std::span{MAGIC});
+	file.write(std::span{id.c_str(), id.size() + 1}); // including zero-terminator
+	file.write(std::span{&headerSize, 1});
+	file.write(std::span{&headerSum, 1});
+	file.write(headerBuf);
+	file.write(compressed.first(compressedSize));
+}
+
+// Verify the signature, build id and header checksum. On success returns the
+// parsed header, and 'data' is advanced to the start of the compressed state.
+[[nodiscard]] static Header parse(std::span<const uint8_t>& data)
+{
+	auto error = [] [[noreturn]] (std::string_view msg) {
+		throw MSXException("Invalid binary savestate: ", msg);
+	};
+	if ((data.size() < MAGIC.size()) || !std::ranges::equal(data.first(MAGIC.size()), MAGIC)) {
+		error("wrong signature");
+	}
+	data = data.subspan(MAGIC.size());
+
+	auto idEnd = std::ranges::find(data, 0);
+	if (idEnd == data.end()) error("truncated file");
+	std::string_view id(std::bit_cast<const char*>(data.data()), idEnd - data.begin());
+	if (id != buildId()) {
+		throw MSXException(
+			"This binary savestate was created by a different openMSX "
+			"build (", id, "). Binary savestates can only be loaded by "
+			"the build that created them, use the XML format for "
+			"portable savestates.");
+	}
+	data = data.subspan(id.size() + 1);
+
+	uint64_t headerSize;
+	uint32_t headerSum;
+	if (data.size() < (sizeof(headerSize) + sizeof(headerSum))) error("truncated file");
+	memcpy(&headerSize, data.data(), sizeof(headerSize));
+	memcpy(&headerSum, data.data() + sizeof(headerSize), sizeof(headerSum));
+	data = data.subspan(sizeof(headerSize) + sizeof(headerSum));
+	if (data.size() < headerSize) error("truncated file");
+	auto headerBuf = data.first(headerSize);
+	if (checksum(headerBuf) != headerSum) error("corrupt header");
+	data = data.subspan(headerSize);
+
+	Header header;
+	MemInputArchive in(headerBuf, true); // checked
+	in.serialize("header", header);
+	if (data.size() != header.compressedSize) error("wrong file size");
+	if (header.stateSize > MAX_STATE_SIZE) error("state too large");
+	return header;
+}
+
+Header loadHeader(const std::string& filename)
+{
+	File file(filename, "rb");
+	auto mmap = file.mmap<const uint8_t>();
+	std::span<const uint8_t> data{mmap.data(), mmap.size()};
+	return parse(data);
+}
+
+void load(MSXMotherBoard& board, const std::string& filename)
+{
+	File file(filename, "rb");
+	auto mmap = file.mmap<const uint8_t>();
+	std::span<const uint8_t> data{mmap.data(), mmap.size()};
+	auto header = parse(data);
+
+	MemBuffer<uint8_t> state(header.stateSize);
+	auto stateSize = uLongf(header.stateSize);
+	// Note: zlib verifies the (adler32) checksum of the uncompressed data.
+	if ((uncompress(state.data(), &stateSize, data.data(), uLong(data.size())) != Z_OK) ||
+	    (stateSize != header.stateSize)) {
+		throw MSXException("Invalid binary savestate: error while decompressing.");
+	}
+	MemInputArchive in(state, true); // checked
+	in.serialize("machine", board);
+}
+
+} // namespace openmsx::BinarySaveState
@@ -0,0 +1,101 @@
+#ifndef BINARYSAVESTATE_HH
+#define BINARYSAVESTATE_HH
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class MSXMotherBoard;
+
+/** Binary savestate files.
+  *
+  * The default savestate format is (gzipped) XML. That format is portable
+  * between openMSX versions, but it's slow to write and especially slow to
+  * parse. This is an alternative format that uses the same (fast) binary
+  * MemOutputArchive/MemInputArchive as the reverse snapshots, compressed
+  * with zlib (at the fastest setting).
+  *
+  * Like the reverse snapshots, the binary serialization doesn't store class
+  * version information. So these files can only be loaded by the exact
+  * same openMSX build that created them (this is checked). Use the XML
+  * format for savestates that should remain loadable after an upgrade.
+  *
+  * File layout:
+  *  - 8 bytes magic
+  *  - build identification, zero-terminated string
+  *  - (native) size and xxhash of the header
+  *  - header (see Header below)
+  *  - zlib compressed machine state
+  */
+namespace BinarySaveState {
+
+	struct Media {
+		std::string name;
+		std::string info; // as returned by 'machine_info media <name>'
+
+		template<typename Archive>
+		void serialize(Archive& ar, unsigned /*version*/) {
+			ar.serialize("name", name,
+			             "info", info);
+		}
+	};
+
+	/** Summary of the savestate, can be read without loading the full
+	  * machine state.
+	  */
+	struct Header {
+		std::string dateTime;
+		std::string machine;
+		std::vector<std::string> extensions;
+		std::vector<Media> media;
+		std::vector<uint8_t> thumbnail; // PNG data, possibly empty
+
+		uint64_t stateSize = 0;      // uncompressed
+		uint64_t compressedSize = 0;
+
+		template<typename Archive>
+		void serialize(Archive& ar, unsigned /*version*/) {
+			ar.serialize("dateTime",       dateTime,
+			             "machine",        machine,
+			             "extensions",     extensions,
+			             "media",          media,
+			             "thumbnail",      thumbnail,
+			             "stateSize",      stateSize,
+			             "compressedSize", compressedSize);
+		}
+	};
+
+	/** Identification of this openMSX build. The binary serialization
+	  * depends on the exact class layout (no versioning) and on the native
+	  * integer representation, so binary files are tied to one build.
+	  */
+	[[nodiscard]] std::string buildId();
+
+	/** Does the given file start with the binary savestate signature?
+	  * Never throws, returns false on errors.
+	  */
+	[[nodiscard]] bool isBinarySaveState(const std::string& filename);
+
+	/** Write the state of the given machine.
+	  * @throws MSXException on errors
+	  */
+	void save(const MSXMotherBoard& board, const std::string& filename,
+	          std::span<const uint8_t> thumbnail);
+
+	/** Only read the header.
+	  * @throws MSXException on errors
+	  */
+	[[nodiscard]] Header loadHeader(const std::string& filename);
+
+	/** Restore the full state in the given (empty) machine.
+	  * @throws MSXException on errors
+	  */
+	void load(MSXMotherBoard& board, const std::string& filename);
+
+} // namespace BinarySaveState
+} // namespace openmsx
+
+#endif
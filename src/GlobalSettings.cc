@@ -28,6 +28,10 @@ GlobalSettings::GlobalSettings(GlobalCommandController& commandController_)
 		EnumSetting<ResampledSoundDevice::ResampleType>::Map{
 			{"hq",   ResampledSoundDevice::ResampleType::HQ},
 			{"blip", ResampledSoundDevice::ResampleType::BLIP}})
+	, soundThreadsSetting(commandController, "sound_threads",
+		"generate the sound of the different sound chips in parallel "
+		"(only helps for machines with several expensive sound chips, "
+		"e.g. MoonSound or MSX-AUDIO)", false)
 	, speedManager(commandController)
 	, throttleManager(commandController)
 	// Debug streaming settings (default: ON, can be turned OFF via TCL)
@@ -49,6 +49,9 @@ public:
 	[[nodiscard]] EnumSetting<ResampledSoundDevice::ResampleType>& getResampleSetting() {
 		return resampleSetting;
 	}
+	[[nodiscard]] BooleanSetting& getSoundThreadsSetting() {
+		return soundThreadsSetting;
+	}
 	[[nodiscard]] SpeedManager& getSpeedManager() {
 		return speedManager;
 	}
@@ -84,6 +87,7 @@ private:
 	StringSetting  invalidPsgDirectionsSetting;
 	StringSetting  invalidPpiModeSetting;
 	EnumSetting<ResampledSoundDevice::ResampleType> resampleSetting;
+	BooleanSetting soundThreadsSetting;
 	SpeedManager speedManager;
 	ThrottleManager throttleManager;
 
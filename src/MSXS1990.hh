@@ -35,6 +35,7 @@ private:
 		Debuggable(MSXMotherBoard& motherBoard, const std::string& name);
 		[[nodiscard]] byte read(unsigned address) override;
 		void write(unsigned address, byte value) override;
+		[[nodiscard]] bool includeInStateHash() const override { return true; }
 	} debuggable;
 
 	FirmwareSwitch firmwareSwitch;
@@ -2,6 +2,7 @@
 
 #include "AfterCommand.hh"
 #include "AviRecorder.hh"
+#include "BinarySaveState.hh"
 #include "BooleanSetting.hh"
 #include "Command.hh"
 #include "CommandException.hh"
@@ -14,6 +15,7 @@
 #include "EnumSetting.hh"
 #include "Event.hh"
 #include "EventDistributor.hh"
+#include "File.hh"
 #include "FileContext.hh"
 #include "FileException.hh"
 #include "FilePool.hh"
@@ -35,6 +37,7 @@
 #include "StateChangeDistributor.hh"
 #include "SymbolManager.hh"
 #include "TclCallbackMessages.hh"
+#include "TclArgParser.hh"
 #include "TclObject.hh"
 #include "UserSettings.hh"
 #include "VideoSystem.hh"
@@ -1054,15 +1057,37 @@ StoreMachineCommand::StoreMachineCommand(
 
 void StoreMachineCommand::execute(std::span<const TclObject> tokens, TclObject& result)
 {
-	checkNumArgs(tokens, 3, Prefix{1}, "id filename");
-	const auto& machineID = tokens[1].getString();
-	const auto& filename = tokens[2].getString();
+	bool binary = false;
+	std::string thumbnail;
+	std::array info = {
+		flagArg("-binary", binary),
+		valueArg("-thumbnail", thumbnail),
+	};
+	auto args = parseTclArgs(getInterpreter(), tokens.subspan(1), info);
+	if (args.size() != 2) throw SyntaxError();
+	const auto& machineID = args[0].getString();
+	const auto& filename = args[1].getString();
 
 	const auto& board = *reactor.getMachine(machineID);
 
-	XmlOutputArchive out(filename);
-	out.serialize("machine", board);
-	out.close();
+	if (binary) {
+		try {
+			File pngFile;
+			MappedFile<const uint8_t> png;
+			if (!thumbnail.empty()) {
+				pngFile = File(FileOperations::expandTilde(std::move(thumbnail)));
+				png = pngFile.mmap<const uint8_t>();
+			}
+			BinarySaveState::save(board, std::string(filename),
+			                      std::span{png.data(), png.size()});
+		} catch (MSXException& e) {
+			throw CommandException("Cannot save state: ", e.getMessage());
+		}
+	} else {
+		XmlOutputArchive out(filename);
+		out.serialize("machine", board);
+		out.close();
+	}
 	result = filename;
 }
 
@@ -1070,6 +1095,10 @@ std::string StoreMachineCommand::help(std::span<const TclObject> /*tokens*/) con
 {
 	return
 		"store_machine machineID <filename>  Save state of machine \"machineID\" to indicated file\n"
+		"store_machine -binary [-thumbnail <png>] machineID <filename>\n"
+		"    Save in the binary format, optionally with a thumbnail image.\n"
+		"    This is much faster to save and load, but the file can only be\n"
+		"    loaded by the same openMSX build.\n"
 		"\n"
 		"This is a low-level command, the 'savestate' script is easier to use.";
 }
@@ -1092,14 +1121,46 @@ RestoreMachineCommand::RestoreMachineCommand(
 void RestoreMachineCommand::execute(std::span<const TclObject> tokens,
                                     TclObject& result)
 {
-	checkNumArgs(tokens, 2, Prefix{1}, "filename");
-	auto newBoard = reactor.createEmptyMotherBoard();
+	bool headerOnly = false;
+	std::array info = {flagArg("-header", headerOnly)};
+	auto args = parseTclArgs(getInterpreter(), tokens.subspan(1), info);
+	if (args.size() != 1) throw SyntaxError();
 
-	const auto filename = FileOperations::expandTilde(std::string(tokens[1].getString()));
+	const auto filename = FileOperations::expandTilde(std::string(args[0].getString()));
+	bool binary = BinarySaveState::isBinarySaveState(filename);
+
+	if (headerOnly) {
+		if (!binary) {
+			throw CommandException("Not a binary savestate: ", filename);
+		}
+		try {
+			auto header = BinarySaveState::loadHeader(filename);
+			TclObject extensions;
+			extensions.addListElements(header.extensions);
+			TclObject media;
+			for (const auto& m : header.media) {
+				media.addDictKeyValue(m.name, TclObject(m.info));
+			}
+			result = makeTclDict(
+				"date_time", header.dateTime,
+				"machine", header.machine,
+				"extensions", extensions,
+				"media", media,
+				"thumbnail", std::span<const uint8_t>(header.thumbnail));
+		} catch (MSXException& e) {
+			throw CommandException("Cannot read savestate header: ", e.getMessage());
+		}
+		return;
+	}
 
+	auto newBoard = reactor.createEmptyMotherBoard();
 	try {
-		XmlInputArchive in(filename);
-		in.serialize("machine", *newBoard);
+		if (binary) {
+			BinarySaveState::load(*newBoard, filename);
+		} else {
+			XmlInputArchive in(filename);
+			in.serialize("machine", *newBoard);
+		}
 	} catch (XMLException& e) {
 		throw CommandException("Cannot load state, bad file format: ",
 		                       e.getMessage());
@@ -1120,6 +1181,7 @@ std::string RestoreMachineCommand::help(std::span<const TclObject> /*tokens*/) c
 {
 	return "restore_machine                       Load state from last saved state in default directory\n"
 	       "restore_machine <filename>            Load state from indicated file\n"
+	       "restore_machine -header <filename>    Only return the header info of a binary savestate\n"
 	       "\n"
 	       "This is a low-level command, the 'loadstate' script is easier to use.";
 }
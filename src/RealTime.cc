@@ -1,9 +1,11 @@
 #include "RealTime.hh"
 
 #include "BooleanSetting.hh"
+#include "Display.hh"
 #include "Event.hh"
 #include "EventDelay.hh"
 #include "EventDistributor.hh"
+#include "FrameTelemetry.hh"
 #include "GlobalSettings.hh"
 #include "MSXMotherBoard.hh"
 #include "Reactor.hh"
@@ -73,6 +75,14 @@ bool RealTime::timeLeft(uint64_t us, EmuTime time) const
 	           (idealRealTime + realDuration + ALLOWED_LAG);
 }
 
+int64_t RealTime::getSyncDrift(EmuTime time) const
+{
+	if (!enabled || !throttleManager.isThrottled()) return 0;
+	auto realDuration = static_cast<uint64_t>(
+		getRealDuration(emuTime, time) * 1000000ULL);
+	return narrow_cast<int64_t>(idealRealTime + realDuration - Timer::getTime());
+}
+
 void RealTime::sync(EmuTime time, bool allowSleep)
 {
 	if (allowSleep) {
@@ -99,6 +109,7 @@ void RealTime::internalSync(EmuTime time, bool allowSleep)
 			if (sleep > 0) {
 				Timer::sleep(sleep); // request to sleep for 'sleep+sleepAdjust'
 				auto slept = narrow<int64_t>(Timer::getTime() - currentRealTime);
+				motherBoard.getReactor().getDisplay().getFrameTelemetry().addSleep(narrow<uint64_t>(slept));
 				delta = sleep - slept; // actually slept for 'slept' us
 			}
 			const double ALPHA = 0.2;
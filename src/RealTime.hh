@@ -45,6 +45,13 @@ public:
 	  */
 	[[nodiscard]] bool timeLeft(uint64_t us, EmuTime time) const;
 
+	/** How far (in us) the emulation is ahead of real time when it
+	  * reaches the given point in emulated time. Positive means it will
+	  * sleep at the next synchronization, negative means it lags behind.
+	  * Zero when not throttled.
+	  */
+	[[nodiscard]] int64_t getSyncDrift(EmuTime time) const;
+
 	void resync();
 
 	void enable();
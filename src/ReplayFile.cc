@@ -0,0 +1,192 @@
+#include "ReplayFile.hh"
+
+#include "BinarySaveState.hh"
+#include "FileOperations.hh"
+#include "MSXException.hh"
+
+#include "xxhash.hh"
+
+#include <array>
+#include <bit>
+
+#include <zlib.h>
+
+namespace openmsx {
+
+static constexpr std::array<uint8_t, 8> MAGIC = {
+	'o', 'M', 'S', 'X', 'r', 'p', 'l', 0x1a,
+};
+
+// The trailer (at the very end of the file) locates the index: offset,
+// compressed and uncompressed size (3 x uint64_t), checksum of the compressed
+// index (uint32_t). Followed by the magic again, to detect truncated files.
+static constexpr size_t TRAILER_SIZE = 3 * sizeof(uint64_t) + sizeof(uint32_t) + MAGIC.size();
+
+[[nodiscard]] static uint32_t checksum(std::span<const uint8_t> data)
+{
+	return xxhash(std::string_view(std::bit_cast<const char*>(data.data()), data.size()));
+}
+
+[[nodiscard]] static MemBuffer<uint8_t> compressBlob(std::span<const uint8_t> data, uLongf& compressedSize)
+{
+	compressedSize = compressBound(uLong(data.size()));
+	MemBuffer<uint8_t> result(compressedSize);
+	if (compress2(result.data(), &compressedSize,
+	              data.data(), uLong(data.size()), Z_BEST_SPEED) != Z_OK) {
+		throw MSXException("Error while compressing replay data.");
+	}
+	return result;
+}
+
+
+// class ReplayFile::Writer
+
+ReplayFile::Writer::Writer(const std::string& filename_)
+	: filename(filename_)
+	, tmpFilename(filename_ + ".tmp")
+	, file(tmpFilename, File::OpenMode::TRUNCATE)
+{
+	auto id = BinarySaveState::buildId();
+	file.write(std::span{MAGIC});
+	file.write(std::span{id.c_str(), id.size() + 1}); // including zero-terminator
+	offset = MAGIC.size() + id.size() + 1;
+}
+
+ReplayFile::Writer::~Writer()
+{
+	if (!finished) {
+		file.close();
+		FileOperations::unlink(tmpFilename);
+	}
+}
+
+ReplayFile::Keyframe ReplayFile::Writer::addKeyframe(EmuTime time, std::span<const uint8_t> state)
+{
+	uLongf compressedSize;
+	auto compressed = compressBlob(state, compressedSize);
+	file.write(compressed.first(compressedSize));
+
+	Keyframe result{time, offset, compressedSize, state.size()};
+	offset += compressedSize;
+	return result;
+}
+
+void ReplayFile::Writer::finish(std::span<const uint8_t> index)
+{
+	uLongf compressedSize;
+	auto compressed = compressBlob(index, compressedSize);
+	auto compressedIndex = compressed.first(compressedSize);
+	file.write(compressedIndex);
+
+	uint64_t indexOffset = offset;
+	uint64_t indexCompressedSize = compressedSize;
+	uint64_t indexSize = index.size();
+	uint32_t indexChecksum = checksum(compressedIndex);
+	file.write(std::span{&indexOffset, 1});
+	file.write(std::span{&indexCompressedSize, 1});
+	file.write(std::span{&indexSize, 1});
+	file.write(std::span{&indexChecksum, 1});
+	file.write(std::span{MAGIC});
+	offset += compressedSize + TRAILER_SIZE;
+	file.close();
+
+	finished = true;
+	if (FileOperations::rename(tmpFilename, filename) != 0) {
+		FileOperations::unlink(tmpFilename);
+		throw MSXException("Couldn't replace ", filename);
+	}
+}
+
+
+// class ReplayFile
+
+bool ReplayFile::isReplayFile(const std::string& filename)
+{
+	try {
+		File file(filename, "rb"); // don't transparently uncompress
+		if (file.getSize() < MAGIC.size()) return false;
+		std::array<uint8_t, MAGIC.size()> buf;
+		file.read(buf);
+		return buf == MAGIC;
+	} catch (MSXException&) {
+		return false;
+	}
+}
+
+ReplayFile::ReplayFile(const std::string& filename)
+	: file(filename, "rb")
+{
+	auto error = [] [[noreturn]] (std::string_view msg) {
+		throw MSXException("Invalid replay file: ", msg);
+	};
+
+	// Only the start and the end of the file are read here, in particular
+	// we don't mmap() the file, that would read it completely.
+	auto id = BinarySaveState::buildId();
+	auto fileSize = file.getSize();
+	if (fileSize < (MAGIC.size() + id.size() + 1 + TRAILER_SIZE)) error("truncated file");
+
+	std::array<uint8_t, MAGIC.size()> magic;
+	file.read(magic);
+	if (magic != MAGIC) error("wrong signature");
+
+	std::string fileId(id.size() + 1, '\0');
+	file.read(std::span{fileId});
+	if (fileId != std::string_view(id.c_str(), id.size() + 1)) {
+		// (in case of a longer id, only a prefix is shown)
+		throw MSXException(
+			"This replay was created by a different openMSX build (",
+			fileId.c_str(), "). Binary replays can only be loaded by "
+			"the build that created them, use the XML format for "
+			"portable replays.");
+	}
+	dataStart = MAGIC.size() + id.size() + 1;
+
+	file.seek(fileSize - TRAILER_SIZE);
+	file.read(std::span{&indexOffset, 1});
+	file.read(std::span{&indexCompressedSize, 1});
+	file.read(std::span{&indexSize, 1});
+	file.read(std::span{&indexChecksum, 1});
+	file.read(magic);
+	if (magic != MAGIC) error("truncated file");
+	if ((indexOffset < dataStart) ||
+	    ((indexOffset + indexCompressedSize + TRAILER_SIZE) != fileSize)) {
+		error("corrupt trailer");
+	}
+}
+
+MemBuffer<uint8_t> ReplayFile::load(uint64_t offset, uint64_t compressedSize, uint64_t size,
+                                    std::optional<uint32_t> expectedChecksum)
+{
+	MemBuffer<uint8_t> compressed(compressedSize);
+	file.seek(offset);
+	file.read(std::span{compressed});
+	if (expectedChecksum && (checksum(compressed) != *expectedChecksum)) {
+		throw MSXException("Invalid replay file: corrupt index");
+	}
+
+	MemBuffer<uint8_t> result(size);
+	auto resultSize = uLongf(size);
+	// Note: zlib verifies the (adler32) checksum of the uncompressed data.
+	if ((uncompress(result.data(), &resultSize, compressed.data(), uLong(compressedSize)) != Z_OK) ||
+	    (resultSize != size)) {
+		throw MSXException("Invalid replay file: error while decompressing.");
+	}
+	return result;
+}
+
+MemBuffer<uint8_t> ReplayFile::loadIndex()
+{
+	return load(indexOffset, indexCompressedSize, indexSize, indexChecksum);
+}
+
+MemBuffer<uint8_t> ReplayFile::loadKeyframe(const Keyframe& keyframe)
+{
+	if ((keyframe.offset < dataStart) ||
+	    ((keyframe.offset + keyframe.compressedSize) > indexOffset)) {
+		throw MSXException("Invalid replay file: wrong keyframe location");
+	}
+	return load(keyframe.offset, keyframe.compressedSize, keyframe.size, {});
+}
+
+} // namespace openmsx
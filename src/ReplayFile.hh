@@ -0,0 +1,120 @@
+#ifndef REPLAYFILE_HH
+#define REPLAYFILE_HH
+
+#include "EmuTime.hh"
+#include "File.hh"
+
+#include "MemBuffer.hh"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace openmsx {
+
+/** Container for seekable (binary) replay files.
+  *
+  * The XML replay format must be parsed completely (including all embedded
+  * snapshots) before the replay can be used. This format instead stores
+  * each snapshot ('keyframe') as a separately compressed blob. An index at
+  * the end of the file contains the list of keyframes (time and location
+  * in the file) together with the event log. So opening a replay only
+  * requires reading the index, keyframes are read when they're needed.
+  *
+  * This class only deals with the container, the content of the index and
+  * the keyframes is determined by ReverseManager. Like binary savestates,
+  * these files can only be loaded by the openMSX build that created them.
+  *
+  * File layout:
+  *  - 8 bytes magic
+  *  - build identification, zero-terminated string
+  *  - zlib compressed keyframes
+  *  - zlib compressed index
+  *  - trailer (see below)
+  */
+class ReplayFile
+{
+public:
+	struct Keyframe {
+		EmuTime time = EmuTime::zero();
+		uint64_t offset = 0;
+		uint64_t compressedSize = 0;
+		uint64_t size = 0; // uncompressed
+
+		template<typename Archive>
+		void serialize(Archive& ar, unsigned /*version*/) {
+			ar.serialize("time",           time,
+			             "offset",         offset,
+			             "compressedSize", compressedSize,
+			             "size",           size);
+		}
+	};
+
+	/** The data is first written to a temporary file (in the same
+	  * directory), that only replaces the given file in finish(). So
+	  * it's possible to write to a replay file that's being read.
+	  */
+	class Writer
+	{
+	public:
+		/** @throws MSXException */
+		explicit Writer(const std::string& filename);
+		/** Removes the temporary file when finish() wasn't called. */
+		~Writer();
+
+		Writer(const Writer&) = delete;
+		Writer(Writer&&) = delete;
+		Writer& operator=(const Writer&) = delete;
+		Writer& operator=(Writer&&) = delete;
+
+		/** Append a keyframe, the result should be stored in the index.
+		  * @throws MSXException
+		  */
+		[[nodiscard]] Keyframe addKeyframe(EmuTime time, std::span<const uint8_t> state);
+
+		/** Write the index and move the file in place, after this no
+		  * more keyframes can be added.
+		  * @throws MSXException
+		  */
+		void finish(std::span<const uint8_t> index);
+
+	private:
+		std::string filename;
+		std::string tmpFilename;
+		File file;
+		uint64_t offset = 0;
+		bool finished = false;
+	};
+
+public:
+	/** Does the given file start with the replay file signature?
+	  * Never throws, returns false on errors.
+	  */
+	[[nodiscard]] static bool isReplayFile(const std::string& filename);
+
+	/** Open the file and verify the signature, build and trailer.
+	  * @throws MSXException
+	  */
+	explicit ReplayFile(const std::string& filename);
+
+	/** @throws MSXException */
+	[[nodiscard]] MemBuffer<uint8_t> loadIndex();
+	[[nodiscard]] MemBuffer<uint8_t> loadKeyframe(const Keyframe& keyframe);
+
+private:
+	[[nodiscard]] MemBuffer<uint8_t> load(uint64_t offset, uint64_t compressedSize, uint64_t size,
+	                                      std::optional<uint32_t> expectedChecksum);
+
+private:
+	File file;
+	uint64_t dataStart;
+	uint64_t indexOffset;
+	uint64_t indexCompressedSize;
+	uint64_t indexSize;
+	uint32_t indexChecksum;
+};
+
+} // namespace openmsx
+
+#endif
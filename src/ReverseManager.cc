@@ -1,6 +1,7 @@
 #include "ReverseManager.hh"
 
 #include "CommandException.hh"
+#include "Debuggable.hh"
 #include "Debugger.hh"
 #include "Display.hh"
 #include "Event.hh"
@@ -14,6 +15,7 @@
 #include "MSXMixer.hh"
 #include "MSXMotherBoard.hh"
 #include "Reactor.hh"
+#include "ReverseMemoryUsage.hh"
 #include "StateChange.hh"
 #include "StateChangeDistributor.hh"
 #include "TclArgParser.hh"
@@ -23,13 +25,17 @@
 #include "serialize.hh"
 #include "serialize_meta.hh"
 
+#include "join.hh"
 #include "narrow.hh"
 #include "one_of.hh"
+#include "stl.hh"
 
 #include <array>
+#include <bit>
 #include <cassert>
 #include <cmath>
 #include <iomanip>
+#include <limits>
 #include <ranges>
 
 namespace openmsx {
@@ -39,6 +45,10 @@ using namespace std::literals;
 // Time between two snapshots (in seconds)
 static constexpr double SNAPSHOT_PERIOD = 1.0;
 
+// Time between two state hashes, see StateHashes. This is the duration of a
+// PAL frame, though the hashes are not synchronized with the VDP frames.
+static constexpr auto STATE_HASH_PERIOD = EmuDuration::hz(50);
+
 // Max number of snapshots in a replay file
 static constexpr unsigned MAX_NOF_SNAPSHOTS = 10;
 
@@ -63,6 +73,7 @@ struct Replay
 	Reactor& reactor;
 
 	ReverseManager::Events* events;
+	StateHashes* stateHashes;
 	std::vector<Reactor::Board> motherBoards;
 	EmuTime currentTime = EmuTime::dummy();
 	// this is the amount of times the reverse goto command was used, which
@@ -95,9 +106,34 @@ struct Replay
 		if (ar.versionAtLeast(version, 4)) {
 			ar.serialize("reRecordCount", reRecordCount);
 		}
+
+		if (ar.versionAtLeast(version, 5)) {
+			ar.serialize("stateHashes", *stateHashes);
+		}
+	}
+};
+SERIALIZE_CLASS_VERSION(Replay, 5);
+
+// The index of a binary replay file, see ReplayFile. The snapshots are stored
+// separately in that file, they are only loaded when needed.
+struct BinaryReplay
+{
+	ReverseManager::Events* events;
+	StateHashes* stateHashes;
+	std::vector<ReplayFile::Keyframe> keyframes;
+	EmuTime currentTime = EmuTime::dummy();
+	unsigned reRecordCount = 0;
+
+	template<typename Archive>
+	void serialize(Archive& ar, unsigned /*version*/)
+	{
+		ar.serialize("keyframes",     keyframes,
+		             "events",        *events,
+		             "stateHashes",   *stateHashes,
+		             "currentTime",   currentTime,
+		             "reRecordCount", reRecordCount);
 	}
 };
-SERIALIZE_CLASS_VERSION(Replay, 4);
 
 
 // struct ReverseHistory
@@ -106,6 +142,8 @@ void ReverseManager::ReverseHistory::swap(ReverseHistory& other) noexcept
 {
 	std::swap(chunks, other.chunks);
 	std::swap(events, other.events);
+	stateHashes.swap(other.stateHashes);
+	std::swap(spilledBlocks, other.spilledBlocks);
 }
 
 void ReverseManager::ReverseHistory::clear()
@@ -113,6 +151,24 @@ void ReverseManager::ReverseHistory::clear()
 	// clear() and free storage capacity
 	Chunks().swap(chunks);
 	Events().swap(events);
+	stateHashes.clear();
+	spilledBlocks.clear(); // file is removed when the last block is gone
+}
+
+
+template<typename Chunks>
+[[nodiscard]] static ReverseMemoryUsage calcMemoryUsage(const Chunks& chunks)
+{
+	ReverseMemoryUsage result;
+	for (const auto& [idx, chunk] : chunks) {
+		result.add(chunk.savestate, chunk.deltaBlocks);
+	}
+	return result;
+}
+
+[[nodiscard]] static double toMB(size_t bytes)
+{
+	return double(bytes) / (1024.0 * 1024.0);
 }
 
 
@@ -137,11 +193,33 @@ REGISTER_POLYMORPHIC_CLASS(StateChange, EndLogEvent, "EndLog");
 ReverseManager::ReverseManager(MSXMotherBoard& motherBoard_)
 	: syncNewSnapshot(motherBoard_.getScheduler())
 	, syncInputEvent (motherBoard_.getScheduler())
+	, syncStateHash  (motherBoard_.getScheduler())
 	, motherBoard(motherBoard_)
 	, eventDistributor(motherBoard.getReactor().getEventDistributor())
 	, reverseCmd(motherBoard.getCommandController())
+	, stateHashSetting(
+		motherBoard.getCommandController(), "reverse_state_hash",
+		"While collecting reverse data, also record a hash of the emulated "
+		"state every frame. These hashes are stored in replay files and "
+		"checked while replaying, to detect replays that diverge.",
+		false)
+	, memoryBudgetSetting(
+		motherBoard.getCommandController(), "reverse_memory_budget",
+		"Maximum amount of memory (in MB) used by the reverse history, "
+		"0 means unlimited. When the history grows larger, older "
+		"snapshots are thinned out (the oldest and the most recent "
+		"snapshot are always kept).",
+		1024, 0, 1024 * 1024)
+	, spillSetting(
+		motherBoard.getCommandController(), "reverse_spill_after",
+		"Move reverse snapshots that are older than this number of "
+		"seconds from RAM to a temporary file on disk (0 means never). "
+		"This allows a much longer reverse history. Going back to such "
+		"a snapshot reads it back from disk.",
+		0, 0, 24 * 60 * 60)
 {
 	eventDistributor.registerEventListener(EventType::TAKE_REVERSE_SNAPSHOT, *this);
+	stateHashSetting.attach(*this);
 
 	assert(!isCollecting());
 	assert(!isReplaying());
@@ -150,6 +228,7 @@ ReverseManager::ReverseManager(MSXMotherBoard& motherBoard_)
 ReverseManager::~ReverseManager()
 {
 	stop();
+	stateHashSetting.detach(*this);
 	eventDistributor.unregisterEventListener(EventType::TAKE_REVERSE_SNAPSHOT, *this);
 }
 
@@ -166,6 +245,7 @@ void ReverseManager::start()
 		takeSnapshot(getCurrentTime());
 		// schedule creation of next snapshot
 		schedule(getCurrentTime());
+		scheduleStateHash(getCurrentTime());
 		// start recording events
 		motherBoard.getStateChangeDistributor().registerRecorder(*this);
 	}
@@ -178,7 +258,9 @@ void ReverseManager::stop()
 		motherBoard.getStateChangeDistributor().unregisterRecorder(*this);
 		syncNewSnapshot.removeSyncPoint(); // don't schedule new snapshot takings
 		syncInputEvent .removeSyncPoint(); // stop any pending replay actions
+		syncStateHash  .removeSyncPoint();
 		history.clear();
+		divergence.reset();
 		replayIndex = 0;
 		collecting = false;
 		pendingTakeSnapshot = false;
@@ -248,6 +330,32 @@ void ReverseManager::status(TclObject& result) const
 	}
 	EmuTime le(isCollecting() && (lastEvent != rend(history.events)) ? (*lastEvent)->getTime() : EmuTime::zero());
 	result.addDictKeyValue("last_event", (le - EmuTime::zero()).toDouble());
+
+	if (divergence) {
+		TclObject subsystems;
+		subsystems.addListElements(divergence->subsystems);
+		result.addDictKeyValue("divergence", makeTclDict(
+			"time", (divergence->time - EmuTime::zero()).toDouble(),
+			"frame", narrow<unsigned>(divergence->frame),
+			"subsystems", subsystems));
+	}
+
+	auto usage = calcMemoryUsage(history.chunks);
+	result.addDictKeyValue("memory", makeTclDict(
+		"usage", toMB(usage.getTotal()),
+		"uncompressed", toMB(usage.getUncompressed()),
+		"compression_ratio", usage.getTotal() ? double(usage.getUncompressed()) / double(usage.getTotal()) : 1.0,
+		"budget", memoryBudgetSetting.getInt(),
+		"spilled", toMB(history.spilledBlocks.getSize())));
+
+	if (lastSeek) {
+		result.addDictKeyValue("last_seek", makeTclDict(
+			"restore", lastSeek->restore,
+			"fast_forward", lastSeek->fastForward,
+			"render", lastSeek->render,
+			"emulated", lastSeek->emulated,
+			"speed", lastSeek->fastForward > 0.0 ? lastSeek->emulated / lastSeek->fastForward : 0.0));
+	}
 }
 
 void ReverseManager::debugInfo(TclObject& result) const
@@ -256,15 +364,21 @@ void ReverseManager::debugInfo(TclObject& result) const
 	// information means nothing. We should remove this later.
 	std::string res;
 	size_t totalSize = 0;
+	auto usage = calcMemoryUsage(history.chunks);
 	for (const auto& [idx, chunk] : history.chunks) {
 		strAppend(res, idx, ' ',
 		          (chunk.time - EmuTime::zero()).toDouble(), ' ',
 		          ((chunk.time - EmuTime::zero()).toDouble() / (getCurrentTime() - EmuTime::zero()).toDouble()) * 100, "%"
 		          " (", chunk.savestate.size(), ")"
-		          " (next event index: ", chunk.eventCount, ")\n");
+		          " (exclusive memory: ", usage.exclusive(chunk.savestate, chunk.deltaBlocks), ")"
+		          " (next event index: ", chunk.eventCount, ")",
+		          chunk.spilled ? " (spilled)\n" : "\n");
 		totalSize += chunk.savestate.size();
 	}
-	strAppend(res, "total size: ", totalSize, '\n');
+	strAppend(res, "total size: ", totalSize, "\n"
+	               "memory usage: ", usage.getTotal(), "\n"
+	               "uncompressed size: ", usage.getUncompressed(), "\n"
+	               "spill file size: ", history.spilledBlocks.getSize(), '\n');
 	result = res;
 }
 
@@ -366,13 +480,18 @@ void ReverseManager::goTo(
 		                  : firstTime;
 
 		// find oldest snapshot that is not newer than requested time
-		// TODO ATM we do a linear search, could be improved to do a binary search.
+		// The sequence numbers are (approximately) proportional to the
+		// snapshot times, so use that to directly locate a nearby
+		// snapshot (O(log n)), then correct for the approximation. The
+		// snapshot times are increasing with the sequence numbers.
 		assert(it->second.time <= preTarget); // first one is not newer
-		assert(it != end(hist.chunks)); // there are snapshots
-		do {
+		it = hist.chunks.upper_bound(hist.getNextSeqNum(preTarget));
+		while (it != end(hist.chunks) && it->second.time <= preTarget) {
 			++it;
-		} while (it != end(hist.chunks) &&
-			 it->second.time <= preTarget);
+		}
+		while (it != begin(hist.chunks) && std::prev(it)->second.time > preTarget) {
+			--it;
+		}
 		// We found the first one that's newer, previous one is last
 		// one that's not newer (thus older or equal).
 		assert(it != begin(hist.chunks));
@@ -391,6 +510,8 @@ void ReverseManager::goTo(
 		//   'reverse loadreplay' command.
 		auto& reactor = motherBoard.getReactor();
 		EmuTime currentTime = getCurrentTime();
+		SeekStats stats;
+		auto startSeek = Timer::getTime();
 		MSXMotherBoard* newBoard;
 		Reactor::Board newBoard_; // either nullptr or the same as newBoard
 		if (sameTimeLine &&
@@ -409,9 +530,8 @@ void ReverseManager::goTo(
 			// suppress messages we'd get by deserializing (and
 			// thus instantiating the parts of) the new board
 			newBoard->getMSXCliComm().setSuppressMessages(true);
-			MemInputArchive in(chunk.savestate,
-					   chunk.deltaBlocks);
-			in.serialize("machine", *newBoard);
+			restoreSnapshot(chunk, *newBoard);
+			stats.restore = double(Timer::getTime() - startSeek) * 1e-6;
 
 			if (eventDelay) {
 				// Handle all events that are scheduled, but not yet
@@ -447,7 +567,8 @@ void ReverseManager::goTo(
 		// at least the usual interval, but the later, the more: each
 		// time divide the remaining time in half and make a snapshot
 		// there.
-		auto lastProgress = Timer::getTime();
+		auto startFastForward = Timer::getTime();
+		auto lastProgress = startFastForward;
 		auto startMSXTime = newBoard->getCurrentTime();
 		auto lastSnapshotTarget = startMSXTime;
 		bool everShowedProgress = false;
@@ -483,8 +604,13 @@ void ReverseManager::goTo(
 				lastSnapshotTarget = nextSnapshotTarget;
 			}
 		}
+		auto startRender = Timer::getTime();
+		stats.fastForward = double(startRender - startFastForward) * 1e-6;
+		stats.emulated = (newBoard->getCurrentTime() - startMSXTime).toDouble();
+
 		// re-enable messages
 		newBoard->getMSXCliComm().setSuppressMessages(false);
+		newBoard->getReverseManager().reportStateDivergence();
 		// re-enable automatic snapshots
 		schedule(getCurrentTime());
 
@@ -500,6 +626,8 @@ void ReverseManager::goTo(
 		// Fast forward to actual target time with board activated.
 		// This makes sure the video output gets rendered.
 		newBoard->fastForward(targetTime, false);
+		stats.render = double(Timer::getTime() - startRender) * 1e-6;
+		newBoard->getReverseManager().lastSeek = stats;
 
 		// In case we didn't actually create a new board, don't leave
 		// the (old) board muted.
@@ -516,6 +644,18 @@ void ReverseManager::goTo(
 	}
 }
 
+void ReverseManager::restoreSnapshot(const ReverseChunk& chunk, MSXMotherBoard& board)
+{
+	if (chunk.replayFile) {
+		auto state = chunk.replayFile->loadKeyframe(chunk.keyframe);
+		MemInputArchive in(std::span{state}); // blobs stored inline
+		in.serialize("machine", board);
+	} else {
+		MemInputArchive in(chunk.savestate, chunk.deltaBlocks);
+		in.serialize("machine", board);
+	}
+}
+
 void ReverseManager::transferState(MSXMotherBoard& newBoard)
 {
 	// Transfer view only mode
@@ -542,44 +682,13 @@ void ReverseManager::transferState(MSXMotherBoard& newBoard)
 	newBoard.getMSXCommandController().transferSettings(oldController);
 }
 
-void ReverseManager::saveReplay(
-	Interpreter& interp, std::span<const TclObject> tokens, TclObject& result)
+std::vector<const ReverseManager::ReverseChunk*> ReverseManager::selectReplaySnapshots(
+	unsigned maxNofExtraSnapshots) const
 {
 	const auto& chunks = history.chunks;
-	if (chunks.empty()) {
-		throw CommandException("No recording...");
-	}
-
-	std::string_view filenameArg;
-	int maxNofExtraSnapshots = MAX_NOF_SNAPSHOTS;
-	std::array info = {valueArg("-maxnofextrasnapshots", maxNofExtraSnapshots)};
-	auto args = parseTclArgs(interp, tokens.subspan(2), info);
-	switch (args.size()) {
-		case 0: break; // nothing
-		case 1: filenameArg = args[0].getString(); break;
-		default: throw SyntaxError();
-	}
-	if (maxNofExtraSnapshots < 0) {
-		throw CommandException("Maximum number of snapshots should be at least 0");
-	}
-
-	auto filename = FileOperations::parseCommandFileArgument(
-		filenameArg, REPLAY_DIR, "openmsx", REPLAY_EXTENSION);
-
-	auto& reactor = motherBoard.getReactor();
-	Replay replay(reactor);
-	replay.reRecordCount = reRecordCount;
-
-	// store current time (possibly somewhere in the middle of the timeline)
-	// so that on load we can go back there
-	replay.currentTime = getCurrentTime();
-
-	// restore first snapshot to be able to serialize it to a file
-	auto initialBoard = reactor.createEmptyMotherBoard();
-	MemInputArchive in(begin(chunks)->second.savestate,
-			   begin(chunks)->second.deltaBlocks);
-	in.serialize("machine", *initialBoard);
-	replay.motherBoards.push_back(std::move(initialBoard));
+	assert(!chunks.empty());
+	std::vector<const ReverseChunk*> result;
+	result.push_back(&begin(chunks)->second);
 
 	if (maxNofExtraSnapshots > 0) {
 		// determine which extra snapshots to put in the replay
@@ -603,11 +712,7 @@ void ReverseManager::saveReplay(
 				assert(it->second.time <= nextPartitionEnd);
 				if (it != lastAddedIt) {
 					// this is a new one, add it to the list of snapshots
-					Reactor::Board board = reactor.createEmptyMotherBoard();
-					MemInputArchive in2(it->second.savestate,
-							    it->second.deltaBlocks);
-					in2.serialize("machine", *board);
-					replay.motherBoards.push_back(std::move(board));
+					result.push_back(&it->second);
 					lastAddedIt = it;
 				}
 				++it;
@@ -618,6 +723,38 @@ void ReverseManager::saveReplay(
 		}
 		assert(lastAddedIt == std::prev(end(chunks))); // last snapshot must be included
 	}
+	return result;
+}
+
+void ReverseManager::saveReplay(
+	Interpreter& interp, std::span<const TclObject> tokens, TclObject& result)
+{
+	const auto& chunks = history.chunks;
+	if (chunks.empty()) {
+		throw CommandException("No recording...");
+	}
+
+	std::string_view filenameArg;
+	std::optional<int> maxNofExtraSnapshots;
+	bool binary = false;
+	std::array info = {
+		valueArg("-maxnofextrasnapshots", maxNofExtraSnapshots),
+		flagArg("-binary", binary),
+	};
+	auto args = parseTclArgs(interp, tokens.subspan(2), info);
+	switch (args.size()) {
+		case 0: break; // nothing
+		case 1: filenameArg = args[0].getString(); break;
+		default: throw SyntaxError();
+	}
+	if (maxNofExtraSnapshots && (*maxNofExtraSnapshots < 0)) {
+		throw CommandException("Maximum number of snapshots should be at least 0");
+	}
+
+	auto filename = FileOperations::parseCommandFileArgument(
+		filenameArg, REPLAY_DIR, "openmsx", REPLAY_EXTENSION);
+
+	auto snapshots = selectReplaySnapshots(maxNofExtraSnapshots.value_or(MAX_NOF_SNAPSHOTS));
 
 	// add sentinel when there isn't one yet
 	bool addSentinel = history.events.empty() ||
@@ -628,10 +765,30 @@ void ReverseManager::saveReplay(
 			getCurrentTime()));
 	}
 	try {
-		XmlOutputArchive out(filename);
-		replay.events = &history.events;
-		out.serialize("replay", replay);
-		out.close();
+		if (binary) {
+			saveBinaryReplay(filename, snapshots);
+		} else {
+			auto& reactor = motherBoard.getReactor();
+			Replay replay(reactor);
+			replay.reRecordCount = reRecordCount;
+
+			// store current time (possibly somewhere in the middle of the timeline)
+			// so that on load we can go back there
+			replay.currentTime = getCurrentTime();
+
+			// restore the snapshots to be able to serialize them to a file
+			for (const auto* chunk : snapshots) {
+				auto board = reactor.createEmptyMotherBoard();
+				restoreSnapshot(*chunk, *board);
+				replay.motherBoards.push_back(std::move(board));
+			}
+
+			XmlOutputArchive out(filename);
+			replay.events = &history.events;
+			replay.stateHashes = &history.stateHashes;
+			out.serialize("replay", replay);
+			out.close();
+		}
 	} catch (MSXException&) {
 		if (addSentinel) {
 			history.events.pop_back();
@@ -650,6 +807,87 @@ void ReverseManager::saveReplay(
 	result = filename;
 }
 
+void ReverseManager::saveBinaryReplay(
+	const std::string& filename, std::span<const ReverseChunk* const> snapshots)
+{
+	auto& reactor = motherBoard.getReactor();
+	ReplayFile::Writer writer(filename);
+
+	BinaryReplay replay;
+	replay.events = &history.events;
+	replay.stateHashes = &history.stateHashes;
+	replay.currentTime = getCurrentTime();
+	replay.reRecordCount = reRecordCount;
+
+	// Each snapshot is restored one at a time and immediately written, so
+	// there's only one extra machine in memory.
+	for (const auto* chunk : snapshots) {
+		auto board = reactor.createEmptyMotherBoard();
+		board->getMSXCliComm().setSuppressMessages(true);
+		restoreSnapshot(*chunk, *board);
+		MemOutputArchive out; // blobs stored inline
+		out.serialize("machine", *board);
+		auto state = std::move(out).releaseBuffer();
+		replay.keyframes.push_back(writer.addKeyframe(chunk->time, state));
+	}
+
+	MemOutputArchive out;
+	out.serialize("replay", replay);
+	writer.finish(std::move(out).releaseBuffer());
+}
+
+void ReverseManager::loadBinaryReplay(
+	const std::string& filename, ReverseHistory& newHistory,
+	EmuTime& saveTime, unsigned& newReRecordCount)
+{
+	auto file = std::make_shared<ReplayFile>(filename);
+	auto index = file->loadIndex();
+
+	BinaryReplay replay;
+	replay.events = &newHistory.events;
+	replay.stateHashes = &newHistory.stateHashes;
+	MemInputArchive in(std::span{index}); // blobs stored inline
+	in.serialize("replay", replay);
+	if (replay.keyframes.empty() || newHistory.events.empty()) {
+		throw MSXException("Invalid replay file: no snapshots");
+	}
+	saveTime = replay.currentTime;
+	newReRecordCount = replay.reRecordCount;
+
+	// Only register the snapshots, they're read when needed.
+	const auto& newEvents = newHistory.events;
+	unsigned replayIdx = 0;
+	for (const auto& keyframe : replay.keyframes) {
+		ReverseChunk newChunk;
+		newChunk.time = keyframe.time;
+		newChunk.replayFile = file;
+		newChunk.keyframe = keyframe;
+
+		while (replayIdx < newEvents.size() &&
+		       (newEvents[replayIdx]->getTime() < newChunk.time)) {
+			replayIdx++;
+		}
+		newChunk.eventCount = replayIdx;
+
+		newHistory.chunks[newHistory.getNextSeqNum(newChunk.time)] =
+			std::move(newChunk);
+	}
+}
+
+[[nodiscard]] static EmuTime getReplayDestination(
+	Interpreter& interp, const std::optional<TclObject>& where, EmuTime saveTime)
+{
+	if (!where || (*where == "begin")) {
+		return EmuTime::zero();
+	} else if (*where == "end") {
+		return EmuTime::infinity();
+	} else if (*where == "savetime") {
+		return saveTime;
+	} else {
+		return EmuTime::zero() + EmuDuration::sec(where->getDouble(interp));
+	}
+}
+
 void ReverseManager::loadReplay(
 	Interpreter& interp, std::span<const TclObject> tokens, TclObject& result)
 {
@@ -681,11 +919,34 @@ void ReverseManager::loadReplay(
 		throw e2;
 	}}}
 
+	if (ReplayFile::isReplayFile(filename)) {
+		// Only reads the event log and the list of snapshots.
+		ReverseHistory newHistory;
+		auto saveTime = EmuTime::zero();
+		unsigned newReRecordCount = 0;
+		try {
+			loadBinaryReplay(filename, newHistory, saveTime, newReRecordCount);
+		} catch (MSXException& e) {
+			throw CommandException("Cannot load replay: ", e.getMessage());
+		}
+		auto destination = getReplayDestination(interp, where, saveTime);
+
+		motherBoard.getStateChangeDistributor().setViewOnlyMode(enableViewOnly);
+		reRecordCount = newReRecordCount;
+		bool noVideo = false;
+		goTo(destination, noVideo, newHistory, false); // move to different time-line
+
+		result = tmpStrCat("Loaded replay from ", filename);
+		return;
+	}
+
 	// restore replay
 	auto& reactor = motherBoard.getReactor();
 	Replay replay(reactor);
 	Events events;
+	StateHashes stateHashes;
 	replay.events = &events;
+	replay.stateHashes = &stateHashes;
 	try {
 		XmlInputArchive in(filename);
 		in.serialize("replay", replay);
@@ -697,16 +958,7 @@ void ReverseManager::loadReplay(
 	}
 
 	// get destination time index
-	auto destination = EmuTime::zero();
-	if (!where || (*where == "begin")) {
-		destination = EmuTime::zero();
-	} else if (*where == "end") {
-		destination = EmuTime::infinity();
-	} else if (*where == "savetime") {
-		destination = replay.currentTime;
-	} else {
-		destination += EmuDuration::sec(where->getDouble(interp));
-	}
+	auto destination = getReplayDestination(interp, where, replay.currentTime);
 
 	// OK, we are going to be actually changing states now
 
@@ -728,6 +980,7 @@ void ReverseManager::loadReplay(
 	// Restore event log
 	swap(newHistory.events, events);
 	auto& newEvents = newHistory.events;
+	newHistory.stateHashes.swap(stateHashes);
 
 	// Restore snapshots
 	unsigned replayIdx = 0;
@@ -776,6 +1029,7 @@ void ReverseManager::transferHistory(ReverseHistory& oldHistory,
 	// resume collecting (and event recording)
 	collecting = true;
 	schedule(getCurrentTime());
+	scheduleStateHash(getCurrentTime());
 	motherBoard.getStateChangeDistributor().registerRecorder(*this);
 
 	// start replaying events
@@ -852,6 +1106,77 @@ bool ReverseManager::signalEvent(const Event& event)
 	return false;
 }
 
+void ReverseManager::update(const Setting& setting) noexcept
+{
+	assert(&setting == &stateHashSetting); (void)setting;
+	syncStateHash.removeSyncPoint();
+	scheduleStateHash(getCurrentTime());
+}
+
+void ReverseManager::execStateHash(EmuTime time)
+{
+	calcStateHashes(currentHashes);
+	auto& hashes = history.stateHashes;
+	if (!isReplaying()) {
+		hashes.record(time, currentHashes);
+	} else if (!divergence) {
+		// Only check when the recording has a hash for this exact
+		// moment (e.g. it's not there when the recording was made
+		// with state hashes disabled).
+		if (auto idx = hashes.find(time); idx >= 0) {
+			auto frame = size_t(idx);
+			if (hashes[frame].hash != StateHashes::combine(currentHashes)) {
+				divergence.emplace(StateDivergence{
+					time, frame, hashes.diff(frame, currentHashes)});
+				reportStateDivergence();
+			}
+		}
+	}
+	scheduleStateHash(time);
+}
+
+void ReverseManager::calcStateHashes(std::vector<StateHashes::Subsystem>& result)
+{
+	// We use the debuggables to get (almost) all emulated state: RAM,
+	// VRAM, CPU and device registers. Only the ones that opt in (see
+	// Debuggable::includeInStateHash()), so e.g. not ROM content or the
+	// different views on memory. RAM is hashed in place, the others are
+	// small register sets.
+	result.clear();
+	for (const auto& [name, debuggable] : motherBoard.getDebugger().getDebuggables()) {
+		if (!debuggable->includeInStateHash()) continue;
+		auto buf = debuggable->getStateBuffer();
+		if (buf.empty()) {
+			auto size = debuggable->getSize();
+			if (hashBuffer.size() < size) hashBuffer.resize(size);
+			std::span out{hashBuffer.data(), size};
+			debuggable->readBlock(0, out);
+			buf = out;
+		}
+		result.push_back({name, xxhash(std::string_view(
+			std::bit_cast<const char*>(buf.data()), buf.size()))});
+	}
+	std::ranges::sort(result, {}, &StateHashes::Subsystem::name);
+}
+
+void ReverseManager::reportStateDivergence()
+{
+	// During reverse goto, messages are suppressed while fast-forwarding.
+	// In that case we get called again when that's finished.
+	if (!divergence || divergence->reported) return;
+	auto& cliComm = motherBoard.getMSXCliComm();
+	if (cliComm.isSuppressingMessages()) return;
+
+	divergence->reported = true;
+	auto subsystems = divergence->subsystems.empty()
+		? std::string("unknown (the machine configuration changed)")
+		: strCat(join(divergence->subsystems, ", "));
+	cliComm.printWarning(
+		"Replay diverged from the recording at frame ", divergence->frame,
+		" (time ", (divergence->time - EmuTime::zero()).toDouble(), "s). "
+		"Differing state: ", subsystems);
+}
+
 unsigned ReverseManager::ReverseHistory::getNextSeqNum(EmuTime time) const
 {
 	if (chunks.empty()) {
@@ -883,6 +1208,9 @@ void ReverseManager::takeSnapshot(EmuTime time)
 	newChunk.time = time;
 	newChunk.savestate = std::move(out).releaseBuffer();
 	newChunk.eventCount = replayIndex;
+
+	spillOldSnapshots();
+	enforceMemoryBudget();
 }
 
 void ReverseManager::replayNextEvent()
@@ -912,6 +1240,8 @@ void ReverseManager::stopReplay(EmuTime time) noexcept
 			return p.second.time > time;
 		});
 		history.chunks.erase(it, end(history.chunks));
+		history.stateHashes.eraseAfter(time);
+		if (divergence && (divergence->time > time)) divergence.reset();
 		// this also means someone is changing history, record that
 		reRecordCount++;
 	}
@@ -945,11 +1275,91 @@ void ReverseManager::dropOldSnapshots(unsigned count)
 	}
 }
 
+/* Complements dropOldSnapshots(): when the history uses more memory than
+ * allowed, drop snapshots till it fits again. Each time the snapshot is
+ * dropped that leaves the smallest gap relative to its age, so that (like
+ * with dropOldSnapshots()) the distance between the remaining snapshots
+ * grows with their age. The oldest and the newest snapshot are never dropped
+ * (the sequence numbers are relative to the oldest snapshot).
+ */
+void ReverseManager::enforceMemoryBudget()
+{
+	auto budget = size_t(memoryBudgetSetting.getInt()) * 1024 * 1024;
+	if (budget == 0) return; // unlimited
+
+	auto& chunks = history.chunks;
+	auto usage = calcMemoryUsage(chunks);
+	if (usage.getTotal() > budget) {
+		// The most recent blocks might still be compressed in the
+		// background, they then count with their uncompressed size. Wait
+		// for that before dropping history that would fit after all.
+		DeltaBlock::waitAllReady();
+		usage.refresh();
+	}
+	while ((usage.getTotal() > budget) && (chunks.size() > 2)) {
+		auto now = rbegin(chunks)->second.time;
+		auto best = end(chunks);
+		// Spilled snapshots use little RAM, prefer to drop others.
+		auto bestCost = std::pair(true, std::numeric_limits<double>::infinity());
+		auto prev = begin(chunks);
+		for (auto it = std::next(prev); std::next(it) != end(chunks); prev = it++) {
+			auto next = std::next(it);
+			double gap = (next->second.time - prev->second.time).toDouble();
+			double age = (now - it->second.time).toDouble() + SNAPSHOT_PERIOD;
+			auto cost = std::pair(it->second.spilled, gap / age);
+			if (best == end(chunks) || (cost < bestCost)) {
+				bestCost = cost;
+				best = it;
+			}
+		}
+		assert(best != end(chunks));
+		usage.remove(best->second.savestate, best->second.deltaBlocks);
+		chunks.erase(best);
+	}
+}
+
+/* Move the delta blocks of snapshots older than 'reverse_spill_after' to the
+ * spill file. Only the (small) savestate buffer of those snapshots remains in
+ * RAM. The actual writing happens in the background, a write error is only
+ * reported on the next call.
+ */
+void ReverseManager::spillOldSnapshots()
+{
+	int spillAfter = spillSetting.getInt();
+	if ((spillAfter == 0) || history.chunks.empty()) return;
+
+	auto now = rbegin(history.chunks)->second.time;
+	try {
+		for (auto& [idx, chunk] : history.chunks) {
+			if (chunk.spilled) continue;
+			if ((now - chunk.time).toDouble() < spillAfter) break;
+
+			history.spilledBlocks.spill(chunk.deltaBlocks);
+			chunk.spilled = true;
+		}
+	} catch (MSXException& e) {
+		motherBoard.getMSXCliComm().printWarning(
+			"Couldn't move old reverse snapshots to disk, "
+			"disabling reverse_spill_after: ", e.getMessage());
+		spillSetting.setInt(0);
+	}
+}
+
 void ReverseManager::schedule(EmuTime time)
 {
 	syncNewSnapshot.setSyncPoint(time + EmuDuration::sec(SNAPSHOT_PERIOD));
 }
 
+void ReverseManager::scheduleStateHash(EmuTime time)
+{
+	if (!isCollecting() || !stateHashSetting.getBoolean()) return;
+	// Take the hashes at fixed moments in time (multiples of the period),
+	// so that a replay takes them at the same moments as the recording.
+	auto sinceStart = time - EmuTime::zero();
+	syncStateHash.setSyncPoint(
+		time + STATE_HASH_PERIOD - (sinceStart % STATE_HASH_PERIOD));
+}
+
 
 // class ReverseCmd
 
@@ -999,7 +1409,8 @@ std::string ReverseManager::ReverseCmd::help(std::span<const TclObject> /*tokens
 	       "goto <time>         go to an absolute moment in time\n"
 	       "viewonlymode <bool> switch viewonly mode on or off\n"
 	       "truncatereplay      stop replaying and remove all 'future' data\n"
-	       "savereplay [<name>] save the first snapshot and all replay data as a 'replay' (with optional name)\n"
+	       "savereplay [-binary] [-maxnofextrasnapshots <n>] [<name>] save the first snapshot and all replay data as a 'replay' (with optional name)\n"
+	       "                    -binary: seekable format, fast to load, but only for this openMSX build\n"
 	       "loadreplay [-goto <begin|end|savetime|<n>>] [-viewonly] <name>   load a replay (snapshot and replay data) with given name and start replaying\n";
 }
 
@@ -1015,9 +1426,11 @@ void ReverseManager::ReverseCmd::tabCompletion(std::vector<std::string>& tokens)
 		completeString(tokens, subCommands);
 	} else if ((tokens.size() == 3) || (tokens[1] == "loadreplay")) {
 		if (tokens[1] == one_of("loadreplay", "savereplay")) {
-			static constexpr std::array cmds = {"-goto"sv, "-viewonly"sv};
+			static constexpr std::array loadCmds = {"-goto"sv, "-viewonly"sv};
+			static constexpr std::array saveCmds = {"-binary"sv, "-maxnofextrasnapshots"sv};
 			completeFileName(tokens, userDataFileContext(REPLAY_DIR),
-				(tokens[1] == "loadreplay") ? cmds : std::span<const std::string_view>{});
+				(tokens[1] == "loadreplay") ? std::span<const std::string_view>{loadCmds}
+				                            : std::span<const std::string_view>{saveCmds});
 		} else if (tokens[1] == "viewonlymode") {
 			static constexpr std::array options = {"true"sv, "false"sv};
 			completeString(tokens, options);
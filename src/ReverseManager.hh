@@ -1,19 +1,25 @@
 #ifndef REVERSEMANGER_HH
 #define REVERSEMANGER_HH
 
+#include "BooleanSetting.hh"
 #include "Command.hh"
 #include "EmuTime.hh"
 #include "EventListener.hh"
+#include "IntegerSetting.hh"
+#include "ReplayFile.hh"
 #include "Schedulable.hh"
+#include "StateHashes.hh"
 
 #include "DeltaBlock.hh"
 #include "MemBuffer.hh"
+#include "Observer.hh"
 #include "outer.hh"
 
 #include <cstdint>
 #include <deque>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ranges>
 #include <span>
 #include <string_view>
@@ -28,7 +34,7 @@ class MSXMotherBoard;
 class StateChange;
 class TclObject;
 
-class ReverseManager final : private EventListener
+class ReverseManager final : private EventListener, private Observer<Setting>
 {
 public:
 	static constexpr std::string_view REPLAY_DIR = "replays";
@@ -84,6 +90,15 @@ private:
 		// snapshot was created. So when going back replay should
 		// start at this index.
 		unsigned eventCount;
+
+		// Are the 'deltaBlocks' moved to the spill file?
+		bool spilled = false;
+
+		// A snapshot from a binary replay file is only read from
+		// that file when it's needed. For such snapshots 'deltaBlocks'
+		// and 'savestate' are empty.
+		std::shared_ptr<ReplayFile> replayFile;
+		ReplayFile::Keyframe keyframe;
 	};
 	using Chunks = std::map<unsigned, ReverseChunk>;
 	using Events = std::deque<std::unique_ptr<StateChange>>;
@@ -95,7 +110,27 @@ private:
 
 		Chunks chunks;
 		Events events;
+		StateHashes stateHashes;
 		LastDeltaBlocks lastDeltaBlocks;
+
+		// Disk cache for old snapshots.
+		SpilledDeltaBlocks spilledBlocks;
+	};
+
+	struct StateDivergence {
+		EmuTime time = EmuTime::zero();
+		size_t frame; // index in ReverseHistory::stateHashes
+		std::vector<std::string> subsystems;
+		bool reported = false;
+	};
+
+	// Timing of the last goTo() that ended on this machine. All durations
+	// in seconds, 'restore', 'fastForward' and 'render' are host time.
+	struct SeekStats {
+		double restore = 0.0;     // deserialize the snapshot (0 if none used)
+		double fastForward = 0.0; // emulate till 2 frames before the target
+		double render = 0.0;      // emulate (and render) the last 2 frames
+		double emulated = 0.0;    // emulated time covered by fastForward
 	};
 
 	void start();
@@ -108,6 +143,13 @@ private:
 	                std::span<const TclObject> tokens, TclObject& result);
 	void loadReplay(Interpreter& interp,
 	                std::span<const TclObject> tokens, TclObject& result);
+	[[nodiscard]] std::vector<const ReverseChunk*> selectReplaySnapshots(
+		unsigned maxNofExtraSnapshots) const;
+	void saveBinaryReplay(const std::string& filename,
+	                      std::span<const ReverseChunk* const> snapshots);
+	void loadBinaryReplay(const std::string& filename, ReverseHistory& newHistory,
+	                      EmuTime& saveTime, unsigned& newReRecordCount);
+	static void restoreSnapshot(const ReverseChunk& chunk, MSXMotherBoard& board);
 
 	void signalStopReplay(EmuTime time);
 	[[nodiscard]] EmuTime getEndTime(const ReverseHistory& history) const;
@@ -121,6 +163,11 @@ private:
 	void schedule(EmuTime time);
 	void replayNextEvent();
 	template<unsigned N> void dropOldSnapshots(unsigned count);
+	void enforceMemoryBudget();
+	void spillOldSnapshots();
+	void scheduleStateHash(EmuTime time);
+	void calcStateHashes(std::vector<StateHashes::Subsystem>& result);
+	void reportStateDivergence();
 
 	// Schedulable
 	struct SyncNewSnapshot final : Schedulable {
@@ -139,14 +186,26 @@ private:
 			rm.execInputEvent();
 		}
 	} syncInputEvent;
+	struct SyncStateHash final : Schedulable {
+		friend class ReverseManager;
+		explicit SyncStateHash(Scheduler& s) : Schedulable(s) {}
+		void executeUntil(EmuTime time) override {
+			auto& rm = OUTER(ReverseManager, syncStateHash);
+			rm.execStateHash(time);
+		}
+	} syncStateHash;
 
 	void execNewSnapshot();
 	void execInputEvent();
+	void execStateHash(EmuTime time);
 	[[nodiscard]] EmuTime getCurrentTime() const { return syncNewSnapshot.getCurrentTime(); }
 
 	// EventListener
 	bool signalEvent(const Event& event) override;
 
+	// Observer<Setting>
+	void update(const Setting& setting) noexcept override;
+
 private:
 	MSXMotherBoard& motherBoard;
 	EventDistributor& eventDistributor;
@@ -158,8 +217,16 @@ private:
 		void tabCompletion(std::vector<std::string>& tokens) const override;
 	} reverseCmd;
 
+	BooleanSetting stateHashSetting;
+	IntegerSetting memoryBudgetSetting;
+	IntegerSetting spillSetting;
+
 	EventDelay* eventDelay = nullptr;
 	ReverseHistory history;
+	std::optional<StateDivergence> divergence;
+	std::optional<SeekStats> lastSeek;
+	std::vector<StateHashes::Subsystem> currentHashes; // only used in execStateHash()
+	MemBuffer<uint8_t> hashBuffer; // idem
 	unsigned replayIndex = 0;
 	bool collecting = false;
 	bool pendingTakeSnapshot = false;
@@ -167,6 +234,7 @@ private:
 	unsigned reRecordCount = 0;
 
 	friend struct Replay;
+	friend struct BinaryReplay;
 };
 
 } // namespace openmsx
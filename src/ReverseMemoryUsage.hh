@@ -0,0 +1,118 @@
+#ifndef REVERSEMEMORYUSAGE_HH
+#define REVERSEMEMORYUSAGE_HH
+
+#include "DeltaBlock.hh"
+
+#include "MemBuffer.hh"
+#include "hash_map.hh"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace openmsx {
+
+/** Memory used by (a subset of) the snapshots in the reverse history. Delta
+  * blocks can be shared between snapshots (an unchanged block is reused, all
+  * diff blocks depend on a reference block), such blocks are counted once.
+  *
+  * The size of a block is taken when it's added. Blocks that are still being
+  * compressed in the background then count with their uncompressed size,
+  * use refresh() to re-read the current sizes.
+  */
+class ReverseMemoryUsage
+{
+public:
+	using Blocks = std::span<const std::shared_ptr<DeltaBlock>>;
+
+	void add(const MemBuffer<uint8_t>& savestate, Blocks blocks)
+	{
+		total        += savestate.size();
+		uncompressed += savestate.size();
+		for (const auto& b : blocks) {
+			uncompressed += b->getSize();
+			addBlock(b.get());
+		}
+	}
+
+	// Returns the number of bytes that are freed.
+	size_t remove(const MemBuffer<uint8_t>& savestate, Blocks blocks)
+	{
+		auto before = total;
+		total        -= savestate.size();
+		uncompressed -= savestate.size();
+		for (const auto& b : blocks) {
+			uncompressed -= b->getSize();
+			removeBlock(b.get());
+		}
+		return before - total;
+	}
+
+	/** Update the sizes of all blocks, e.g. after the background
+	  * compression finished (see DeltaBlock::waitAllReady()). */
+	void refresh()
+	{
+		for (auto& [block, use] : uses) {
+			auto memory = block->getMemorySize();
+			total = total - use.memory + memory;
+			use.memory = memory;
+		}
+	}
+
+	// Number of bytes that are only used by the given snapshot.
+	[[nodiscard]] size_t exclusive(const MemBuffer<uint8_t>& savestate, Blocks blocks) const
+	{
+		size_t result = savestate.size();
+		for (const auto& b : blocks) {
+			const auto* use = lookup(uses, b.get());
+			assert(use);
+			if (use->refs != 1) continue;
+			result += use->memory;
+			if (const auto* ref = b->getReference()) {
+				const auto* refUse = lookup(uses, ref);
+				assert(refUse);
+				if (refUse->refs == 1) result += refUse->memory;
+			}
+		}
+		return result;
+	}
+
+	[[nodiscard]] size_t getTotal() const { return total; }
+	[[nodiscard]] size_t getUncompressed() const { return uncompressed; }
+
+private:
+	void addBlock(const DeltaBlock* block)
+	{
+		auto [it, inserted] = uses.try_emplace(block, Use{block->getMemorySize(), 0});
+		++it->second.refs;
+		if (inserted) {
+			total += it->second.memory;
+			if (const auto* ref = block->getReference()) addBlock(ref);
+		}
+	}
+
+	void removeBlock(const DeltaBlock* block)
+	{
+		auto it = uses.find(block);
+		assert(it != uses.end());
+		if (--it->second.refs) return;
+		total -= it->second.memory;
+		uses.erase(it);
+		if (const auto* ref = block->getReference()) removeBlock(ref);
+	}
+
+private:
+	struct Use {
+		size_t memory; // snapshot of DeltaBlock::getMemorySize()
+		unsigned refs; // number of snapshots or diff blocks using this block
+	};
+	hash_map<const DeltaBlock*, Use> uses;
+	size_t total = 0;
+	size_t uncompressed = 0;
+};
+
+} // namespace openmsx
+
+#endif
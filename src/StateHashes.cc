@@ -0,0 +1,110 @@
+#include "StateHashes.hh"
+
+#include <algorithm>
+#include <utility>
+
+namespace openmsx {
+
+void StateHashes::swap(StateHashes& other) noexcept
+{
+	std::swap(names,     other.names);
+	std::swap(frames,    other.frames);
+	std::swap(nameIndex, other.nameIndex);
+	std::swap(last,      other.last);
+	std::swap(lastValid, other.lastValid);
+}
+
+void StateHashes::clear()
+{
+	StateHashes().swap(*this);
+}
+
+uint32_t StateHashes::combine(std::span<const Subsystem> current)
+{
+	std::string buf;
+	for (const auto& s : current) {
+		buf += s.name;
+		buf += '\0';
+		for (auto i : xrange(4)) {
+			buf += char(s.hash >> (8 * i));
+		}
+	}
+	return xxhash(buf);
+}
+
+unsigned StateHashes::getIndex(std::string_view name)
+{
+	if (const auto* idx = lookup(nameIndex, name)) return *idx;
+	auto idx = unsigned(names.size());
+	names.emplace_back(name);
+	nameIndex.try_emplace(names.back(), idx);
+	return idx;
+}
+
+void StateHashes::replayChanges(
+	size_t end, std::vector<std::optional<uint32_t>>& result) const
+{
+	result.assign(names.size(), std::nullopt);
+	for (auto f : xrange(end)) {
+		for (const auto& c : frames[f].changes) {
+			result[c.subsystem] = c.hash;
+		}
+	}
+}
+
+void StateHashes::record(EmuTime time, std::span<const Subsystem> current)
+{
+	if (!frames.empty() && (time <= frames.back().time)) return;
+
+	if (lastValid != frames.size()) {
+		// only after loading or after (partially) erasing the log
+		replayChanges(frames.size(), last);
+		lastValid = frames.size();
+	}
+
+	Frame frame;
+	frame.time = time;
+	frame.hash = combine(current);
+	for (const auto& s : current) {
+		auto idx = getIndex(s.name);
+		if (idx >= last.size()) last.resize(idx + 1);
+		if (last[idx] != s.hash) {
+			last[idx] = s.hash;
+			frame.changes.push_back({idx, s.hash});
+		}
+	}
+	frames.push_back(std::move(frame));
+	lastValid = frames.size();
+}
+
+void StateHashes::eraseAfter(EmuTime time)
+{
+	auto it = std::ranges::upper_bound(frames, time, {}, &Frame::time);
+	frames.erase(it, frames.end());
+	if (lastValid > frames.size()) lastValid = 0; // recalculate on next record()
+}
+
+ptrdiff_t StateHashes::find(EmuTime time) const
+{
+	auto it = std::ranges::lower_bound(frames, time, {}, &Frame::time);
+	if ((it == frames.end()) || (it->time != time)) return -1;
+	return std::distance(frames.begin(), it);
+}
+
+std::vector<std::string> StateHashes::diff(
+	size_t idx, std::span<const Subsystem> current) const
+{
+	std::vector<std::optional<uint32_t>> expected;
+	replayChanges(idx + 1, expected);
+
+	std::vector<std::string> result;
+	for (const auto& s : current) {
+		const auto* i = lookup(nameIndex, s.name);
+		if (!i || (expected[*i] != s.hash)) {
+			result.emplace_back(s.name);
+		}
+	}
+	return result;
+}
+
+} // namespace openmsx
@@ -0,0 +1,131 @@
+#ifndef STATEHASHES_HH
+#define STATEHASHES_HH
+
+#include "EmuTime.hh"
+
+#include "hash_map.hh"
+#include "xrange.hh"
+#include "xxhash.hh"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openmsx {
+
+/** A log of hashes of the emulated machine state, taken at regular moments
+  * in time (once per frame). It's part of the reverse history and of replay
+  * files. While replaying, the hashes of the current state are compared
+  * with the recorded ones, this detects replays that diverge (e.g. because
+  * of a change in the emulation code) long before the divergence becomes
+  * visible.
+  *
+  * The state is split in 'subsystems' (e.g. "CPU regs", "physical VRAM",
+  * "PSG regs"), each with its own hash, so that on a mismatch we can report
+  * which part of the machine diverged. To keep the log small, only the
+  * combined hash is stored for each frame, together with the hashes of the
+  * subsystems that changed since the previous frame.
+  */
+class StateHashes
+{
+public:
+	struct Subsystem {
+		std::string_view name;
+		uint32_t hash;
+	};
+
+	struct Change {
+		unsigned subsystem; // index in 'names'
+		uint32_t hash;
+
+		template<typename Archive>
+		void serialize(Archive& ar, unsigned /*version*/) {
+			ar.serialize("subsystem", subsystem,
+			             "hash",      hash);
+		}
+	};
+
+	struct Frame {
+		EmuTime time = EmuTime::zero();
+		uint32_t hash = 0; // combined hash of all subsystems
+		std::vector<Change> changes; // relative to the previous frame
+
+		template<typename Archive>
+		void serialize(Archive& ar, unsigned /*version*/) {
+			ar.serialize("time",    time,
+			             "hash",    hash,
+			             "changes", changes);
+		}
+	};
+
+public:
+	void swap(StateHashes& other) noexcept;
+	void clear();
+
+	[[nodiscard]] bool empty() const { return frames.empty(); }
+	[[nodiscard]] size_t size() const { return frames.size(); }
+
+	/** Combine the hashes of the individual subsystems (which must be
+	  * sorted on name) into one value.
+	  */
+	[[nodiscard]] static uint32_t combine(std::span<const Subsystem> current);
+
+	/** Append a new frame. Frames must be recorded in chronological order,
+	  * a frame that's not newer than the last recorded one is ignored.
+	  */
+	void record(EmuTime time, std::span<const Subsystem> current);
+
+	/** Drop all frames that are newer than the given time. */
+	void eraseAfter(EmuTime time);
+
+	/** Returns the index of the frame recorded at exactly the given time,
+	  * or -1 if there is no such frame.
+	  */
+	[[nodiscard]] ptrdiff_t find(EmuTime time) const;
+	[[nodiscard]] const Frame& operator[](size_t idx) const { return frames[idx]; }
+
+	/** Returns the names of the subsystems whose hash in 'current' doesn't
+	  * match the recorded hash in the given frame (this includes subsystems
+	  * that didn't exist yet at that moment during recording).
+	  */
+	[[nodiscard]] std::vector<std::string> diff(
+		size_t idx, std::span<const Subsystem> current) const;
+
+	template<typename Archive>
+	void serialize(Archive& ar, unsigned version);
+
+private:
+	[[nodiscard]] unsigned getIndex(std::string_view name);
+	void replayChanges(size_t end, std::vector<std::optional<uint32_t>>& result) const;
+
+private:
+	std::vector<std::string> names;
+	std::vector<Frame> frames; // sorted on time
+
+	// Not serialized, these can be recalculated from the above.
+	hash_map<std::string, unsigned, XXHasher> nameIndex;
+	std::vector<std::optional<uint32_t>> last; // subsystem hashes after the last frame
+	size_t lastValid = 0; // 'last' represents frames [0, lastValid)
+};
+
+template<typename Archive>
+void StateHashes::serialize(Archive& ar, unsigned /*version*/)
+{
+	ar.serialize("names",  names,
+	             "frames", frames);
+	if constexpr (Archive::IS_LOADER) {
+		nameIndex.clear();
+		for (auto i : xrange(names.size())) {
+			nameIndex.try_emplace(names[i], unsigned(i));
+		}
+		last.clear();
+		lastValid = 0;
+	}
+}
+
+} // namespace openmsx
+
+#endif
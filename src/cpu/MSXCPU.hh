@@ -211,6 +211,7 @@ private:
 		explicit Debuggable(MSXMotherBoard& motherboard);
 		[[nodiscard]] uint8_t read(unsigned address) override;
 		void write(unsigned address, uint8_t value) override;
+		[[nodiscard]] bool includeInStateHash() const override { return true; }
 	} debuggable;
 
 	bool z80Active{true};
@@ -87,6 +87,7 @@ MSXCPUInterface::MSXCPUInterface(MSXMotherBoard& motherBoard_)
 	, externalSlotInfo(motherBoard_.getMachineInfoCommand())
 	, inputPortInfo (motherBoard_.getMachineInfoCommand())
 	, outputPortInfo(motherBoard_.getMachineInfoCommand())
+	, slowPathProfiler(motherBoard_)
 	, dummyDevice(DeviceFactory::createDummyDevice(
 		*motherBoard_.getMachineConfig()))
 	, msxcpu(motherBoard_.getCPU())
@@ -604,6 +605,7 @@ void MSXCPUInterface::unregisterSlot(
 		// partial range
 		multi->remove(device, base, size);
 		if (multi->empty()) {
+			slowPathProfiler.forgetDevice(*multi);
 			delete multi;
 			slot = dummyDevice.get();
 		}
@@ -612,6 +614,7 @@ void MSXCPUInterface::unregisterSlot(
 		assert(slot == &device);
 		slot = dummyDevice.get();
 	}
+	slowPathProfiler.forgetDevice(device);
 	invalidateRWCache(narrow<uint16_t>(base), size, ps, ss);
 	updateVisible(page);
 }
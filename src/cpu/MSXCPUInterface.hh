@@ -10,6 +10,7 @@
 #include "MSXDevice.hh"
 #include "ProfileCounters.hh"
 #include "SimpleDebuggable.hh"
+#include "SlowPathProfiler.hh"
 
 #include "narrow.hh"
 
@@ -141,6 +142,9 @@ public:
 	 */
 	uint8_t readMem(uint16_t address, EmuTime time) {
 		tick(CacheLineCounters::SlowRead);
+		if (slowPathProfiler.isEnabled()) [[unlikely]] {
+			slowPathProfiler.countRead(visibleDevices[address >> 14], address);
+		}
 		if (disallowReadCache[address >> CacheLine::BITS]) [[unlikely]] {
 			return readMemSlow(address, time);
 		}
@@ -152,6 +156,9 @@ public:
 	 */
 	void writeMem(uint16_t address, uint8_t value, EmuTime time) {
 		tick(CacheLineCounters::SlowWrite);
+		if (slowPathProfiler.isEnabled()) [[unlikely]] {
+			slowPathProfiler.countWrite(visibleDevices[address >> 14], address);
+		}
 		if (disallowWriteCache[address >> CacheLine::BITS]) [[unlikely]] {
 			writeMemSlow(address, value, time);
 			return;
@@ -422,6 +429,8 @@ private:
 		             TclObject& result) const override;
 	} outputPortInfo;
 
+	SlowPathProfiler slowPathProfiler;
+
 	/** Updated visibleDevices for a given page and clears the cache
 	  * on changes.
 	  * Should be called whenever PrimarySlotState or SecondarySlotState
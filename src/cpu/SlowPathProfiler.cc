@@ -0,0 +1,106 @@
+#include "SlowPathProfiler.hh"
+
+#include "MSXDevice.hh"
+#include "MSXMotherBoard.hh"
+#include "TclObject.hh"
+
+#include "outer.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace openmsx {
+
+SlowPathProfiler::SlowPathProfiler(MSXMotherBoard& motherBoard)
+	: profileSetting(
+		motherBoard.getCommandController(), "slowpath_profile",
+		"Count memory accesses that bypass the CPU cache lines, per "
+		"device and per cache line (see 'machine_info slow_path')",
+		false, Setting::Save::NO)
+	, info(motherBoard.getMachineInfoCommand())
+{
+	profileSetting.attach(*this);
+}
+
+SlowPathProfiler::~SlowPathProfiler()
+{
+	profileSetting.detach(*this);
+}
+
+void SlowPathProfiler::forgetDevice(const MSXDevice& device)
+{
+	counts.erase(&device);
+}
+
+void SlowPathProfiler::update(const Setting& setting) noexcept
+{
+	assert(&setting == &profileSetting); (void)setting;
+	bool newEnabled = profileSetting.getBoolean();
+	if (newEnabled && !enabled) {
+		// start a new measurement
+		counts.clear();
+	}
+	enabled = newEnabled;
+}
+
+
+// class Info
+
+SlowPathProfiler::Info::Info(InfoCommand& machineInfoCommand)
+	: InfoTopic(machineInfoCommand, "slow_path")
+{
+}
+
+void SlowPathProfiler::Info::execute(
+	std::span<const TclObject> /*tokens*/, TclObject& result) const
+{
+	const auto& profiler = OUTER(SlowPathProfiler, info);
+
+	struct Line {
+		unsigned address;
+		unsigned reads;
+		unsigned writes;
+	};
+	std::vector<Line> lines;
+	for (const auto& [device, c] : profiler.counts) {
+		lines.clear();
+		unsigned totalReads = 0;
+		unsigned totalWrites = 0;
+		for (auto i : xrange(CacheLine::NUM)) {
+			if (c.reads[i] || c.writes[i]) {
+				lines.push_back({i * CacheLine::SIZE, c.reads[i], c.writes[i]});
+				totalReads  += c.reads [i];
+				totalWrites += c.writes[i];
+			}
+		}
+		if (lines.empty()) continue;
+		// hottest lines first
+		std::ranges::stable_sort(lines, std::greater{},
+			[](const Line& l) { return uint64_t(l.reads) + l.writes; });
+
+		TclObject lineList;
+		for (const auto& l : lines) {
+			lineList.addListElement(makeTclList(
+				l.address, l.reads, l.writes));
+		}
+		result.addDictKeyValue(device->getName(), makeTclDict(
+			"reads",  totalReads,
+			"writes", totalWrites,
+			"lines",  std::move(lineList)));
+	}
+}
+
+std::string SlowPathProfiler::Info::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Returns, per device, the number of memory reads and writes that "
+	       "did not use the CPU cache lines. The result is a dict with as "
+	       "key the device name, and as value a dict with the total 'reads' "
+	       "and 'writes' and a list of 'lines' {address reads writes}, "
+	       "sorted with the most frequently accessed cache line first. "
+	       "Counting is only done while the 'slowpath_profile' setting is "
+	       "enabled.";
+}
+
+} // namespace openmsx
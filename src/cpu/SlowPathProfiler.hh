@@ -0,0 +1,78 @@
+#ifndef SLOWPATHPROFILER_HH
+#define SLOWPATHPROFILER_HH
+
+#include "BooleanSetting.hh"
+#include "CacheLine.hh"
+#include "InfoTopic.hh"
+#include "Observer.hh"
+
+#include "hash_map.hh"
+
+#include <array>
+#include <cstdint>
+
+namespace openmsx {
+
+class MSXDevice;
+class MSXMotherBoard;
+
+/** Counts the memory accesses that can't use the CPU cache lines, thus the
+  * accesses that go via MSXCPUInterface::readMem()/writeMem() and a virtual
+  * call to the device. The counts are kept per device and per cache line.
+  *
+  * This helps to find devices (or device states) that would benefit from
+  * (better) getReadCacheLine()/getWriteCacheLine() support. Counting is off
+  * by default, it's enabled via the 'slowpath_profile' setting, the results
+  * can be queried via 'machine_info slow_path'.
+  */
+class SlowPathProfiler final : private Observer<Setting>
+{
+public:
+	explicit SlowPathProfiler(MSXMotherBoard& motherBoard);
+	SlowPathProfiler(const SlowPathProfiler&) = delete;
+	SlowPathProfiler(SlowPathProfiler&&) = delete;
+	SlowPathProfiler& operator=(const SlowPathProfiler&) = delete;
+	SlowPathProfiler& operator=(SlowPathProfiler&&) = delete;
+	~SlowPathProfiler();
+
+	[[nodiscard]] bool isEnabled() const { return enabled; }
+
+	void countRead(const MSXDevice* device, uint16_t address) {
+		++counts[device].reads[address >> CacheLine::BITS];
+	}
+	void countWrite(const MSXDevice* device, uint16_t address) {
+		++counts[device].writes[address >> CacheLine::BITS];
+	}
+
+	/** Drop the counts of a device that's being removed (we only store a
+	  * pointer to the device, so after removal we can't query its name
+	  * anymore).
+	  */
+	void forgetDevice(const MSXDevice& device);
+
+private:
+	// Observer<Setting>
+	void update(const Setting& setting) noexcept override;
+
+private:
+	struct Counts {
+		std::array<unsigned, CacheLine::NUM> reads = {};
+		std::array<unsigned, CacheLine::NUM> writes = {};
+	};
+
+	BooleanSetting profileSetting;
+
+	struct Info final : InfoTopic {
+		explicit Info(InfoCommand& machineInfoCommand);
+		void execute(std::span<const TclObject> tokens,
+		             TclObject& result) const override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+	} info;
+
+	hash_map<const MSXDevice*, Counts> counts;
+	bool enabled = false;
+};
+
+} // namespace openmsx
+
+#endif
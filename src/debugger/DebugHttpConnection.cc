@@ -306,6 +306,9 @@ void DebugHttpConnection::handleRequest(const HttpRequest& request)
 		handleApiRequest(request);
 	} else if (request.path == "/stream") {
 		handleStreamRequest(request);
+	} else if (request.path == "/telemetry") {
+		// Frame pacing telemetry, independent of the port type
+		handleTelemetryRequest(request);
 	} else {
 		sendErrorResponse(404, "Not Found");
 	}
@@ -324,6 +327,21 @@ void DebugHttpConnection::handleApiRequest(const HttpRequest& /*request*/)
 	sendHttpResponse(200, "application/json", json);
 }
 
+void DebugHttpConnection::handleTelemetryRequest(const HttpRequest& request)
+{
+	unsigned frames = 256;
+	auto framesIt = request.queryParams.find("frames");
+	if (framesIt != request.queryParams.end()) {
+		try {
+			frames = static_cast<unsigned>(std::stoul(framesIt->second));
+		} catch (...) {
+			frames = 256;
+		}
+	}
+	std::string json = infoProvider.getTelemetryInfo(frames);
+	sendHttpResponse(200, "application/json", json);
+}
+
 void DebugHttpConnection::handleInfoRequest(const HttpRequest& request)
 {
 	// Check Accept header to determine response type
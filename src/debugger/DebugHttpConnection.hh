@@ -69,6 +69,7 @@ private:
 	void handleApiRequest(const HttpRequest& request);
 	void handleInfoRequest(const HttpRequest& request);
 	void handleStreamRequest(const HttpRequest& request);
+	void handleTelemetryRequest(const HttpRequest& request);
 
 	// Info generation
 	[[nodiscard]] std::string generateInfo();
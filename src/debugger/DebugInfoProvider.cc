@@ -1,6 +1,8 @@
 #include "DebugInfoProvider.hh"
 
 #include "Reactor.hh"
+#include "Display.hh"
+#include "FrameTelemetry.hh"
 #include "MSXMotherBoard.hh"
 #include "MSXCPU.hh"
 #include "CPURegs.hh"
@@ -289,6 +291,58 @@ std::string DebugInfoProvider::getMemoryInfo(unsigned start, unsigned size)
 	return json.str();
 }
 
+std::string DebugInfoProvider::getTelemetryInfo(unsigned maxFrames)
+{
+	std::lock_guard<std::mutex> lock(accessMutex);
+
+	// FrameTelemetry is thread-safe, no need to touch the motherboard
+	auto frames = reactor.getDisplay().getFrameTelemetry().getFrames(maxFrames);
+	auto summary = FrameTelemetry::summarize(frames);
+
+	std::ostringstream json;
+	json << std::fixed << std::setprecision(3);
+	json << "{\n";
+	json << jsonNumber("timestamp", static_cast<int>(getTimestamp()));
+	json << jsonString("units", "ms");
+	json << jsonNumber("skipped", static_cast<int>(summary.skipped));
+
+	auto stat = [&](const char* name, const FrameTelemetry::Stat& st) {
+		json << "    \"" << name << "\": {\"min\": " << st.min
+		     << ", \"avg\": " << st.avg << ", \"max\": " << st.max << "}";
+	};
+	json << "  \"summary\": {\n";
+	stat("interval",     summary.interval);    json << ",\n";
+	stat("emulation",    summary.emulation);   json << ",\n";
+	stat("sleep",        summary.sleep);       json << ",\n";
+	stat("render",       summary.render);      json << ",\n";
+	stat("present",      summary.present);     json << ",\n";
+	stat("audio_buffer", summary.audioBuffer); json << ",\n";
+	stat("sync_drift",   summary.syncDrift);   json << "\n";
+	json << "  },\n";
+
+	// Oldest frame first, one frame per line
+	json << "  \"frames\": [";
+	bool first = true;
+	for (const auto& f : frames) {
+		if (!first) json << ",";
+		first = false;
+		json << "\n    {\"time\": " << f.time / 1000 // ms, like 'timestamp'
+		     << ", \"interval\": " << f.interval
+		     << ", \"emulation\": " << f.emulation
+		     << ", \"sleep\": " << f.sleep
+		     << ", \"render\": " << f.render
+		     << ", \"present\": " << f.present
+		     << ", \"audio_buffer\": " << f.audioBuffer
+		     << ", \"sync_drift\": " << f.syncDrift
+		     << ", \"skipped\": " << f.skipped << "}";
+	}
+	if (!frames.empty()) json << "\n  ";
+	json << "]\n";
+
+	json << "}";
+	return json.str();
+}
+
 // JSON formatting helpers
 std::string DebugInfoProvider::jsonEscape(const std::string& s)
 {
@@ -24,6 +24,7 @@ public:
 	[[nodiscard]] std::string getIOInfo();
 	[[nodiscard]] std::string getCPUInfo();
 	[[nodiscard]] std::string getMemoryInfo(unsigned start, unsigned size);
+	[[nodiscard]] std::string getTelemetryInfo(unsigned maxFrames);
 
 	// Get active motherboard (may be nullptr)
 	[[nodiscard]] MSXMotherBoard* getMotherBoard();
@@ -32,6 +32,18 @@ public:
 		}
 	}
 
+	/** Support for the reverse state hashes (see ReverseManager). Only
+	  * debuggables that opt in are hashed: those that hold emulated state
+	  * (not a view on state of other debuggables, not constant like ROM)
+	  * and whose readBlock() is cheap and has no side effects.
+	  */
+	[[nodiscard]] virtual bool includeInStateHash() const { return false; }
+
+	/** When the content is directly available as a buffer, return it, so
+	  * it can be hashed without copying. Otherwise readBlock() is used.
+	  */
+	[[nodiscard]] virtual std::span<const uint8_t> getStateBuffer() const { return {}; }
+
 protected:
 	Debuggable() = default;
 	~Debuggable() = default;
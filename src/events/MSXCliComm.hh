@@ -27,6 +27,7 @@ public:
 
 	// enable/disable message suppression
 	void setSuppressMessages(bool enable);
+	[[nodiscard]] bool isSuppressingMessages() const { return suppressMessages; }
 
 private:
 	MSXMotherBoard& motherBoard;
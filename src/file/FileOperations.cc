@@ -194,6 +194,13 @@ int deleteRecursive(zstring_view path)
 	return ec ? -1 : 0;
 }
 
+int rename(zstring_view from, zstring_view to)
+{
+	std::error_code ec;
+	fs::rename(makeFsPath(from), makeFsPath(to), ec);
+	return ec ? -1 : 0;
+}
+
 FILE_t openFile(zstring_view filename, zstring_view mode)
 {
 	// Mode must contain a 'b' character. On unix this doesn't make any
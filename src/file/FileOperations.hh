@@ -75,6 +75,11 @@ namespace openmsx::FileOperations {
 	  */
 	int deleteRecursive(zstring_view path);
 
+	/** Rename a file. When 'to' already exists it's replaced (also on
+	  * Windows, unlike the C library rename()).
+	  */
+	int rename(zstring_view from, zstring_view to);
+
 	/** Call fopen() in a platform-independent manner
 	  * @param filename the file path
 	  * @param mode the mode parameter, same as fopen
@@ -0,0 +1,136 @@
+#include "SpillFile.hh"
+
+#include "FileException.hh"
+#include "FileOperations.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace openmsx {
+
+SpillFile::SpillFile()
+{
+	auto dir = FileOperations::getTempDir();
+	auto fp = FileOperations::openUniqueFile(dir, filename);
+	if (!fp) {
+		throw FileException("Couldn't create temp file in ", dir);
+	}
+	fp.reset();
+	file = File(filename, "wb+");
+#ifndef _WIN32
+	// The open file handle keeps the data accessible.
+	FileOperations::unlink(filename);
+	filename.clear();
+#endif
+}
+
+SpillFile::~SpillFile()
+{
+	assert(used == 0);
+	mapping = {};
+	file.close();
+	if (!filename.empty()) {
+		FileOperations::unlink(filename);
+	}
+}
+
+size_t SpillFile::store(std::span<const uint8_t> data)
+{
+	std::scoped_lock lock(mutex);
+	auto num = data.size();
+	// first fit, otherwise append
+	auto offset = end;
+	auto it = std::ranges::find_if(freeRanges, [&](const auto& r) { return r.second >= num; });
+	if (it != freeRanges.end()) offset = it->first;
+
+	try {
+		file.seek(offset);
+		file.write(data);
+		// Unlike the mapping, the stdio buffer isn't shared with readers.
+		file.flush();
+	} catch (FileException& e) {
+		if (error.empty()) error = e.getMessage();
+		throw;
+	}
+
+	if (it != freeRanges.end()) {
+		auto [freeOffset, freeSize] = *it;
+		freeRanges.erase(it);
+		if (freeSize > num) freeRanges.emplace(freeOffset + num, freeSize - num);
+	} else {
+		end += num;
+		fileSize = std::max(fileSize, end);
+	}
+	if (offset < mapping.size()) mappingStale = true;
+	used += num;
+	return offset;
+}
+
+void SpillFile::free(size_t offset, size_t num)
+{
+	if (num == 0) return;
+	std::scoped_lock lock(mutex);
+	assert(used >= num);
+	used -= num;
+
+	// merge with the neighbouring free ranges
+	auto next = freeRanges.lower_bound(offset);
+	assert((next == freeRanges.end()) || (offset + num <= next->first));
+	if ((next != freeRanges.end()) && (offset + num == next->first)) {
+		num += next->second;
+		next = freeRanges.erase(next);
+	}
+	if (next != freeRanges.begin()) {
+		auto prev = std::prev(next);
+		assert(prev->first + prev->second <= offset);
+		if (prev->first + prev->second == offset) {
+			offset = prev->first;
+			num += prev->second;
+			freeRanges.erase(prev);
+		}
+	}
+	if (offset + num == end) {
+		// The file isn't truncated (it may still be mapped), the space
+		// is reused when appending.
+		end = offset;
+	} else {
+		freeRanges.emplace(offset, num);
+	}
+}
+
+std::span<const uint8_t> SpillFile::read(size_t offset, size_t num)
+{
+	std::scoped_lock lock(mutex);
+	assert((offset + num) <= end);
+	if (mappingStale || ((offset + num) > mapping.size())) {
+		// (re)map the whole file, including the recently written data
+		mapping = {};
+		mapping = file.mmap<const uint8_t>();
+		mappingStale = false;
+		if (mapping.size() < end) {
+			throw FileException("Error reading back temp file");
+		}
+	}
+	return {mapping.data() + offset, num};
+}
+
+size_t SpillFile::getSize() const
+{
+	std::scoped_lock lock(mutex);
+	return used;
+}
+
+size_t SpillFile::getFileSize() const
+{
+	std::scoped_lock lock(mutex);
+	return fileSize;
+}
+
+std::string SpillFile::getError() const
+{
+	std::scoped_lock lock(mutex);
+	return error;
+}
+
+} // namespace openmsx
@@ -0,0 +1,83 @@
+#ifndef SPILLFILE_HH
+#define SPILLFILE_HH
+
+#include "File.hh"
+#include "MappedFile.hh"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string>
+
+namespace openmsx {
+
+/** A temporary file, read back via a memory mapping.
+  *
+  * This is used to move data that's rarely needed out of RAM (e.g. old
+  * reverse snapshots). Data that's read back is paged in on demand by the
+  * OS, and those (clean, file-backed) pages can again be dropped by the OS
+  * under memory pressure. Space that's released with free() is reused by
+  * later calls to store(), so the file only grows when there's no suitable
+  * free range.
+  *
+  * store() and free() may be called from any thread, read() should always
+  * be called from the same thread.
+  *
+  * The file is created in the system temp directory and removed again when
+  * this object is destroyed (on non-Windows systems it's already unlinked
+  * right after creation, so it's also removed when openMSX crashes).
+  */
+class SpillFile
+{
+public:
+	/** @throws FileException when the file can't be created. */
+	SpillFile();
+	~SpillFile();
+
+	SpillFile(const SpillFile&) = delete;
+	SpillFile(SpillFile&&) = delete;
+	SpillFile& operator=(const SpillFile&) = delete;
+	SpillFile& operator=(SpillFile&&) = delete;
+
+	/** Write data to the file, in a free range or at the end.
+	  * @result The offset of the data in the file.
+	  * @throws FileException
+	  */
+	[[nodiscard]] size_t store(std::span<const uint8_t> data);
+
+	/** The given range (earlier returned by store()) is no longer used. */
+	void free(size_t offset, size_t size);
+
+	/** Read back data that was earlier stored. The result remains valid
+	  * till the next call to read().
+	  * @throws FileException
+	  */
+	[[nodiscard]] std::span<const uint8_t> read(size_t offset, size_t size);
+
+	/** Number of bytes in use (stored but not yet freed). */
+	[[nodiscard]] size_t getSize() const;
+
+	/** Size of the file, including free ranges. */
+	[[nodiscard]] size_t getFileSize() const;
+
+	/** The error of the first store() that failed, or empty. This allows
+	  * to report errors of stores done on another thread. */
+	[[nodiscard]] std::string getError() const;
+
+private:
+	std::string filename;
+	File file;
+	MappedFile<const uint8_t> mapping; // possibly only covers a prefix of the file
+	bool mappingStale = false; // a mapped range was overwritten
+	std::map<size_t, size_t> freeRanges; // offset -> size, never adjacent
+	size_t used = 0;
+	size_t end = 0; // end of the last used range
+	size_t fileSize = 0; // 'end' can drop, the file isn't truncated
+	std::string error;
+	mutable std::mutex mutex;
+};
+
+} // namespace openmsx
+
+#endif
@@ -8,6 +8,7 @@
 #include "ImGuiManager.hh"
 #include "ImGuiMessages.hh"
 #include "ImGuiMsxMusicViewer.hh"
+#include "ImGuiPlot.hh"
 #include "ImGuiSCCViewer.hh"
 #include "ImGuiTrainer.hh"
 #include "ImGuiUtils.hh"
@@ -15,12 +16,14 @@
 
 #include "AviRecorder.hh"
 #include "Display.hh"
+#include "FrameTelemetry.hh"
 
 #include "FileOperations.hh"
 
 #include "StringOp.hh"
 #include "enumerate.hh"
 #include "escape_newline.hh"
+#include "narrow.hh"
 
 #include <imgui.h>
 #include <imgui_stdlib.h>
@@ -143,6 +146,7 @@ void ImGuiTools::showMenu(MSXMotherBoard* motherBoard)
 		ImGui::MenuItem("SCC viewer", nullptr, &manager.sccViewer->show);
 		ImGui::MenuItem("MSX-Music viewer", nullptr, &manager.msxMusicViewer->show);
 		ImGui::MenuItem("Audio channel viewer", nullptr, &manager.waveViewer->show);
+		ImGui::MenuItem("Frame telemetry", nullptr, &showTelemetry);
 		ImGui::Separator();
 
 		im::Menu("Toys", [&]{
@@ -166,6 +170,7 @@ void ImGuiTools::paint(MSXMotherBoard* /*motherBoard*/)
 {
 	if (showScreenshot) paintScreenshot();
 	if (showRecord) paintRecord();
+	if (showTelemetry) paintTelemetry();
 	paintNotes();
 
 	confirmDialog.execute();
@@ -387,6 +392,75 @@ void ImGuiTools::paintRecord()
 	});
 }
 
+void ImGuiTools::paintTelemetry()
+{
+	ImGui::SetNextWindowSize(gl::vec2{36, 22} * ImGui::GetFontSize(), ImGuiCond_FirstUseEver);
+	im::Window("Frame telemetry", &showTelemetry, [&]{
+		auto& telemetry = manager.getReactor().getDisplay().getFrameTelemetry();
+		auto frames = telemetry.getFrames();
+		auto summary = FrameTelemetry::summarize(frames);
+
+		ImGui::Text("Last %d painted frames, %u MSX frames skipped (all times in ms)",
+		            narrow<int>(summary.frames), summary.skipped);
+		ImGui::SameLine();
+		if (ImGui::SmallButton("Clear")) telemetry.clear();
+
+		int flags = ImGuiTableFlags_RowBg |
+		            ImGuiTableFlags_BordersV |
+		            ImGuiTableFlags_BordersOuter |
+		            ImGuiTableFlags_SizingStretchProp;
+		im::Table("##telemetry", 5, flags, [&]{
+			ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn("Graph", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("Min", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn("Avg", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn("Max", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableHeadersRow();
+
+			std::vector<float> values(frames.size());
+			auto row = [&](const char* name, float FrameTelemetry::Frame::*field,
+			               const FrameTelemetry::Stat& stat, const char* help) {
+				if (ImGui::TableNextColumn()) {
+					ImGui::TextUnformatted(name);
+					simpleToolTip(help);
+				}
+				if (ImGui::TableNextColumn()) {
+					std::ranges::transform(frames, values.begin(), field);
+					// include zero, so that the graphs can be compared
+					auto lo = std::min(stat.min, 0.0f);
+					auto hi = std::max(stat.max, 0.0f);
+					if (hi == lo) hi = lo + 1.0f;
+					ImGui::SetNextItemWidth(-FLT_MIN); // full cell-width
+					auto size = gl::vec2{ImGui::CalcItemWidth(), 2.0f * ImGui::GetFrameHeight()};
+					if (values.size() >= 2) {
+						plotLines(values, lo, hi, size);
+					} else {
+						ImGui::Dummy(size);
+					}
+				}
+				if (ImGui::TableNextColumn()) ImGui::Text("%.2f", stat.min);
+				if (ImGui::TableNextColumn()) ImGui::Text("%.2f", stat.avg);
+				if (ImGui::TableNextColumn()) ImGui::Text("%.2f", stat.max);
+			};
+			using Frame = FrameTelemetry::Frame;
+			row("Interval", &Frame::interval, summary.interval,
+			    "Time between two painted frames");
+			row("Emulation", &Frame::emulation, summary.emulation,
+			    "Emulating (and handling events) in that interval");
+			row("Sleep", &Frame::sleep, summary.sleep,
+			    "Sleeping to stay in sync with real time");
+			row("Render", &Frame::render, summary.render,
+			    "Painting all layers (MSX screen, OSD, ImGui)");
+			row("Present", &Frame::present, summary.present,
+			    "Showing the result, e.g. waiting for vsync");
+			row("Audio buffer", &Frame::audioBuffer, summary.audioBuffer,
+			    "Sound buffered for the host sound output, see also 'openmsx_info sound_buffer'");
+			row("Sync drift", &Frame::syncDrift, summary.syncDrift,
+			    "Emulation ahead (>0) or behind (<0) real time");
+		});
+	});
+}
+
 void ImGuiTools::paintNotes()
 {
 	for (auto [i, note] : enumerate(notes)) {
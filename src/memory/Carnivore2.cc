@@ -125,6 +125,8 @@ void Carnivore2::reset(EmuTime time)
 
 	// User-defined ID and control port I/O
 	PF0_RV = 0;
+
+	invalidateDeviceRWCache();
 }
 
 void Carnivore2::globalRead(uint16_t address, EmuTime /*time*/)
@@ -137,6 +139,7 @@ void Carnivore2::globalRead(uint16_t address, EmuTime /*time*/)
 		for (auto i : xrange(0x05, 0x1f)) {
 			configRegs[i] = shadowConfigRegs[i];
 		}
+		invalidateDeviceRWCache();
 	}
 }
 
@@ -203,10 +206,32 @@ byte Carnivore2::peekMem(uint16_t address, EmuTime time) const
 	}
 }
 
+const byte* Carnivore2::getReadCacheLine(uint16_t address) const
+{
+	if (slotExpanded() &&
+	    ((address & CacheLine::HIGH) == (0xffff & CacheLine::HIGH))) {
+		// read subslot register
+		return nullptr;
+	}
+	switch (getSubDevice(address)) {
+		using enum SubDevice;
+		case MultiMapper:  return getReadCacheLineMultiMapperSlot(address);
+		case MemoryMapper: return getReadCacheLineMemoryMapperSlot(address);
+		case Nothing:      return unmappedRead.data();
+		default:           return nullptr; // IDE and FM-PAC are not cached
+	}
+}
+
 void Carnivore2::writeMem(uint16_t address, byte value, EmuTime time)
 {
 	if (slotExpanded() && (address == 0xffff)) {
+		byte diff = value ^ subSlotReg;
 		subSlotReg = value;
+		for (auto page : xrange(4)) {
+			if (diff & (3 << (2 * page))) {
+				invalidateDeviceRWCache(0x4000 * page, 0x4000);
+			}
+		}
 		// this does not block the writes below
 	}
 
@@ -340,6 +365,10 @@ void Carnivore2::writePFXN(byte value)
 
 void Carnivore2::writeConfigRegister(uint16_t address, byte value, EmuTime time)
 {
+	// Most config registers influence the memory layout, don't bother
+	// figuring out which exactly.
+	invalidateDeviceRWCache();
+
 	address &= 0x3f;
 	if ((0x05 <= address) && (address <= 0x1e)) {
 		// shadow registers
@@ -442,6 +471,31 @@ byte Carnivore2::readMultiMapperSlot(uint16_t address, EmuTime time)
 	}
 }
 
+const byte* Carnivore2::getReadCacheLineMultiMapperSlot(uint16_t address) const
+{
+	// The config registers are 0x40 bytes located at offset 0x80 within a
+	// cache line, so testing that offset is enough.
+	if (isConfigReg((address & CacheLine::HIGH) | 0x80)) return nullptr;
+	if (sccEnabled() &&
+	    (((0x9800 <= address) && (address < 0xa000)) ||
+	     ((0xb800 <= address) && (address < 0xc000)))) {
+		// (possibly) SCC registers, this also depends on the sccBank
+		// and sccMode registers, so never cache this region
+		return nullptr;
+	}
+
+	// The smallest bank size is 4kB, so a cache line is always fully
+	// contained within one bank.
+	auto [addr, mult] = decodeMultiMapper(address);
+	if (addr == unsigned(-1)) return unmappedRead.data();
+
+	if (mult & 0x20) {
+		return &ram[addr & 0x1fffff]; // 2MB
+	} else {
+		return flash.getReadCacheLine(addr);
+	}
+}
+
 byte Carnivore2::peekMultiMapperSlot(uint16_t address, EmuTime time) const
 {
 	if (isConfigReg(address)) {
@@ -477,6 +531,7 @@ void Carnivore2::writeMultiMapperSlot(uint16_t address, byte value, EmuTime time
 				// update actual+shadow reg
 				      configRegs[(i * 6) + 6 + 2] = value;
 				shadowConfigRegs[(i * 6) + 6 + 2] = value;
+				invalidateDeviceRWCache();
 			}
 		}
 	}
@@ -680,6 +735,13 @@ byte Carnivore2::readMemoryMapperSlot(uint16_t address) const
 	return peekMemoryMapperSlot(address);
 }
 
+const byte* Carnivore2::getReadCacheLineMemoryMapperSlot(uint16_t address) const
+{
+	// the control registers are mirrored in every 256 bytes of the page
+	if (isMemMapControl(address)) return nullptr;
+	return &ram[getMemoryMapperAddress(address)];
+}
+
 void Carnivore2::writeMemoryMapperSlot(uint16_t address, byte value)
 {
 	if (isMemMapControl(address)) {
@@ -687,9 +749,11 @@ void Carnivore2::writeMemoryMapperSlot(uint16_t address, byte value)
 		case 0x3c:
 			value |= (value & 0x02) << 6; // TODO should be '(.. 0x20) << 2' ???
 			port3C = value;
+			invalidateDeviceRWCache();
 			return;
 		case 0xfc: case 0xfd: case 0xfe: case 0xff:
 			memMapRegs[address & 0x03] = value & 0x3f;
+			invalidateDeviceRWCache(0x4000 * (address & 0x03), 0x4000);
 			return;
 		}
 	}
@@ -810,6 +874,7 @@ void Carnivore2::writeIO(uint16_t port, byte value, EmuTime time)
 	} else if (((port & 0xff) == 0x3c) && writePort3cEnabled()) {
 		// only change bit 7
 		port3C = (port3C & 0x7F) | (value & 0x80);
+		invalidateDeviceRWCache();
 
 	} else if ((port & 0xfc) == 0xfc) {
 		// memory mapper registers
@@ -827,6 +892,7 @@ void Carnivore2::writeIO(uint16_t port, byte value, EmuTime time)
 		} else if ('0' <= value && value <= '3') {
 			configRegs[0x00] &= ~(0b11 << 5);
 			configRegs[0x00] |= byte((value - '0') << 5);
+			invalidateDeviceRWCache(); // moves the config registers
 		} else if (value == 'A') {
 			shadowConfigRegs[0x1e] &= ~1; // Mconf
 		} else if (value == 'M') {
@@ -37,6 +37,7 @@ public:
 
 	[[nodiscard]] byte readMem(uint16_t address, EmuTime time) override;
 	[[nodiscard]] byte peekMem(uint16_t address, EmuTime time) const override;
+	[[nodiscard]] const byte* getReadCacheLine(uint16_t address) const override;
 	void writeMem(uint16_t address, byte value, EmuTime time) override;
 	void globalRead(uint16_t address, EmuTime time) override;
 
@@ -88,6 +89,7 @@ private:
 	[[nodiscard]] bool sccAccess(uint16_t address) const;
 	[[nodiscard]] byte readMultiMapperSlot(uint16_t address, EmuTime time);
 	[[nodiscard]] byte peekMultiMapperSlot(uint16_t address, EmuTime time) const;
+	[[nodiscard]] const byte* getReadCacheLineMultiMapperSlot(uint16_t address) const;
 	void writeMultiMapperSlot(uint16_t address, byte value, EmuTime time);
 
 	// IDE
@@ -107,6 +109,7 @@ private:
 	[[nodiscard]] bool isMemoryMapperWriteProtected(uint16_t address) const;
 	[[nodiscard]] byte peekMemoryMapperSlot(uint16_t address) const;
 	[[nodiscard]] byte readMemoryMapperSlot(uint16_t address) const;
+	[[nodiscard]] const byte* getReadCacheLineMemoryMapperSlot(uint16_t address) const;
 	void writeMemoryMapperSlot(uint16_t address, byte value);
 
 	// fm-pac
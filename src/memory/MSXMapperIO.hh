@@ -48,6 +48,7 @@ private:
 		[[nodiscard]] byte read(unsigned address) override;
 		void write(unsigned address, byte value, EmuTime time) override;
 		void readBlock(unsigned start, std::span<byte> output) override;
+		[[nodiscard]] bool includeInStateHash() const override { return true; }
 	} debuggable;
 
 	std::vector<MSXMemoryMapperInterface*> mappers;
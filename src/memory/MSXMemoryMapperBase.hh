@@ -66,6 +66,7 @@ private:
 		[[nodiscard]] byte read(unsigned address) override;
 		void write(unsigned address, byte value) override;
 		void readBlock(unsigned start, std::span<byte> output) override;
+		[[nodiscard]] bool includeInStateHash() const override { return true; }
 	} debuggable;
 };
 SERIALIZE_CLASS_VERSION(MSXMemoryMapperBase, 2);
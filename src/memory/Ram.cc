@@ -102,6 +102,11 @@ void RamDebuggable::readBlock(unsigned start, std::span<uint8_t> output)
 	copy_to_range(std::span{ram}.subspan(start, output.size()), output);
 }
 
+std::span<const uint8_t> RamDebuggable::getStateBuffer() const
+{
+	return {ram.data(), ram.size()};
+}
+
 void RamDebuggable::write(unsigned address, uint8_t value)
 {
 	ram[address] = value;
@@ -24,6 +24,8 @@ public:
 	uint8_t read(unsigned address) override;
 	void write(unsigned address, uint8_t value) override;
 	void readBlock(unsigned start, std::span<uint8_t> output) override;
+	[[nodiscard]] bool includeInStateHash() const override { return true; }
+	[[nodiscard]] std::span<const uint8_t> getStateBuffer() const override;
 private:
 	Ram& ram;
 	bool* debugWrite;
@@ -120,6 +120,7 @@ void MemInputArchive::load(std::string& s)
 {
 	size_t length;
 	load(length);
+	buffer.check(length); // before allocating
 	s.resize_and_overwrite(length, [&](char* dst, size_t /*n*/) {
 		//assert(length == n); <-- not true with gcc-12 (bug)
 		if (length) {
@@ -150,12 +151,12 @@ void MemOutputArchive::serialize_blob(const char* /*tag*/, std::span<const uint8
                                       bool diff)
 {
 	// Delta-compress in-memory blobs, see DeltaBlock.hh for more details.
-	if (data.size() > SMALL_SIZE) {
-		auto deltaBlockIdx = unsigned(deltaBlocks.size());
+	if (deltaBlocks && (data.size() > SMALL_SIZE)) {
+		auto deltaBlockIdx = unsigned(deltaBlocks->size());
 		save(deltaBlockIdx); // see comment below in MemInputArchive
-		deltaBlocks.push_back(diff
-			? lastDeltaBlocks.createNew(data.data(), data)
-			: lastDeltaBlocks.createNullDiff(data.data(), data));
+		deltaBlocks->push_back(diff
+			? lastDeltaBlocks->createNew(data.data(), data)
+			: lastDeltaBlocks->createNullDiff(data.data(), data));
 	} else {
 		auto buf = buffer.allocate(data.size());
 		copy_to_range(data, buf);
@@ -165,7 +166,7 @@ void MemOutputArchive::serialize_blob(const char* /*tag*/, std::span<const uint8
 void MemInputArchive::serialize_blob(const char* /*tag*/, std::span<uint8_t> data,
                                      bool /*diff*/)
 {
-	if (data.size() > SMALL_SIZE) {
+	if (!inlineBlobs && (data.size() > SMALL_SIZE)) {
 		// Usually blobs are saved in the same order as they are loaded
 		// (via the serialize_blob() methods in respectively
 		// MemOutputArchive and MemInputArchive). In that case keeping
@@ -177,8 +178,7 @@ void MemInputArchive::serialize_blob(const char* /*tag*/, std::span<uint8_t> dat
 		unsigned deltaBlockIdx; load(deltaBlockIdx);
 		deltaBlocks[deltaBlockIdx]->apply(data);
 	} else {
-		copy_to_range(std::span{buffer.getCurrentPos(), data.size()}, data);
-		buffer.skip(data.size());
+		buffer.read(data.data(), data.size());
 	}
 }
 
@@ -653,12 +653,22 @@ public:
 	MemOutputArchive(LastDeltaBlocks& lastDeltaBlocks_,
 	                 std::vector<std::shared_ptr<DeltaBlock>>& deltaBlocks_,
 			 bool reverseSnapshot_)
-		: lastDeltaBlocks(lastDeltaBlocks_)
-		, deltaBlocks(deltaBlocks_)
+		: lastDeltaBlocks(&lastDeltaBlocks_)
+		, deltaBlocks(&deltaBlocks_)
 		, reverseSnapshot(reverseSnapshot_)
 	{
 	}
 
+	/** Archive without delta blocks: all blobs are stored in the buffer
+	  * itself, so the result is self-contained (e.g. to write it to disk).
+	  */
+	MemOutputArchive()
+		: lastDeltaBlocks(nullptr)
+		, deltaBlocks(nullptr)
+		, reverseSnapshot(false)
+	{
+	}
+
 	~MemOutputArchive()
 	{
 		assert(openSections.empty());
@@ -750,8 +760,8 @@ private:
 private:
 	OutputBuffer buffer;
 	std::vector<size_t> openSections;
-	LastDeltaBlocks& lastDeltaBlocks;
-	std::vector<std::shared_ptr<DeltaBlock>>& deltaBlocks;
+	LastDeltaBlocks* lastDeltaBlocks; // both nullptr -> store blobs inline
+	std::vector<std::shared_ptr<DeltaBlock>>* deltaBlocks;
 	const bool reverseSnapshot;
 };
 
@@ -762,6 +772,18 @@ public:
 	                std::span<const std::shared_ptr<DeltaBlock>> deltaBlocks_)
 		: buffer(buf_)
 		, deltaBlocks(deltaBlocks_)
+		, inlineBlobs(false)
+	{
+	}
+
+	/** Counterpart of the MemOutputArchive constructor without delta
+	  * blocks.
+	  * Use 'checked = true' for data from an untrusted source (a file),
+	  * see InputBuffer.
+	  */
+	explicit MemInputArchive(std::span<const uint8_t> buf_, bool checked = false)
+		: buffer(buf_, checked)
+		, inlineBlobs(true)
 	{
 	}
 
@@ -835,6 +857,7 @@ private:
 private:
 	InputBuffer buffer;
 	std::span<const std::shared_ptr<DeltaBlock>> deltaBlocks;
+	const bool inlineBlobs;
 };
 
 ////
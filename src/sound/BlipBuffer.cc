@@ -1,5 +1,7 @@
 #include "BlipBuffer.hh"
 
+#include "BlipKernels.hh"
+
 #include "Math.hh"
 #include "cstd.hh"
 #include "narrow.hh"
@@ -124,17 +126,8 @@ template<size_t PITCH>
 void BlipBuffer::readSamplesHelper(float* __restrict out, size_t samples)
 {
 	assert((offset + samples) <= BUFFER_SIZE);
-	auto acc = accum;
-	auto ofst = offset;
-	for (auto i : xrange(samples)) {
-		out[i * PITCH] = acc;
-		acc *= BASS_FACTOR;
-		acc += buffer[ofst];
-		buffer[ofst] = 0.0f;
-		++ofst;
-	}
-	accum = acc;
-	offset = ofst & BUFFER_MASK;
+	accum = BlipKernels::integrate<PITCH>(out, &buffer[offset], samples, accum, BASS_FACTOR);
+	offset = (offset + samples) & BUFFER_MASK;
 }
 
 static bool isSilent(float x)
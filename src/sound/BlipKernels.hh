@@ -0,0 +1,133 @@
+#ifndef BLIPKERNELS_HH
+#define BLIPKERNELS_HH
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <span>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace openmsx {
+
+/** Helper functions for band-limited synthesis (ResampleBlip, BlipBuffer).
+  * The cost of that synthesis should depend on the number of edges in the
+  * input signal rather than on its sample rate. These functions handle the
+  * parts that do run per sample several samples at a time.
+  */
+namespace BlipKernels {
+
+/** Call 'edge(i, ch, delta)' for each sample where the input changes value.
+  * @param buf The input: 'CHANNELS' interleaved channels.
+  * @param last The value of each channel right before the first sample.
+  *             On return this is the value of the last sample.
+  * @param edge Callback, 'i' is the index of the sample (per channel), 'ch'
+  *             the channel and 'delta' the difference with the previous
+  *             sample. For each channel the edges are reported in order.
+  */
+template<unsigned CHANNELS, typename Edge>
+inline void forEachEdge(std::span<const float> buf, std::span<float, CHANNELS> last, Edge edge)
+{
+	size_t total = buf.size();
+	assert((total % CHANNELS) == 0);
+	if (total == 0) return;
+
+	for (unsigned ch = 0; ch < CHANNELS; ++ch) {
+		if (buf[ch] != last[ch]) edge(size_t(0), ch, buf[ch] - last[ch]);
+	}
+	auto check = [&](size_t e) {
+		if (buf[e] != buf[e - CHANNELS]) {
+			edge(e / CHANNELS, unsigned(e % CHANNELS), buf[e] - buf[e - CHANNELS]);
+		}
+	};
+	size_t e = CHANNELS;
+#ifdef __SSE2__
+	// Typically (PSG, SCC) there are long runs without any change, so
+	// compare 16 values at once with the values one sample earlier.
+	for (/**/; (e + 16) <= total; e += 16) {
+		const float* p = &buf[e];
+		auto ne0 = _mm_cmpneq_ps(_mm_loadu_ps(p +  0), _mm_loadu_ps(p +  0 - CHANNELS));
+		auto ne1 = _mm_cmpneq_ps(_mm_loadu_ps(p +  4), _mm_loadu_ps(p +  4 - CHANNELS));
+		auto ne2 = _mm_cmpneq_ps(_mm_loadu_ps(p +  8), _mm_loadu_ps(p +  8 - CHANNELS));
+		auto ne3 = _mm_cmpneq_ps(_mm_loadu_ps(p + 12), _mm_loadu_ps(p + 12 - CHANNELS));
+		auto any = _mm_or_ps(_mm_or_ps(ne0, ne1), _mm_or_ps(ne2, ne3));
+		if (_mm_movemask_ps(any) == 0) [[likely]] continue;
+
+		auto mask = unsigned(_mm_movemask_ps(ne0))
+		          | unsigned(_mm_movemask_ps(ne1)) << 4
+		          | unsigned(_mm_movemask_ps(ne2)) << 8
+		          | unsigned(_mm_movemask_ps(ne3)) << 12;
+		for (/**/; mask; mask &= mask - 1) {
+			auto d = e + std::countr_zero(mask);
+			edge(d / CHANNELS, unsigned(d % CHANNELS), buf[d] - buf[d - CHANNELS]);
+		}
+	}
+#endif
+	for (/**/; e < total; ++e) check(e);
+
+	for (unsigned ch = 0; ch < CHANNELS; ++ch) {
+		last[ch] = buf[total - CHANNELS + ch];
+	}
+}
+
+/** The integration step of BlipBuffer (a leaky integrator):
+  *   for each i: out[i * PITCH] = acc; acc = acc * factor + in[i]; in[i] = 0;
+  * @return The final value of 'acc'.
+  * Note: the SSE version sums in a different order, so the result can
+  * differ in the last bits.
+  */
+template<size_t PITCH>
+[[nodiscard]] inline float integrate(float* __restrict out, float* __restrict in,
+                                     size_t num, float acc, float factor)
+{
+	size_t i = 0;
+#ifdef __SSE2__
+	if (num >= 4) {
+		// Per group of 4 inputs b0..b3 calculate the prefix sums
+		//   s[k] = sum(b[j] * factor^(k-j)) for j <= k
+		// then the outputs are 's[k-1] + acc * factor^k', and the next
+		// 'acc' is 's[3] + acc * factor^4'.
+		float f2 = factor * factor;
+		auto vf1 = _mm_set1_ps(factor);
+		auto vf2 = _mm_set1_ps(f2);
+		auto vf4 = _mm_set1_ps(f2 * f2);
+		auto vPow = _mm_setr_ps(1.0f, factor, f2, f2 * factor);
+		auto shift1 = [](__m128 x) { return _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)); };
+		auto shift2 = [](__m128 x) { return _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)); };
+		auto vAcc = _mm_set1_ps(acc);
+		for (/**/; i < (num & ~size_t(3)); i += 4) {
+			auto b = _mm_loadu_ps(&in[i]);
+			_mm_storeu_ps(&in[i], _mm_setzero_ps());
+			auto s = _mm_add_ps(b, _mm_mul_ps(shift1(b), vf1));
+			s = _mm_add_ps(s, _mm_mul_ps(shift2(s), vf2));
+			auto o = _mm_add_ps(shift1(s), _mm_mul_ps(vAcc, vPow));
+			if constexpr (PITCH == 1) {
+				_mm_storeu_ps(out, o);
+			} else {
+				alignas(16) float tmp[4];
+				_mm_store_ps(tmp, o);
+				for (int j = 0; j < 4; ++j) out[j * PITCH] = tmp[j];
+			}
+			out += 4 * PITCH;
+			vAcc = _mm_add_ps(_mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3)),
+			                  _mm_mul_ps(vAcc, vf4));
+		}
+		acc = _mm_cvtss_f32(vAcc);
+	}
+#endif
+	for (/**/; i < num; ++i) {
+		*out = acc;
+		out += PITCH;
+		acc *= factor;
+		acc += in[i];
+		in[i] = 0.0f;
+	}
+	return acc;
+}
+
+} // namespace BlipKernels
+} // namespace openmsx
+
+#endif
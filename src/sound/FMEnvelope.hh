@@ -0,0 +1,55 @@
+#ifndef FMENVELOPE_HH
+#define FMENVELOPE_HH
+
+#include <bit>
+#include <cstdint>
+#include <span>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace openmsx {
+
+/** Helper for FM cores with a (MAME-style) global envelope generator
+  * counter: an envelope generator only takes a step when 'egCnt & mask' is
+  * zero, where 'mask' depends on the current rate (of the current envelope
+  * state). For the typical rates that is only on a small fraction of the
+  * samples. Instead of checking each operator one at a time, keep the masks
+  * of all operators in an array and check them all at once.
+  */
+namespace FMEnvelope {
+
+/** Mask for operators whose envelope doesn't change (e.g. in the OFF state).
+  * Note that such an operator is still reported when 'egCnt' is zero, so
+  * stepping it must be a no-op.
+  */
+static constexpr uint32_t IDLE = 0xFFFFFFFF;
+
+/** Bit n of the result is set when 'egCnt & masks[n]' is zero. */
+template<size_t N>
+[[nodiscard]] inline uint64_t dueSlots(std::span<const uint32_t, N> masks, uint32_t egCnt)
+{
+	static_assert(N <= 64);
+	uint64_t result = 0;
+	size_t i = 0;
+#ifdef __SSE2__
+	auto cnt = _mm_set1_epi32(int(egCnt));
+	auto zero = _mm_setzero_si128();
+	for (/**/; i < (N & ~3); i += 4) {
+		auto m = _mm_loadu_si128(std::bit_cast<const __m128i*>(&masks[i]));
+		auto due = _mm_cmpeq_epi32(_mm_and_si128(m, cnt), zero);
+		result |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(due))) << i;
+	}
+	if constexpr ((N % 4) == 0) return result;
+#endif
+	for (/**/; i < N; ++i) {
+		result |= uint64_t((egCnt & masks[i]) == 0) << i;
+	}
+	return result;
+}
+
+} // namespace FMEnvelope
+} // namespace openmsx
+
+#endif
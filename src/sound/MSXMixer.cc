@@ -16,6 +16,7 @@
 #include "StringSetting.hh"
 #include "TclObject.hh"
 #include "ThrottleManager.hh"
+#include "WorkerPool.hh"
 
 #include "Math.hh"
 #include "aligned.hh"
@@ -44,10 +45,12 @@ MSXMixer::MSXMixer(Mixer& mixer_, MSXMotherBoard& motherBoard_,
 	, motherBoard(motherBoard_)
 	, commandController(motherBoard.getMSXCommandController())
 	, masterVolume(mixer.getMasterVolume())
+	, soundThreadsSetting(globalSettings.getSoundThreadsSetting())
 	, speedManager(globalSettings.getSpeedManager())
 	, throttleManager(globalSettings.getThrottleManager())
 	, prevTime(getCurrentTime(), 44100)
 	, soundDeviceInfo(commandController.getMachineInfoCommand())
+	, soundSilenceInfo(commandController.getMachineInfoCommand())
 {
 	reschedule2();
 
@@ -452,6 +455,24 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 		return;
 	}
 
+	// While seeking in the reverse history (fast-forward to the target
+	// time) the output is muted anyway. Then only advance the sound
+	// devices (their state is part of the emulated machine), but skip
+	// resampling, mixing and filtering. Not when recording, the recorder
+	// does capture the fast-forwarded sound.
+	if (motherBoard.isFastForwarding() && !recorder) {
+		if (!generateParallel(samples, time, true)) {
+			// 2 * ...: big enough for stereo devices
+			inplace_buffer<float, 2 * (8192 + 3)> skipBuf(uninitialized_tag{}, 2 * (samples + 3));
+			for (auto& info : infos) {
+				info.device->skipBuffer(samples, skipBuf.data(), time);
+			}
+		}
+		std::ranges::fill(output, StereoFloat{});
+		tl0 = tr0 = 0.0f;
+		return;
+	}
+
 	// +3 to allow processing samples in groups of 4 (and upto 3 samples
 	// more than requested).
 	inplace_buffer<float,       8192 + 3> monoBufExtra  (uninitialized_tag{}, samples + 3);
@@ -469,6 +490,21 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 	constexpr unsigned HAS_STEREO_FLAG = 2;
 	unsigned usedBuffers = 0;
 
+	// Either generate the output of each device on-demand in the loop
+	// below, or (see generateParallel()) generate all of them upfront on
+	// multiple threads. In the latter case the mixing below
+	// still happens in the same order, so the result is bit-identical.
+	bool parallel = generateParallel(samples, time, false);
+	auto updateBuffer = [&](SoundDeviceInfo& info, float* buf) {
+		if (!parallel) {
+			return info.device->updateBuffer(samples, buf, time);
+		}
+		if (!info.parallelResult) return false;
+		auto num = info.device->isStereo() ? 2 * samples : samples;
+		std::copy_n(info.parallelBuf.data(), num, buf);
+		return true;
+	};
+
 	// TODO: The Infos should be ordered such that all the mono
 	// devices are handled first
 	for (auto& info : infos) {
@@ -482,14 +518,14 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 				if (!(usedBuffers & HAS_MONO_FLAG)) {
 					// generate in 'monoBuf' (because it was still empty)
 					// then multiply in-place
-					if (device.updateBuffer(samples, monoBufPtr, time)) {
+					if (updateBuffer(info, monoBufPtr)) {
 						usedBuffers |= HAS_MONO_FLAG;
 						mul(monoBuf, l1);
 					}
 				} else {
 					// generate in 'tmpBuf' (as mono data)
 					// then multiply-accumulate into 'monoBuf'
-					if (device.updateBuffer(samples, tmpBufPtr, time)) {
+					if (updateBuffer(info, tmpBufPtr)) {
 						mulAcc(monoBuf, tmpBufMono, l1);
 					}
 				}
@@ -498,14 +534,14 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 				if (!(usedBuffers & HAS_STEREO_FLAG)) {
 					// 'stereoBuf' (which is still empty) is first filled with mono-data,
 					// then in-place expanded to stereo-data
-					if (device.updateBuffer(samples, stereoBufPtr, time)) {
+					if (updateBuffer(info, stereoBufPtr)) {
 						usedBuffers |= HAS_STEREO_FLAG;
 						mulExpand(stereoBuf, l1, r1);
 					}
 				} else {
 					// 'tmpBuf' is first filled with mono-data,
 					// then expanded to stereo and mul-acc into 'stereoBuf'
-					if (device.updateBuffer(samples, tmpBufPtr, time)) {
+					if (updateBuffer(info, tmpBufPtr)) {
 						mulExpandAcc(stereoBuf, tmpBufMono, l1, r1);
 					}
 				}
@@ -521,14 +557,14 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 				if (!(usedBuffers & HAS_STEREO_FLAG)) {
 					// generate in 'stereoBuf' (because it was still empty)
 					// then multiply in-place
-					if (device.updateBuffer(samples, stereoBufPtr, time)) {
+					if (updateBuffer(info, stereoBufPtr)) {
 						usedBuffers |= HAS_STEREO_FLAG;
 						mul(stereoBuf, l1);
 					}
 				} else {
 					// generate in 'tmpBuf' (as stereo data)
 					// then multiply-accumulate into 'stereoBuf'
-					if (device.updateBuffer(samples, tmpBufPtr, time)) {
+					if (updateBuffer(info, tmpBufPtr)) {
 						mulAcc(stereoBuf, tmpBufStereo, l1);
 					}
 				}
@@ -538,14 +574,14 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 				if (!(usedBuffers & HAS_STEREO_FLAG)) {
 					// generate in 'stereoBuf' (because it was still empty)
 					// then mix in-place
-					if (device.updateBuffer(samples, stereoBufPtr, time)) {
+					if (updateBuffer(info, stereoBufPtr)) {
 						usedBuffers |= HAS_STEREO_FLAG;
 						mulMix2(stereoBuf, l1, l2, r1, r2);
 					}
 				} else {
 					// 'tmpBuf' is first filled with stereo-data,
 					// then mixed into stereoBuf
-					if (device.updateBuffer(samples, tmpBufPtr, time)) {
+					if (updateBuffer(info, tmpBufPtr)) {
 						mulMix2Acc(stereoBuf, tmpBufStereo, l1, l2, r1, r2);
 					}
 				}
@@ -590,6 +626,58 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime time)
 	default: // mono + stereo
 		std::tie(tl0, tr0) = filterBothStereo(tl0, tr0, monoBuf, stereoBuf, output);
 	}
+
+	// Remember when the output was last audible (see 'machine_info
+	// sound_silence'), e.g. to stop a recording after a song has ended.
+	if (std::ranges::any_of(output, [](const StereoFloat& s) {
+		return !approxEqual(s.left, 0.0f) || !approxEqual(s.right, 0.0f);
+	})) {
+		lastAudibleTime = time;
+	}
+}
+
+bool MSXMixer::generateParallel(size_t samples, EmuTime time, bool skip)
+{
+	// Always done when running faster than real time (e.g. fast-forward
+	// while rewinding or with throttle off), then the sound generation is
+	// a large part of the total emulation cost. In real time only when
+	// enabled by the user: for cheap sound chips the overhead of waking
+	// up the worker threads is larger than the gain. In both cases not
+	// for small fragments (e.g. generated when a sound chip register is
+	// written), for the same reason.
+	static constexpr size_t MIN_PARALLEL_SAMPLES = 64;
+	if (infos.size() < 2) return false;
+	if (samples < MIN_PARALLEL_SAMPLES) return false;
+	if (!motherBoard.isFastForwarding() && throttleManager.isThrottled() &&
+	    !soundThreadsSetting.getBoolean()) {
+		return false;
+	}
+	if (!workerPool) {
+		workerPool = std::make_unique<WorkerPool>(
+			WorkerPool::defaultNumThreads(3));
+	}
+	if (workerPool->size() == 0) return false; // single core
+
+	for (auto& info : infos) {
+		// +3: see comment in generate()
+		auto size = (info.device->isStereo() ? 2 : 1) * (samples + 3);
+		if (info.parallelBuf.size() < size) info.parallelBuf.resize(size);
+	}
+	// The sound devices are independent of each other, and the emulation
+	// thread is blocked till all are done. So no further synchronization
+	// is needed.
+	workerPool->parallelFor(infos.size(), [&](size_t i) {
+		Math::DenormalGuard noDenormals; // this is a per-thread setting
+		auto& info = infos[i];
+		if (skip) {
+			info.device->skipBuffer(samples, info.parallelBuf.data(), time);
+			info.parallelResult = false;
+		} else {
+			info.parallelResult = info.device->updateBuffer(
+				samples, info.parallelBuf.data(), time);
+		}
+	});
+	return true;
 }
 
 bool MSXMixer::needStereoRecording() const
@@ -856,4 +944,32 @@ void MSXMixer::SoundDeviceInfoTopic::tabCompletion(std::vector<std::string>& tok
 	}
 }
 
+
+// Sound silence info
+
+MSXMixer::SoundSilenceInfoTopic::SoundSilenceInfoTopic(
+		InfoCommand& machineInfoCommand)
+	: InfoTopic(machineInfoCommand, "sound_silence")
+{
+}
+
+void MSXMixer::SoundSilenceInfoTopic::execute(
+	std::span<const TclObject> tokens, TclObject& result) const
+{
+	if (tokens.size() != 2) {
+		throw CommandException("Too many parameters");
+	}
+	const auto& msxMixer = OUTER(MSXMixer, soundSilenceInfo);
+	auto now = msxMixer.prevTime.getTime();
+	result = (now > msxMixer.lastAudibleTime)
+	       ? (now - msxMixer.lastAudibleTime).toDouble()
+	       : 0.0;
+}
+
+std::string MSXMixer::SoundSilenceInfoTopic::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Shows for how long (in seconds of emulated time) the sound "
+	       "output has been silent.\n";
+}
+
 } // namespace openmsx
@@ -7,6 +7,7 @@
 #include "Mixer.hh"
 #include "Schedulable.hh"
 
+#include "MemBuffer.hh"
 #include "Observer.hh"
 #include "dynarray.hh"
 
@@ -28,6 +29,7 @@ class StringSetting;
 class BooleanSetting;
 class Setting;
 class AviRecorder;
+class WorkerPool;
 
 class MSXMixer final : private Schedulable, private Observer<Setting>
                      , private Observer<SpeedManager>
@@ -51,6 +53,11 @@ public:
 		dynarray<ChannelSettings> channelSettings;
 		float defaultVolume = 0.f;
 		float left1 = 0.f, right1 = 0.f, left2 = 0.f, right2 = 0.f;
+
+		// Only used when generating the device output in parallel,
+		// see MSXMixer::generate().
+		MemBuffer<float> parallelBuf;
+		bool parallelResult = false;
 	};
 
 public:
@@ -148,6 +155,7 @@ private:
 	void reschedule();
 	void reschedule2();
 	void generate(std::span<StereoFloat> output, EmuTime time);
+	[[nodiscard]] bool generateParallel(size_t samples, EmuTime time, bool skip);
 
 	// Schedulable
 	void executeUntil(EmuTime time) override;
@@ -174,10 +182,12 @@ private:
 	MSXCommandController& commandController;
 
 	IntegerSetting& masterVolume;
+	BooleanSetting& soundThreadsSetting;
 	SpeedManager& speedManager;
 	ThrottleManager& throttleManager;
 
 	DynamicClock prevTime;
+	EmuTime lastAudibleTime = EmuTime::zero(); // end of the last non-silent fragment
 
 	struct SoundDeviceInfoTopic final : InfoTopic {
 		explicit SoundDeviceInfoTopic(InfoCommand& machineInfoCommand);
@@ -187,6 +197,15 @@ private:
 		void tabCompletion(std::vector<std::string>& tokens) const override;
 	} soundDeviceInfo;
 
+	struct SoundSilenceInfoTopic final : InfoTopic {
+		explicit SoundSilenceInfoTopic(InfoCommand& machineInfoCommand);
+		void execute(std::span<const TclObject> tokens,
+			     TclObject& result) const override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+	} soundSilenceInfo;
+
+	std::unique_ptr<WorkerPool> workerPool; // created on first use
+
 	AviRecorder* recorder = nullptr;
 	unsigned synchronousCounter = 0;
 
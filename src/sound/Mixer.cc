@@ -6,9 +6,13 @@
 
 #include "CliComm.hh"
 #include "CommandController.hh"
+#include "CommandException.hh"
 #include "MSXException.hh"
+#include "Reactor.hh"
+#include "TclObject.hh"
 
 #include "one_of.hh"
+#include "outer.hh"
 #include "stl.hh"
 #include "unreachable.hh"
 
@@ -50,6 +54,7 @@ Mixer::Mixer(Reactor& reactor_, CommandController& commandController_)
 	, samplesSetting(
 		commandController, "samples",
 		"mixer samples", defaultSamples, 64, 8192)
+	, soundBufferInfo(reactor.getOpenMSXInfoCommand())
 {
 	muteSetting       .attach(*this);
 	frequencySetting  .attach(*this);
@@ -158,6 +163,12 @@ void Mixer::uploadBuffer(MSXMixer& /*msxMixer*/, std::span<const StereoFloat> bu
 	driver->uploadBuffer(buffer);
 }
 
+float Mixer::getBufferedTime() const
+{
+	if (!driver) return 0.0f;
+	return float(driver->getBufferFill()) * 1000.0f / float(driver->getFrequency());
+}
+
 void Mixer::update(const Setting& setting) noexcept
 {
 	if (&setting == &muteSetting) {
@@ -174,4 +185,40 @@ void Mixer::update(const Setting& setting) noexcept
 	}
 }
 
+
+// class SoundBufferInfo
+
+Mixer::SoundBufferInfo::SoundBufferInfo(InfoCommand& openMSXInfoCommand)
+	: InfoTopic(openMSXInfoCommand, "sound_buffer")
+{
+}
+
+void Mixer::SoundBufferInfo::execute(
+	std::span<const TclObject> tokens, TclObject& result) const
+{
+	if (tokens.size() != 2) {
+		throw CommandException("Too many parameters");
+	}
+	const auto& mixer = OUTER(Mixer, soundBufferInfo);
+	if (!mixer.driver) return;
+	auto stats = mixer.driver->getBufferStats();
+	result.addDictKeyValues("fill",      stats.fill,
+	                        "min_fill",  stats.minFill,
+	                        "target",    stats.target,
+	                        "capacity",  stats.capacity,
+	                        "underruns", stats.underruns,
+	                        "overruns",  stats.overruns,
+	                        "frequency", mixer.driver->getFrequency());
+}
+
+std::string Mixer::SoundBufferInfo::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Shows statistics about the buffer between the emulation and "
+	       "the sound output (sizes in samples): the current fill level, the "
+	       "lowest fill level since the previous query, the latency target, "
+	       "the number of underruns (the sound output ran out of samples) "
+	       "and overruns (samples were dropped during real-time play, not while "
+	       "fast-forwarding or recording).\n";
+}
+
 } // namespace openmsx
@@ -3,6 +3,7 @@
 
 #include "BooleanSetting.hh"
 #include "EnumSetting.hh"
+#include "InfoTopic.hh"
 #include "IntegerSetting.hh"
 
 #include "Observer.hh"
@@ -55,6 +56,10 @@ public:
 	 */
 	void uploadBuffer(MSXMixer& msxMixer, std::span<const StereoFloat> buffer);
 
+	/** Duration (in ms) of the sound buffered for the host sound output.
+	 */
+	[[nodiscard]] float getBufferedTime() const;
+
 	[[nodiscard]] IntegerSetting& getMasterVolume() { return masterVolume; }
 	[[nodiscard]] BooleanSetting& getMuteSetting() { return muteSetting; }
 
@@ -78,6 +83,13 @@ private:
 	IntegerSetting frequencySetting;
 	IntegerSetting samplesSetting;
 
+	struct SoundBufferInfo final : InfoTopic {
+		explicit SoundBufferInfo(InfoCommand& openMSXInfoCommand);
+		void execute(std::span<const TclObject> tokens,
+		             TclObject& result) const override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+	} soundBufferInfo;
+
 	int muteCount = 0;
 };
 
@@ -22,11 +22,26 @@ public:
 		return result;
 	}
 
+	/** Advance the input till 'time' without needing the output.
+	  * @see SoundDevice::skipBuffer()
+	  */
+	void skipOutput(float* dataOut, size_t num, EmuTime time)
+	{
+		skipOutputImpl(dataOut, num, time);
+		const auto& emuClk = getEmuClock(); (void)emuClk;
+		assert(emuClk.getTime() <= time);
+		assert(emuClk.getFastAdd(1) > time);
+	}
+
 protected:
 	explicit ResampleAlgo(ResampledSoundDevice& input_) : input(input_) {}
 	[[nodiscard]] DynamicClock& getEmuClock() const { return input.getEmuClock(); }
 	virtual bool generateOutputImpl(float* dataOut, size_t num,
 	                                EmuTime time) = 0;
+	virtual void skipOutputImpl(float* dataOut, size_t num, EmuTime time)
+	{
+		(void)generateOutputImpl(dataOut, num, time);
+	}
 
 protected:
 	ResampledSoundDevice& input;
@@ -1,5 +1,6 @@
 #include "ResampleBlip.hh"
 
+#include "BlipKernels.hh"
 #include "ResampledSoundDevice.hh"
 
 #include "narrow.hh"
@@ -34,42 +35,27 @@ bool ResampleBlip<CHANNELS>::generateOutputImpl(float* dataOut, size_t hostNum,
 {
 	auto& emuClk = getEmuClock();
 	if (unsigned emuNum = emuClk.getTicksTill(time); emuNum > 0) {
-		// 3 extra for padding, CHANNELS extra for sentinel
+		// 3 extra for padding
 		// Clang will produce a link error if the length expression is put
 		// inside the macro.
-		const unsigned len = emuNum * CHANNELS + std::max(3u, CHANNELS);
+		const unsigned len = emuNum * CHANNELS + 3;
 		small_buffer<float, 8192> buf(uninitialized_tag{}, len); // typical ~5194 (PSG, samples=1024) but could be larger
 		EmuTime emu1 = emuClk.getFastAdd(1); // time of 1st emu-sample
 		assert(emu1 > hostClock.getTime());
 		if (input.generateInput(buf.data(), emuNum)) {
 			FP pos1;
 			hostClock.getTicksTill(emu1, pos1);
-			for (auto ch : xrange(CHANNELS)) {
-				// In case of PSG (and to a lesser degree SCC) it happens
-				// very often that two consecutive samples have the same
-				// value. We can benefit from this by setting a sentinel
-				// at the end of the buffer and move the end-of-loop test
-				// into the 'samples differ' branch.
-				assert(emuNum > 0);
-				buf[CHANNELS * emuNum + ch] =
-					buf[CHANNELS * (emuNum - 1) + ch] + 1.0f;
-				FP pos = pos1;
-				auto last = lastInput[ch]; // local var is slightly faster
-				for (unsigned i = 0; /**/; ++i) {
-					if (auto delta = buf[CHANNELS * i + ch] - last;
-					    delta != 0) [[unlikely]] {
-						if (i == emuNum) {
-							break;
-						}
-						last = buf[CHANNELS * i + ch];
-						blip[ch].addDelta(
-							BlipBuffer::TimeIndex(pos),
-							delta);
-					}
-					pos += step;
-				}
-				lastInput[ch] = last;
-			}
+			// In case of PSG (and to a lesser degree SCC) it happens
+			// very often that two consecutive samples have the same
+			// value. Only the changes are added to the blip buffer.
+			BlipKernels::forEachEdge<CHANNELS>(
+				std::span<const float>(buf.data(), CHANNELS * emuNum),
+				std::span<float, CHANNELS>(lastInput),
+				[&](size_t i, unsigned ch, float delta) {
+					blip[ch].addDelta(
+						BlipBuffer::TimeIndex(pos1 + step * narrow<int>(i)),
+						delta);
+				});
 		} else {
 			// input all zero
 			BlipBuffer::TimeIndex pos;
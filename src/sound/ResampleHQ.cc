@@ -11,6 +11,7 @@
 
 #include "ResampleHQ.hh"
 
+#include "ResampleHQKernels.hh"
 #include "ResampledSoundDevice.hh"
 
 #include "FixedPoint.hh"
@@ -24,15 +25,11 @@
 
 #include <algorithm>
 #include <array>
-#include <bit>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
 #include <iterator>
 #include <vector>
-#ifdef __SSE2__
-#include <emmintrin.h>
-#endif
 
 namespace openmsx {
 
@@ -406,141 +403,6 @@ ResampleHQ<CHANNELS>::~ResampleHQ()
 	ResampleCoeffs::instance().releaseCoeffs(double(ratio));
 }
 
-#ifdef __SSE2__
-
-static inline __m128 reverse(__m128 x)
-{
-	return _mm_shuffle_ps(x, x, _MM_SHUFFLE(0, 1, 2, 3));
-}
-
-template<bool REVERSE>
-static inline void calcSseMono(const float* buf_, const float* tab_, size_t len, float* out)
-{
-	assert((len % 4) == 0);
-	assert((uintptr_t(tab_) % 16) == 0);
-
-	auto x = narrow<ptrdiff_t>((len & ~7) * sizeof(float));
-	assert((x % 32) == 0);
-	const char* buf = std::bit_cast<const char*>(buf_) + x;
-	const char* tab = std::bit_cast<const char*>(tab_) + (REVERSE ? -x : x);
-	x = -x;
-
-	__m128 a0 = _mm_setzero_ps();
-	__m128 a1 = _mm_setzero_ps();
-	do {
-		__m128 b0 = _mm_loadu_ps(std::bit_cast<const float*>(buf + x +  0));
-		__m128 b1 = _mm_loadu_ps(std::bit_cast<const float*>(buf + x + 16));
-		__m128 t0, t1;
-		if constexpr (REVERSE) {
-			t0 = reverse(_mm_loadu_ps(std::bit_cast<const float*>(tab - x - 16)));
-			t1 = reverse(_mm_loadu_ps(std::bit_cast<const float*>(tab - x - 32)));
-		} else {
-			t0 = _mm_loadu_ps (std::bit_cast<const float*>(tab + x +  0));
-			t1 = _mm_loadu_ps (std::bit_cast<const float*>(tab + x + 16));
-		}
-		__m128 m0 = _mm_mul_ps(b0, t0);
-		__m128 m1 = _mm_mul_ps(b1, t1);
-		a0 = _mm_add_ps(a0, m0);
-		a1 = _mm_add_ps(a1, m1);
-		x += 2 * sizeof(__m128);
-	} while (x < 0);
-	if (len & 4) {
-		__m128 b0 = _mm_loadu_ps(std::bit_cast<const float*>(buf));
-		__m128 t0;
-		if constexpr (REVERSE) {
-			t0 = reverse(_mm_loadu_ps(std::bit_cast<const float*>(tab - 16)));
-		} else {
-			t0 = _mm_loadu_ps (std::bit_cast<const float*>(tab));
-		}
-		__m128 m0 = _mm_mul_ps(b0, t0);
-		a0 = _mm_add_ps(a0, m0);
-	}
-
-	__m128 a = _mm_add_ps(a0, a1);
-	// The following can be _slightly_ faster by using the SSE3 _mm_hadd_ps()
-	// intrinsic, but not worth the trouble.
-	__m128 t = _mm_add_ps(a, _mm_movehl_ps(a, a));
-	__m128 s = _mm_add_ss(t, _mm_shuffle_ps(t, t, 1));
-
-	_mm_store_ss(out, s);
-}
-
-template<int N> static inline __m128 shuffle(__m128 x)
-{
-	return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(x), N));
-}
-template<bool REVERSE>
-static inline void calcSseStereo(const float* buf_, const float* tab_, size_t len, float* out)
-{
-	assert((len % 4) == 0);
-	assert((uintptr_t(tab_) % 16) == 0);
-
-	auto x = narrow<ptrdiff_t>(2 * (len & ~7) * sizeof(float));
-	const auto* buf = std::bit_cast<const char*>(buf_) + x;
-	const auto* tab = std::bit_cast<const char*>(tab_);
-	x = -x;
-
-	__m128 a0 = _mm_setzero_ps();
-	__m128 a1 = _mm_setzero_ps();
-	__m128 a2 = _mm_setzero_ps();
-	__m128 a3 = _mm_setzero_ps();
-	do {
-		__m128 b0 = _mm_loadu_ps(std::bit_cast<const float*>(buf + x +  0));
-		__m128 b1 = _mm_loadu_ps(std::bit_cast<const float*>(buf + x + 16));
-		__m128 b2 = _mm_loadu_ps(std::bit_cast<const float*>(buf + x + 32));
-		__m128 b3 = _mm_loadu_ps(std::bit_cast<const float*>(buf + x + 48));
-		__m128 ta, tb;
-		if constexpr (REVERSE) {
-			ta = reverse(_mm_loadu_ps(std::bit_cast<const float*>(tab - 16)));
-			tb = reverse(_mm_loadu_ps(std::bit_cast<const float*>(tab - 32)));
-			tab -= 2 * sizeof(__m128);
-		} else {
-			ta = _mm_loadu_ps (std::bit_cast<const float*>(tab +  0));
-			tb = _mm_loadu_ps (std::bit_cast<const float*>(tab + 16));
-			tab += 2 * sizeof(__m128);
-		}
-		__m128 t0 = shuffle<0x50>(ta);
-		__m128 t1 = shuffle<0xFA>(ta);
-		__m128 t2 = shuffle<0x50>(tb);
-		__m128 t3 = shuffle<0xFA>(tb);
-		__m128 m0 = _mm_mul_ps(b0, t0);
-		__m128 m1 = _mm_mul_ps(b1, t1);
-		__m128 m2 = _mm_mul_ps(b2, t2);
-		__m128 m3 = _mm_mul_ps(b3, t3);
-		a0 = _mm_add_ps(a0, m0);
-		a1 = _mm_add_ps(a1, m1);
-		a2 = _mm_add_ps(a2, m2);
-		a3 = _mm_add_ps(a3, m3);
-		x += 4 * sizeof(__m128);
-	} while (x < 0);
-	if (len & 4) {
-		__m128 b0 = _mm_loadu_ps(std::bit_cast<const float*>(buf +  0));
-		__m128 b1 = _mm_loadu_ps(std::bit_cast<const float*>(buf + 16));
-		__m128 ta;
-		if constexpr (REVERSE) {
-			ta = reverse(_mm_loadu_ps(std::bit_cast<const float*>(tab - 16)));
-		} else {
-			ta = _mm_loadu_ps (std::bit_cast<const float*>(tab +  0));
-		}
-		__m128 t0 = shuffle<0x50>(ta);
-		__m128 t1 = shuffle<0xFA>(ta);
-		__m128 m0 = _mm_mul_ps(b0, t0);
-		__m128 m1 = _mm_mul_ps(b1, t1);
-		a0 = _mm_add_ps(a0, m0);
-		a1 = _mm_add_ps(a1, m1);
-	}
-
-	__m128 a01 = _mm_add_ps(a0, a1);
-	__m128 a23 = _mm_add_ps(a2, a3);
-	__m128 a   = _mm_add_ps(a01, a23);
-	// Can faster with SSE3, but (like above) not worth the trouble.
-	__m128 s = _mm_add_ps(a, _mm_movehl_ps(a, a));
-	_mm_store_ss(&out[0], s);
-	_mm_store_ss(&out[1], shuffle<0x55>(s));
-}
-
-#endif
-
 template<unsigned CHANNELS>
 void ResampleHQ<CHANNELS>::calcOutput(
 	float pos, float* __restrict output)
@@ -557,60 +419,12 @@ void ResampleHQ<CHANNELS>::calcOutput(
 		// first half, begin of row 't'
 		t = permute[t];
 		const float* tab = &table[t * filterLen];
-
-#ifdef __SSE2__
-		if constexpr (CHANNELS == 1) {
-			calcSseMono  <false>(buf, tab, filterLen, output);
-		} else {
-			calcSseStereo<false>(buf, tab, filterLen, output);
-		}
-		return;
-#endif
-
-		// c++ version, both mono and stereo
-		for (auto ch : xrange(CHANNELS)) {
-			float r0 = 0.0f;
-			float r1 = 0.0f;
-			float r2 = 0.0f;
-			float r3 = 0.0f;
-			for (size_t i = 0; i < filterLen; i += 4) {
-				r0 += tab[i + 0] * buf[CHANNELS * (i + 0)];
-				r1 += tab[i + 1] * buf[CHANNELS * (i + 1)];
-				r2 += tab[i + 2] * buf[CHANNELS * (i + 2)];
-				r3 += tab[i + 3] * buf[CHANNELS * (i + 3)];
-			}
-			output[ch] = r0 + r1 + r2 + r3;
-			++buf;
-		}
+		ResampleHQKernels::calc<CHANNELS, false>(buf, tab, filterLen, output);
 	} else {
 		// 2nd half, end of row 'TAB_LEN - 1 - t'
 		t = permute[TAB_LEN - 1 - t];
 		const float* tab = &table[(t + 1) * filterLen];
-
-#ifdef __SSE2__
-		if constexpr (CHANNELS == 1) {
-			calcSseMono  <true>(buf, tab, filterLen, output);
-		} else {
-			calcSseStereo<true>(buf, tab, filterLen, output);
-		}
-		return;
-#endif
-
-		// c++ version, both mono and stereo
-		for (auto ch : xrange(CHANNELS)) {
-			float r0 = 0.0f;
-			float r1 = 0.0f;
-			float r2 = 0.0f;
-			float r3 = 0.0f;
-			for (ptrdiff_t i = 0; i < ptrdiff_t(filterLen); i += 4) {
-				r0 += tab[-i - 1] * buf[CHANNELS * (i + 0)];
-				r1 += tab[-i - 2] * buf[CHANNELS * (i + 1)];
-				r2 += tab[-i - 3] * buf[CHANNELS * (i + 2)];
-				r3 += tab[-i - 4] * buf[CHANNELS * (i + 3)];
-			}
-			output[ch] = r0 + r1 + r2 + r3;
-			++buf;
-		}
+		ResampleHQKernels::calc<CHANNELS, true>(buf, tab, filterLen, output);
 	}
 }
 
@@ -691,6 +505,16 @@ bool ResampleHQ<CHANNELS>::generateOutputImpl(
 	return notMuted;
 }
 
+template<unsigned CHANNELS>
+void ResampleHQ<CHANNELS>::skipOutputImpl(
+	float* /*dataOut*/, size_t /*hostNum*/, EmuTime time)
+{
+	// Only the (expensive) filter calculation can be skipped, the input
+	// must still be generated. The host clock is shared with the mixer,
+	// so nothing else needs to be advanced.
+	(void)generateOutputImpl(nullptr, 0, time);
+}
+
 // Force template instantiation.
 template class ResampleHQ<1>;
 template class ResampleHQ<2>;
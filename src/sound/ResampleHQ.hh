@@ -28,6 +28,8 @@ public:
 
 	bool generateOutputImpl(float* dataOut, size_t num,
 	                        EmuTime time) override;
+	void skipOutputImpl(float* dataOut, size_t num,
+	                    EmuTime time) override;
 
 private:
 	void calcOutput(float pos, float* output);
@@ -0,0 +1,331 @@
+#ifndef RESAMPLEHQKERNELS_HH
+#define RESAMPLEHQKERNELS_HH
+
+#include "narrow.hh"
+#include "xrange.hh"
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Distro builds only assume SSE2. The AVX2/FMA kernels are compiled with a
+// function specific target and only used when the host CPU supports them.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RESAMPLEHQ_AVX2
+#include <immintrin.h>
+#endif
+
+namespace openmsx {
+
+/** The inner loop of ResampleHQ: the dot product of 'len' input frames with
+  * one row of the filter table. 'len' must be a multiple of 4 (and at least
+  * 8, which is always the case for the ResampleHQ filters). When REVERSE
+  * is true the row is traversed backwards: 'tab' then points just past the
+  * end of the row.
+  */
+namespace ResampleHQKernels {
+
+// c++ version, both mono and stereo
+template<unsigned CHANNELS, bool REVERSE>
+inline void calcScalar(const float* buf, const float* tab, size_t len, float* out)
+{
+	assert((len % 4) == 0);
+	for (auto ch : xrange(CHANNELS)) {
+		float r0 = 0.0f;
+		float r1 = 0.0f;
+		float r2 = 0.0f;
+		float r3 = 0.0f;
+		for (ptrdiff_t i = 0; i < ptrdiff_t(len); i += 4) {
+			if constexpr (REVERSE) {
+				r0 += tab[-i - 1] * buf[CHANNELS * (i + 0)];
+				r1 += tab[-i - 2] * buf[CHANNELS * (i + 1)];
+				r2 += tab[-i - 3] * buf[CHANNELS * (i + 2)];
+				r3 += tab[-i - 4] * buf[CHANNELS * (i + 3)];
+			} else {
+				r0 += tab[i + 0] * buf[CHANNELS * (i + 0)];
+				r1 += tab[i + 1] * buf[CHANNELS * (i + 1)];
+				r2 += tab[i + 2] * buf[CHANNELS * (i + 2)];
+				r3 += tab[i + 3] * buf[CHANNELS * (i + 3)];
+			}
+		}
+		out[ch] = r0 + r1 + r2 + r3;
+		++buf;
+	}
+}
+
+#ifdef __SSE2__
+
+inline __m128 reverse(__m128 x)
+{
+	return _mm_shuffle_ps(x, x, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+template<bool REVERSE>
+inline void calcSseMono(const float* buf_, const float* tab_, size_t len, float* out)
+{
+	assert((len % 4) == 0);
+	assert((uintptr_t(tab_) % 16) == 0);
+
+	auto x = narrow<ptrdiff_t>((len & ~7) * sizeof(float));
+	assert((x % 32) == 0);
+	const char* buf = std::bit_cast<const char*>(buf_) + x;
+	const char* tab = std::bit_cast<const char*>(tab_) + (REVERSE ? -x : x);
+	x = -x;
+
+	__m128 a0 = _mm_setzero_ps();
+	__m128 a1 = _mm_setzero_ps();
+	do {
+		__m128 b0 = _mm_loadu_ps(std::bit_cast<const float*>(buf + x +  0));
+		__m128 b1 = _mm_loadu_ps(std::bit_cast<const float*>(buf + x + 16));
+		__m128 t0, t1;
+		if constexpr (REVERSE) {
+			t0 = reverse(_mm_loadu_ps(std::bit_cast<const float*>(tab - x - 16)));
+			t1 = reverse(_mm_loadu_ps(std::bit_cast<const float*>(tab - x - 32)));
+		} else {
+			t0 = _mm_loadu_ps (std::bit_cast<const float*>(tab + x +  0));
+			t1 = _mm_loadu_ps (std::bit_cast<const float*>(tab + x + 16));
+		}
+		__m128 m0 = _mm_mul_ps(b0, t0);
+		__m128 m1 = _mm_mul_ps(b1, t1);
+		a0 = _mm_add_ps(a0, m0);
+		a1 = _mm_add_ps(a1, m1);
+		x += 2 * sizeof(__m128);
+	} while (x < 0);
+	if (len & 4) {
+		__m128 b0 = _mm_loadu_ps(std::bit_cast<const float*>(buf));
+		__m128 t0;
+		if constexpr (REVERSE) {
+			t0 = reverse(_mm_loadu_ps(std::bit_cast<const float*>(tab - 16)));
+		} else {
+			t0 = _mm_loadu_ps (std::bit_cast<const float*>(tab));
+		}
+		__m128 m0 = _mm_mul_ps(b0, t0);
+		a0 = _mm_add_ps(a0, m0);
+	}
+
+	__m128 a = _mm_add_ps(a0, a1);
+	// The following can be _slightly_ faster by using the SSE3 _mm_hadd_ps()
+	// intrinsic, but not worth the trouble.
+	__m128 t = _mm_add_ps(a, _mm_movehl_ps(a, a));
+	__m128 s = _mm_add_ss(t, _mm_shuffle_ps(t, t, 1));
+
+	_mm_store_ss(out, s);
+}
+
+template<int N> inline __m128 shuffle(__m128 x)
+{
+	return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(x), N));
+}
+template<bool REVERSE>
+inline void calcSseStereo(const float* buf_, const float* tab_, size_t len, float* out)
+{
+	assert((len % 4) == 0);
+	assert((uintptr_t(tab_) % 16) == 0);
+
+	auto x = narrow<ptrdiff_t>(2 * (len & ~7) * sizeof(float));
+	const auto* buf = std::bit_cast<const char*>(buf_) + x;
+	const auto* tab = std::bit_cast<const char*>(tab_);
+	x = -x;
+
+	__m128 a0 = _mm_setzero_ps();
+	__m128 a1 = _mm_setzero_ps();
+	__m128 a2 = _mm_setzero_ps();
+	__m128 a3 = _mm_setzero_ps();
+	do {
+		__m128 b0 = _mm_loadu_ps(std::bit_cast<const float*>(buf + x +  0));
+		__m128 b1 = _mm_loadu_ps(std::bit_cast<const float*>(buf + x + 16));
+		__m128 b2 = _mm_loadu_ps(std::bit_cast<const float*>(buf + x + 32));
+		__m128 b3 = _mm_loadu_ps(std::bit_cast<const float*>(buf + x + 48));
+		__m128 ta, tb;
+		if constexpr (REVERSE) {
+			ta = reverse(_mm_loadu_ps(std::bit_cast<const float*>(tab - 16)));
+			tb = reverse(_mm_loadu_ps(std::bit_cast<const float*>(tab - 32)));
+			tab -= 2 * sizeof(__m128);
+		} else {
+			ta = _mm_loadu_ps (std::bit_cast<const float*>(tab +  0));
+			tb = _mm_loadu_ps (std::bit_cast<const float*>(tab + 16));
+			tab += 2 * sizeof(__m128);
+		}
+		__m128 t0 = shuffle<0x50>(ta);
+		__m128 t1 = shuffle<0xFA>(ta);
+		__m128 t2 = shuffle<0x50>(tb);
+		__m128 t3 = shuffle<0xFA>(tb);
+		__m128 m0 = _mm_mul_ps(b0, t0);
+		__m128 m1 = _mm_mul_ps(b1, t1);
+		__m128 m2 = _mm_mul_ps(b2, t2);
+		__m128 m3 = _mm_mul_ps(b3, t3);
+		a0 = _mm_add_ps(a0, m0);
+		a1 = _mm_add_ps(a1, m1);
+		a2 = _mm_add_ps(a2, m2);
+		a3 = _mm_add_ps(a3, m3);
+		x += 4 * sizeof(__m128);
+	} while (x < 0);
+	if (len & 4) {
+		__m128 b0 = _mm_loadu_ps(std::bit_cast<const float*>(buf +  0));
+		__m128 b1 = _mm_loadu_ps(std::bit_cast<const float*>(buf + 16));
+		__m128 ta;
+		if constexpr (REVERSE) {
+			ta = reverse(_mm_loadu_ps(std::bit_cast<const float*>(tab - 16)));
+		} else {
+			ta = _mm_loadu_ps (std::bit_cast<const float*>(tab +  0));
+		}
+		__m128 t0 = shuffle<0x50>(ta);
+		__m128 t1 = shuffle<0xFA>(ta);
+		__m128 m0 = _mm_mul_ps(b0, t0);
+		__m128 m1 = _mm_mul_ps(b1, t1);
+		a0 = _mm_add_ps(a0, m0);
+		a1 = _mm_add_ps(a1, m1);
+	}
+
+	__m128 a01 = _mm_add_ps(a0, a1);
+	__m128 a23 = _mm_add_ps(a2, a3);
+	__m128 a   = _mm_add_ps(a01, a23);
+	// Can faster with SSE3, but (like above) not worth the trouble.
+	__m128 s = _mm_add_ps(a, _mm_movehl_ps(a, a));
+	_mm_store_ss(&out[0], s);
+	_mm_store_ss(&out[1], shuffle<0x55>(s));
+}
+
+#endif
+
+#ifdef RESAMPLEHQ_AVX2
+
+// Note: lambdas (or helper functions without the same target attribute)
+// can't use the AVX2 intrinsics, so everything is written out inline.
+
+template<bool REVERSE>
+[[gnu::target("avx2,fma")]] inline void calcAvx2Mono(const float* buf, const float* tab, size_t len, float* out)
+{
+	assert((len % 4) == 0);
+	__m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+	__m256 a0 = _mm256_setzero_ps();
+	__m256 a1 = _mm256_setzero_ps();
+	size_t i = 0;
+	for (/**/; (i + 16) <= len; i += 16) {
+		__m256 t0, t1;
+		if constexpr (REVERSE) {
+			t0 = _mm256_permutevar8x32_ps(_mm256_loadu_ps(tab - i -  8), rev);
+			t1 = _mm256_permutevar8x32_ps(_mm256_loadu_ps(tab - i - 16), rev);
+		} else {
+			t0 = _mm256_loadu_ps(tab + i + 0);
+			t1 = _mm256_loadu_ps(tab + i + 8);
+		}
+		a0 = _mm256_fmadd_ps(_mm256_loadu_ps(buf + i + 0), t0, a0);
+		a1 = _mm256_fmadd_ps(_mm256_loadu_ps(buf + i + 8), t1, a1);
+	}
+	if (len & 8) {
+		__m256 t0 = REVERSE ? _mm256_permutevar8x32_ps(_mm256_loadu_ps(tab - i - 8), rev)
+		                    : _mm256_loadu_ps(tab + i);
+		a0 = _mm256_fmadd_ps(_mm256_loadu_ps(buf + i), t0, a0);
+		i += 8;
+	}
+	__m256 a01 = _mm256_add_ps(a0, a1);
+	__m128 a = _mm_add_ps(_mm256_castps256_ps128(a01), _mm256_extractf128_ps(a01, 1));
+	if (len & 4) {
+		__m128 t0;
+		if constexpr (REVERSE) {
+			t0 = _mm_loadu_ps(tab - i - 4);
+			t0 = _mm_shuffle_ps(t0, t0, _MM_SHUFFLE(0, 1, 2, 3));
+		} else {
+			t0 = _mm_loadu_ps(tab + i);
+		}
+		a = _mm_fmadd_ps(_mm_loadu_ps(buf + i), t0, a);
+	}
+
+	__m128 t = _mm_add_ps(a, _mm_movehl_ps(a, a));
+	__m128 s = _mm_add_ss(t, _mm_shuffle_ps(t, t, 1));
+	_mm_store_ss(out, s);
+}
+
+template<bool REVERSE>
+[[gnu::target("avx2,fma")]] inline void calcAvx2Stereo(const float* buf, const float* tab, size_t len, float* out)
+{
+	assert((len % 4) == 0);
+	// duplicate each coefficient, for the left and right channel
+	__m256i dup0 = REVERSE ? _mm256_setr_epi32(7, 7, 6, 6, 5, 5, 4, 4)
+	                       : _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+	__m256i dup1 = REVERSE ? _mm256_setr_epi32(3, 3, 2, 2, 1, 1, 0, 0)
+	                       : _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+
+	__m256 a0 = _mm256_setzero_ps();
+	__m256 a1 = _mm256_setzero_ps();
+	__m256 a2 = _mm256_setzero_ps();
+	__m256 a3 = _mm256_setzero_ps();
+	size_t i = 0;
+	for (/**/; (i + 16) <= len; i += 16) {
+		__m256 ta = _mm256_loadu_ps(REVERSE ? (tab - i -  8) : (tab + i + 0));
+		__m256 tb = _mm256_loadu_ps(REVERSE ? (tab - i - 16) : (tab + i + 8));
+		a0 = _mm256_fmadd_ps(_mm256_loadu_ps(buf + 2 * i +  0), _mm256_permutevar8x32_ps(ta, dup0), a0);
+		a1 = _mm256_fmadd_ps(_mm256_loadu_ps(buf + 2 * i +  8), _mm256_permutevar8x32_ps(ta, dup1), a1);
+		a2 = _mm256_fmadd_ps(_mm256_loadu_ps(buf + 2 * i + 16), _mm256_permutevar8x32_ps(tb, dup0), a2);
+		a3 = _mm256_fmadd_ps(_mm256_loadu_ps(buf + 2 * i + 24), _mm256_permutevar8x32_ps(tb, dup1), a3);
+	}
+	if (len & 8) {
+		__m256 t = _mm256_loadu_ps(REVERSE ? (tab - i - 8) : (tab + i));
+		a0 = _mm256_fmadd_ps(_mm256_loadu_ps(buf + 2 * i + 0), _mm256_permutevar8x32_ps(t, dup0), a0);
+		a1 = _mm256_fmadd_ps(_mm256_loadu_ps(buf + 2 * i + 8), _mm256_permutevar8x32_ps(t, dup1), a1);
+		i += 8;
+	}
+	if (len & 4) {
+		// only the lower 4 elements are used
+		__m256 t = _mm256_castps128_ps256(_mm_loadu_ps(REVERSE ? (tab - i - 4) : (tab + i)));
+		__m256i dup = REVERSE ? _mm256_setr_epi32(3, 3, 2, 2, 1, 1, 0, 0)
+		                      : _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+		a0 = _mm256_fmadd_ps(_mm256_loadu_ps(buf + 2 * i), _mm256_permutevar8x32_ps(t, dup), a0);
+	}
+
+	__m256 a01 = _mm256_add_ps(_mm256_add_ps(a0, a1), _mm256_add_ps(a2, a3)); // L R L R L R L R
+	__m128 a = _mm_add_ps(_mm256_castps256_ps128(a01), _mm256_extractf128_ps(a01, 1));
+	__m128 s = _mm_add_ps(a, _mm_movehl_ps(a, a));
+	_mm_store_ss(&out[0], s);
+	_mm_store_ss(&out[1], _mm_shuffle_ps(s, s, 1));
+}
+
+/** Does the host CPU support the AVX2 kernels? */
+[[nodiscard]] inline bool hasAvx2()
+{
+	static const bool result = [] {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	}();
+	return result;
+}
+
+#endif
+
+/** Use the fastest kernel supported by the host CPU. */
+template<unsigned CHANNELS, bool REVERSE>
+inline void calc(const float* buf, const float* tab, size_t len, float* out)
+{
+	static_assert((CHANNELS == 1) || (CHANNELS == 2));
+#ifdef RESAMPLEHQ_AVX2
+	if (hasAvx2()) {
+		if constexpr (CHANNELS == 1) {
+			calcAvx2Mono  <REVERSE>(buf, tab, len, out);
+		} else {
+			calcAvx2Stereo<REVERSE>(buf, tab, len, out);
+		}
+		return;
+	}
+#endif
+#ifdef __SSE2__
+	if constexpr (CHANNELS == 1) {
+		calcSseMono  <REVERSE>(buf, tab, len, out);
+	} else {
+		calcSseStereo<REVERSE>(buf, tab, len, out);
+	}
+#else
+	calcScalar<CHANNELS, REVERSE>(buf, tab, len, out);
+#endif
+}
+
+} // namespace ResampleHQKernels
+} // namespace openmsx
+
+#endif
@@ -43,6 +43,12 @@ bool ResampledSoundDevice::updateBuffer(size_t length, float* buffer,
 	return algo->generateOutput(buffer, length, time);
 }
 
+void ResampledSoundDevice::skipBuffer(size_t length, float* buffer,
+                                      EmuTime time)
+{
+	algo->skipOutput(buffer, length, time);
+}
+
 bool ResampledSoundDevice::generateInput(float* buffer, size_t num)
 {
 	return mixChannels(buffer, num);
@@ -473,12 +473,27 @@ void SCC::generateChannels(std::span<float*> bufs, unsigned num)
 			unsigned pos2 = pos[i];
 			unsigned incr2 = incr[i];
 			unsigned period2 = period[i] + 1;
-			for (auto j : xrange(num)) {
-				bufs[i][j] += out2;
-				count2 += incr2;
+			// The output only changes when the waveform index
+			// changes, so fill the buffer in runs of equal samples.
+			auto* buf = bufs[i];
+			unsigned remaining = num;
+			while (remaining) {
+				// number of samples until (and including) the one
+				// after which the waveform index changes
+				unsigned run = (count2 >= period2) ? 1
+				             : (incr2 == 0) ? remaining
+				             : (period2 - count2 + incr2 - 1) / incr2;
+				if (run > remaining) {
+					addFill(buf, out2, remaining);
+					count2 += remaining * incr2;
+					break;
+				}
+				addFill(buf, out2, run);
+				remaining -= run;
+				count2 += run * incr2;
 				// Note: only for very small periods
 				//       this will take more than 1 iteration
-				while (count2 >= period2) [[unlikely]] {
+				while (count2 >= period2) {
 					count2 -= period2;
 					pos2 = (pos2 + 1) % 32;
 					out2 = volAdjustedWave[i][pos2];
@@ -53,6 +53,7 @@ private:
 		Debuggable(MSXMotherBoard& motherBoard, const std::string& name);
 		[[nodiscard]] uint8_t read(unsigned address, EmuTime time) override;
 		void write(unsigned address, uint8_t value, EmuTime time) override;
+		[[nodiscard]] bool includeInStateHash() const override { return true; }
 	} debuggable;
 
 	Clock<CLOCK_FREQ> deformTimer;
@@ -3,6 +3,8 @@
 #include "MSXMixer.hh"
 #include "Mixer.hh"
 
+#include "Display.hh"
+#include "FrameTelemetry.hh"
 #include "GlobalSettings.hh"
 #include "MSXException.hh"
 #include "MSXMotherBoard.hh"
@@ -40,8 +42,10 @@ SDLSoundDriver::SDLSoundDriver(Reactor& reactor_,
 
 	frequency = obtained.freq;
 	fragmentSize = obtained.samples;
+	maxTarget = std::min(8 * fragmentSize, narrow<unsigned>(ring.capacity()));
+	target = std::min(3 * fragmentSize, maxTarget);
+	minFill = narrow<unsigned>(ring.capacity()); // lowered by audioCallback()
 
-	mixBuffer.resize(3 * (obtained.size / sizeof(StereoFloat)) + 1);
 	reInit();
 }
 
@@ -53,8 +57,8 @@ SDLSoundDriver::~SDLSoundDriver()
 void SDLSoundDriver::reInit()
 {
 	SDL_LockAudioDevice(deviceID);
-	readIdx  = 0;
-	writeIdx = 0;
+	ring.clear();
+	started = false;
 	SDL_UnlockAudioDevice(deviceID);
 }
 
@@ -93,81 +97,108 @@ void SDLSoundDriver::audioCallbackHelper(void* userdata, uint8_t* strm, int len)
 		                        len / (2 * sizeof(float))});
 }
 
-unsigned SDLSoundDriver::getBufferFilled() const
+unsigned SDLSoundDriver::getBufferFree() const
 {
-	int result = narrow_cast<int>(writeIdx - readIdx);
-	if (result < 0) result += narrow<int>(mixBuffer.size());
-	assert((0 <= result) && (narrow<unsigned>(result) < mixBuffer.size()));
-	return result;
+	auto filled = narrow<unsigned>(ring.size());
+	auto t = target.load(std::memory_order_relaxed);
+	return (filled < t) ? (t - filled) : 0;
 }
 
-unsigned SDLSoundDriver::getBufferFree() const
+void SDLSoundDriver::adjustTarget(bool underrun)
 {
-	// we can't distinguish completely filled from completely empty
-	// (in both cases readIx would be equal to writeIdx), so instead
-	// we define full as '(writeIdx + 1) == readIdx'.
-	auto result = narrow<unsigned>(mixBuffer.size() - 1 - getBufferFilled());
-	assert(narrow_cast<int>(result) >= 0);
-	assert(result < mixBuffer.size());
-	return result;
+	// Lower the target by 1/8 fragment after 10 seconds without
+	// underruns, but keep at least 2 fragments (the emulation uploads
+	// about one fragment at a time). After an underrun immediately raise
+	// it by half a fragment.
+	auto t = target.load(std::memory_order_relaxed);
+	if (underrun) {
+		stableCallbacks = 0;
+		target.store(std::min(t + fragmentSize / 2, maxTarget),
+		             std::memory_order_relaxed);
+	} else if (++stableCallbacks >= 10 * frequency / fragmentSize) {
+		stableCallbacks = 0;
+		target.store(std::max(t - fragmentSize / 8, std::min(2 * fragmentSize, maxTarget)),
+		             std::memory_order_relaxed);
+	}
 }
 
 void SDLSoundDriver::audioCallback(std::span<StereoFloat> stream)
 {
-	auto len = stream.size();
-
-	size_t available = getBufferFilled();
-	if (auto num = std::min(len, available);
-	    (readIdx + num) < mixBuffer.size()) {
-		copy_to_range(mixBuffer.subspan(readIdx, num), stream);
-		readIdx += narrow<unsigned>(num);
-	} else {
-		auto len1 = mixBuffer.size() - readIdx;
-		copy_to_range(mixBuffer.subspan(readIdx, len1), stream);
-		auto len2 = num - len1;
-		copy_to_range(mixBuffer.first(len2), stream.subspan(len1));
-		readIdx = narrow<unsigned>(len2);
+	auto filled = narrow<unsigned>(ring.size());
+	// compare-exchange, so a concurrent reset in getBufferStats() can't
+	// overwrite a new minimum (or be overwritten by an old one)
+	auto oldMin = minFill.load(std::memory_order_relaxed);
+	while ((filled < oldMin) &&
+	       !minFill.compare_exchange_weak(oldMin, filled, std::memory_order_relaxed)) {
+		// 'oldMin' was reloaded, retry
 	}
-	auto missing = narrow_cast<ptrdiff_t>(len - available);
-	if (missing > 0) {
-		// buffer underrun
-		std::ranges::fill(subspan(stream, available, missing), StereoFloat{});
+
+	auto num = ring.popSome(stream);
+	if (num) started = true;
+	bool underrun = num < stream.size();
+	if (underrun) {
+		std::ranges::fill(stream.subspan(num), StereoFloat{});
+		// ignore the (expected) underruns before the emulation
+		// delivered its first samples
+		if (started) underruns.fetch_add(1, std::memory_order_relaxed);
 	}
+	if (started) adjustTarget(underrun);
 }
 
 void SDLSoundDriver::uploadBuffer(std::span<const StereoFloat> buffer)
 {
-	SDL_LockAudioDevice(deviceID);
+	// Only in real-time play dropping samples is a problem. When not
+	// throttled (fast-forward) or while recording, the emulation produces
+	// samples faster than they're played, then drops are expected.
+	auto* board = reactor.getMotherBoard();
+	bool realTime = board && !board->getMSXMixer().isSynchronousMode() &&
+	                reactor.getGlobalSettings().getThrottleManager().isThrottled();
 	unsigned free = getBufferFree();
 	if (buffer.size() > free) {
-		auto* board = reactor.getMotherBoard();
-		if (board && !board->getMSXMixer().isSynchronousMode() && // when not recording
-		    reactor.getGlobalSettings().getThrottleManager().isThrottled()) {
+		if (realTime) {
+			// Wait till the audio thread consumed enough samples.
+			// Without a lock, this doesn't block that thread.
+			auto needed = [&] {
+				return std::min(narrow<unsigned>(buffer.size()),
+				                target.load(std::memory_order_relaxed));
+			};
+			auto start = Timer::getTime();
 			do {
-				SDL_UnlockAudioDevice(deviceID);
 				Timer::sleep(5000); // 5ms
-				SDL_LockAudioDevice(deviceID);
 				board->getRealTime().resync();
 				free = getBufferFree();
-			} while (buffer.size() > free);
-		} else {
+			} while (needed() > free);
+			reactor.getDisplay().getFrameTelemetry().addSleep(Timer::getTime() - start);
+		}
+		if (buffer.size() > free) {
 			// drop excess samples
-			buffer = buffer.subspan(0, free);
+			if (realTime) overruns.fetch_add(1, std::memory_order_relaxed);
+			buffer = buffer.first(free);
 		}
 	}
-	assert(buffer.size() <= free);
-	if ((writeIdx + buffer.size()) < mixBuffer.size()) {
-		copy_to_range(buffer, mixBuffer.subspan(writeIdx));
-		writeIdx += narrow<unsigned>(buffer.size());
-	} else {
-		auto len1 = mixBuffer.size() - writeIdx;
-		copy_to_range(buffer.subspan(0, len1), mixBuffer.subspan(writeIdx));
-		auto len2 = buffer.size() - len1;
-		copy_to_range(buffer.subspan(len1, len2), std::span{mixBuffer});
-		writeIdx = narrow<unsigned>(len2);
+	auto pushed = ring.pushSome(buffer);
+	if (pushed < buffer.size()) {
+		// only possible when the target was just lowered
+		if (realTime) overruns.fetch_add(1, std::memory_order_relaxed);
 	}
+}
 
-	SDL_UnlockAudioDevice(deviceID);
+unsigned SDLSoundDriver::getBufferFill() const
+{
+	return narrow<unsigned>(ring.size());
+}
+
+SoundDriver::BufferStats SDLSoundDriver::getBufferStats()
+{
+	auto filled = narrow<unsigned>(ring.size());
+	return {
+		.fill = filled,
+		.minFill = std::min(minFill.exchange(filled, std::memory_order_relaxed), filled),
+		.target = target.load(std::memory_order_relaxed),
+		.capacity = narrow<unsigned>(ring.capacity()),
+		.underruns = underruns.load(std::memory_order_relaxed),
+		.overruns = overruns.load(std::memory_order_relaxed),
+	};
 }
 
 } // namespace openmsx
@@ -5,10 +5,12 @@
 
 #include "SDLSurfacePtr.hh"
 
-#include "MemBuffer.hh"
+#include "SPSCRingBuffer.hh"
 
 #include <SDL.h>
 
+#include <atomic>
+
 namespace openmsx {
 
 class Reactor;
@@ -30,22 +32,40 @@ public:
 	[[nodiscard]] unsigned getSamples() const override;
 
 	void uploadBuffer(std::span<const StereoFloat> buffer) override;
+	[[nodiscard]] BufferStats getBufferStats() override;
+	[[nodiscard]] unsigned getBufferFill() const override;
 
 private:
 	void reInit();
-	[[nodiscard]] unsigned getBufferFilled() const;
 	[[nodiscard]] unsigned getBufferFree() const;
 	static void audioCallbackHelper(void* userdata, uint8_t* strm, int len);
 	void audioCallback(std::span<StereoFloat> stream);
+	void adjustTarget(bool underrun);
 
 private:
+	// Enough for the maximum latency target with the maximum fragment
+	// size ('samples' setting).
+	static constexpr size_t RING_CAPACITY = 8 * 8192 + 1;
+
 	Reactor& reactor;
 	SDL_AudioDeviceID deviceID;
-	MemBuffer<StereoFloat> mixBuffer;
+	// The emulation thread (uploadBuffer()) is the producer, the SDL
+	// audio thread (audioCallback()) is the consumer.
+	SPSCRingBuffer<StereoFloat, RING_CAPACITY> ring;
 	unsigned frequency;
 	unsigned fragmentSize;
-	unsigned readIdx = 0, writeIdx = 0;
+	unsigned maxTarget;
 	bool muted = true;
+
+	// How full the emulation keeps the ring. Raised after an underrun,
+	// slowly lowered again while there are no underruns.
+	std::atomic<unsigned> target;
+	std::atomic<unsigned> minFill; // since the last getBufferStats()
+	std::atomic<unsigned> underruns = 0;
+	std::atomic<unsigned> overruns = 0;
+	// only accessed from the audio thread (or while it's paused)
+	unsigned stableCallbacks = 0;
+	bool started = false;
 	[[no_unique_address]] SDLSubSystemInitializer<SDL_INIT_AUDIO> audioInitializer;
 };
 
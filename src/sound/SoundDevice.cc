@@ -198,13 +198,17 @@ std::span<const float> SoundDevice::getLastBuffer(unsigned channel)
 	return {&buf.buffer[buf.stopIdx - requestedSize], requestedSize};
 }
 
+void SoundDevice::skipBuffer(size_t length, float* buffer, EmuTime time)
+{
+	bool ignore = updateBuffer(length, buffer, time);
+	(void)ignore;
+}
+
 bool SoundDevice::mixChannels(float* dataOut, size_t samples)
 {
 	if (samples == 0) return true;
 	size_t outputStereo = isStereo() ? 2 : 1;
 
-	inplace_buffer<float*, MAX_CHANNELS> bufs(uninitialized_tag{}, numChannels);
-
 	// TODO optimization: All channels with the same balance (according to
 	// channelBalance[]) could use the same buffer when balanceCenter is
 	// false
@@ -214,6 +218,17 @@ bool SoundDevice::mixChannels(float* dataOut, size_t samples)
 		    || writer[channel]
 		    || !balanceCenter;
 	};
+
+	bool idle = isIdle();
+	if (idle && std::ranges::none_of(xrange(numChannels), needSeparateBuffer)) {
+		// Nothing to generate, and no per-channel data to update.
+		for (auto i : xrange(numChannels)) {
+			channelBuffers[i].stopIdx = 0; // no valid last data
+		}
+		return false;
+	}
+
+	inplace_buffer<float*, MAX_CHANNELS> bufs(uninitialized_tag{}, numChannels);
 	bool anySeparateChannel = false;
 	auto size = narrow<unsigned>(samples * stereo);
 	auto padded = (size + 3) & ~3; // round up to multiple of 4
@@ -260,7 +275,12 @@ bool SoundDevice::mixChannels(float* dataOut, size_t samples)
 		std::ranges::fill(std::span{dataOut, outputStereo * samples}, 0.0f);
 	}
 
-	generateChannels(bufs, narrow<unsigned>(samples));
+	if (idle) {
+		// same result as a generateChannels() call that mutes all channels
+		std::ranges::fill(bufs, nullptr);
+	} else {
+		generateChannels(bufs, narrow<unsigned>(samples));
+	}
 
 	if (!anySeparateChannel) {
 		return std::ranges::any_of(xrange(numChannels),
@@ -204,6 +204,25 @@ public: // Will be called by Mixer:
 	[[nodiscard]] virtual bool updateBuffer(size_t length, float* buffer,
 	                                        EmuTime time) = 0;
 
+	/** Is this device silent until its registers are written again?
+	  * E.g. because all envelopes are at maximum attenuation and there's
+	  * no sample or DAC playback. While idle, generateChannels() is not
+	  * called at all (instead all channels are treated as muted). This
+	  * also means that free running internal state (e.g. LFO or noise
+	  * generators) is not advanced while idle.
+	  * This is checked on every mixChannels() call, so it should be cheap.
+	  * The default implementation returns false.
+	  */
+	[[nodiscard]] virtual bool isIdle() const { return false; }
+
+	/** Like updateBuffer(), but the caller doesn't need the generated
+	  * samples (e.g. while seeking in the reverse history). The device
+	  * must still advance its internal state till 'time', because that
+	  * state is part of the emulated machine. The default implementation
+	  * simply calls updateBuffer(), so 'buffer' must have the same size.
+	  */
+	virtual void skipBuffer(size_t length, float* buffer, EmuTime time);
+
 protected:
 	/** Adds a number of samples that all have the same value.
 	  * Can be used to synthesize segments of a square wave.
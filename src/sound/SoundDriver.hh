@@ -2,6 +2,7 @@
 #define SOUNDDRIVER_HH
 
 #include "Mixer.hh"
+
 #include <span>
 
 namespace openmsx {
@@ -31,6 +32,23 @@ public:
 
 	virtual void uploadBuffer(std::span<const StereoFloat> buffer) = 0;
 
+	/** Statistics about the buffer between the emulation and the sound
+	  * output, see 'openmsx_info sound_buffer'. Sizes are in samples.
+	  */
+	struct BufferStats {
+		unsigned fill = 0;     // currently buffered
+		unsigned minFill = 0;  // lowest fill seen by the output since the previous call
+		unsigned target = 0;   // (adaptive) latency target
+		unsigned capacity = 0;
+		unsigned underruns = 0; // number of times the output ran out of samples
+		unsigned overruns = 0;  // number of times samples were dropped (during real-time play)
+	};
+	[[nodiscard]] virtual BufferStats getBufferStats() { return {}; }
+
+	/** Number of samples currently buffered. Unlike getBufferStats() this
+	  * doesn't reset any statistics. */
+	[[nodiscard]] virtual unsigned getBufferFill() const { return 0; }
+
 protected:
 	SoundDriver() = default;
 };
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cassert>
 #include <cmath>
 #include <iostream>
 
@@ -788,7 +789,7 @@ void Y8950::setEnabled(bool enabled_, EmuTime time)
 	enabled = enabled_;
 }
 
-bool Y8950::checkMuteHelper()
+bool Y8950::isIdle() const
 {
 	if (!enabled) {
 		return true;
@@ -814,13 +815,9 @@ bool Y8950::checkMuteHelper()
 void Y8950::generateChannels(std::span<float*> bufs, unsigned num)
 {
 	// TODO implement per-channel mute (instead of all-or-nothing)
-	if (checkMuteHelper()) {
-		// TODO update internal state even when muted
-		// during mute pm_phase, am_phase, noiseA_phase, noiseB_phase
-		// and noise_seed aren't updated, probably ok
-		std::ranges::fill(bufs, nullptr);
-		return;
-	}
+	// Note: not called while isIdle(), so during mute pm_phase, am_phase,
+	// noiseA_phase, noiseB_phase and noise_seed aren't updated, probably ok
+	assert(!isIdle());
 
 	for (auto sample : xrange(num)) {
 		// Amplitude modulation: 27 output levels (triangle waveform);
@@ -79,6 +79,7 @@ public:
 private:
 	// SoundDevice
 	[[nodiscard]] float getAmplificationFactorImpl() const override;
+	[[nodiscard]] bool isIdle() const override;
 	void generateChannels(std::span<float*> bufs, unsigned num) override;
 
 	void keyOn_BD();
@@ -94,8 +95,6 @@ private:
 	void setRythmMode(int data);
 	void update_key_status();
 
-	[[nodiscard]] bool checkMuteHelper();
-
 	void changeStatusMask(uint8_t newMask);
 
 	void callback(uint8_t flag) override;
@@ -213,6 +212,7 @@ private:
 		Debuggable(MSXMotherBoard& motherBoard, const std::string& name);
 		[[nodiscard]] uint8_t read(unsigned address, EmuTime time) override;
 		void write(unsigned address, uint8_t value, EmuTime time) override;
+		[[nodiscard]] bool includeInStateHash() const override { return true; }
 	} debuggable;
 
 	const std::unique_ptr<EmuTimer> timer1; //  80us timer
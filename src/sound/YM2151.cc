@@ -920,7 +920,7 @@ YM2151::~YM2151()
 	unregisterSound();
 }
 
-bool YM2151::checkMuteHelper()
+bool YM2151::isIdle() const
 {
 	return std::ranges::all_of(oper, [](auto& op) { return op.state == EG_OFF; });
 }
@@ -1499,11 +1499,9 @@ void YM2151::advance()
 
 void YM2151::generateChannels(std::span<float*> bufs, unsigned num)
 {
-	if (checkMuteHelper()) {
-		// TODO update internal state, even if muted
-		std::ranges::fill(bufs, nullptr);
-		return;
-	}
+	// Note: not called while isIdle(), so while muted the internal state
+	// isn't updated.
+	assert(!isIdle());
 
 	for (auto i : xrange(num)) {
 		advanceEG();
@@ -128,6 +128,7 @@ private:
 	void setConnect(std::span<YM2151Operator, 4> o, int cha, int v);
 
 	// SoundDevice
+	[[nodiscard]] bool isIdle() const override;
 	void generateChannels(std::span<float*> bufs, unsigned num) override;
 
 	void callback(uint8_t flag) override;
@@ -150,8 +151,6 @@ private:
 	void advanceEG();
 	void advance();
 
-	[[nodiscard]] bool checkMuteHelper();
-
 	IRQHelper irq;
 
 	// Timers (see EmuTimer class for details about timing)
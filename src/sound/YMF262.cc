@@ -40,6 +40,7 @@
 #include "YMF262.hh"
 
 #include "DeviceConfig.hh"
+#include "FMEnvelope.hh"
 #include "MSXMotherBoard.hh"
 #include "serialize.hh"
 
@@ -51,17 +52,20 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cassert>
 #include <cmath>
 #include <iostream>
+#include <utility>
 
 namespace openmsx {
 
-[[nodiscard]] static constexpr YMF262::FreqIndex fnumToIncrement(unsigned block_fnum)
+[[nodiscard]] static constexpr YMF262Core::FreqIndex fnumToIncrement(unsigned block_fnum)
 {
 	// opn phase increment counter = 20bit
 	// chip works with 10.10 fixed point, while we use 16.16
 	int block = narrow<int>((block_fnum & 0x1C00) >> 10);
-	return YMF262::FreqIndex(block_fnum & 0x03FF) >> (11 - block);
+	return YMF262Core::FreqIndex(block_fnum & 0x03FF) >> (11 - block);
 }
 
 // envelope output entries
@@ -394,16 +398,16 @@ static constexpr auto tlTab = [] {
 // sin waveform table in 'decibel' scale
 // there are eight waveforms on OPL3 chips
 struct SinTab {
-	std::array<std::array<unsigned, YMF262::SIN_LEN>, 8> tab;
+	std::array<std::array<unsigned, YMF262Core::SIN_LEN>, 8> tab;
 };
 
 static constexpr SinTab getSinTab()
 {
 	SinTab sin = {};
 
-	constexpr auto SIN_BITS = YMF262::SIN_BITS;
-	constexpr auto SIN_LEN  = YMF262::SIN_LEN;
-	constexpr auto SIN_MASK = YMF262::SIN_MASK;
+	constexpr auto SIN_BITS = YMF262Core::SIN_BITS;
+	constexpr auto SIN_LEN  = YMF262Core::SIN_LEN;
+	constexpr auto SIN_MASK = YMF262Core::SIN_MASK;
 	for (auto i : xrange(SIN_LEN / 4)) {
 		// non-standard sinus
 		double m = cstd::sin<2>(((i * 2) + 1) * Math::pi / SIN_LEN); // checked against the real chip
@@ -489,7 +493,7 @@ static int phase_modulation2; // phase modulation input (SLOT 3
                               // in 4 operator channels)
 
 
-YMF262::Slot::Slot()
+YMF262Core::Slot::Slot()
 	: waveTable(sin.tab[0])
 {
 }
@@ -536,7 +540,7 @@ void YMF262::changeStatusMask(uint8_t flag)
 	}
 }
 
-void YMF262::Slot::advanceEnvelopeGenerator(unsigned egCnt)
+void YMF262Core::Slot::advanceEnvelopeGenerator(unsigned egCnt)
 {
 	switch (state) {
 	using enum EnvelopeState;
@@ -594,7 +598,20 @@ void YMF262::Slot::advanceEnvelopeGenerator(unsigned egCnt)
 	}
 }
 
-void YMF262::Slot::advancePhaseGenerator(const Channel& ch, unsigned lfo_pm)
+// The 'egCnt' mask for advanceEnvelopeGenerator() in the current state.
+uint32_t YMF262Core::Slot::envelopeMask() const
+{
+	switch (state) {
+	using enum EnvelopeState;
+	case ATTACK:  return eg_m_ar;
+	case DECAY:   return eg_m_dr;
+	case SUSTAIN: return eg_type ? FMEnvelope::IDLE : eg_m_rr;
+	case RELEASE: return eg_m_rr;
+	default:      return FMEnvelope::IDLE;
+	}
+}
+
+void YMF262Core::Slot::advancePhaseGenerator(const Channel& ch, unsigned lfo_pm)
 {
 	if (vib) {
 		// LFO phase modulation active
@@ -608,8 +625,30 @@ void YMF262::Slot::advancePhaseGenerator(const Channel& ch, unsigned lfo_pm)
 	}
 }
 
+void YMF262Core::updateEnvelopeMasks()
+{
+	for (auto i : xrange(unsigned(channel.size()))) {
+		for (auto j : xrange(2u)) {
+			egMasks[2 * i + j] = channel[i].slot[j].envelopeMask();
+		}
+	}
+}
+
+// Usually only a few envelope generators take a step, find those for all
+// slots at once.
+void YMF262Core::stepDueEnvelopes()
+{
+	for (auto due = FMEnvelope::dueSlots(std::span{std::as_const(egMasks)}, eg_cnt);
+	     due; due &= due - 1) {
+		auto s = unsigned(std::countr_zero(due));
+		auto& op = channel[s / 2].slot[s % 2];
+		op.advanceEnvelopeGenerator(eg_cnt);
+		egMasks[s] = op.envelopeMask();
+	}
+}
+
 // advance to next sample
-void YMF262::advance()
+void YMF262Core::advance()
 {
 	// Vibrato: 8 output levels (triangle waveform);
 	// 1 level takes 1024 samples
@@ -617,11 +656,11 @@ void YMF262::advance()
 	unsigned lfo_pm = (lfo_pm_cnt.toInt() & 7) | lfo_pm_depth_range;
 
 	++eg_cnt;
+	stepDueEnvelopes();
 	for (auto i : xrange(unsigned(channel.size()))) {
 		auto& ch = channel[i];
 		auto& ch2 = isExtended(i) ? getFirstOfPair(i) : ch;
 		for (auto& op : ch.slot) {
-			op.advanceEnvelopeGenerator(eg_cnt);
 			op.advancePhaseGenerator(ch2, lfo_pm);
 		}
 	}
@@ -651,7 +690,7 @@ void YMF262::advance()
 	noise_rng >>= 1;
 }
 
-inline int YMF262::Slot::op_calc(unsigned phase, unsigned lfo_am) const
+inline int YMF262Core::Slot::op_calc(unsigned phase, unsigned lfo_am) const
 {
 	unsigned env = (TLL + volume + (lfo_am & AMmask)) << 4;
 	auto p = env + waveTable[phase & SIN_MASK];
@@ -660,7 +699,7 @@ inline int YMF262::Slot::op_calc(unsigned phase, unsigned lfo_am) const
 
 // calculate output of a standard 2 operator channel
 // (or 1st part of a 4-op channel)
-void YMF262::Channel::chan_calc(unsigned lfo_am)
+void YMF262Core::Channel::chan_calc(unsigned lfo_am)
 {
 	// !! something is wrong with this, it caused bug
 	// !!    [2823673] MoonSound 4 operator FM fail
@@ -699,7 +738,7 @@ void YMF262::Channel::chan_calc(unsigned lfo_am)
 }
 
 // calculate output of a 2nd part of 4-op channel
-void YMF262::Channel::chan_calc_ext(unsigned lfo_am)
+void YMF262Core::Channel::chan_calc_ext(unsigned lfo_am)
 {
 	// !! see remark in chan_cal(), something is wrong with this
 	// !! optimization disabled for now
@@ -755,7 +794,7 @@ void YMF262::Channel::chan_calc_ext(unsigned lfo_am)
 // The following formulas can be well optimized.
 // I leave them in direct form for now (in case I've missed something).
 
-inline unsigned YMF262::genPhaseHighHat()
+inline unsigned YMF262Core::genPhaseHighHat()
 {
 	// high hat phase generation (verified on real YM3812):
 	// phase = d0 or 234 (based on frequency only)
@@ -798,7 +837,7 @@ inline unsigned YMF262::genPhaseHighHat()
 	return phase;
 }
 
-inline unsigned YMF262::genPhaseSnare()
+inline unsigned YMF262Core::genPhaseSnare()
 {
 	// verified on real YM3812
 	// base frequency derived from operator 1 in channel 7
@@ -807,7 +846,7 @@ inline unsigned YMF262::genPhaseSnare()
 	     ^ ((noise_rng & 1) << 8);
 }
 
-inline unsigned YMF262::genPhaseCymbal()
+inline unsigned YMF262Core::genPhaseCymbal()
 {
 	// verified on real YM3812
 	// enable gate based on frequency of operator 2 in channel 8
@@ -827,7 +866,7 @@ inline unsigned YMF262::genPhaseCymbal()
 }
 
 // calculate rhythm
-void YMF262::chan_calc_rhythm(unsigned lfo_am)
+void YMF262Core::chan_calc_rhythm(unsigned lfo_am)
 {
 	// Bass Drum (verified on real YM3812):
 	//  - depends on the channel 6 'connect' register:
@@ -867,7 +906,7 @@ void YMF262::chan_calc_rhythm(unsigned lfo_am)
 	chanOut[8] += 2 * car8.op_calc(genPhaseCymbal(),  lfo_am);
 }
 
-void YMF262::Slot::FM_KEYON(uint8_t key_set)
+void YMF262Core::Slot::FM_KEYON(uint8_t key_set)
 {
 	if (!key) {
 		// restart Phase Generator
@@ -878,7 +917,7 @@ void YMF262::Slot::FM_KEYON(uint8_t key_set)
 	key |= key_set;
 }
 
-void YMF262::Slot::FM_KEYOFF(uint8_t key_clr)
+void YMF262Core::Slot::FM_KEYOFF(uint8_t key_clr)
 {
 	if (key) {
 		key &= ~key_clr;
@@ -891,7 +930,7 @@ void YMF262::Slot::FM_KEYOFF(uint8_t key_clr)
 	}
 }
 
-void YMF262::Slot::update_ar_dr()
+void YMF262Core::Slot::update_ar_dr()
 {
 	if ((ar + ksr) < 16 + 60) {
 		// verified on real YMF262 - all 15 x rates take "zero" time
@@ -906,7 +945,7 @@ void YMF262::Slot::update_ar_dr()
 	eg_sel_dr = eg_rate_select[dr + ksr];
 	eg_m_dr   = (1 << eg_sh_dr) - 1;
 }
-void YMF262::Slot::update_rr()
+void YMF262Core::Slot::update_rr()
 {
 	eg_sh_rr  = eg_rate_shift [rr + ksr];
 	eg_sel_rr = eg_rate_select[rr + ksr];
@@ -914,7 +953,7 @@ void YMF262::Slot::update_rr()
 }
 
 // update phase increment counter of operator (also update the EG rates if necessary)
-void YMF262::Slot::calc_fc(const Channel& ch)
+void YMF262Core::Slot::calc_fc(const Channel& ch)
 {
 	// (frequency) phase increment counter
 	Incr = ch.fc * mul;
@@ -932,7 +971,7 @@ static constexpr std::array<unsigned, 18> channelPairTab = {
 	0,  1,  2,  0,  1,  2, unsigned(~0), unsigned(~0), unsigned(~0),
 	9, 10, 11,  9, 10, 11, unsigned(~0), unsigned(~0), unsigned(~0),
 };
-inline bool YMF262::isExtended(unsigned ch) const
+inline bool YMF262Core::isExtended(unsigned ch) const
 {
 	assert(ch < 18);
 	if (!OPL3_mode) return false;
@@ -944,17 +983,17 @@ static constexpr unsigned getFirstOfPairNum(unsigned ch)
 	assert((ch < 18) && (channelPairTab[ch] != unsigned(~0)));
 	return channelPairTab[ch];
 }
-inline YMF262::Channel& YMF262::getFirstOfPair(unsigned ch)
+inline YMF262Core::Channel& YMF262Core::getFirstOfPair(unsigned ch)
 {
 	return channel[getFirstOfPairNum(ch) + 0];
 }
-inline YMF262::Channel& YMF262::getSecondOfPair(unsigned ch)
+inline YMF262Core::Channel& YMF262Core::getSecondOfPair(unsigned ch)
 {
 	return channel[getFirstOfPairNum(ch) + 3];
 }
 
 // set multi,am,vib,EG-TYP,KSR,mul
-void YMF262::set_mul(unsigned sl, uint8_t v)
+void YMF262Core::set_mul(unsigned sl, uint8_t v)
 {
 	unsigned chan_no = sl / 2;
 	auto& ch = channel[chan_no];
@@ -977,7 +1016,7 @@ void YMF262::set_mul(unsigned sl, uint8_t v)
 }
 
 // set ksl & tl
-void YMF262::set_ksl_tl(unsigned sl, uint8_t v)
+void YMF262Core::set_ksl_tl(unsigned sl, uint8_t v)
 {
 	unsigned chan_no = sl / 2;
 	auto& ch = channel[chan_no];
@@ -1001,7 +1040,7 @@ void YMF262::set_ksl_tl(unsigned sl, uint8_t v)
 }
 
 // set attack rate & decay rate
-void YMF262::set_ar_dr(unsigned sl, uint8_t v)
+void YMF262Core::set_ar_dr(unsigned sl, uint8_t v)
 {
 	auto& ch = channel[sl / 2];
 	auto& slot = ch.slot[sl & 1];
@@ -1012,7 +1051,7 @@ void YMF262::set_ar_dr(unsigned sl, uint8_t v)
 }
 
 // set sustain level & release rate
-void YMF262::set_sl_rr(unsigned sl, uint8_t v)
+void YMF262Core::set_sl_rr(unsigned sl, uint8_t v)
 {
 	auto& ch = channel[sl / 2];
 	auto& slot = ch.slot[sl & 1];
@@ -1030,12 +1069,12 @@ uint8_t YMF262::readReg(unsigned r) const
 
 uint8_t YMF262::peekReg(unsigned r) const
 {
-	return reg[r];
+	return core.peekReg(r);
 }
 
 void YMF262::writeReg(unsigned r, uint8_t v, EmuTime time)
 {
-	if (!OPL3_mode && (r != 0x105)) {
+	if (!core.isOPL3Mode() && (r != 0x105)) {
 		// in OPL2 mode the only accessible in set #2 is register 0x05
 		r &= ~0x100;
 	}
@@ -1047,6 +1086,43 @@ void YMF262::writeReg512(unsigned r, uint8_t v, EmuTime time)
 	writeRegDirect(r, v, time);
 }
 void YMF262::writeRegDirect(unsigned r, uint8_t v, EmuTime time)
+{
+	switch (r) {
+	case 0x002: // Timer 1
+		timer1->setValue(v);
+		break;
+
+	case 0x003: // Timer 2
+		timer2->setValue(v);
+		break;
+
+	case 0x004: // IRQ clear / mask and Timer enable
+		if (v & 0x80) {
+			// IRQ flags clear
+			resetStatus(0x60);
+		} else {
+			changeStatusMask((~v) & 0x60);
+			timer1->setStart((v & R04_ST1) != 0, time);
+			timer2->setStart((v & R04_ST2) != 0, time);
+		}
+		break;
+
+	case 0x105:
+		// Verified on real YMF278: When NEW2 bit is first set, a read
+		// from the status register (once) returns bit 1 set (0x02).
+		// This only happens once after reset, so clearing NEW2 and
+		// setting it again doesn't cause another change in the status
+		// register. Also, only bit 1 changes.
+		if ((v & 0x02) && !alreadySignaledNEW2 && isYMF278) {
+			status2 = 0x02;
+			alreadySignaledNEW2 = true;
+		}
+		break;
+	}
+	core.writeReg(r, v);
+}
+
+void YMF262Core::writeReg(unsigned r, uint8_t v)
 {
 	reg[r] = v;
 
@@ -1059,22 +1135,9 @@ void YMF262::writeRegDirect(unsigned r, uint8_t v, EmuTime time)
 			break;
 
 		case 0x002: // Timer 1
-			timer1->setValue(v);
-			break;
-
 		case 0x003: // Timer 2
-			timer2->setValue(v);
-			break;
-
 		case 0x004: // IRQ clear / mask and Timer enable
-			if (v & 0x80) {
-				// IRQ flags clear
-				resetStatus(0x60);
-			} else {
-				changeStatusMask((~v) & 0x60);
-				timer1->setStart((v & R04_ST1) != 0, time);
-				timer2->setStart((v & R04_ST2) != 0, time);
-			}
+			// handled by YMF262
 			break;
 
 		case 0x008: // x,NTS,x,x, x,x,x,x
@@ -1099,16 +1162,6 @@ void YMF262::writeRegDirect(unsigned r, uint8_t v, EmuTime time)
 			// OPL3 mode when bit0=1 otherwise it is OPL2 mode
 			OPL3_mode = v & 0x01;
 
-			// Verified on real YMF278: When NEW2 bit is first set, a read
-			// from the status register (once) returns bit 1 set (0x02).
-			// This only happens once after reset, so clearing NEW2 and
-			// setting it again doesn't cause another change in the status
-			// register. Also, only bit 1 changes.
-			if ((v & 0x02) && !alreadySignaledNEW2 && isYMF278) {
-				status2 = 0x02;
-				alreadySignaledNEW2 = true;
-			}
-
 			// following behaviour was tested on real YMF262,
 			// switching OPL3/OPL2 modes on the fly:
 			//  - does not change the waveform previously selected
@@ -1395,29 +1448,27 @@ void YMF262::writeRegDirect(unsigned r, uint8_t v, EmuTime time)
 }
 
 
-void YMF262::reset(EmuTime time)
+void YMF262Core::reset()
 {
 	eg_cnt = 0;
 
 	noise_rng = 1; // noise shift register
 	nts = false; // note split
-	alreadySignaledNEW2 = false;
-	resetStatus(0x60);
 
 	// reset with register write
-	writeRegDirect(0x01, 0, time); // test register
-	writeRegDirect(0x02, 0, time); // Timer1
-	writeRegDirect(0x03, 0, time); // Timer2
-	writeRegDirect(0x04, 0, time); // IRQ mask clear
+	writeReg(0x01, 0); // test register
+	writeReg(0x02, 0); // Timer1
+	writeReg(0x03, 0); // Timer2
+	writeReg(0x04, 0); // IRQ mask clear
 
 	// FIX IT  registers 101, 104 and 105
 	// FIX IT (dont change CH.D, CH.C, CH.B and CH.A in C0-C8 registers)
 	for (int c = 0xFF; c >= 0x20; c--) {
-		writeRegDirect(c, 0, time);
+		writeReg(c, 0);
 	}
 	// FIX IT (dont change CH.D, CH.C, CH.B and CH.A in C0-C8 registers)
 	for (int c = 0x1FF; c >= 0x120; c--) {
-		writeRegDirect(c, 0, time);
+		writeReg(c, 0);
 	}
 
 	// reset operator parameters
@@ -1427,6 +1478,16 @@ void YMF262::reset(EmuTime time)
 			sl.volume = MAX_ATT_INDEX;
 		}
 	}
+}
+
+void YMF262::reset(EmuTime time)
+{
+	alreadySignaledNEW2 = false;
+	resetStatus(0x60);
+	writeRegDirect(0x02, 0, time); // Timer1
+	writeRegDirect(0x03, 0, time); // Timer2
+	writeRegDirect(0x04, 0, time); // IRQ mask clear
+	core.reset();
 
 	setMixLevel(0x1b, time); // -9dB left and right
 }
@@ -1484,7 +1545,12 @@ uint8_t YMF262::peekStatus() const
 	return status | status2;
 }
 
-bool YMF262::checkMuteHelper() const
+bool YMF262::isIdle() const
+{
+	return core.isIdle();
+}
+
+bool YMF262Core::isIdle() const
 {
 	// TODO this doesn't always mute when possible
 	for (const auto& ch : channel) {
@@ -1525,13 +1591,18 @@ void YMF262::generateChannels(std::span<float*> bufs, unsigned num)
 {
 	// TODO implement per-channel mute (instead of all-or-nothing)
 	// TODO output rhythm on separate channels?
-	if (checkMuteHelper()) {
-		// TODO update internal state, even if muted
-		std::ranges::fill(bufs, nullptr);
-		return;
-	}
+	// Note: not called while isIdle(), so while muted the internal state
+	// isn't updated.
+	assert(!isIdle());
+	core.generateChannels(bufs, num);
+}
 
+void YMF262Core::generateChannels(std::span<float*> bufs, unsigned num)
+{
 	bool rhythmEnabled = (rhythm & 0x20) != 0;
+	// registers (and thus the envelope states) don't change during this call,
+	// except in advance() itself
+	updateEnvelopeMasks();
 
 	for (auto j : xrange(num)) {
 		// Amplitude modulation: 27 output levels (triangle waveform);
@@ -1593,17 +1664,17 @@ void YMF262::generateChannels(std::span<float*> bufs, unsigned num)
 }
 
 
-static constexpr auto envelopeStateInfo = std::to_array<enum_string<YMF262::EnvelopeState>>({
-	{ "ATTACK",  YMF262::EnvelopeState::ATTACK  },
-	{ "DECAY",   YMF262::EnvelopeState::DECAY   },
-	{ "SUSTAIN", YMF262::EnvelopeState::SUSTAIN },
-	{ "RELEASE", YMF262::EnvelopeState::RELEASE },
-	{ "OFF",     YMF262::EnvelopeState::OFF     },
+static constexpr auto envelopeStateInfo = std::to_array<enum_string<YMF262Core::EnvelopeState>>({
+	{ "ATTACK",  YMF262Core::EnvelopeState::ATTACK  },
+	{ "DECAY",   YMF262Core::EnvelopeState::DECAY   },
+	{ "SUSTAIN", YMF262Core::EnvelopeState::SUSTAIN },
+	{ "RELEASE", YMF262Core::EnvelopeState::RELEASE },
+	{ "OFF",     YMF262Core::EnvelopeState::OFF     },
 });
-SERIALIZE_ENUM(YMF262::EnvelopeState, envelopeStateInfo);
+SERIALIZE_ENUM(YMF262Core::EnvelopeState, envelopeStateInfo);
 
 template<typename Archive>
-void YMF262::Slot::serialize(Archive& a, unsigned /*version*/)
+void YMF262Core::Slot::serialize(Archive& a, unsigned /*version*/)
 {
 	// waveTable
 	auto waveform = unsigned((waveTable.data() - sin.tab[0].data()) / SIN_LEN);
@@ -1647,7 +1718,7 @@ void YMF262::Slot::serialize(Archive& a, unsigned /*version*/)
 }
 
 template<typename Archive>
-void YMF262::Channel::serialize(Archive& a, unsigned /*version*/)
+void YMF262Core::Channel::serialize(Archive& a, unsigned /*version*/)
 {
 	a.serialize("slots",      slot,
 	            "block_fnum", block_fnum,
@@ -1657,15 +1728,10 @@ void YMF262::Channel::serialize(Archive& a, unsigned /*version*/)
 	            "extended",   extended);
 }
 
-// version 1: initial version
-// version 2: added alreadySignaledNEW2
 template<typename Archive>
-void YMF262::serialize(Archive& a, unsigned version)
+void YMF262Core::serialize(Archive& a, unsigned /*version*/)
 {
-	a.serialize("timer1",  *timer1,
-	            "timer2",  *timer2,
-	            "irq",     irq,
-	            "chanout", chanOut);
+	a.serialize("chanout", chanOut);
 	a.serialize_blob("registers", reg);
 	a.serialize("channels",           channel,
 	            "eg_cnt",             eg_cnt,
@@ -1676,8 +1742,26 @@ void YMF262::serialize(Archive& a, unsigned version)
 	            "lfo_pm_depth_range", lfo_pm_depth_range,
 	            "rhythm",             rhythm,
 	            "nts",                nts,
-	            "OPL3_mode",          OPL3_mode,
-	            "status",             status,
+	            "OPL3_mode",          OPL3_mode);
+
+	// TODO restore more state by rewriting register values
+	//   this handles pan
+	for (auto i : xrange(0xC0, 0xC9)) {
+		writeReg(i + 0x000, reg[i + 0x000]);
+		writeReg(i + 0x100, reg[i + 0x100]);
+	}
+}
+
+// version 1: initial version
+// version 2: added alreadySignaledNEW2
+template<typename Archive>
+void YMF262::serialize(Archive& a, unsigned version)
+{
+	a.serialize("timer1",  *timer1,
+	            "timer2",  *timer2,
+	            "irq",     irq);
+	core.serialize(a, version); // (not in a separate tag)
+	a.serialize("status",             status,
 	            "status2",            status2,
 	            "statusMask",         statusMask);
 	if (a.versionAtLeast(version, 2)) {
@@ -1687,14 +1771,6 @@ void YMF262::serialize(Archive& a, unsigned version)
 		alreadySignaledNEW2 = true; // we can't know the actual value,
 									// but 'true' is the safest value
 	}
-
-	// TODO restore more state by rewriting register values
-	//   this handles pan
-	EmuTime time = timer1->getCurrentTime();
-	for (auto i : xrange(0xC0, 0xC9)) {
-		writeRegDirect(i + 0x000, reg[i + 0x000], time);
-		writeRegDirect(i + 0x100, reg[i + 0x100], time);
-	}
 }
 
 INSTANTIATE_SERIALIZE_METHODS(YMF262);
@@ -21,7 +21,11 @@ namespace openmsx {
 
 class DeviceConfig;
 
-class YMF262 final : private ResampledSoundDevice, private EmuTimerCallback
+/** The sound generation part of the YMF262: registers in, samples out.
+  * Timers, status register and IRQ are handled by the YMF262 class below.
+  * Like YM2413Core this allows to test the emulation in isolation.
+  */
+class YMF262Core
 {
 public:
 	// sin-wave entries
@@ -29,25 +33,6 @@ public:
 	static constexpr int SIN_LEN  = 1 << SIN_BITS;
 	static constexpr int SIN_MASK = SIN_LEN - 1;
 
-public:
-	YMF262(const std::string& name, const DeviceConfig& config,
-	       bool isYMF278);
-	~YMF262();
-
-	void reset(EmuTime time);
-	void writeReg   (unsigned r, uint8_t v, EmuTime time);
-	void writeReg512(unsigned r, uint8_t v, EmuTime time);
-	[[nodiscard]] uint8_t readReg(unsigned reg) const;
-	[[nodiscard]] uint8_t peekReg(unsigned reg) const;
-	[[nodiscard]] uint8_t readStatus();
-	[[nodiscard]] uint8_t peekStatus() const;
-
-	void setMixLevel(uint8_t x, EmuTime time);
-
-	template<typename Archive>
-	void serialize(Archive& ar, unsigned version);
-
-public:
 	/** 16.16 fixed point type for frequency calculations */
 	using FreqIndex = FixedPoint<16>;
 
@@ -55,6 +40,21 @@ public:
 		ATTACK, DECAY, SUSTAIN, RELEASE, OFF
 	};
 
+public:
+	void reset();
+	/** Write a register in the range [0x000, 0x1FF], without OPL2 mode
+	  * translation. Timer and IRQ registers are ignored. */
+	void writeReg(unsigned r, uint8_t v);
+	[[nodiscard]] uint8_t peekReg(unsigned r) const { return reg[r]; }
+	[[nodiscard]] bool isOPL3Mode() const { return OPL3_mode; }
+
+	[[nodiscard]] bool isIdle() const;
+	/** Add 'num' stereo samples for each of the 18 channels to 'bufs'. */
+	void generateChannels(std::span<float*> bufs, unsigned num);
+
+	template<typename Archive>
+	void serialize(Archive& ar, unsigned version);
+
 private:
 	class Channel;
 
@@ -65,6 +65,7 @@ private:
 		void FM_KEYON(uint8_t key_set);
 		void FM_KEYOFF(uint8_t key_clr);
 		void advanceEnvelopeGenerator(unsigned egCnt);
+		[[nodiscard]] uint32_t envelopeMask() const;
 		void advancePhaseGenerator(const Channel& ch, unsigned lfo_pm);
 		void update_ar_dr();
 		void update_rr();
@@ -151,17 +152,9 @@ private:
 		                      // channels, ie 0,1,2 and 9,10,11)
 	};
 
-	// SoundDevice
-	[[nodiscard]] float getAmplificationFactorImpl() const override;
-	void generateChannels(std::span<float*> bufs, unsigned num) override;
-
-	void callback(uint8_t flag) override;
-
-	void writeRegDirect(unsigned r, uint8_t v, EmuTime time);
 	void init_tables();
-	void setStatus(uint8_t flag);
-	void resetStatus(uint8_t flag);
-	void changeStatusMask(uint8_t flag);
+	void updateEnvelopeMasks();
+	void stepDueEnvelopes();
 	void advance();
 
 	[[nodiscard]] unsigned genPhaseHighHat();
@@ -173,16 +166,76 @@ private:
 	void set_ksl_tl(unsigned sl, uint8_t v);
 	void set_ar_dr(unsigned sl, uint8_t v);
 	void set_sl_rr(unsigned sl, uint8_t v);
-	[[nodiscard]] bool checkMuteHelper() const;
 
 	[[nodiscard]] bool isExtended(unsigned ch) const;
 	[[nodiscard]] Channel& getFirstOfPair(unsigned ch);
 	[[nodiscard]] Channel& getSecondOfPair(unsigned ch);
 
+private:
+	std::array<int, 18> chanOut = {};      // 18 channels
+
+	std::array<uint8_t, 512> reg = {};
+	std::array<Channel, 18> channel;  // OPL3 chips have 18 channels
+
+	std::array<int, 18 * 4> pan; // channels output masks 4 per channel
+	                             //    0xffffffff = enable
+	unsigned eg_cnt{0};          // global envelope generator counter
+	// Slot::envelopeMask() for all 36 slots (slot n is in channel n / 2),
+	// only valid during generateChannels(), not serialized.
+	std::array<uint32_t, 18 * 2> egMasks = {};
+	unsigned noise_rng{1};       // 23 bit noise shift register
+
+	// LFO
+	using LFOAMIndex = FixedPoint< 6>;
+	using LFOPMIndex = FixedPoint<10>;
+	LFOAMIndex lfo_am_cnt{0};
+	LFOPMIndex lfo_pm_cnt{0};
+	bool lfo_am_depth{false};
+	uint8_t lfo_pm_depth_range{0};
+
+	uint8_t rhythm{0};		// Rhythm mode
+	bool nts{false};			// NTS (note select)
+	bool OPL3_mode{false};		// OPL3 extension enable flag
+};
+
+class YMF262 final : private ResampledSoundDevice, private EmuTimerCallback
+{
+public:
+	YMF262(const std::string& name, const DeviceConfig& config,
+	       bool isYMF278);
+	~YMF262();
+
+	void reset(EmuTime time);
+	void writeReg   (unsigned r, uint8_t v, EmuTime time);
+	void writeReg512(unsigned r, uint8_t v, EmuTime time);
+	[[nodiscard]] uint8_t readReg(unsigned reg) const;
+	[[nodiscard]] uint8_t peekReg(unsigned reg) const;
+	[[nodiscard]] uint8_t readStatus();
+	[[nodiscard]] uint8_t peekStatus() const;
+
+	void setMixLevel(uint8_t x, EmuTime time);
+
+	template<typename Archive>
+	void serialize(Archive& ar, unsigned version);
+
+private:
+	// SoundDevice
+	[[nodiscard]] float getAmplificationFactorImpl() const override;
+	[[nodiscard]] bool isIdle() const override;
+	void generateChannels(std::span<float*> bufs, unsigned num) override;
+
+	void callback(uint8_t flag) override;
+
+	void writeRegDirect(unsigned r, uint8_t v, EmuTime time);
+	void setStatus(uint8_t flag);
+	void resetStatus(uint8_t flag);
+	void changeStatusMask(uint8_t flag);
+
 	struct Debuggable final : SimpleDebuggable {
 		Debuggable(MSXMotherBoard& motherBoard, const std::string& name);
 		[[nodiscard]] uint8_t read(unsigned address) override;
 		void write(unsigned address, uint8_t value, EmuTime time) override;
+		[[nodiscard]] bool includeInStateHash() const override { return true; }
 	} debuggable;
 
 	// Bitmask for register 0x04
@@ -201,27 +254,7 @@ private:
 
 	IRQHelper irq;
 
-	std::array<int, 18> chanOut = {};      // 18 channels
-
-	std::array<uint8_t, 512> reg = {};
-	std::array<Channel, 18> channel;  // OPL3 chips have 18 channels
-
-	std::array<int, 18 * 4> pan; // channels output masks 4 per channel
-	                             //    0xffffffff = enable
-	unsigned eg_cnt{0};          // global envelope generator counter
-	unsigned noise_rng{1};       // 23 bit noise shift register
-
-	// LFO
-	using LFOAMIndex = FixedPoint< 6>;
-	using LFOPMIndex = FixedPoint<10>;
-	LFOAMIndex lfo_am_cnt{0};
-	LFOPMIndex lfo_pm_cnt{0};
-	bool lfo_am_depth{false};
-	uint8_t lfo_pm_depth_range{0};
-
-	uint8_t rhythm{0};		// Rhythm mode
-	bool nts{false};			// NTS (note select)
-	bool OPL3_mode{false};		// OPL3 extension enable flag
+	YMF262Core core;
 
 	uint8_t status{0};		// status flag
 	uint8_t status2{0};
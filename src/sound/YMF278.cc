@@ -43,6 +43,7 @@
 #include "xrange.hh"
 
 #include <algorithm>
+#include <cassert>
 
 namespace openmsx {
 
@@ -471,9 +472,9 @@ uint16_t YMF278::nextPos(const Slot& slot, uint16_t pos, uint16_t increment)
 	return pos;
 }
 
-bool YMF278::anyActive()
+bool YMF278::isIdle() const
 {
-	return std::ranges::any_of(slots, [](auto& op) { return op.state != EG_OFF; });
+	return std::ranges::all_of(slots, [](const auto& op) { return op.state == EG_OFF; });
 }
 
 // In: 'envVol', 0=max volume, others -> -3/32 = -0.09375 dB/step
@@ -505,12 +506,10 @@ void YMF278::setMixLevel(uint8_t x, EmuTime time)
 
 void YMF278::generateChannels(std::span<float*> bufs, unsigned num)
 {
-	if (!anyActive()) {
-		// TODO update internal state, even if muted
-		// TODO also mute individual channels
-		std::ranges::fill(bufs, nullptr);
-		return;
-	}
+	// Note: not called while isIdle(), so while muted the internal state
+	// isn't updated.
+	// TODO also mute individual channels
+	assert(!isIdle());
 
 	for (auto j : xrange(num)) {
 		for (auto i : xrange(24)) {
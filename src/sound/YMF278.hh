@@ -106,6 +106,7 @@ private:
 	};
 
 	// SoundDevice
+	[[nodiscard]] bool isIdle() const override;
 	void generateChannels(std::span<float*> bufs, unsigned num) override;
 
 	void writeRegDirect(uint8_t reg, uint8_t data, EmuTime time);
@@ -113,7 +114,6 @@ private:
 	[[nodiscard]] int16_t getSample(const Slot& slot, uint16_t pos) const;
 	[[nodiscard]] static uint16_t nextPos(const Slot& slot, uint16_t pos, uint16_t increment);
 	void advance();
-	[[nodiscard]] bool anyActive();
 	void keyOnHelper(Slot& slot) const;
 
 	MSXMotherBoard& motherBoard;
@@ -122,6 +122,7 @@ private:
 		DebugRegisters(MSXMotherBoard& motherBoard, const std::string& name);
 		[[nodiscard]] uint8_t read(unsigned address) override;
 		void write(unsigned address, uint8_t value, EmuTime time) override;
+		[[nodiscard]] bool includeInStateHash() const override { return true; }
 	} debugRegisters;
 
 	struct DebugMemory final : SimpleDebuggable {
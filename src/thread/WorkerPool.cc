@@ -0,0 +1,92 @@
+#include "WorkerPool.hh"
+
+#include "xrange.hh"
+
+#include <algorithm>
+#include <cassert>
+
+namespace openmsx {
+
+WorkerPool::WorkerPool(unsigned numThreads)
+{
+	threads.reserve(numThreads);
+	for (auto i : xrange(numThreads)) {
+		(void)i;
+		threads.emplace_back([this] { workerLoop(); });
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::scoped_lock lock(mutex);
+		stop = true;
+	}
+	startCond.notify_all();
+	for (auto& t : threads) t.join();
+}
+
+unsigned WorkerPool::defaultNumThreads(unsigned maxThreads)
+{
+	unsigned cores = std::thread::hardware_concurrency(); // 0 if unknown
+	return std::min(std::max(cores, 1u) - 1, maxThreads);
+}
+
+void WorkerPool::parallelFor(size_t n, function_ref<void(size_t)> job)
+{
+	if (threads.empty() || (n <= 1)) {
+		for (auto i : xrange(n)) job(i);
+		return;
+	}
+
+	{
+		std::scoped_lock lock(mutex);
+		assert(!currentJob); // not re-entrant
+		currentJob = &job;
+		count = n;
+		next.store(0, std::memory_order_relaxed);
+		++generation;
+	}
+	startCond.notify_all();
+
+	runJobs(); // also work on the calling thread
+
+	// All jobs are claimed now, wait till the workers that claimed a job
+	// have finished it. Workers that didn't wake up yet won't touch 'job'
+	// anymore (there's nothing left to claim).
+	std::unique_lock lock(mutex);
+	doneCond.wait(lock, [&] { return active == 0; });
+	currentJob = nullptr;
+	count = 0;
+}
+
+void WorkerPool::runJobs()
+{
+	// 'currentJob' and 'count' don't change while jobs can be claimed
+	auto& job = *currentJob;
+	while (true) {
+		auto i = next.fetch_add(1, std::memory_order_relaxed);
+		if (i >= count) break;
+		job(i);
+	}
+}
+
+void WorkerPool::workerLoop()
+{
+	std::unique_lock lock(mutex);
+	unsigned seen = generation;
+	while (true) {
+		startCond.wait(lock, [&] { return stop || (generation != seen); });
+		if (stop) return;
+		seen = generation;
+		if (!currentJob) continue; // job already completely finished
+
+		++active;
+		lock.unlock();
+		runJobs();
+		lock.lock();
+		if (--active == 0) doneCond.notify_one();
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,74 @@
+#ifndef WORKERPOOL_HH
+#define WORKERPOOL_HH
+
+#include "function_ref.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace openmsx {
+
+/** A small pool of worker threads to execute fork-join style parallel loops.
+  *
+  * The calling thread participates in the work and parallelFor() only
+  * returns once all jobs are finished. So from the point of view of the
+  * caller it behaves like a normal (sequential) loop, only the individual
+  * iterations may run concurrently (and in any order). This makes it
+  * possible to parallelize work on (independent) emulation objects without
+  * any further synchronization with the rest of the emulator: the emulation
+  * thread is blocked while the workers access those objects.
+  */
+class WorkerPool
+{
+public:
+	/** Create a pool with the given number of worker threads (this does
+	  * not include the calling thread). Zero is allowed, then all work is
+	  * executed on the calling thread.
+	  */
+	explicit WorkerPool(unsigned numThreads);
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool(WorkerPool&&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+	WorkerPool& operator=(WorkerPool&&) = delete;
+	~WorkerPool();
+
+	/** Number of worker threads (excluding the calling thread). */
+	[[nodiscard]] unsigned size() const { return unsigned(threads.size()); }
+
+	/** Execute 'job(i)' for all 'i' in the range [0, n). Returns when all
+	  * jobs have finished. The job must not throw.
+	  */
+	void parallelFor(size_t n, function_ref<void(size_t)> job);
+
+	/** A reasonable default for the number of worker threads: one less
+	  * than the number of cores (the calling thread also works), with an
+	  * upper limit.
+	  */
+	[[nodiscard]] static unsigned defaultNumThreads(unsigned maxThreads);
+
+private:
+	void workerLoop();
+	void runJobs();
+
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable startCond; // signals: new job or stop
+	std::condition_variable doneCond;  // signals: 'active' became zero
+
+	// all protected by 'mutex', except 'next' which is atomic
+	function_ref<void(size_t)>* currentJob = nullptr;
+	std::atomic<size_t> next = 0;
+	size_t count = 0;
+	unsigned generation = 0;
+	unsigned active = 0;
+	bool stop = false;
+};
+
+} // namespace openmsx
+
+#endif
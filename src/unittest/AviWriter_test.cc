@@ -0,0 +1,72 @@
+#include "catch.hpp"
+
+#include "AviWriter.hh"
+#include "File.hh"
+#include "FileOperations.hh"
+#include "Filename.hh"
+#include "RawFrame.hh"
+
+#include "endian.hh"
+#include "xrange.hh"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace openmsx;
+
+// Sizes of the '00dc' (video) chunks, from the index at the end of the file.
+static std::vector<uint32_t> videoChunkSizes(const std::string& filename)
+{
+	File file(filename, "rb");
+	auto data = file.mmap<const uint8_t>();
+	std::vector<uint32_t> result;
+	// The index is the last chunk: 'idx1', size, then 16 bytes per entry.
+	for (size_t pos = data.size() - 8; pos > 0; --pos) {
+		if (memcmp(&data[pos], "idx1", 4) != 0) continue;
+		uint32_t size = Endian::read_UA_L32(&data[pos + 4]);
+		if (pos + 8 + size != data.size()) continue;
+		for (size_t e = pos + 8; e < data.size(); e += 16) {
+			if (memcmp(&data[e], "00dc", 4) == 0) {
+				result.push_back(Endian::read_UA_L32(&data[e + 12]));
+			}
+		}
+		break;
+	}
+	return result;
+}
+
+TEST_CASE("AviWriter: frames survive the queue")
+{
+	static constexpr unsigned NUM_FRAMES = 5 * AviWriter::MAX_QUEUED_FRAMES;
+	auto filename = FileOperations::getTempDir() + "/aviwriter_unittest.avi";
+
+	RawFrame frame(320, 240);
+	std::vector<int16_t> audio(735, 0); // 44100Hz / 60Hz, mono
+	unsigned dropped = 0;
+	{
+		AviWriter writer(Filename(filename), 320, 240, 1, 44100);
+		writer.setFps(60.0f);
+		for (auto n : xrange(NUM_FRAMES)) {
+			// a different frame each time
+			for (auto y : xrange(240u)) {
+				auto line = frame.getLineDirect(y);
+				for (auto x : xrange(320u)) {
+					line[x] = RawFrame::Pixel(x * y + n * 12345);
+				}
+				frame.setLineWidth(y, 320);
+			}
+			// Without dropping, the encoder can't keep up (the queue is
+			// bigger than MAX_QUEUED_FRAMES after a few frames).
+			writer.addFrame(&frame, audio, false);
+		}
+		dropped = writer.getDroppedFrames();
+	}
+	CHECK(dropped == 0);
+	auto sizes = videoChunkSizes(filename);
+	CHECK(sizes.size() == NUM_FRAMES);
+	for (auto size : sizes) {
+		CHECK(size != 0); // an empty chunk means a dropped frame
+	}
+	FileOperations::unlink(filename);
+}
@@ -0,0 +1,159 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+
+#include "BitmapConverter.hh"
+
+#include "xrange.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace openmsx;
+using Pixel = BitmapConverter::Pixel;
+
+namespace {
+
+struct Palettes {
+	Palettes()
+	{
+		std::mt19937 rng(1234);
+		std::ranges::generate(p16,    [&] { return Pixel(rng()); });
+		std::ranges::generate(p256,   [&] { return Pixel(rng()); });
+		std::ranges::generate(p32768, [&] { return Pixel(rng()); });
+	}
+	std::array<Pixel, 16 * 2> p16;
+	std::array<Pixel, 256> p256;
+	std::vector<Pixel> p32768 = std::vector<Pixel>(32768);
+
+	[[nodiscard]] BitmapConverter makeConverter() const
+	{
+		return {p16, p256, std::span<const Pixel, 32768>(p32768)};
+	}
+};
+
+[[nodiscard]] DisplayMode makeMode(uint8_t byte)
+{
+	DisplayMode mode;
+	mode.setByte(byte);
+	return mode;
+}
+
+// Straightforward reference implementation, one pixel at a time.
+[[nodiscard]] Pixel refYJK(const Palettes& pal, std::span<const uint8_t, 4> p, unsigned n, bool yae)
+{
+	if (yae && (p[n] & 0x08)) return pal.p16[p[n] >> 4];
+	int j = (p[2] & 7) + ((p[3] & 3) << 3) - ((p[3] & 4) << 3);
+	int k = (p[0] & 7) + ((p[1] & 3) << 3) - ((p[1] & 4) << 3);
+	int y = p[n] >> 3;
+	int r = std::clamp(y + j,                       0, 31);
+	int g = std::clamp(y + k,                       0, 31);
+	int b = std::clamp((5 * y - 2 * j - k + 2) / 4, 0, 31);
+	return pal.p32768[(r << 10) + (g << 5) + b];
+}
+
+[[nodiscard]] std::array<uint8_t, 128> randomLine(std::mt19937& rng)
+{
+	std::array<uint8_t, 128> result;
+	std::ranges::generate(result, [&] { return uint8_t(rng()); });
+	return result;
+}
+
+} // namespace
+
+TEST_CASE("BitmapConverter")
+{
+	Palettes pal;
+	auto converter = pal.makeConverter();
+	std::mt19937 rng(5678);
+	std::vector<Pixel> buf(512);
+
+	for (auto iter : xrange(20)) {
+		auto vram0 = randomLine(rng);
+		auto vram1 = randomLine(rng);
+		// also test the extreme values
+		if (iter == 0) { std::ranges::fill(vram0, 0x00); std::ranges::fill(vram1, 0x00); }
+		if (iter == 1) { std::ranges::fill(vram0, 0xff); std::ranges::fill(vram1, 0xff); }
+
+		{ // Graphic4
+			converter.setDisplayMode(makeMode(DisplayMode::GRAPHIC4));
+			converter.convertLine(buf, vram0);
+			for (auto i : xrange(256)) {
+				auto data = vram0[i / 2];
+				CHECK(buf[i] == pal.p16[(i & 1) ? (data & 15) : (data >> 4)]);
+			}
+		}
+		{ // Graphic5
+			converter.setDisplayMode(makeMode(DisplayMode::GRAPHIC5));
+			converter.convertLine(buf, vram0);
+			for (auto i : xrange(512)) {
+				auto data = vram0[i / 4];
+				auto idx = (data >> (2 * (3 - (i & 3)))) & 3;
+				CHECK(buf[i] == pal.p16[16 * (i & 1) + idx]);
+			}
+		}
+		{ // Graphic6
+			converter.setDisplayMode(makeMode(DisplayMode::GRAPHIC6));
+			converter.convertLinePlanar(buf, vram0, vram1);
+			for (auto i : xrange(512)) {
+				auto data = ((i / 2) & 1) ? vram1[i / 4] : vram0[i / 4];
+				CHECK(buf[i] == pal.p16[(i & 1) ? (data & 15) : (data >> 4)]);
+			}
+		}
+		{ // Graphic7
+			converter.setDisplayMode(makeMode(DisplayMode::GRAPHIC7));
+			converter.convertLinePlanar(buf, vram0, vram1);
+			for (auto i : xrange(256)) {
+				CHECK(buf[i] == pal.p256[(i & 1) ? vram1[i / 2] : vram0[i / 2]]);
+			}
+		}
+		for (bool yae : {false, true}) {
+			{ // YJK or YJK+YAE
+				converter.setDisplayMode(makeMode(
+					DisplayMode::GRAPHIC7 | DisplayMode::YJK | (yae ? DisplayMode::YAE : 0)));
+				converter.convertLinePlanar(buf, vram0, vram1);
+				for (auto i : xrange(64)) {
+					std::array<uint8_t, 4> p = {
+						vram0[2 * i + 0], vram1[2 * i + 0],
+						vram0[2 * i + 1], vram1[2 * i + 1],
+					};
+					for (auto n : xrange(4)) {
+						CHECK(buf[4 * i + n] == refYJK(pal, p, n, yae));
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("BitmapConverter benchmark", "[.][benchmark]")
+{
+	Palettes pal;
+	auto converter = pal.makeConverter();
+	std::mt19937 rng(5678);
+	auto vram0 = randomLine(rng);
+	auto vram1 = randomLine(rng);
+	std::vector<Pixel> buf(512);
+
+	// 212 lines, roughly one frame
+	auto frame = [&](uint8_t mode, bool planar) {
+		converter.setDisplayMode(makeMode(mode));
+		for (auto line : xrange(212)) {
+			(void)line;
+			if (planar) {
+				converter.convertLinePlanar(buf, vram0, vram1);
+			} else {
+				converter.convertLine(buf, vram0);
+			}
+		}
+		return buf[0];
+	};
+	BENCHMARK("Graphic4 (screen 5)")  { return frame(DisplayMode::GRAPHIC4, false); };
+	BENCHMARK("Graphic5 (screen 6)")  { return frame(DisplayMode::GRAPHIC5, false); };
+	BENCHMARK("Graphic6 (screen 7)")  { return frame(DisplayMode::GRAPHIC6, true); };
+	BENCHMARK("Graphic7 (screen 8)")  { return frame(DisplayMode::GRAPHIC7, true); };
+	BENCHMARK("YJK (screen 12)")      { return frame(DisplayMode::GRAPHIC7 | DisplayMode::YJK, true); };
+	BENCHMARK("YJK+YAE (screen 10)")  { return frame(DisplayMode::GRAPHIC7 | DisplayMode::YJK | DisplayMode::YAE, true); };
+}
@@ -0,0 +1,185 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+
+#include "BlipKernels.hh"
+
+#include "xrange.hh"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <span>
+#include <vector>
+
+using namespace openmsx;
+
+namespace {
+
+struct Edge {
+	size_t i;
+	unsigned ch;
+	float delta;
+	bool operator==(const Edge&) const = default;
+};
+
+// Straightforward reference implementations, these are the loops
+// ResampleBlip and BlipBuffer used before.
+template<unsigned CHANNELS>
+[[nodiscard]] std::vector<Edge> refEdges(std::span<const float> buf, std::array<float, CHANNELS>& last)
+{
+	std::vector<Edge> result;
+	size_t num = buf.size() / CHANNELS;
+	for (auto ch : xrange(CHANNELS)) {
+		for (auto i : xrange(num)) {
+			if (auto delta = buf[CHANNELS * i + ch] - last[ch]; delta != 0) {
+				last[ch] = buf[CHANNELS * i + ch];
+				result.push_back({i, ch, delta});
+			}
+		}
+	}
+	return result;
+}
+
+template<size_t PITCH>
+[[nodiscard]] float refIntegrate(float* out, float* in, size_t num, float acc, float factor)
+{
+	for (auto i : xrange(num)) {
+		out[i * PITCH] = acc;
+		acc *= factor;
+		acc += in[i];
+		in[i] = 0.0f;
+	}
+	return acc;
+}
+
+// A square wave (like a PSG channel), optionally with some noise.
+[[nodiscard]] std::vector<float> squareWave(std::mt19937& rng, size_t num, unsigned halfPeriod, bool noise)
+{
+	std::vector<float> result(num);
+	float value = 0.5f;
+	for (auto i : xrange(num)) {
+		if ((i % halfPeriod) == 0) value = -value;
+		result[i] = (noise && (rng() % 7) == 0) ? float(rng() % 16) : value;
+	}
+	return result;
+}
+
+template<unsigned CHANNELS>
+void checkEdges(std::span<const float> buf, std::array<float, CHANNELS> last)
+{
+	auto last2 = last;
+	auto expected = refEdges<CHANNELS>(buf, last);
+
+	std::array<std::vector<Edge>, CHANNELS> perChannel;
+	BlipKernels::forEachEdge<CHANNELS>(buf, std::span<float, CHANNELS>(last2),
+		[&](size_t i, unsigned ch, float delta) {
+			perChannel[ch].push_back({i, ch, delta});
+		});
+	std::vector<Edge> result;
+	for (const auto& v : perChannel) result.insert(result.end(), v.begin(), v.end());
+
+	CHECK(result == expected);
+	CHECK(last2 == last);
+}
+
+} // namespace
+
+TEST_CASE("BlipKernels::forEachEdge")
+{
+	std::mt19937 rng(1234);
+	for (auto num : {0, 1, 2, 3, 4, 5, 15, 16, 17, 31, 100, 1000}) {
+		for (unsigned halfPeriod : {1, 3, 16, 50}) {
+			for (bool noise : {false, true}) {
+				auto mono = squareWave(rng, num, halfPeriod, noise);
+				checkEdges<1>(mono, {0.0f});
+				checkEdges<1>(mono, {0.5f});
+				auto stereo = squareWave(rng, 2 * num, halfPeriod, noise);
+				checkEdges<2>(stereo, {0.0f, 0.0f});
+				checkEdges<2>(stereo, {-0.5f, 3.0f});
+			}
+		}
+	}
+}
+
+TEST_CASE("BlipKernels::integrate")
+{
+	std::mt19937 rng(5678);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	constexpr float factor = 511.0f / 512.0f;
+	for (auto num : {0, 1, 3, 4, 5, 8, 100, 1023}) {
+		std::vector<float> in1(num);
+		for (auto& x : in1) x = (rng() % 3) ? 0.0f : dist(rng);
+		auto in2 = in1;
+		float acc = dist(rng);
+
+		std::vector<float> out1(2 * num, 9.0f), out2(2 * num, 9.0f);
+		auto acc1 = refIntegrate<2>(out1.data(), in1.data(), num, acc, factor);
+		auto acc2 = BlipKernels::integrate<2>(out2.data(), in2.data(), num, acc, factor);
+		CHECK(std::abs(acc1 - acc2) < 1e-4f);
+		for (auto i : xrange(num)) {
+			CHECK(std::abs(out1[2 * i] - out2[2 * i]) < 1e-4f);
+			CHECK(out2[2 * i + 1] == 9.0f); // other channel untouched
+			CHECK(in2[i] == 0.0f);
+		}
+
+		std::vector<float> in3(num);
+		for (auto& x : in3) x = dist(rng);
+		auto in4 = in3;
+		std::vector<float> out3(num), out4(num);
+		acc1 = refIntegrate<1>(out3.data(), in3.data(), num, acc, factor);
+		acc2 = BlipKernels::integrate<1>(out4.data(), in4.data(), num, acc, factor);
+		CHECK(std::abs(acc1 - acc2) < 1e-4f);
+		for (auto i : xrange(num)) {
+			CHECK(std::abs(out3[i] - out4[i]) < 1e-4f);
+		}
+	}
+}
+
+TEST_CASE("BlipKernels benchmark", "[.][benchmark]")
+{
+	// PSG: ~5200 input samples per fragment of 1024 output samples, a
+	// square wave of ~440Hz has an edge every ~250 samples.
+	std::mt19937 rng(1234);
+	auto psg = squareWave(rng, 5200, 250, false);
+	auto noisy = squareWave(rng, 5200, 250, true);
+
+	BENCHMARK("edges: reference, square wave") {
+		std::array<float, 1> last = {0.0f};
+		return refEdges<1>(psg, last).size();
+	};
+	BENCHMARK("edges: square wave") {
+		std::array<float, 1> last = {0.0f};
+		std::vector<Edge> result;
+		BlipKernels::forEachEdge<1>(psg, std::span<float, 1>(last),
+			[&](size_t i, unsigned ch, float delta) { result.push_back({i, ch, delta}); });
+		return result.size();
+	};
+	BENCHMARK("edges: reference, noise") {
+		std::array<float, 1> last = {0.0f};
+		return refEdges<1>(noisy, last).size();
+	};
+	BENCHMARK("edges: noise") {
+		std::array<float, 1> last = {0.0f};
+		std::vector<Edge> result;
+		BlipKernels::forEachEdge<1>(noisy, std::span<float, 1>(last),
+			[&](size_t i, unsigned ch, float delta) { result.push_back({i, ch, delta}); });
+		return result.size();
+	};
+
+	constexpr float factor = 511.0f / 512.0f;
+	std::vector<float> in(1024, 0.0f);
+	std::vector<float> out(2 * 1024);
+	BENCHMARK("integrate: reference, 1024 samples") {
+		return refIntegrate<1>(out.data(), in.data(), 1024, 0.25f, factor);
+	};
+	BENCHMARK("integrate: 1024 samples") {
+		return BlipKernels::integrate<1>(out.data(), in.data(), 1024, 0.25f, factor);
+	};
+	BENCHMARK("integrate: reference, 1024 samples, stereo") {
+		return refIntegrate<2>(out.data(), in.data(), 1024, 0.25f, factor);
+	};
+	BENCHMARK("integrate: 1024 samples, stereo") {
+		return BlipKernels::integrate<2>(out.data(), in.data(), 1024, 0.25f, factor);
+	};
+}
@@ -0,0 +1,205 @@
+#include "catch.hpp"
+
+#include "DeltaBlock.hh"
+#include "ReverseMemoryUsage.hh"
+#include "SpillFile.hh"
+
+#include "xrange.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+using namespace openmsx;
+
+static void check(const DeltaBlock& block, const std::vector<uint8_t>& expected)
+{
+	std::vector<uint8_t> buf(expected.size());
+	block.apply(buf);
+	CHECK(buf == expected);
+}
+
+TEST_CASE("DeltaBlock")
+{
+	static constexpr size_t SIZE = 10000;
+	std::vector<uint8_t> data(SIZE);
+	for (auto i : xrange(SIZE)) data[i] = uint8_t(i * 7);
+
+	LastDeltaBlocks lastBlocks;
+	const void* id = &data;
+
+	std::vector<std::shared_ptr<DeltaBlock>> blocks;
+	std::vector<std::vector<uint8_t>> snapshots;
+	for (auto n : xrange(50)) {
+		// a few small changes per snapshot
+		data[(n * 37) % SIZE] ^= 0x55;
+		data[(n * 101) % SIZE] += 1;
+		if (n % 10 == 0) {
+			for (auto i : xrange(SIZE / 2)) data[i] ^= uint8_t(n);
+		}
+		blocks.push_back(lastBlocks.createNew(id, data));
+		snapshots.push_back(data);
+	}
+	// an unchanged snapshot reuses the last block
+	blocks.push_back(lastBlocks.createNullDiff(id, data));
+	snapshots.push_back(data);
+	CHECK(blocks[blocks.size() - 1] == blocks[blocks.size() - 2]);
+
+	// read back, possibly while the worker is still busy
+	for (auto i : xrange(blocks.size())) {
+		check(*blocks[i], snapshots[i]);
+	}
+
+	// also after all blocks are compressed
+	lastBlocks.clear();
+	DeltaBlock::waitAllReady();
+	for (auto i : xrange(blocks.size())) {
+		check(*blocks[i], snapshots[i]);
+	}
+
+	// memory usage reflects the compression
+	CHECK(blocks[0]->getReference() == nullptr);
+	CHECK(blocks[0]->getSize() == SIZE);
+	CHECK(blocks[0]->getMemorySize() < SIZE);
+	CHECK(blocks[1]->getReference() == blocks[0].get());
+	CHECK(blocks[1]->getSize() == SIZE);
+	CHECK(blocks[1]->getMemorySize() < 100);
+
+	// blocks can be dropped while the worker still references them
+	blocks.clear();
+	for (auto n : xrange(20)) {
+		data[n] = uint8_t(n);
+		(void)lastBlocks.createNew(id, data);
+	}
+	DeltaBlock::waitAllReady();
+}
+
+TEST_CASE("SpillFile")
+{
+	std::vector<uint8_t> data(300);
+	for (auto i : xrange(data.size())) data[i] = uint8_t(i);
+	auto part = [&](size_t n) { return std::span{data.data(), n}; };
+
+	SpillFile file;
+	auto o1 = file.store(part(100));
+	auto o2 = file.store(part(200));
+	auto o3 = file.store(part(300));
+	CHECK(o1 == 0);
+	CHECK(o2 == 100);
+	CHECK(o3 == 300);
+	CHECK(file.getSize() == 600);
+	CHECK(std::ranges::equal(file.read(o2, 200), part(200)));
+
+	// freed space is reused, adjacent free ranges are merged
+	file.free(o1, 100);
+	file.free(o2, 200);
+	CHECK(file.getSize() == 300);
+	auto o4 = file.store(part(250));
+	CHECK(o4 == 0);
+	CHECK(std::ranges::equal(file.read(o4, 250), part(250))); // overwritten
+	CHECK(std::ranges::equal(file.read(o3, 300), part(300)));
+
+	// freeing the tail makes the file 'shrink'
+	file.free(o3, 300);
+	auto o5 = file.store(part(10));
+	CHECK(o5 == 250);
+	CHECK(file.getFileSize() == 600);
+	file.free(o4, 250);
+	file.free(o5, 10);
+	CHECK(file.getSize() == 0);
+	CHECK(file.store(part(1)) == 0);
+	file.free(0, 1);
+}
+
+TEST_CASE("DeltaBlockSpilled")
+{
+	static constexpr size_t SIZE = 5000;
+	std::vector<uint8_t> data1(SIZE);
+	std::vector<uint8_t> data2(SIZE);
+	for (auto i : xrange(SIZE)) {
+		data1[i] = uint8_t(i / 16); // compressible
+		data2[i] = uint8_t((i * 2654435761u) >> 13); // not compressible
+	}
+
+	LastDeltaBlocks lastBlocks;
+	std::vector<std::shared_ptr<DeltaBlock>> snapshot1 = {
+		lastBlocks.createNew(&data1, data1),
+		lastBlocks.createNew(&data2, data2),
+	};
+	data1[100] = 42;
+	std::vector<std::shared_ptr<DeltaBlock>> snapshot2 = {
+		lastBlocks.createNew(&data1, data1), // a diff block
+		lastBlocks.createNullDiff(&data2, data2), // shared with snapshot1
+	};
+	auto block3 = snapshot2[0];
+	REQUIRE(block3->getReference() == snapshot1[0].get());
+
+	SpilledDeltaBlocks spilled;
+	spilled.spill(snapshot1);
+	spilled.spill(snapshot2);
+	// the diff block is spilled as a diff against the spilled reference
+	CHECK(snapshot2[0]->getReference() == snapshot1[0].get());
+	CHECK(snapshot2[1] == snapshot1[1]);
+	DeltaBlock::waitAllReady();
+	CHECK(snapshot1[0]->getMemorySize() == 0);
+	CHECK(snapshot2[0]->getMemorySize() == 0);
+	CHECK(spilled.getSize() < SIZE + SIZE / 2);
+
+	// The spilled blocks don't need the originals. Except the original
+	// reference block, which is still used by the last (unspilled) block.
+	block3.reset();
+	lastBlocks.clear();
+	DeltaBlock::waitAllReady();
+	check(*snapshot1[1], data2);
+	check(*snapshot2[0], data1);
+	data1[100] = uint8_t(100 / 16);
+	check(*snapshot1[0], data1);
+
+	// dropping snapshots frees the space in the file
+	snapshot2.clear();
+	auto size1 = spilled.getSize();
+	CHECK(size1 != 0);
+	snapshot1.clear();
+	CHECK(spilled.getSize() == 0);
+}
+
+TEST_CASE("ReverseMemoryUsage")
+{
+	static constexpr size_t SIZE = 100000;
+	std::vector<uint8_t> data(SIZE);
+	for (auto i : xrange(SIZE)) data[i] = uint8_t(i / 64); // compressible
+
+	LastDeltaBlocks lastBlocks;
+	MemBuffer<uint8_t> savestate(100);
+	std::vector<std::vector<std::shared_ptr<DeltaBlock>>> snapshots;
+	for (auto n : xrange(10)) {
+		data[n * 1000] ^= 0xff;
+		snapshots.push_back({lastBlocks.createNew(&data, data)});
+	}
+	lastBlocks.clear(); // also compress the reference block
+
+	// possibly while the blocks are still being processed
+	ReverseMemoryUsage usage;
+	for (const auto& blocks : snapshots) usage.add(savestate, blocks);
+	auto before = usage.getTotal();
+
+	DeltaBlock::waitAllReady();
+	usage.refresh();
+	size_t expected = 0;
+	for (const auto& blocks : snapshots) {
+		expected += savestate.size() + blocks[0]->getMemorySize();
+	}
+	CHECK(usage.getTotal() == expected);
+	CHECK(usage.getTotal() <= before);
+	CHECK(usage.getUncompressed() == 10 * (savestate.size() + SIZE));
+	// a budget of a single uncompressed block is enough for all snapshots
+	CHECK(usage.getTotal() < SIZE);
+
+	// the first block is the reference of all others
+	auto exclusive = usage.exclusive(savestate, snapshots[5]);
+	CHECK(exclusive == savestate.size() + snapshots[5][0]->getMemorySize());
+	CHECK(usage.remove(savestate, snapshots[5]) == exclusive);
+	CHECK(usage.exclusive(savestate, snapshots[0]) == savestate.size());
+}
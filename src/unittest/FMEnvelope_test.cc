@@ -0,0 +1,187 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+
+#include "FMEnvelope.hh"
+
+#include "xrange.hh"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <span>
+
+using namespace openmsx;
+
+namespace {
+
+[[nodiscard]] uint64_t refDueSlots(std::span<const uint32_t> masks, uint32_t egCnt)
+{
+	uint64_t result = 0;
+	for (auto i : xrange(masks.size())) {
+		if (!(egCnt & masks[i])) result |= uint64_t(1) << i;
+	}
+	return result;
+}
+
+// A simplified OPL-style envelope generator: attack, decay and release
+// with a rate-dependent mask, like in YMF262.
+struct Slot {
+	enum State : uint8_t { ATTACK, DECAY, RELEASE, OFF };
+
+	int volume = 511;
+	uint32_t mAr, mDr, mRr;
+	State state = OFF;
+
+	[[nodiscard]] uint32_t envelopeMask() const {
+		switch (state) {
+		case ATTACK:  return mAr;
+		case DECAY:   return mDr;
+		case RELEASE: return mRr;
+		default:      return FMEnvelope::IDLE;
+		}
+	}
+	void advanceEnvelopeGenerator(uint32_t egCnt) {
+		switch (state) {
+		case ATTACK:
+			if (!(egCnt & mAr)) {
+				volume += (~volume * int(1 + ((egCnt >> 3) & 3))) >> 3;
+				if (volume <= 0) { volume = 0; state = DECAY; }
+			}
+			break;
+		case DECAY:
+			if (!(egCnt & mDr)) {
+				volume += 1 + int((egCnt >> 5) & 1);
+				if (volume >= 300) state = RELEASE;
+			}
+			break;
+		case RELEASE:
+			if (!(egCnt & mRr)) {
+				volume += 2;
+				if (volume >= 511) { volume = 511; state = OFF; }
+			}
+			break;
+		default:
+			break;
+		}
+	}
+};
+
+template<size_t N>
+[[nodiscard]] std::array<Slot, N> randomSlots(std::mt19937& rng)
+{
+	auto mask = [&] { return (uint32_t(1) << (rng() % 13)) - 1; };
+	std::array<Slot, N> result;
+	for (auto& s : result) {
+		s.mAr = mask();
+		s.mDr = mask();
+		s.mRr = mask();
+	}
+	return result;
+}
+
+template<size_t N>
+void keyOn(std::array<Slot, N>& slots, std::mt19937& rng)
+{
+	for (auto& s : slots) {
+		if (rng() & 1) s.state = Slot::ATTACK;
+	}
+}
+
+// the way YMF262 did it before: step all slots on every sample
+template<size_t N>
+void advanceAll(std::array<Slot, N>& slots, uint32_t egCnt)
+{
+	for (auto& s : slots) s.advanceEnvelopeGenerator(egCnt);
+}
+
+template<size_t N>
+void advanceDue(std::array<Slot, N>& slots, std::array<uint32_t, N>& masks, uint32_t egCnt)
+{
+	for (auto due = FMEnvelope::dueSlots(std::span<const uint32_t, N>(masks), egCnt);
+	     due; due &= due - 1) {
+		auto i = std::countr_zero(due);
+		slots[i].advanceEnvelopeGenerator(egCnt);
+		masks[i] = slots[i].envelopeMask();
+	}
+}
+
+template<size_t N>
+void checkSameOutput(uint32_t egCnt)
+{
+	std::mt19937 rng(1234);
+	auto slots1 = randomSlots<N>(rng);
+	auto slots2 = slots1;
+	std::array<uint32_t, N> masks;
+	for (auto block : xrange(50)) {
+		// key-on between blocks (like register writes between calls
+		// to generateChannels())
+		std::mt19937 rng2(block);
+		keyOn(slots1, rng2);
+		std::mt19937 rng3(block);
+		keyOn(slots2, rng3);
+		for (auto i : xrange(N)) masks[i] = slots2[i].envelopeMask();
+
+		for (auto sample : xrange(2000)) {
+			(void)sample;
+			++egCnt;
+			advanceAll(slots1, egCnt);
+			advanceDue(slots2, masks, egCnt);
+		}
+		for (auto i : xrange(N)) {
+			CHECK(slots1[i].volume == slots2[i].volume);
+			CHECK(slots1[i].state  == slots2[i].state);
+		}
+	}
+}
+
+} // namespace
+
+TEST_CASE("FMEnvelope::dueSlots")
+{
+	std::mt19937 rng(5678);
+	std::array<uint32_t, 64> masks;
+	for (auto iter : xrange(1000)) {
+		for (auto& m : masks) {
+			m = (iter & 1) ? uint32_t(rng())
+			               : (uint32_t(1) << (rng() % 16)) - 1;
+		}
+		masks[rng() % 64] = FMEnvelope::IDLE;
+		for (auto egCnt : {uint32_t(0), uint32_t(1), uint32_t(rng()), uint32_t(rng() << 12), uint32_t(0xFFFFFFFF)}) {
+			std::span<const uint32_t, 64> all{masks};
+			CHECK(FMEnvelope::dueSlots(all, egCnt) == refDueSlots(all, egCnt));
+			CHECK(FMEnvelope::dueSlots(all.first<36>(), egCnt) == refDueSlots(all.first(36), egCnt));
+			CHECK(FMEnvelope::dueSlots(all.first<7>(), egCnt) == refDueSlots(all.first(7), egCnt));
+		}
+	}
+}
+
+TEST_CASE("FMEnvelope: stepping only the due slots gives the same envelopes")
+{
+	checkSameOutput<36>(0);
+	checkSameOutput<36>(0xFFFFFFFF - 30000); // egCnt wraps around
+	checkSameOutput<18>(12345);
+}
+
+TEST_CASE("FMEnvelope benchmark", "[.][benchmark]")
+{
+	// 36 slots (OPL3), typical rates: a step every 16 to 4096 samples
+	std::mt19937 rng(1234);
+	auto slots = randomSlots<36>(rng);
+	keyOn(slots, rng);
+	std::array<uint32_t, 36> masks;
+	for (auto i : xrange(36)) masks[i] = slots[i].envelopeMask();
+	uint32_t egCnt = 0;
+
+	BENCHMARK("all slots, 1000 samples") {
+		auto s = slots;
+		for (auto j : xrange(1000)) advanceAll(s, egCnt + j);
+		return s[0].volume;
+	};
+	BENCHMARK("due slots, 1000 samples") {
+		auto s = slots;
+		auto m = masks;
+		for (auto j : xrange(1000)) advanceDue(s, m, egCnt + j);
+		return s[0].volume;
+	};
+}
@@ -0,0 +1,97 @@
+#include "catch.hpp"
+
+#include "FrameTelemetry.hh"
+
+#include "xrange.hh"
+
+using namespace openmsx;
+
+TEST_CASE("FrameTelemetry: frame durations")
+{
+	FrameTelemetry telemetry;
+	CHECK(telemetry.getFrames().empty());
+
+	// first frame: no previous frame, so no emulation time yet
+	telemetry.frameEnd(1000, 3000, 4000, 50.0f, 1.5f);
+	auto frames = telemetry.getFrames();
+	REQUIRE(frames.size() == 1);
+	CHECK(frames[0].time == 4000);
+	CHECK(frames[0].interval == Approx(3.0f));
+	CHECK(frames[0].emulation == 0.0f);
+	CHECK(frames[0].render == Approx(2.0f));
+	CHECK(frames[0].present == Approx(1.0f));
+	CHECK(frames[0].audioBuffer == 50.0f);
+	CHECK(frames[0].syncDrift == 1.5f);
+	CHECK(frames[0].skipped == 0);
+
+	// 20ms later, of which 12ms sleeping, 2 skipped frames
+	telemetry.addSleep(10000);
+	telemetry.frameSkipped();
+	telemetry.addSleep(2000);
+	telemetry.frameSkipped();
+	telemetry.frameEnd(20000, 22000, 24000, 40.0f, -0.5f);
+	frames = telemetry.getFrames();
+	REQUIRE(frames.size() == 2);
+	CHECK(frames[1].interval == Approx(20.0f));
+	CHECK(frames[1].sleep == Approx(12.0f));
+	CHECK(frames[1].emulation == Approx(4.0f)); // 24 - 4 - 12 - 2 - 2
+	CHECK(frames[1].render == Approx(2.0f));
+	CHECK(frames[1].present == Approx(2.0f));
+	CHECK(frames[1].skipped == 2);
+
+	// sleep and skip counters were reset, sleep is at most the busy time
+	telemetry.addSleep(100000);
+	telemetry.frameEnd(30000, 30000, 30000, 0.0f, 0.0f);
+	frames = telemetry.getFrames();
+	REQUIRE(frames.size() == 3);
+	CHECK(frames[2].skipped == 0);
+	CHECK(frames[2].sleep == Approx(6.0f));
+	CHECK(frames[2].emulation == 0.0f);
+
+	telemetry.clear();
+	CHECK(telemetry.getFrames().empty());
+}
+
+TEST_CASE("FrameTelemetry: ring buffer")
+{
+	FrameTelemetry telemetry;
+	auto total = FrameTelemetry::CAPACITY + 10;
+	for (auto i : xrange(total)) {
+		auto t = 1000 * (i + 1);
+		telemetry.frameEnd(t, t, t, float(i), 0.0f);
+	}
+	auto frames = telemetry.getFrames();
+	REQUIRE(frames.size() == FrameTelemetry::CAPACITY);
+	// oldest first, the first 10 are dropped
+	CHECK(frames.front().audioBuffer == 10.0f);
+	CHECK(frames.back().audioBuffer == float(total - 1));
+
+	auto last = telemetry.getFrames(3);
+	REQUIRE(last.size() == 3);
+	CHECK(last[0].audioBuffer == float(total - 3));
+	CHECK(last[2].audioBuffer == float(total - 1));
+	CHECK(telemetry.getFrames(0).empty());
+}
+
+TEST_CASE("FrameTelemetry: summarize")
+{
+	auto empty = FrameTelemetry::summarize({});
+	CHECK(empty.frames == 0);
+	CHECK(empty.skipped == 0);
+
+	std::vector<FrameTelemetry::Frame> frames = {
+		{.interval = 20.0f, .syncDrift = -1.0f, .skipped = 1},
+		{.interval = 10.0f, .syncDrift =  2.0f, .skipped = 0},
+		{.interval = 30.0f, .syncDrift =  2.0f, .skipped = 3},
+	};
+	auto summary = FrameTelemetry::summarize(frames);
+	CHECK(summary.frames == 3);
+	CHECK(summary.skipped == 4);
+	CHECK(summary.interval.min == 10.0f);
+	CHECK(summary.interval.avg == Approx(20.0f));
+	CHECK(summary.interval.max == 30.0f);
+	CHECK(summary.syncDrift.min == -1.0f);
+	CHECK(summary.syncDrift.avg == Approx(1.0f));
+	CHECK(summary.syncDrift.max == 2.0f);
+	CHECK(summary.render.max == 0.0f);
+}
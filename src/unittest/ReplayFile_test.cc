@@ -0,0 +1,122 @@
+#include "catch.hpp"
+
+#include "ReplayFile.hh"
+#include "File.hh"
+#include "FileOperations.hh"
+#include "MSXException.hh"
+
+#include "xrange.hh"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+using namespace openmsx;
+
+static std::vector<uint8_t> makeData(size_t size, uint8_t seed)
+{
+	std::vector<uint8_t> result(size);
+	for (auto i : xrange(size)) result[i] = uint8_t(seed + i / 7);
+	return result;
+}
+
+static bool equal(const MemBuffer<uint8_t>& buf, const std::vector<uint8_t>& expected)
+{
+	return std::ranges::equal(std::span{buf}, expected);
+}
+
+TEST_CASE("ReplayFile")
+{
+	auto filename = FileOperations::getTempDir() + "/replayfile_unittest.omr";
+
+	auto index = makeData(100, 1);
+	auto state1 = makeData(5000, 2);
+	auto state2 = makeData(7000, 3);
+	auto time1 = EmuTime::zero() + EmuDuration::sec(1.0);
+	auto time2 = EmuTime::zero() + EmuDuration::sec(2.0);
+
+	ReplayFile::Keyframe key1, key2;
+	{
+		ReplayFile::Writer writer(filename);
+		key1 = writer.addKeyframe(time1, state1);
+		key2 = writer.addKeyframe(time2, state2);
+		writer.finish(index);
+	}
+	CHECK(key1.time == time1);
+	CHECK(key2.time == time2);
+	CHECK(key1.size == state1.size());
+	CHECK(key2.offset == key1.offset + key1.compressedSize);
+
+	REQUIRE(ReplayFile::isReplayFile(filename));
+	{
+		ReplayFile file(filename);
+		CHECK(equal(file.loadIndex(), index));
+		// keyframes can be loaded in any order
+		CHECK(equal(file.loadKeyframe(key2), state2));
+		CHECK(equal(file.loadKeyframe(key1), state1));
+
+		auto bad = key1;
+		bad.offset = 0;
+		CHECK_THROWS_AS(file.loadKeyframe(bad), MSXException);
+	}
+
+	// truncated file
+	{
+		File file(filename, "rb+");
+		file.truncate(file.getSize() - 1);
+	}
+	CHECK_THROWS_AS(ReplayFile(filename), MSXException);
+
+	FileOperations::unlink(filename);
+	CHECK(!ReplayFile::isReplayFile(filename));
+}
+
+TEST_CASE("ReplayFile: overwrite while reading")
+{
+	auto filename = FileOperations::getTempDir() + "/replayfile_unittest2.omr";
+
+	auto index = makeData(100, 1);
+	auto state1 = makeData(5000, 2);
+	auto state2 = makeData(7000, 3);
+	auto time1 = EmuTime::zero() + EmuDuration::sec(1.0);
+	auto time2 = EmuTime::zero() + EmuDuration::sec(2.0);
+	ReplayFile::Keyframe key1, key2;
+	{
+		ReplayFile::Writer writer(filename);
+		key1 = writer.addKeyframe(time1, state1);
+		key2 = writer.addKeyframe(time2, state2);
+		writer.finish(index);
+	}
+
+	// An unfinished writer leaves the original file untouched.
+	{
+		ReplayFile::Writer writer(filename);
+		(void)writer.addKeyframe(time1, state2);
+	}
+	CHECK(!FileOperations::exists(filename + ".tmp"));
+
+	// Save a loaded replay back to itself, keyframes are read lazily
+	// (like ReverseManager does), after the writer was created. (The
+	// reader is closed before finish(), Windows can't replace open files.)
+	{
+		ReplayFile::Writer writer(filename);
+		auto file = std::make_unique<ReplayFile>(filename);
+		auto newKey2 = writer.addKeyframe(time2, file->loadKeyframe(key2));
+		auto newKey1 = writer.addKeyframe(time1, file->loadKeyframe(key1));
+		auto oldIndex = file->loadIndex();
+		file.reset();
+		writer.finish(oldIndex);
+		CHECK(newKey2.offset == key1.offset);
+		key1 = newKey1;
+		key2 = newKey2;
+	}
+	{
+		ReplayFile file(filename);
+		CHECK(equal(file.loadIndex(), index));
+		CHECK(equal(file.loadKeyframe(key1), state1));
+		CHECK(equal(file.loadKeyframe(key2), state2));
+	}
+
+	FileOperations::unlink(filename);
+}
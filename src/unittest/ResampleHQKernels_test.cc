@@ -0,0 +1,163 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+
+#include "ResampleHQKernels.hh"
+
+#include "xrange.hh"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace openmsx;
+
+namespace {
+
+// Input frames and (one row of) filter coefficients. The row is placed in
+// the middle of the table, so that it can be traversed in both directions.
+struct Data {
+	Data(size_t len_, unsigned channels, std::mt19937& rng)
+		: len(len_), buf(channels * len), table(3 * len)
+	{
+		std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+		for (auto& b : buf) b = dist(rng);
+		for (auto& t : table) t = dist(rng);
+	}
+	[[nodiscard]] const float* tab(bool reverse) const {
+		return &table[reverse ? 2 * len : len];
+	}
+
+	size_t len;
+	std::vector<float> buf;
+	std::vector<float> table;
+};
+
+[[nodiscard]] double reference(const Data& d, unsigned channels, unsigned ch, bool reverse)
+{
+	const float* tab = d.tab(reverse);
+	double result = 0.0;
+	for (auto i : xrange(ptrdiff_t(d.len))) {
+		double t = reverse ? tab[-i - 1] : tab[i];
+		result += t * d.buf[channels * i + ch];
+	}
+	return result;
+}
+
+template<unsigned CHANNELS, bool REVERSE, typename Kernel>
+void check(Kernel kernel)
+{
+	std::mt19937 rng(1234);
+	for (size_t len = 8; len <= 400; len += 4) {
+		Data d(len, CHANNELS, rng);
+		std::array<float, CHANNELS> out;
+		kernel(d.buf.data(), d.tab(REVERSE), len, out.data());
+		for (auto ch : xrange(CHANNELS)) {
+			CHECK(out[ch] == Approx(reference(d, CHANNELS, ch, REVERSE)).margin(1e-4));
+		}
+	}
+}
+
+template<unsigned CHANNELS, bool REVERSE>
+void checkAll()
+{
+	check<CHANNELS, REVERSE>(ResampleHQKernels::calcScalar<CHANNELS, REVERSE>);
+	check<CHANNELS, REVERSE>(ResampleHQKernels::calc<CHANNELS, REVERSE>);
+#ifdef __SSE2__
+	if constexpr (CHANNELS == 1) {
+		check<CHANNELS, REVERSE>(ResampleHQKernels::calcSseMono<REVERSE>);
+	} else {
+		check<CHANNELS, REVERSE>(ResampleHQKernels::calcSseStereo<REVERSE>);
+	}
+#endif
+#ifdef RESAMPLEHQ_AVX2
+	if (ResampleHQKernels::hasAvx2()) {
+		if constexpr (CHANNELS == 1) {
+			check<CHANNELS, REVERSE>(ResampleHQKernels::calcAvx2Mono<REVERSE>);
+		} else {
+			check<CHANNELS, REVERSE>(ResampleHQKernels::calcAvx2Stereo<REVERSE>);
+		}
+	}
+#endif
+}
+
+// The filter length ResampleHQ uses for a given ratio (input / output
+// sample rate), see ResampleCoeffs::calcTable().
+[[nodiscard]] size_t filterLength(double ratio)
+{
+	auto len = size_t(std::ceil(2.0 * 2462.0 * std::max(ratio, 1.0) / 128.0)) + 2;
+	return (len + 3) & ~size_t(3);
+}
+
+template<unsigned CHANNELS, typename Kernel>
+void benchmark(const std::string& name, Kernel kernel)
+{
+	// typical input rates, resampled to 44100Hz
+	static constexpr std::array<std::pair<const char*, double>, 4> rates = {{
+		{"YM2413 49716Hz", 3579545.0 / 72},
+		{"SCC 111861Hz", 3579545.0 / 32},
+		{"PSG 223722Hz", 3579545.0 / 16},
+		{"MoonSound 44100Hz", 44100.0},
+	}};
+	std::mt19937 rng(1234);
+	for (const auto& [rateName, rate] : rates) {
+		auto len = filterLength(rate / 44100.0);
+		Data d(len, CHANNELS, rng);
+		BENCHMARK(name + ", " + rateName + ", 1024 samples") {
+			std::array<float, CHANNELS> out;
+			float sum = 0.0f;
+			for (auto i : xrange(1024)) {
+				kernel(d.buf.data(), d.tab(i & 1), len, out.data());
+				sum += out[0];
+			}
+			return sum;
+		};
+	}
+}
+
+template<unsigned CHANNELS>
+void benchmarkAll()
+{
+	auto ch = (CHANNELS == 1) ? std::string("mono") : std::string("stereo");
+	benchmark<CHANNELS>("scalar " + ch, [](const float* buf, const float* tab, size_t len, float* out) {
+		ResampleHQKernels::calcScalar<CHANNELS, false>(buf, tab, len, out);
+	});
+#ifdef __SSE2__
+	benchmark<CHANNELS>("SSE2 " + ch, [](const float* buf, const float* tab, size_t len, float* out) {
+		if constexpr (CHANNELS == 1) {
+			ResampleHQKernels::calcSseMono<false>(buf, tab, len, out);
+		} else {
+			ResampleHQKernels::calcSseStereo<false>(buf, tab, len, out);
+		}
+	});
+#endif
+#ifdef RESAMPLEHQ_AVX2
+	if (ResampleHQKernels::hasAvx2()) {
+		benchmark<CHANNELS>("AVX2 " + ch, [](const float* buf, const float* tab, size_t len, float* out) {
+			if constexpr (CHANNELS == 1) {
+				ResampleHQKernels::calcAvx2Mono<false>(buf, tab, len, out);
+			} else {
+				ResampleHQKernels::calcAvx2Stereo<false>(buf, tab, len, out);
+			}
+		});
+	}
+#endif
+}
+
+} // namespace
+
+TEST_CASE("ResampleHQKernels")
+{
+	checkAll<1, false>();
+	checkAll<1, true>();
+	checkAll<2, false>();
+	checkAll<2, true>();
+}
+
+TEST_CASE("ResampleHQKernels benchmark", "[.][benchmark]")
+{
+	benchmarkAll<1>();
+	benchmarkAll<2>();
+}
@@ -0,0 +1,104 @@
+#include "catch.hpp"
+
+#include "SPSCRingBuffer.hh"
+
+#include "xrange.hh"
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <thread>
+#include <vector>
+
+using namespace openmsx;
+
+TEST_CASE("SPSCRingBuffer: single items")
+{
+	SPSCRingBuffer<int, 4> rb;
+	CHECK(rb.isEmpty());
+	CHECK(rb.capacity() == 3);
+	CHECK(rb.tryPush(1));
+	CHECK(rb.tryPush(2));
+	CHECK(rb.tryPush(3));
+	CHECK(!rb.tryPush(4)); // full
+	CHECK(rb.size() == 3);
+
+	int i = 0;
+	CHECK(rb.tryPop(i)); CHECK(i == 1);
+	CHECK(rb.tryPop(i)); CHECK(i == 2);
+	CHECK(rb.tryPop(i)); CHECK(i == 3);
+	CHECK(!rb.tryPop(i)); // empty
+	CHECK(rb.isEmpty());
+}
+
+TEST_CASE("SPSCRingBuffer: pushSome/popSome")
+{
+	SPSCRingBuffer<int, 8> rb;
+	std::array<int, 10> in = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+	std::array<int, 10> out = {};
+
+	// only 7 fit
+	CHECK(rb.pushSome(in) == 7);
+	CHECK(rb.size() == 7);
+	CHECK(rb.pushSome(in) == 0);
+
+	CHECK(rb.popSome(std::span{out}.first(5)) == 5);
+	CHECK(std::ranges::equal(std::span{out}.first(5), std::span{in}.first(5)));
+	CHECK(rb.size() == 2);
+
+	// wraps around the end of the buffer
+	CHECK(rb.pushSome(std::span{in}.subspan(7)) == 3);
+	CHECK(rb.size() == 5);
+	CHECK(rb.popSome(out) == 5);
+	CHECK(std::ranges::equal(std::span{out}.first(5), std::span{in}.subspan(5, 5)));
+	CHECK(rb.isEmpty());
+	CHECK(rb.popSome(out) == 0);
+
+	// mixed with single items
+	CHECK(rb.tryPush(42));
+	CHECK(rb.pushSome(std::span{in}.first(3)) == 3);
+	CHECK(rb.popSome(out) == 4);
+	CHECK(out[0] == 42);
+	CHECK(out[1] == 0);
+	CHECK(out[3] == 2);
+
+	CHECK(rb.pushSome(in) == 7);
+	rb.clear();
+	CHECK(rb.isEmpty());
+	CHECK(rb.size() == 0);
+}
+
+TEST_CASE("SPSCRingBuffer: producer and consumer thread")
+{
+	SPSCRingBuffer<unsigned, 101> rb;
+	static constexpr unsigned TOTAL = 200000;
+
+	std::thread producer([&] {
+		std::vector<unsigned> chunk;
+		unsigned next = 0;
+		while (next < TOTAL) {
+			chunk.clear();
+			for (auto i : xrange(1 + next % 37)) {
+				if ((next + i) < TOTAL) chunk.push_back(next + i);
+			}
+			std::span<const unsigned> todo{chunk};
+			while (!todo.empty()) {
+				todo = todo.subspan(rb.pushSome(todo));
+			}
+			next += unsigned(chunk.size());
+		}
+	});
+
+	bool ok = true;
+	std::array<unsigned, 53> buf;
+	unsigned expected = 0;
+	while (expected < TOTAL) {
+		auto num = rb.popSome(buf);
+		for (auto i : xrange(num)) {
+			ok &= buf[i] == expected++;
+		}
+	}
+	producer.join();
+	CHECK(ok);
+	CHECK(rb.isEmpty());
+}
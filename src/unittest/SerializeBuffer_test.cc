@@ -0,0 +1,40 @@
+#include "catch.hpp"
+
+#include "SerializeBuffer.hh"
+
+#include "MSXException.hh"
+
+#include <cstdint>
+
+using namespace openmsx;
+
+TEST_CASE("InputBuffer")
+{
+	OutputBuffer out;
+	uint32_t a = 0x12345678;
+	uint16_t b = 0xabcd;
+	out.insert(&a, sizeof(a));
+	out.insert(&b, sizeof(b));
+	auto buf = std::move(out).release();
+	std::span<const uint8_t> data{buf.data(), sizeof(a) + sizeof(b)};
+
+	SECTION("read back") {
+		InputBuffer in(data);
+		uint32_t a2 = 0; in.read(&a2, sizeof(a2));
+		uint16_t b2 = 0; in.read(&b2, sizeof(b2));
+		CHECK(a2 == a);
+		CHECK(b2 == b);
+	}
+	SECTION("checked, read past the end") {
+		InputBuffer in(data, true);
+		uint32_t a2 = 0; in.read(&a2, sizeof(a2));
+		CHECK(a2 == a);
+		uint32_t c = 0;
+		CHECK_THROWS_AS(in.read(&c, sizeof(c)), MSXException);
+		CHECK_THROWS_AS(in.skip(3), MSXException);
+		CHECK_NOTHROW(in.check(2));
+		CHECK_THROWS_AS(in.check(size_t(-1)), MSXException);
+		in.skip(2);
+		CHECK_THROWS_AS(in.check(1), MSXException);
+	}
+}
@@ -0,0 +1,174 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+
+#include "SpriteScan.hh"
+
+#include "xrange.hh"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace openmsx;
+
+namespace {
+
+struct Sprite {
+	uint32_t pattern;
+	int16_t x;
+	uint8_t colorAttrib;
+};
+
+// Straightforward reference implementations, these are the algorithms
+// SpriteChecker used before.
+template<int STRIDE>
+[[nodiscard]] SpriteScan::Visible refVisible(
+	std::span<const uint8_t, 32 * STRIDE> attr, uint8_t terminator,
+	int firstLine, int numLines, int magSize)
+{
+	SpriteScan::Visible result = {0, 0};
+	for (/**/; result.count < 32; ++result.count) {
+		int y = attr[result.count * STRIDE];
+		if (y == terminator) break;
+		for (auto line : xrange(firstLine, firstLine + numLines)) {
+			if (((line - y) & 0xFF) < magSize) {
+				result.mask |= 1u << result.count;
+				break;
+			}
+		}
+	}
+	return result;
+}
+
+[[nodiscard]] int refCollision(std::span<const Sprite> sprites, int magSize)
+{
+	int minXCollision = SpriteScan::NO_COLLISION;
+	for (int i = int(sprites.size()); --i >= 1; /**/) {
+		int x_i = sprites[i].x;
+		uint32_t pattern_i = sprites[i].pattern;
+		for (int j = i; --j >= 0; /**/) {
+			int dist = sprites[j].x - x_i;
+			if ((-magSize < dist) && (dist < magSize)) {
+				uint32_t pattern_j = sprites[j].pattern;
+				if (dist < 0) {
+					pattern_j <<= -dist;
+				} else {
+					pattern_j >>= dist;
+				}
+				uint32_t colPat = pattern_i & pattern_j;
+				if (x_i < 0) colPat &= (1 << (32 + x_i)) - 1;
+				if (colPat) {
+					minXCollision = std::min(minXCollision, x_i + std::countl_zero(colPat));
+				}
+			}
+		}
+	}
+	return minXCollision;
+}
+
+[[nodiscard]] std::vector<Sprite> randomSprites(std::mt19937& rng, int num, int magSize)
+{
+	std::vector<Sprite> result(num);
+	for (auto& s : result) {
+		// mostly sparse patterns, so that not every pair overlaps
+		s.pattern = (rng() & rng() & rng()) & ~0u << (32 - magSize);
+		s.x = int16_t(int(rng() % 256) - ((rng() & 3) == 0 ? 32 : 0));
+		s.colorAttrib = 1;
+	}
+	return result;
+}
+
+constexpr auto always = [](const Sprite&) { return true; };
+
+} // namespace
+
+TEST_CASE("SpriteScan::visibleSprites")
+{
+	std::mt19937 rng(1234);
+	for (auto iter : xrange(200)) {
+		std::array<uint8_t, 128> attr;
+		std::ranges::generate(attr, [&] { return uint8_t(rng()); });
+		// sometimes use coordinates close to each other
+		if (iter & 1) {
+			for (auto i : xrange(32)) attr[4 * i] = uint8_t(attr[4 * i] % 16 + 100);
+		}
+		uint8_t terminator = (iter & 2) ? 208 : attr[4 * (rng() % 32)];
+		for (int magSize : {8, 16, 32}) {
+			for (int numLines : {0, 1, 2, 7, 100, 255, 256, 300}) {
+				int firstLine = int(rng() % 300) - 20;
+				std::span<const uint8_t, 128> s4{attr};
+				CHECK(SpriteScan::visibleSprites<4>(s4, terminator, firstLine, numLines, magSize).mask ==
+				      refVisible<4>(s4, terminator, firstLine, numLines, magSize).mask);
+				CHECK(SpriteScan::visibleSprites<4>(s4, terminator, firstLine, numLines, magSize).count ==
+				      refVisible<4>(s4, terminator, firstLine, numLines, magSize).count);
+				auto s2 = std::span<const uint8_t, 64>{attr.data(), 64};
+				CHECK(SpriteScan::visibleSprites<2>(s2, terminator, firstLine, numLines, magSize).mask ==
+				      refVisible<2>(s2, terminator, firstLine, numLines, magSize).mask);
+				CHECK(SpriteScan::visibleSprites<2>(s2, terminator, firstLine, numLines, magSize).count ==
+				      refVisible<2>(s2, terminator, firstLine, numLines, magSize).count);
+			}
+		}
+	}
+}
+
+TEST_CASE("SpriteScan::firstCollision")
+{
+	std::mt19937 rng(5678);
+	for (auto iter : xrange(2000)) {
+		(void)iter;
+		for (int magSize : {8, 16, 32}) {
+			for (int num : {0, 1, 2, 4, 8}) {
+				auto sprites = randomSprites(rng, num, magSize);
+				CHECK(SpriteScan::firstCollision(std::span<const Sprite>(sprites), always) ==
+				      refCollision(sprites, magSize));
+			}
+		}
+	}
+	// filtered sprites don't collide
+	std::array<Sprite, 2> sprites = {{{0xFFFF0000, 10, 0}, {0xFFFF0000, 12, 1}}};
+	CHECK(SpriteScan::firstCollision(std::span<const Sprite>(sprites), always) == 12);
+	CHECK(SpriteScan::firstCollision(std::span<const Sprite>(sprites),
+		[](const Sprite& s) { return s.colorAttrib != 0; }) == SpriteScan::NO_COLLISION);
+	// pixels with x < 0 don't collide
+	sprites = {{{0xFFFFFF00, -20, 1}, {0xFFFFFF00, -18, 1}}};
+	CHECK(SpriteScan::firstCollision(std::span<const Sprite>(sprites), always) == 0);
+	sprites = {{{0xFFFF0000, -20, 1}, {0xFFFF0000, -18, 1}}};
+	CHECK(SpriteScan::firstCollision(std::span<const Sprite>(sprites), always) == SpriteScan::NO_COLLISION);
+}
+
+TEST_CASE("SpriteScan benchmark", "[.][benchmark]")
+{
+	// Sprite stress workload: 32 sprites (16x16, magnified), checked one
+	// line at a time (the worst case, e.g. when the status register is
+	// polled every line), 8 sprites per line for the collision check.
+	std::mt19937 rng(1234);
+	std::array<uint8_t, 128> attr;
+	std::ranges::generate(attr, [&] { return uint8_t(rng() % 200); });
+	std::span<const uint8_t, 128> s{attr};
+	std::vector<std::vector<Sprite>> lines(212);
+	for (auto& l : lines) l = randomSprites(rng, 8, 32);
+
+	BENCHMARK("visibleSprites: reference, per frame") {
+		uint32_t r = 0;
+		for (auto line : xrange(212)) r ^= refVisible<4>(s, 216, line, 1, 32).mask;
+		return r;
+	};
+	BENCHMARK("visibleSprites: per frame") {
+		uint32_t r = 0;
+		for (auto line : xrange(212)) r ^= SpriteScan::visibleSprites<4>(s, 216, line, 1, 32).mask;
+		return r;
+	};
+	BENCHMARK("collision: reference (pairs), per frame") {
+		int r = 0;
+		for (const auto& l : lines) r += refCollision(l, 32);
+		return r;
+	};
+	BENCHMARK("collision: bitmask, per frame") {
+		int r = 0;
+		for (const auto& l : lines) r += SpriteScan::firstCollision(std::span<const Sprite>(l), always);
+		return r;
+	};
+}
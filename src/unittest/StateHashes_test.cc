@@ -0,0 +1,67 @@
+#include "catch.hpp"
+
+#include "StateHashes.hh"
+
+#include <array>
+#include <string>
+#include <vector>
+
+using namespace openmsx;
+
+static EmuTime frameTime(unsigned n)
+{
+	return EmuTime::zero() + EmuDuration::hz(50) * n;
+}
+
+TEST_CASE("StateHashes")
+{
+	using Subsystem = StateHashes::Subsystem;
+	StateHashes hashes;
+	CHECK(hashes.empty());
+
+	std::array state0 = {Subsystem{"CPU regs", 1}, Subsystem{"VRAM", 2}, Subsystem{"RAM", 3}};
+	std::array state1 = {Subsystem{"CPU regs", 4}, Subsystem{"VRAM", 2}, Subsystem{"RAM", 3}};
+	std::array state2 = {Subsystem{"CPU regs", 5}, Subsystem{"VRAM", 6}, Subsystem{"RAM", 3}};
+	hashes.record(frameTime(0), state0);
+	hashes.record(frameTime(1), state1);
+	hashes.record(frameTime(2), state2);
+	REQUIRE(hashes.size() == 3);
+
+	// only the changed subsystems are stored
+	CHECK(hashes[0].changes.size() == 3);
+	CHECK(hashes[1].changes.size() == 1);
+	CHECK(hashes[2].changes.size() == 2);
+
+	// frames that are not newer than the last one are ignored
+	hashes.record(frameTime(2), state0);
+	CHECK(hashes.size() == 3);
+
+	CHECK(hashes.find(frameTime(1)) == 1);
+	CHECK(hashes.find(frameTime(1) + EmuDuration::msec(1)) == -1);
+	CHECK(hashes.find(frameTime(3)) == -1);
+
+	// combined hash depends on all subsystems
+	CHECK(hashes[1].hash == StateHashes::combine(state1));
+	CHECK(hashes[1].hash != StateHashes::combine(state2));
+
+	// report the subsystems that differ
+	CHECK(hashes.diff(1, state1).empty());
+	CHECK(hashes.diff(1, state2) == std::vector<std::string>{"CPU regs", "VRAM"});
+	std::array extra = {Subsystem{"CPU regs", 4}, Subsystem{"PSG regs", 7}};
+	CHECK(hashes.diff(1, extra) == std::vector<std::string>{"PSG regs"});
+
+	// after erasing the tail, recording continues from the remaining state
+	hashes.eraseAfter(frameTime(1));
+	CHECK(hashes.size() == 2);
+	hashes.record(frameTime(3), state1);
+	REQUIRE(hashes.size() == 3);
+	CHECK(hashes[2].changes.empty());
+	CHECK(hashes.diff(2, state1).empty());
+
+	StateHashes other;
+	other.swap(hashes);
+	CHECK(hashes.empty());
+	CHECK(other.size() == 3);
+	other.clear();
+	CHECK(other.empty());
+}
@@ -0,0 +1,120 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+
+#include "V9990YUVKernels.hh"
+
+#include "xrange.hh"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace openmsx;
+using namespace V9990YUVKernels;
+
+// Per pixel, straight from the V9990 data book (and the code before it was
+// restructured).
+template<bool YJK>
+[[nodiscard]] static uint16_t refIndex(std::array<uint8_t, 4> data, int i)
+{
+	auto sext6 = [](int x) { return (x & 0x20) ? (x - 64) : x; };
+	int v = sext6((data[0] & 7) | ((data[1] & 7) << 3));
+	int u = sext6((data[2] & 7) | ((data[3] & 7) << 3));
+	int y = data[i] >> 3;
+	auto clamp = [](int x) { return std::clamp(x, 0, 31); };
+	int r = clamp(y + u);
+	int g = clamp((5 * y - 2 * u - v) / 4);
+	int b = clamp(y + v);
+	return uint16_t(YJK ? ((b << 10) | (r << 5) | g)
+	                    : ((g << 10) | (r << 5) | b));
+}
+
+template<bool YJK>
+static void checkScalar(std::array<uint8_t, 4> data)
+{
+	auto idx = toIndex4<YJK>(data);
+	for (auto i : xrange(4)) {
+		REQUIRE(idx[i] == refIndex<YJK>(data, i));
+	}
+}
+
+#ifdef __SSE2__
+template<bool YJK>
+static void checkSSE(std::array<uint8_t, 4> g0, std::array<uint8_t, 4> g1)
+{
+	alignas(16) std::array<uint16_t, 8> in = {
+		g0[0], g0[1], g0[2], g0[3], g1[0], g1[1], g1[2], g1[3]};
+	alignas(16) std::array<uint16_t, 8> out;
+	_mm_store_si128(std::bit_cast<__m128i*>(out.data()),
+	                toIndex8<YJK>(_mm_load_si128(std::bit_cast<const __m128i*>(in.data()))));
+	auto i0 = toIndex4<YJK>(g0);
+	auto i1 = toIndex4<YJK>(g1);
+	for (auto i : xrange(4)) {
+		REQUIRE(out[i + 0] == i0[i]);
+		REQUIRE(out[i + 4] == i1[i]);
+	}
+}
+#endif
+
+template<bool YJK>
+static void test()
+{
+	// All combinations of U and V (the lower 3 bits of the 4 bytes) with
+	// all Y values for the first pixel, the other Y values vary as well.
+	for (auto uv : xrange(4096u)) {
+		for (auto y : xrange(32u)) {
+			auto b = [&](unsigned n) {
+				auto yn = (y + 11 * n) & 31;
+				return uint8_t((yn << 3) | ((uv >> (3 * n)) & 7));
+			};
+			std::array<uint8_t, 4> g0 = {b(0), b(1), b(2), b(3)};
+			checkScalar<YJK>(g0);
+#ifdef __SSE2__
+			std::array<uint8_t, 4> g1 = {b(3), b(2), b(1), b(0)};
+			checkSSE<YJK>(g0, g1);
+#endif
+		}
+	}
+}
+
+TEST_CASE("V9990YUVKernels: YUV")
+{
+	test<false>();
+}
+
+TEST_CASE("V9990YUVKernels: YJK")
+{
+	test<true>();
+}
+
+TEST_CASE("V9990YUVKernels benchmark", "[.][benchmark]")
+{
+	// one line of a 512 pixel wide mode
+	std::vector<uint8_t> input(512);
+	std::mt19937 rng(1234);
+	for (auto& i : input) i = uint8_t(rng());
+	std::vector<uint16_t> output(512);
+
+	BENCHMARK("scalar") {
+		for (size_t i = 0; i < input.size(); i += 4) {
+			auto idx = toIndex4<true>({input[i + 0], input[i + 1], input[i + 2], input[i + 3]});
+			for (auto j : xrange(4)) output[i + j] = idx[j];
+		}
+		return output[0];
+	};
+#ifdef __SSE2__
+	BENCHMARK("SSE2") {
+		for (size_t i = 0; i < input.size(); i += 8) {
+			uint64_t d;
+			memcpy(&d, &input[i], 8);
+			__m128i p = _mm_unpacklo_epi8(_mm_cvtsi64_si128(int64_t(d)), _mm_setzero_si128());
+			_mm_storeu_si128(std::bit_cast<__m128i*>(&output[i]), toIndex8<true>(p));
+		}
+		return output[0];
+	};
+#endif
+}
@@ -0,0 +1,84 @@
+#include "catch.hpp"
+
+#include "VDPVRAM.hh"
+
+using namespace openmsx;
+
+// sizeMask for 128kB VRAM with VR=1, see VDPVRAM::setSizeMask()
+static constexpr unsigned SIZE_MASK = 0x3FFFF;
+
+// Byte range of a (Graphic4/5) line, 128 bytes per line.
+static bool lineDisplayed(const DisplayedPages& pages, unsigned y)
+{
+	return pages.intersects(y * 128, y * 128 + 127, SIZE_MASK);
+}
+
+TEST_CASE("DisplayedPages: all")
+{
+	auto pages = DisplayedPages::all();
+	CHECK(pages.intersects(0x00000, 0x00000, SIZE_MASK));
+	CHECK(pages.intersects(0x1FF00, 0x1FFFF, SIZE_MASK));
+	CHECK(pages.intersects(0x20000, 0x20000, SIZE_MASK));
+}
+
+TEST_CASE("DisplayedPages: Graphic4/5")
+{
+	SECTION("page 0") {
+		auto pages = DisplayedPages::bitmap(false, 0x1F << 10, false);
+		CHECK( lineDisplayed(pages, 0));
+		CHECK( lineDisplayed(pages, 255));
+		// drawing in page 1, 2 and 3 doesn't need a renderer sync
+		CHECK(!lineDisplayed(pages, 256));
+		CHECK(!lineDisplayed(pages, 511));
+		CHECK(!lineDisplayed(pages, 600));
+		CHECK(!lineDisplayed(pages, 1023));
+		CHECK( pages.intersects(0x7F00, 0x8000, SIZE_MASK));
+		CHECK(!pages.intersects(0x8000, 0x1FFFF, SIZE_MASK));
+		// extended VRAM
+		CHECK(!pages.intersects(0x20000, 0x27FFF, SIZE_MASK));
+	}
+	SECTION("page 3") {
+		auto pages = DisplayedPages::bitmap(false, 0x7F << 10, false);
+		CHECK(!lineDisplayed(pages, 0));
+		CHECK(!lineDisplayed(pages, 700));
+		CHECK( lineDisplayed(pages, 800));
+		CHECK( lineDisplayed(pages, 1023));
+	}
+	SECTION("page 1, alternating with page 0") {
+		auto pages = DisplayedPages::bitmap(false, 0x3F << 10, true);
+		CHECK( lineDisplayed(pages, 0));
+		CHECK( lineDisplayed(pages, 300));
+		CHECK(!lineDisplayed(pages, 512));
+		CHECK(!lineDisplayed(pages, 1000));
+	}
+	SECTION("16kB address space (VR=0)") {
+		// A16 and A15 are not used, all addresses mirror page 0.
+		auto pages = DisplayedPages::bitmap(false, 0x3F << 10, false);
+		CHECK(pages.intersects(0x0000, 0x3FFF, 0x27FFF));
+	}
+}
+
+TEST_CASE("DisplayedPages: Graphic6/7")
+{
+	// Physical addresses: bit 16 selects the plane (even/odd bytes), bit 15
+	// the page.
+	SECTION("page 0") {
+		auto pages = DisplayedPages::bitmap(true, 0x1F << 10, false);
+		CHECK( pages.intersects(0x00000, 0x07FFF, SIZE_MASK));
+		CHECK( pages.intersects(0x10000, 0x17FFF, SIZE_MASK));
+		CHECK(!pages.intersects(0x08000, 0x0FFFF, SIZE_MASK));
+		CHECK(!pages.intersects(0x18000, 0x1FFFF, SIZE_MASK));
+	}
+	SECTION("page 1") {
+		auto pages = DisplayedPages::bitmap(true, 0x3F << 10, false);
+		CHECK(!pages.intersects(0x00000, 0x07FFF, SIZE_MASK));
+		CHECK(!pages.intersects(0x10000, 0x17FFF, SIZE_MASK));
+		CHECK( pages.intersects(0x08000, 0x0FFFF, SIZE_MASK));
+		CHECK( pages.intersects(0x18000, 0x1FFFF, SIZE_MASK));
+	}
+	SECTION("alternating pages") {
+		auto pages = DisplayedPages::bitmap(true, 0x3F << 10, true);
+		CHECK(pages.intersects(0x00000, 0x00000, SIZE_MASK));
+		CHECK(pages.intersects(0x1FFFF, 0x1FFFF, SIZE_MASK));
+	}
+}
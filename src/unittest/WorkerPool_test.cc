@@ -0,0 +1,38 @@
+#include "catch.hpp"
+#include "WorkerPool.hh"
+
+#include "xrange.hh"
+
+#include <atomic>
+#include <vector>
+
+using namespace openmsx;
+
+static void check(WorkerPool& pool, size_t n)
+{
+	std::vector<int> v(n, 0);
+	pool.parallelFor(n, [&](size_t i) { v[i] += int(i) + 1; });
+	for (auto i : xrange(n)) {
+		CHECK(v[i] == int(i) + 1); // each index executed exactly once
+	}
+}
+
+TEST_CASE("WorkerPool")
+{
+	for (unsigned threads : {0, 1, 3}) {
+		WorkerPool pool(threads);
+		CHECK(pool.size() == threads);
+		check(pool, 0);
+		check(pool, 1);
+		check(pool, 2);
+		check(pool, 100);
+
+		// many short rounds, exercises the start/stop handshake
+		std::atomic<int> sum = 0;
+		for (auto round : xrange(1000)) {
+			(void)round;
+			pool.parallelFor(5, [&](size_t i) { sum += int(i); });
+		}
+		CHECK(sum == 1000 * (0 + 1 + 2 + 3 + 4));
+	}
+}
@@ -0,0 +1,118 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+
+#include "YMF262.hh"
+
+#include "xrange.hh"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
+#include <vector>
+
+using namespace openmsx;
+
+namespace {
+
+// 18 stereo channels
+struct Output {
+	explicit Output(unsigned num)
+		: data(18 * 2 * num)
+	{
+		for (auto i : xrange(18)) ptrs[i] = &data[i * 2 * num];
+	}
+	std::vector<float> data;
+	std::array<float*, 18> ptrs;
+};
+
+// Random values for the sound registers (not the test and timer registers).
+// Note: std::uniform_int_distribution is not the same on all platforms, the
+// raw std::mt19937 output is.
+void randomWrites(YMF262Core& core, std::mt19937& rng, int count)
+{
+	for (auto n : xrange(count)) {
+		(void)n;
+		unsigned r = 0x20 + (rng() % (0xF6 - 0x20)) + ((rng() & 1) ? 0x100 : 0);
+		auto v = uint8_t(rng());
+		if ((r & 0xE0) == 0x40) v &= 0xC7; // mostly audible
+		if ((r & 0xF0) == 0xC0) v |= 0x30; // to the left and right output
+		core.writeReg(r, v);
+	}
+}
+
+// FNV-1a hash of the output samples (these are integer values).
+void hashOutput(uint32_t& hash, std::span<const float> samples)
+{
+	for (auto s : samples) {
+		auto x = uint32_t(int32_t(s));
+		for (auto i : xrange(4)) {
+			hash = (hash ^ ((x >> (8 * i)) & 0xFF)) * 16777619u;
+		}
+	}
+}
+
+} // namespace
+
+TEST_CASE("YMF262: output")
+{
+	// Reference output recorded with the YMF262 code from before the
+	// envelope generators were stepped selectively (FMEnvelope::dueSlots()),
+	// one hash per 20 blocks of 500 samples.
+	static constexpr std::array<uint32_t, 10> expected = {
+		0x109e3f28, 0x0cd48fc5, 0x4421c154, 0x8cfe743e, 0xa46368bc,
+		0x943fc8e1, 0x00dbe5a4, 0x03aa2b1e, 0x5e9b6856, 0xcc381662,
+	};
+
+	auto core = std::make_unique<YMF262Core>();
+	core->reset();
+	core->writeReg(0x105, 0x01); // OPL3 mode
+
+	std::mt19937 rng(12345);
+	static constexpr unsigned NUM = 500;
+	uint32_t hash = 2166136261u;
+	bool audible = false;
+	for (auto block : xrange(200)) {
+		randomWrites(*core, rng, 20);
+		// now and then: 4-operator channels, rhythm mode, key off
+		if ((block % 10) == 0) core->writeReg(0x104, uint8_t(rng() & 0x3F));
+		if ((block % 7) == 0) core->writeReg(0x0BD, uint8_t(rng()));
+		if ((block % 5) == 0) {
+			for (auto i : xrange(9u)) {
+				auto r = 0xB0 + i + ((rng() & 1) ? 0x100 : 0);
+				core->writeReg(r, core->peekReg(r) & ~0x20);
+			}
+		}
+
+		Output out(NUM);
+		core->generateChannels(out.ptrs, NUM);
+		hashOutput(hash, out.data);
+		for (auto s : out.data) audible |= (s != 0.0f);
+		if ((block % 20) == 19) {
+			CHECK(hash == expected[block / 20]);
+		}
+	}
+	CHECK(audible);
+}
+
+TEST_CASE("YMF262 benchmark", "[.][benchmark]")
+{
+	auto core = std::make_unique<YMF262Core>();
+	core->reset();
+	core->writeReg(0x105, 0x01);
+	std::mt19937 rng(54321);
+	randomWrites(*core, rng, 2000);
+	for (auto i : xrange(9u)) {
+		for (auto base : {0x0B0u, 0x1B0u}) {
+			core->writeReg(base + i, core->peekReg(base + i) | 0x20); // key on
+		}
+	}
+
+	static constexpr unsigned NUM = 1024;
+	Output out(NUM);
+	BENCHMARK("generate") {
+		core->generateChannels(out.ptrs, NUM);
+		return out.data[0];
+	};
+}
@@ -1,11 +1,19 @@
 #include "DeltaBlock.hh"
 
+#include "FileException.hh"
+#include "SpillFile.hh"
+
 #include "lz4.hh"
 #include "ranges.hh"
 
 #include <algorithm>
 #include <bit>
 #include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <tuple>
 #include <utility>
 #if STATISTICS
@@ -184,38 +192,41 @@ end:	return std::mismatch(p, p_end, q);
 //   n2 number of bytes are different, and here are the bytes
 //   n3 number of bytes are equal
 //   ...
+// The scan routines temporarily place sentinels in 'newBuf' (not in 'oldBuf').
+// So the (shared) reference block remains untouched and can safely be read
+// by other threads in the meantime.
 [[nodiscard]] static std::vector<uint8_t> calcDelta(
-	const uint8_t* oldBuf, std::span<const uint8_t> newBuf)
+	const uint8_t* oldBuf, std::span<uint8_t> newBuf)
 {
 	std::vector<uint8_t> result;
 
-	const auto* p = oldBuf;
-	const auto* q = newBuf.data();
+	const auto* p = newBuf.data();
+	const auto* q = oldBuf;
 	auto size = newBuf.size();
 	const auto* p_end = p + size;
 	const auto* q_end = q + size;
 
 	// scan equal bytes (possibly zero)
-	const auto* q1 = q;
+	const auto* p1 = p;
 	std::tie(p, q) = scan_mismatch(p, p_end, q, q_end);
-	auto n1 = q - q1;
+	auto n1 = p - p1;
 	storeUleb(result, n1);
 
-	while (q != q_end) {
+	while (p != p_end) {
 		assert(*p != *q);
 
-		const auto* q2 = q;
+		const auto* p2 = p;
 	different:
 		std::tie(p, q) = scan_match(p + 1, p_end, q + 1, q_end);
-		auto n2 = q - q2;
+		auto n2 = p - p2;
 
-		const auto* q3 = q;
+		const auto* p3 = p;
 		std::tie(p, q) = scan_mismatch(p, p_end, q, q_end);
-		auto n3 = q - q3;
-		if ((q != q_end) && (n3 <= 2)) goto different;
+		auto n3 = p - p3;
+		if ((p != p_end) && (n3 <= 2)) goto different;
 
 		storeUleb(result, n2);
-		result.insert(result.end(), q2, q3);
+		result.insert(result.end(), p2, p3);
 
 		if (n3 != 0) storeUleb(result, n3);
 	}
@@ -239,23 +250,150 @@ static void applyDeltaInPlace(std::span<uint8_t> buf, std::span<const uint8_t> d
 	}
 }
 
-#if STATISTICS
+
+// --- Background worker ---
+
+// A single thread that executes the expensive parts of creating delta blocks.
+// Jobs are executed in FIFO order. This is important: a reference block is
+// only compressed after all pending deltas against that block are calculated.
+class DeltaBlockWorker
+{
+public:
+	// Limit on the total size of the data that's still waiting to be
+	// processed. When the worker can't keep up, the producer is stalled
+	// rather than letting the raw copies pile up.
+	static constexpr size_t MAX_QUEUED_BYTES = 64 * 1024 * 1024;
+
+	[[nodiscard]] static DeltaBlockWorker& instance()
+	{
+		static DeltaBlockWorker oneInstance;
+		return oneInstance;
+	}
+
+	// 'job' must keep 'block' alive (e.g. by capturing a shared_ptr).
+	void add(const DeltaBlock& block, size_t cost, std::function<void()> job)
+	{
+		{
+			std::unique_lock lock(mutex);
+			producerCond.wait(lock, [&] {
+				return queue.empty() || (queuedBytes + cost <= MAX_QUEUED_BYTES);
+			});
+			block.pendingJobs.fetch_add(1, std::memory_order_relaxed);
+			queuedBytes += cost;
+			queue.emplace_back(&block, cost, std::move(job));
+		}
+		workerCond.notify_one();
+	}
+
+	void wait(const DeltaBlock& block)
+	{
+		if (block.pendingJobs.load(std::memory_order_acquire) == 0) return;
+		std::unique_lock lock(mutex);
+		doneCond.wait(lock, [&] {
+			return block.pendingJobs.load(std::memory_order_relaxed) == 0;
+		});
+	}
+
+	void waitAll()
+	{
+		std::unique_lock lock(mutex);
+		doneCond.wait(lock, [&] { return queue.empty() && !busy; });
+	}
+
+private:
+	struct Job {
+		const DeltaBlock* block;
+		size_t cost;
+		std::function<void()> work;
+	};
+
+	DeltaBlockWorker()
+		: thread([this] { run(); })
+	{
+	}
+
+	~DeltaBlockWorker()
+	{
+		{
+			std::scoped_lock lock(mutex);
+			stop = true;
+		}
+		workerCond.notify_one();
+		thread.join();
+	}
+
+	void run()
+	{
+		std::unique_lock lock(mutex);
+		while (true) {
+			workerCond.wait(lock, [&] { return stop || !queue.empty(); });
+			if (queue.empty()) return; // only exit when all work is done
+
+			auto job = std::move(queue.front());
+			queue.pop_front();
+			busy = true;
+			lock.unlock();
+
+			job.work();
+
+			lock.lock();
+			job.block->pendingJobs.fetch_sub(1, std::memory_order_release);
+			queuedBytes -= job.cost;
+			doneCond.notify_all();
+			producerCond.notify_all();
+
+			// Destroying the job may free a lot of memory, don't
+			// hold the lock while doing that. Only after this
+			// waitAll() returns, so the job no longer holds any
+			// blocks (or spill file ranges).
+			lock.unlock();
+			job.work = nullptr;
+			lock.lock();
+			busy = false;
+			doneCond.notify_all();
+		}
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable workerCond;   // new job or stop request
+	std::condition_variable doneCond;     // a job has finished
+	std::condition_variable producerCond; // queue has room again
+	std::deque<Job> queue;
+	size_t queuedBytes = 0;
+	bool busy = false;
+	bool stop = false;
+	std::thread thread; // must be initialized last
+};
+
 
 // class DeltaBlock
 
+#if STATISTICS
 DeltaBlock::~DeltaBlock()
 {
 	globalAllocSize -= allocSize;
 	std::cout << "stat: ~DeltaBlock " << globalAllocSize
 	          << " (-" << allocSize << ")\n";
 }
-
 #endif
 
+void DeltaBlock::waitReady() const
+{
+	DeltaBlockWorker::instance().wait(*this);
+}
+
+void DeltaBlock::waitAllReady()
+{
+	DeltaBlockWorker::instance().waitAll();
+}
+
+
 // class DeltaBlockCopy
 
 DeltaBlockCopy::DeltaBlockCopy(std::span<const uint8_t> data)
-	: block(data.size())
+	: DeltaBlock(data.size())
+	, block(data.size())
 {
 #ifdef DEBUG
 	sha1 = SHA1::calc(data);
@@ -271,6 +409,12 @@ DeltaBlockCopy::DeltaBlockCopy(std::span<const uint8_t> data)
 }
 
 void DeltaBlockCopy::apply(std::span<uint8_t> dst) const
+{
+	waitReady();
+	applyNow(dst);
+}
+
+void DeltaBlockCopy::applyNow(std::span<uint8_t> dst) const
 {
 	if (compressed()) {
 		LZ4::decompress(block.data(), dst.data(), int(compressedSize), int(dst.size()));
@@ -282,7 +426,15 @@ void DeltaBlockCopy::apply(std::span<uint8_t> dst) const
 #endif
 }
 
-void DeltaBlockCopy::compress(size_t size)
+void DeltaBlockCopy::compress(std::shared_ptr<DeltaBlockCopy> block)
+{
+	auto& b = *block;
+	DeltaBlockWorker::instance().add(b, b.size, [block = std::move(block)] {
+		block->compressNow();
+	});
+}
+
+void DeltaBlockCopy::compressNow()
 {
 	if (compressed()) return;
 
@@ -297,10 +449,11 @@ void DeltaBlockCopy::compress(size_t size)
 	compressedSize = dstLen;
 	std::swap(block, buf2);
 	block.resize(compressedSize); // shrink to fit
+	memorySize.store(compressedSize, std::memory_order_relaxed);
 	assert(compressed());
 #ifdef DEBUG
 	MemBuffer<uint8_t> buf3(size);
-	apply({buf3.data(), size});
+	LZ4::decompress(block.data(), buf3.data(), int(compressedSize), int(size));
 	assert(std::ranges::equal(std::span{buf3.data(), size}, std::span{buf2.data(), size}));
 #endif
 #if STATISTICS
@@ -314,6 +467,7 @@ void DeltaBlockCopy::compress(size_t size)
 
 const uint8_t* DeltaBlockCopy::getData()
 {
+	// Only called from the worker thread, before this block gets compressed.
 	assert(!compressed());
 	return block.data();
 }
@@ -324,16 +478,38 @@ const uint8_t* DeltaBlockCopy::getData()
 DeltaBlockDiff::DeltaBlockDiff(
 		std::shared_ptr<DeltaBlockCopy> prev_,
 		std::span<const uint8_t> data)
-	: prev(std::move(prev_))
-	, delta(calcDelta(prev->getData(), data))
+	: DeltaBlock(data.size())
+	, prev(std::move(prev_))
+	, raw(data.size())
 {
 #ifdef DEBUG
 	sha1 = SHA1::calc(data);
+#endif
+	copy_to_range(data, std::span{raw});
+}
+
+std::shared_ptr<DeltaBlockDiff> DeltaBlockDiff::create(
+	std::shared_ptr<DeltaBlockCopy> prev, std::span<const uint8_t> data)
+{
+	auto result = std::make_shared<DeltaBlockDiff>(std::move(prev), data);
+	DeltaBlockWorker::instance().add(*result, data.size(), [result] {
+		result->calcDeltaNow();
+	});
+	return result;
+}
 
-	MemBuffer<uint8_t> buf(data.size());
-	apply({buf.data(), data.size()});
-	assert(std::ranges::equal(std::span{buf.data(), data.size()}, data));
+void DeltaBlockDiff::calcDeltaNow()
+{
+	const auto* ref = prev->getData();
+	delta = calcDelta(ref, std::span{raw});
+#ifdef DEBUG
+	MemBuffer<uint8_t> buf(raw.size());
+	copy_to_range(std::span{ref, raw.size()}, std::span{buf});
+	applyDeltaInPlace(std::span{buf}, delta);
+	assert(std::ranges::equal(std::span{buf}, std::span{raw}));
 #endif
+	raw.clear();
+	memorySize.store(delta.size(), std::memory_order_relaxed);
 #if STATISTICS
 	allocSize = delta.size();
 	globalAllocSize += allocSize;
@@ -344,6 +520,7 @@ DeltaBlockDiff::DeltaBlockDiff(
 
 void DeltaBlockDiff::apply(std::span<uint8_t> dst) const
 {
+	waitReady();
 	prev->apply(dst);
 	applyDeltaInPlace(dst, delta);
 #ifdef DEBUG
@@ -353,10 +530,146 @@ void DeltaBlockDiff::apply(std::span<uint8_t> dst) const
 
 size_t DeltaBlockDiff::getDeltaSize() const
 {
+	waitReady();
 	return delta.size();
 }
 
 
+// class DeltaBlockSpilled
+
+DeltaBlockSpilled::DeltaBlockSpilled(
+		std::shared_ptr<DeltaBlock> original_,
+		std::shared_ptr<DeltaBlockSpilled> prev_,
+		std::shared_ptr<SpillFile> file_)
+	: DeltaBlock(original_->getSize())
+	, prev(std::move(prev_))
+	, file(std::move(file_))
+	, original(std::move(original_))
+{
+#ifdef DEBUG
+	sha1 = original->sha1;
+#endif
+	// till it's written, the original remains in RAM
+	memorySize.store(original->getMemorySize(), std::memory_order_relaxed);
+}
+
+DeltaBlockSpilled::~DeltaBlockSpilled()
+{
+	file->free(offset, storedSize);
+}
+
+// Executed on the worker thread. All earlier jobs are finished, so this
+// doesn't need to (and must not) wait for the original block.
+void DeltaBlockSpilled::storeNow()
+{
+	MemBuffer<uint8_t> buf;
+	std::span<const uint8_t> stored;
+	if (prev) {
+		// Same delta, but against the spilled reference block. Deltas
+		// are already small, don't compress them.
+		const auto& diff = static_cast<const DeltaBlockDiff&>(*original);
+		stored = diff.delta;
+	} else {
+		const auto& copy = static_cast<const DeltaBlockCopy&>(*original);
+		MemBuffer<uint8_t> raw(size);
+		copy.applyNow(std::span{raw});
+		buf.resize(LZ4::compressBound(int(size)));
+		auto dstLen = size_t(LZ4::compress(raw.data(), buf.data(), int(size)));
+		compressed = dstLen < size;
+		if (!compressed) std::swap(buf, raw);
+		stored = std::span{buf.data(), compressed ? dstLen : size};
+	}
+	try {
+		offset = file->store(stored);
+	} catch (MSXException&) {
+		// Keep the original. The error is reported via SpillFile::getError().
+		return;
+	}
+	storedSize = stored.size();
+	original.reset();
+	memorySize.store(0, std::memory_order_relaxed); // not in RAM
+}
+
+void DeltaBlockSpilled::apply(std::span<uint8_t> dst) const
+{
+	waitReady();
+	if (original) {
+		original->apply(dst);
+	} else if (prev) {
+		prev->apply(dst);
+		applyDeltaInPlace(dst, file->read(offset, storedSize));
+	} else {
+		auto data = file->read(offset, storedSize);
+		if (compressed) {
+			LZ4::decompress(data.data(), dst.data(), int(storedSize), int(dst.size()));
+		} else {
+			copy_to_range(data, dst);
+		}
+	}
+#ifdef DEBUG
+	assert(SHA1::calc(dst) == sha1);
+#endif
+}
+
+
+// class SpilledDeltaBlocks
+
+void SpilledDeltaBlocks::spill(std::span<std::shared_ptr<DeltaBlock>> blocks)
+{
+	if (!file) {
+		file = std::make_shared<SpillFile>();
+	} else if (auto error = file->getError(); !error.empty()) {
+		throw FileException(error);
+	}
+	for (auto& block : blocks) {
+		block = spill(block);
+	}
+
+	// Only originals that are still alive can be spilled again.
+	std::vector<const DeltaBlock*> expired;
+	for (const auto& [original, entry] : entries) {
+		if (entry.original.expired() || entry.spilled.expired()) {
+			expired.push_back(original);
+		}
+	}
+	for (const auto* original : expired) entries.erase(original);
+}
+
+std::shared_ptr<DeltaBlockSpilled> SpilledDeltaBlocks::spill(const std::shared_ptr<DeltaBlock>& block)
+{
+	if (const auto* entry = lookup(entries, block.get());
+	    entry && (entry->original.lock() == block)) {
+		if (auto s = entry->spilled.lock()) return s;
+	}
+
+	std::shared_ptr<DeltaBlockSpilled> prev;
+	if (const auto* ref = block->getReference()) {
+		// only diff blocks have a reference
+		const auto& diff = static_cast<const DeltaBlockDiff&>(*block);
+		assert(ref == diff.prev.get()); (void)ref;
+		prev = spill(diff.prev);
+	}
+	auto result = std::make_shared<DeltaBlockSpilled>(block, std::move(prev), file);
+	entries.insert_or_assign(block.get(), Entry{block, result});
+	// The spilled block doesn't hold extra memory, so no cost.
+	DeltaBlockWorker::instance().add(*result, 0, [result] {
+		result->storeNow();
+	});
+	return result;
+}
+
+void SpilledDeltaBlocks::clear()
+{
+	entries.clear();
+	file.reset();
+}
+
+size_t SpilledDeltaBlocks::getSize() const
+{
+	return file ? file->getSize() : 0;
+}
+
+
 // class LastDeltaBlocks
 
 std::shared_ptr<DeltaBlock> LastDeltaBlocks::createNew(
@@ -372,12 +685,19 @@ std::shared_ptr<DeltaBlock> LastDeltaBlocks::createNew(
 	assert(it->id   == id);
 	assert(it->size == size);
 
+	if (auto lastDiff = it->lastDiff.lock()) {
+		// Normally this delta was calculated long ago, so this
+		// doesn't block.
+		it->accSize += lastDiff->getDeltaSize();
+	}
+	it->lastDiff.reset();
+
 	auto ref = it->ref.lock();
 	if (it->accSize >= size || !ref) {
 		if (ref) {
 			// We will switch to a new DeltaBlockCopy object. So
 			// now is a good time to compress the old one.
-			ref->compress(size);
+			DeltaBlockCopy::compress(std::move(ref));
 		}
 		// Heuristic: create a new block when too many small
 		// differences have accumulated.
@@ -389,9 +709,9 @@ std::shared_ptr<DeltaBlock> LastDeltaBlocks::createNew(
 	} else {
 		// Create diff based on earlier reference block.
 		// Reference remains unchanged.
-		auto b = std::make_shared<DeltaBlockDiff>(ref, data);
+		auto b = DeltaBlockDiff::create(std::move(ref), data);
 		it->last = b;
-		it->accSize += b->getDeltaSize();
+		it->lastDiff = b;
 		return b;
 	}
 }
@@ -426,7 +746,7 @@ void LastDeltaBlocks::clear()
 {
 	for (const Info& info : infos) {
 		if (auto ref = info.ref.lock()) {
-			ref->compress(info.size);
+			DeltaBlockCopy::compress(std::move(ref));
 		}
 	}
 	infos.clear();
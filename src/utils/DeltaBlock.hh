@@ -4,7 +4,9 @@
 #define STATISTICS 0
 
 #include "MemBuffer.hh"
+#include "hash_map.hh"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <span>
@@ -15,6 +17,14 @@
 
 namespace openmsx {
 
+class SpillFile;
+
+/** The expensive parts of creating delta blocks (calculating the difference
+  * with the reference block, compressing reference blocks that are no longer
+  * the most recent one) are executed on a background thread. Only the raw
+  * copy of the data is done on the calling thread. Reading a block (apply())
+  * waits till the background work for that block is finished.
+  */
 class DeltaBlock
 {
 public:
@@ -25,8 +35,37 @@ public:
 #endif
 	virtual void apply(std::span<uint8_t> dst) const = 0;
 
+	/** Size of the (uncompressed) data in this block. */
+	[[nodiscard]] size_t getSize() const { return size; }
+
+	/** Number of bytes of memory used by this block. Doesn't include the
+	  * reference block (see getReference()). While this block is still
+	  * being processed in the background, this returns the current usage
+	  * (e.g. the size of the not yet compressed data).
+	  */
+	[[nodiscard]] size_t getMemorySize() const {
+		return memorySize.load(std::memory_order_relaxed);
+	}
+
+	/** The block this block depends on, or nullptr. */
+	[[nodiscard]] virtual const DeltaBlock* getReference() const { return nullptr; }
+
+	/** Wait till all background work on this block is done. */
+	void waitReady() const;
+
+	/** Wait till all background work (on all blocks) is done. */
+	static void waitAllReady();
+
 protected:
-	DeltaBlock() = default;
+	explicit DeltaBlock(size_t size_)
+		: size(size_), memorySize(size_) {}
+
+	const size_t size;
+	std::atomic<size_t> memorySize;
+
+private:
+	friend class DeltaBlockWorker;
+	mutable std::atomic<unsigned> pendingJobs = 0;
 
 #ifdef DEBUG
 public:
@@ -46,11 +85,17 @@ class DeltaBlockCopy final : public DeltaBlock
 public:
 	explicit DeltaBlockCopy(std::span<const uint8_t> data);
 	void apply(std::span<uint8_t> dst) const override;
-	void compress(size_t size);
+
+	/** Compress the given block in the background. */
+	static void compress(std::shared_ptr<DeltaBlockCopy> block);
+
 	[[nodiscard]] const uint8_t* getData();
 
 private:
+	friend class DeltaBlockSpilled;
 	[[nodiscard]] bool compressed() const { return compressedSize != 0; }
+	void compressNow();
+	void applyNow(std::span<uint8_t> dst) const;
 
 	MemBuffer<uint8_t> block;
 	size_t compressedSize = 0;
@@ -60,14 +105,91 @@ private:
 class DeltaBlockDiff final : public DeltaBlock
 {
 public:
+	/** Use create(), the delta is calculated in the background. */
 	DeltaBlockDiff(std::shared_ptr<DeltaBlockCopy> prev_,
 	               std::span<const uint8_t> data);
+	[[nodiscard]] static std::shared_ptr<DeltaBlockDiff> create(
+		std::shared_ptr<DeltaBlockCopy> prev, std::span<const uint8_t> data);
+
 	void apply(std::span<uint8_t> dst) const override;
+	[[nodiscard]] const DeltaBlock* getReference() const override { return prev.get(); }
 	[[nodiscard]] size_t getDeltaSize() const;
 
+private:
+	friend class DeltaBlockSpilled;
+	friend class SpilledDeltaBlocks;
+	void calcDeltaNow();
+
 private:
 	const std::shared_ptr<DeltaBlockCopy> prev;
-	const std::vector<uint8_t> delta; // TODO could be tweaked to use OutputBuffer
+	MemBuffer<uint8_t> raw; // copy of the data, only until 'delta' is calculated
+	std::vector<uint8_t> delta; // TODO could be tweaked to use OutputBuffer
+};
+
+
+/** A block that's stored in a SpillFile instead of in RAM. A spilled
+  * DeltaBlockCopy is stored (LZ4 compressed) as a whole, a spilled
+  * DeltaBlockDiff is stored as the same delta, against the spilled copy of
+  * its reference block. Writing to the file is done in the background, till
+  * then the original block is kept alive. See SpilledDeltaBlocks.
+  */
+class DeltaBlockSpilled final : public DeltaBlock
+{
+public:
+	DeltaBlockSpilled(std::shared_ptr<DeltaBlock> original,
+	                  std::shared_ptr<DeltaBlockSpilled> prev,
+	                  std::shared_ptr<SpillFile> file);
+	~DeltaBlockSpilled() override;
+	void apply(std::span<uint8_t> dst) const override;
+	[[nodiscard]] const DeltaBlock* getReference() const override { return prev.get(); }
+
+private:
+	friend class SpilledDeltaBlocks;
+	void storeNow();
+
+private:
+	const std::shared_ptr<DeltaBlockSpilled> prev;
+	const std::shared_ptr<SpillFile> file;
+	// Only until it's written to the file (or when that failed).
+	std::shared_ptr<DeltaBlock> original;
+	size_t offset = 0;
+	size_t storedSize = 0;
+	bool compressed = false;
+};
+
+
+/** Moves delta blocks to a SpillFile (created on first use). Blocks that are
+  * spilled more than once (e.g. an unchanged block that's shared between
+  * snapshots, or the reference block of several diff blocks) are only
+  * stored once.
+  */
+class SpilledDeltaBlocks
+{
+public:
+	/** Replace the given blocks by spilled blocks.
+	  * @throws FileException when the spill file can't be created, or when
+	  *         writing to it failed earlier (then the blocks spilled since
+	  *         that error remain in RAM).
+	  */
+	void spill(std::span<std::shared_ptr<DeltaBlock>> blocks);
+
+	/** Forget which blocks were spilled. The file is removed when the
+	  * last spilled block is gone. */
+	void clear();
+
+	/** Bytes in use in the spill file. */
+	[[nodiscard]] size_t getSize() const;
+
+private:
+	[[nodiscard]] std::shared_ptr<DeltaBlockSpilled> spill(const std::shared_ptr<DeltaBlock>& block);
+
+private:
+	struct Entry {
+		std::weak_ptr<DeltaBlock> original; // to detect a reused address
+		std::weak_ptr<DeltaBlockSpilled> spilled;
+	};
+	hash_map<const DeltaBlock*, Entry> entries;
+	std::shared_ptr<SpillFile> file;
 };
 
 
@@ -89,6 +211,10 @@ private:
 		size_t size;
 		std::weak_ptr<DeltaBlockCopy> ref;
 		std::weak_ptr<DeltaBlock> last;
+		// The size of a delta is only known once it's calculated (in
+		// the background), so it's only added to 'accSize' when the
+		// next block (for this id) is created.
+		std::weak_ptr<DeltaBlockDiff> lastDiff;
 		size_t accSize = 0;
 	};
 
@@ -1,9 +1,11 @@
 #ifndef SPSC_RING_BUFFER_HH
 #define SPSC_RING_BUFFER_HH
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <memory>
+#include <span>
 
 namespace openmsx {
 
@@ -20,6 +22,8 @@ namespace openmsx {
  * - Cache line aligned head/tail to prevent false sharing
  * - Fixed capacity (no dynamic resizing)
  * - Non-blocking: tryPush/tryPop return false instead of blocking
+ * - Bulk variants (pushSome/popSome) for streams of small items, like
+ *   audio samples
  *
  * @tparam T Element type (must be movable)
  * @tparam Capacity Maximum number of elements in the buffer
@@ -93,6 +97,51 @@ public:
 		return true;
 	}
 
+	/**
+	 * Push as many items as fit in the queue (producer side).
+	 * @param items The items to push, in order
+	 * @return The number of items that were pushed (a prefix of 'items')
+	 */
+	size_t pushSome(std::span<const T> items) {
+		size_t currentTail = tail.load(std::memory_order_relaxed);
+		size_t currentHead = head.load(std::memory_order_acquire);
+		size_t free = Capacity - 1 - distance(currentHead, currentTail);
+		size_t num = std::min(items.size(), free);
+
+		size_t len1 = std::min(num, Capacity - currentTail);
+		std::copy_n(items.data(), len1, &buffer[currentTail]);
+		std::copy_n(items.data() + len1, num - len1, &buffer[0]);
+		tail.store((currentTail + num) % Capacity, std::memory_order_release);
+		return num;
+	}
+
+	/**
+	 * Pop as many items as are available, up to 'items.size()' (consumer side).
+	 * @param items Output parameter for the popped items
+	 * @return The number of items that were popped (stored at the start of 'items')
+	 */
+	size_t popSome(std::span<T> items) {
+		size_t currentHead = head.load(std::memory_order_relaxed);
+		size_t currentTail = tail.load(std::memory_order_acquire);
+		size_t num = std::min(items.size(), distance(currentHead, currentTail));
+
+		size_t len1 = std::min(num, Capacity - currentHead);
+		std::copy_n(&buffer[currentHead], len1, items.data());
+		std::copy_n(&buffer[0], num - len1, items.data() + len1);
+		head.store((currentHead + num) % Capacity, std::memory_order_release);
+		return num;
+	}
+
+	/**
+	 * Remove all items from the queue.
+	 * Note: Only allowed while neither the producer nor the consumer is
+	 * accessing the queue.
+	 */
+	void clear() {
+		head.store(0, std::memory_order_relaxed);
+		tail.store(0, std::memory_order_relaxed);
+	}
+
 	/**
 	 * Check if the queue is empty.
 	 * Note: This is a snapshot and may change immediately.
@@ -107,9 +156,8 @@ public:
 	 * Note: This is a snapshot and may change immediately.
 	 */
 	[[nodiscard]] size_t size() const {
-		size_t h = head.load(std::memory_order_acquire);
-		size_t t = tail.load(std::memory_order_acquire);
-		return (t >= h) ? (t - h) : (Capacity - h + t);
+		return distance(head.load(std::memory_order_acquire),
+		                tail.load(std::memory_order_acquire));
 	}
 
 	/**
@@ -119,6 +167,10 @@ public:
 	[[nodiscard]] static constexpr size_t capacity() { return Capacity - 1; }
 
 private:
+	[[nodiscard]] static size_t distance(size_t h, size_t t) {
+		return (t >= h) ? (t - h) : (Capacity - h + t);
+	}
+
 	[[nodiscard]] static size_t increment(size_t idx) {
 		return (idx + 1) % Capacity;
 	}
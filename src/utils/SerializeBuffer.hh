@@ -176,9 +176,12 @@ class InputBuffer
 public:
 	/** Construct new InputBuffer, typically the buf_ parameter
 	  * will come from a MemBuffer object.
+	  * When the data comes from an untrusted source (a file), pass
+	  * 'checked_ = true': then reading past the end throws an MSXException
+	  * instead of being a programming error.
 	  */
-	explicit InputBuffer(std::span<const uint8_t> buf_)
-		: buf(buf_) {}
+	explicit InputBuffer(std::span<const uint8_t> buf_, bool checked_ = false)
+		: buf(buf_), checked(checked_) {}
 
 	/** Read the given number of bytes.
 	  * This 'consumes' the read bytes, so a future read() will continue
@@ -186,7 +189,7 @@ public:
 	  */
 	void read(void* __restrict result, size_t len)
 	{
-		assert(buf.size() >= len);
+		check(len);
 		memcpy(result, buf.data(), len);
 		buf = buf.subspan(len);
 	}
@@ -197,10 +200,22 @@ public:
 	  */
 	void skip(size_t len)
 	{
-		assert(buf.size() >= len);
+		check(len);
 		buf = buf.subspan(len);
 	}
 
+	/** Verify that (at least) the given number of bytes remain. E.g. to
+	  * verify a size before allocating memory for it.
+	  */
+	void check(size_t len) const
+	{
+		if (checked) {
+			if (buf.size() < len) [[unlikely]] throwOverrun();
+		} else {
+			assert(buf.size() >= len);
+		}
+	}
+
 	/** Return a pointer to the current position in the buffer.
 	  * This is useful if you don't want to copy the data, but e.g. use it
 	  * as input for an uncompress algorithm. You can later use skip() to
@@ -208,8 +223,12 @@ public:
 	  */
 	[[nodiscard]] const uint8_t* getCurrentPos() const { return buf.data(); }
 
+private:
+	[[noreturn]] static void throwOverrun();
+
 private:
 	std::span<const uint8_t> buf;
+	bool checked;
 };
 
 } // namespace openmsx
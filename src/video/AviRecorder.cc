@@ -2,6 +2,7 @@
 
 #include "AviWriter.hh"
 #include "PostProcessor.hh"
+#include "RawAVWriter.hh"
 
 #include "CliComm.hh"
 #include "CommandException.hh"
@@ -9,12 +10,15 @@
 #include "FileContext.hh"
 #include "FileOperations.hh"
 #include "Filename.hh"
+#include "GlobalSettings.hh"
 #include "MSXMixer.hh"
 #include "MSXMotherBoard.hh"
 #include "Mixer.hh"
 #include "Reactor.hh"
 #include "TclArgParser.hh"
 #include "TclObject.hh"
+#include "ThrottleManager.hh"
+#include "VDP.hh"
 #include "WavWriter.hh"
 
 #include "Math.hh"
@@ -22,9 +26,11 @@
 #include "narrow.hh"
 #include "outer.hh"
 #include "small_buffer.hh"
+#include "strCat.hh"
 
 #include <array>
 #include <cassert>
+#include <cmath>
 #include <memory>
 
 namespace openmsx {
@@ -40,11 +46,13 @@ AviRecorder::AviRecorder(Reactor& reactor_)
 AviRecorder::~AviRecorder()
 {
 	assert(!aviWriter);
+	assert(!rawWriter);
 	assert(!wavWriter);
 }
 
 void AviRecorder::start(bool recordAudio, bool recordVideo, bool recordMono,
-                        bool recordStereo, const Filename& filename)
+                        bool recordStereo, const Filename& filename,
+                        bool raw, const Filename& rawAudioFilename)
 {
 	stop();
 	MSXMotherBoard* motherBoard = reactor.getMotherBoard();
@@ -85,9 +93,22 @@ void AviRecorder::start(bool recordAudio, bool recordVideo, bool recordMono,
 		prevTime = EmuTime::infinity();
 
 		try {
-			aviWriter = std::make_unique<AviWriter>(
-				filename, frameWidth, frameHeight,
-				(recordAudio && stereo) ? 2 : 1, sampleRate);
+			if (raw) {
+				// The y4m header is written right away, so take
+				// the frame rate from the VDP (frame skip is off
+				// while recording). A change is warned about.
+				float fps = 60.0f;
+				if (auto* vdp = dynamic_cast<VDP*>(motherBoard->findDevice("VDP"))) {
+					fps = float(VDP::TICKS_PER_SECOND) / float(vdp->getTicksPerFrame());
+				}
+				rawWriter = std::make_unique<RawAVWriter>(
+					filename, rawAudioFilename,
+					frameWidth, frameHeight, fps, recordAudio);
+			} else {
+				aviWriter = std::make_unique<AviWriter>(
+					filename, frameWidth, frameHeight,
+					(recordAudio && stereo) ? 2 : 1, sampleRate);
+			}
 		} catch (MSXException& e) {
 			throw CommandException("Can't start recording: ",
 			                       e.getMessage());
@@ -116,6 +137,7 @@ void AviRecorder::stop()
 	}
 	sampleRate = 0;
 	aviWriter.reset();
+	rawWriter.reset();
 	wavWriter.reset();
 }
 
@@ -146,7 +168,7 @@ void AviRecorder::addWave(std::span<const StereoFloat> data)
 				buf[2 * i + 0] = float2int16(s.left);
 				buf[2 * i + 1] = float2int16(s.right);
 			}
-			assert(aviWriter);
+			assert(aviWriter || rawWriter);
 			append(audioBuf, std::span{buf});
 		}
 	} else {
@@ -171,7 +193,7 @@ void AviRecorder::addWave(std::span<const StereoFloat> data)
 		if (wavWriter) {
 			wavWriter->write(buf);
 		} else {
-			assert(aviWriter);
+			assert(aviWriter || rawWriter);
 			append(audioBuf, std::span{buf});
 		}
 	}
@@ -190,14 +212,31 @@ void AviRecorder::addImage(const FrameSource* frame, EmuTime time)
 		}
 	} else if (prevTime != EmuTime::infinity()) {
 		duration = time - prevTime;
-		aviWriter->setFps(narrow_cast<float>(1.0 / duration.toDouble()));
+		auto fps = narrow_cast<float>(1.0 / duration.toDouble());
+		if (aviWriter) aviWriter->setFps(fps);
+		if (rawWriter && (std::abs(fps - rawWriter->getFps()) > 0.01f)) {
+			warnedFps = true;
+			reactor.getCliComm().printWarning(
+				"Frame rate (", fps, "Hz) differs from the one in "
+				"the y4m header (", rawWriter->getFps(), "Hz). "
+				"Audio/video might get out of sync because of this.");
+		}
 	}
 	prevTime = time;
 
 	if (mixer) {
 		mixer->updateStream(time);
 	}
-	aviWriter->addFrame(frame, audioBuf);
+	if (rawWriter) {
+		rawWriter->addFrame(frame, audioBuf);
+	} else {
+		// Only during real-time play it's better to drop a frame than
+		// to slow down the emulation. Not when fast-forwarding (not
+		// throttled), nor when the mixer is in synchronous mode.
+		bool realTime = reactor.getGlobalSettings().getThrottleManager().isThrottled() &&
+		                !(mixer && mixer->isSynchronousMode());
+		aviWriter->addFrame(frame, audioBuf, realTime);
+	}
 	audioBuf.clear();
 }
 
@@ -216,6 +255,8 @@ void AviRecorder::processStart(Interpreter& interp, std::span<const TclObject> t
 	bool recordStereo = false;
 	bool doubleSize   = false;
 	bool tripleSize   = false;
+	bool raw          = false;
+	std::string_view audioFileArg;
 	std::array info = {
 		valueArg("-prefix", prefix),
 		flagArg("-audioonly", audioOnly),
@@ -224,6 +265,8 @@ void AviRecorder::processStart(Interpreter& interp, std::span<const TclObject> t
 		flagArg("-stereo",    recordStereo),
 		flagArg("-doublesize", doubleSize),
 		flagArg("-triplesize", tripleSize),
+		flagArg("-raw",        raw),
+		valueArg("-audiofile", audioFileArg),
 	};
 	auto arguments = parseTclArgs(interp, tokens.subspan(2), info);
 
@@ -239,6 +282,12 @@ void AviRecorder::processStart(Interpreter& interp, std::span<const TclObject> t
 	if (videoOnly && (recordStereo || recordMono)) {
 		throw CommandException("Can't have both -videoonly and -stereo or -mono.");
 	}
+	if (raw && audioOnly) {
+		throw CommandException("Can't have both -raw and -audioonly.");
+	}
+	if (!audioFileArg.empty() && (!raw || videoOnly)) {
+		throw CommandException("-audiofile can only be used with -raw (and without -videoonly).");
+	}
 	std::string_view filenameArg;
 	switch (arguments.size()) {
 	case 0:
@@ -263,16 +312,38 @@ void AviRecorder::processStart(Interpreter& interp, std::span<const TclObject> t
 	bool recordAudio = !videoOnly;
 	bool recordVideo = !audioOnly;
 	std::string_view directory = recordVideo ? VIDEO_DIR : AUDIO_DIR;
-	std::string_view extension = recordVideo ? VIDEO_EXTENSION : AUDIO_EXTENSION;
+	std::string_view extension = raw ? RAW_VIDEO_EXTENSION
+	                           : recordVideo ? VIDEO_EXTENSION : AUDIO_EXTENSION;
 	auto filename = FileOperations::parseCommandFileArgument(
 		filenameArg, directory, prefix, extension);
+	std::string audioFilename;
+	if (raw && recordAudio) {
+		if (audioFileArg.empty()) {
+			// same name as the video stream, but with .pcm extension
+			std::string_view base = filename;
+			if (base.ends_with(RAW_VIDEO_EXTENSION)) {
+				base.remove_suffix(RAW_VIDEO_EXTENSION.size());
+			}
+			audioFilename = strCat(base, RAW_AUDIO_EXTENSION);
+		} else {
+			audioFilename = FileOperations::parseCommandFileArgument(
+				audioFileArg, directory, prefix, RAW_AUDIO_EXTENSION);
+		}
+	}
 
-	if (aviWriter || wavWriter) {
+	if (isRecording()) {
 		result = "Already recording.";
 	} else {
 		start(recordAudio, recordVideo, recordMono, recordStereo,
-				Filename(filename));
-		result = tmpStrCat("Recording to ", filename);
+		      Filename(filename), raw, Filename(audioFilename));
+		if (audioFilename.empty()) {
+			result = tmpStrCat("Recording to ", filename);
+		} else {
+			result = tmpStrCat("Recording video to ", filename,
+			                   " and audio (signed 16-bit little endian, ",
+			                   stereo ? "stereo" : "mono", ", ", sampleRate,
+			                   "Hz) to ", audioFilename);
+		}
 	}
 }
 
@@ -283,7 +354,7 @@ void AviRecorder::processStop(std::span<const TclObject> /*tokens*/)
 
 void AviRecorder::processToggle(Interpreter& interp, std::span<const TclObject> tokens, TclObject& result)
 {
-	if (aviWriter || wavWriter) {
+	if (isRecording()) {
 		// drop extra tokens
 		processStop(tokens.first<2>());
 	} else {
@@ -293,12 +364,18 @@ void AviRecorder::processToggle(Interpreter& interp, std::span<const TclObject>
 
 bool AviRecorder::isRecording() const
 {
-	return aviWriter || wavWriter;
+	return aviWriter || rawWriter || wavWriter;
 }
 
 void AviRecorder::status(std::span<const TclObject> /*tokens*/, TclObject& result) const
 {
 	result.addDictKeyValue("status", isRecording() ? "recording"sv : "idle"sv);
+	if (aviWriter) {
+		result.addDictKeyValues("queue_depth",    aviWriter->getQueueDepth(),
+		                        "dropped_frames", aviWriter->getDroppedFrames());
+	} else if (rawWriter) {
+		result.addDictKeyValue("queue_depth", rawWriter->getQueueDepth());
+	}
 }
 
 // class AviRecorder::Cmd
@@ -333,12 +410,22 @@ std::string AviRecorder::Cmd::help(std::span<const TclObject> /*tokens*/) const
 	       "record start -prefix foo  Record to file 'fooNNNN.avi'\n"
 	       "record stop               Stop recording\n"
 	       "record toggle             Toggle recording (useful as keybinding)\n"
-	       "record status             Query recording state\n"
+	       "record status             Query recording state (while recording a video\n"
+	       "                          this also shows the number of frames waiting to\n"
+	       "                          be encoded and the number of dropped frames)\n"
 	       "\n"
 	       "The start subcommand also accepts an optional -audioonly, -videoonly, "
 	       " -mono, -stereo, -doublesize, -triplesize flag.\n"
 	       "Videos are recorded in a 320x240 size by default, at 640x480 when the "
-	       "-doublesize flag is used and at 960x720 when the -triplesize flag is used.";
+	       "-doublesize flag is used and at 960x720 when the -triplesize flag is used.\n"
+	       "\n"
+	       "With the -raw flag the video is not compressed but written as a y4m stream, "
+	       "and the audio as raw PCM to a separate file (by default the same name with "
+	       "a .pcm extension, or use -audiofile <filename>). These can be (named) pipes "
+	       "to an external encoder, e.g. 'mkfifo v.y4m a.pcm; ffmpeg -i v.y4m -f s16le "
+	       "-ar 44100 -ac 2 -i a.pcm out.mp4' (the actual audio format is shown when "
+	       "recording starts). Frames are never dropped in this mode, instead emulation "
+	       "waits when the encoder can't keep up.";
 }
 
 void AviRecorder::Cmd::tabCompletion(std::vector<std::string>& tokens) const
@@ -353,7 +440,7 @@ void AviRecorder::Cmd::tabCompletion(std::vector<std::string>& tokens) const
 		static constexpr std::array options = {
 			"-prefix"sv, "-videoonly"sv, "-audioonly"sv,
 			"-doublesize"sv, "-triplesize"sv,
-			"-mono"sv, "-stereo"sv,
+			"-mono"sv, "-stereo"sv, "-raw"sv, "-audiofile"sv,
 		};
 		completeFileName(tokens, userFileContext(), options);
 	}
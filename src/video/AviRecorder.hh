@@ -18,6 +18,7 @@ class FrameSource;
 class Interpreter;
 class MSXMixer;
 class PostProcessor;
+class RawAVWriter;
 class Reactor;
 class TclObject;
 class Wav16Writer;
@@ -29,6 +30,8 @@ public:
 	static constexpr std::string_view AUDIO_DIR = "soundlogs";
 	static constexpr std::string_view VIDEO_EXTENSION = ".avi";
 	static constexpr std::string_view AUDIO_EXTENSION = ".wav";
+	static constexpr std::string_view RAW_VIDEO_EXTENSION = ".y4m";
+	static constexpr std::string_view RAW_AUDIO_EXTENSION = ".pcm";
 
 public:
 	explicit AviRecorder(Reactor& reactor);
@@ -42,7 +45,8 @@ public:
 
 private:
 	void start(bool recordAudio, bool recordVideo, bool recordMono,
-		   bool recordStereo, const Filename& filename);
+		   bool recordStereo, const Filename& filename,
+		   bool raw, const Filename& rawAudioFilename);
 	void status(std::span<const TclObject> tokens, TclObject& result) const;
 
 	void processStart (Interpreter& interp, std::span<const TclObject> tokens, TclObject& result);
@@ -61,6 +65,7 @@ private:
 
 	std::vector<int16_t> audioBuf;
 	std::unique_ptr<AviWriter>   aviWriter; // can be nullptr
+	std::unique_ptr<RawAVWriter> rawWriter; // can be nullptr
 	std::unique_ptr<Wav16Writer> wavWriter; // can be nullptr
 	std::vector<PostProcessor*> postProcessors;
 	MSXMixer* mixer = nullptr;
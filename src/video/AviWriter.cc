@@ -18,6 +18,7 @@
 #include <cassert>
 #include <cstring>
 #include <ctime>
+#include <iterator>
 #include <limits>
 
 namespace openmsx {
@@ -37,10 +38,20 @@ AviWriter::AviWriter(const Filename& filename, unsigned width_,
 	file.write(dummy);
 
 	index.resize(2);
+
+	thread = std::thread([this] { encoderLoop(); });
 }
 
 AviWriter::~AviWriter()
 {
+	// finish encoding all queued frames
+	{
+		std::scoped_lock lock(mutex);
+		quit = true;
+	}
+	condition.notify_one();
+	thread.join();
+
 	if (written == 0) {
 		// no data written yet (a recording less than one video frame)
 		std::string filename = file.getURL();
@@ -274,12 +285,107 @@ void AviWriter::addAviChunk(std::span<const char, 4> tag, std::span<const uint8_
 	index[idxSize + 3] = size32;
 }
 
-void AviWriter::addFrame(const FrameSource* video, std::span<const int16_t> audio)
+void AviWriter::addFrame(const FrameSource* video, std::span<const int16_t> audio,
+                         bool mayDrop)
+{
+	std::unique_ptr<Frame> frame;
+	bool drop;
+	{
+		std::unique_lock lock(mutex);
+		auto full = [&] { return (queue.size() + busy) >= MAX_QUEUED_FRAMES; };
+		if (!mayDrop) {
+			// back-pressure: wait till the encoder catches up
+			condition.wait(lock, [&] { return error || !full(); });
+		}
+		if (error) {
+			throw MSXException(*error);
+		}
+		drop = full();
+		if (drop) {
+			++dropped;
+		}
+		if (!freeFrames.empty()) {
+			frame = std::move(freeFrames.back());
+			freeFrames.pop_back();
+		}
+	}
+	if (!frame) frame = std::make_unique<Frame>();
+
+	// Copy the frame now, 'video' gets reused as soon as we return.
+	if (drop) {
+		frame->pixels.clear();
+	} else {
+		frame->pixels.resize(size_t(width) * height);
+		codec.scaleFrame(video, frame->pixels);
+	}
+	frame->audio.assign(audio.begin(), audio.end());
+
+	{
+		std::scoped_lock lock(mutex);
+		queue.push_back(std::move(frame));
+	}
+	condition.notify_all();
+}
+
+unsigned AviWriter::getQueueDepth() const
 {
-	bool keyFrame = (frames++ % 300 == 0);
-	auto buffer = codec.compressFrame(keyFrame, video);
-	addAviChunk(subspan<4>("00dc"), buffer, keyFrame ? 0x10 : 0x0);
+	std::scoped_lock lock(mutex);
+	return narrow<unsigned>(queue.size()) + busy;
+}
+
+unsigned AviWriter::getDroppedFrames() const
+{
+	std::scoped_lock lock(mutex);
+	return dropped;
+}
+
+void AviWriter::encoderLoop()
+{
+	while (true) {
+		std::unique_ptr<Frame> frame;
+		{
+			std::unique_lock lock(mutex);
+			condition.wait(lock, [&] { return quit || !queue.empty(); });
+			if (queue.empty()) return; // quit, and all frames are written
+			frame = std::move(queue.front());
+			queue.pop_front();
+			++busy;
+		}
+		std::optional<std::string> err;
+		try {
+			writeFrame(*frame);
+		} catch (MSXException& e) {
+			err = e.getMessage();
+		}
+		{
+			std::scoped_lock lock(mutex);
+			--busy;
+			freeFrames.push_back(std::move(frame));
+			if (err) {
+				// Reported in the next addFrame() call. Drop the
+				// remaining frames, the file is broken anyway.
+				error = std::move(err);
+				std::ranges::move(queue, std::back_inserter(freeFrames));
+				queue.clear();
+			}
+		}
+		condition.notify_all(); // room in the queue
+	}
+}
+
+void AviWriter::writeFrame(const Frame& frame)
+{
+	++frames;
+	if (frame.pixels.empty()) {
+		// dropped frame: an empty chunk repeats the previous frame
+		addAviChunk(subspan<4>("00dc"), {}, 0x0);
+	} else {
+		bool keyFrame = (encodedFrames++ % 300 == 0);
+		auto buffer = codec.compressFrame(keyFrame, frame.pixels);
+		addAviChunk(subspan<4>("00dc"), buffer, keyFrame ? 0x10 : 0x0);
+	}
 
+	std::span<const int16_t> audio = frame.audio;
 	if (!audio.empty()) {
 		assert((audio.size() % channels) == 0);
 		assert(audioRate != 0);
@@ -9,8 +9,15 @@
 
 #include "endian.hh"
 
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <span>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace openmsx {
@@ -18,16 +25,53 @@ namespace openmsx {
 class Filename;
 class FrameSource;
 
+/** Writes ZMBV compressed video (plus optional 16-bit PCM audio) to an avi
+  * file.
+  *
+  * Compressing a frame is relatively expensive, so that's done on a separate
+  * encoder thread. addFrame() only makes a (scaled) copy of the frame and
+  * puts it in a bounded queue. When the encoder can't keep up and the queue
+  * is full, addFrame() blocks until there is room. Only when the caller
+  * allows it (during real-time play, see AviRecorder), the video frame is
+  * dropped instead: then an empty video chunk (which means 'repeat the
+  * previous frame') is written. The audio data is never dropped, so audio
+  * and video remain in sync.
+  */
 class AviWriter
 {
 public:
+	static constexpr size_t MAX_QUEUED_FRAMES = 8;
+
 	AviWriter(const Filename& filename, unsigned width, unsigned height,
 	          unsigned channels, unsigned freq);
+	AviWriter(const AviWriter&) = delete;
+	AviWriter(AviWriter&&) = delete;
+	AviWriter& operator=(const AviWriter&) = delete;
+	AviWriter& operator=(AviWriter&&) = delete;
 	~AviWriter();
-	void addFrame(const FrameSource* video, std::span<const int16_t> audio);
+
+	/** Queue a frame for encoding.
+	  * @param mayDrop When the queue is full: drop the video frame (true),
+	  *                or wait for the encoder (false).
+	  * @throws MSXException when an earlier frame could not be written.
+	  */
+	void addFrame(const FrameSource* video, std::span<const int16_t> audio,
+	              bool mayDrop);
 	void setFps(float fps_) { fps = fps_; }
 
+	/** Number of frames that are queued or being encoded right now. */
+	[[nodiscard]] unsigned getQueueDepth() const;
+	/** Number of video frames that were dropped because the queue was full. */
+	[[nodiscard]] unsigned getDroppedFrames() const;
+
 private:
+	struct Frame {
+		std::vector<ZMBVEncoder::Pixel> pixels; // empty for a dropped frame
+		std::vector<int16_t> audio;
+	};
+
+	void encoderLoop();
+	void writeFrame(const Frame& frame);
 	void addAviChunk(std::span<const char, 4> tag, std::span<const uint8_t> data, unsigned flags);
 
 private:
@@ -41,9 +85,25 @@ private:
 	const uint32_t channels;
 	const uint32_t audioRate;
 
+	// Only accessed from the encoder thread (and from the destructor
+	// after that thread has finished).
 	uint32_t frames = 0;
+	uint32_t encodedFrames = 0;
 	uint32_t audioWritten = 0;
 	uint32_t written = 0;
+
+	// Shared between the emulation and the encoder thread, protected by
+	// 'mutex'.
+	mutable std::mutex mutex;
+	std::condition_variable condition; // signals: frame queued, or room in queue, or quit
+	std::deque<std::unique_ptr<Frame>> queue;
+	std::vector<std::unique_ptr<Frame>> freeFrames; // recycled buffers
+	unsigned busy = 0; // number of frames taken from 'queue' but not yet written
+	unsigned dropped = 0;
+	std::optional<std::string> error;
+	bool quit = false;
+
+	std::thread thread; // must be constructed last
 };
 
 } // namespace openmsx
@@ -8,8 +8,13 @@
 
 #include <algorithm>
 #include <bit>
+#include <cstring>
 #include <tuple>
 
+#ifdef __SSE2__
+#include "emmintrin.h" // SSE2
+#endif
+
 namespace openmsx {
 
 BitmapConverter::BitmapConverter(
@@ -37,6 +42,19 @@ void BitmapConverter::calcDPalette()
 	}
 }
 
+void BitmapConverter::calcQPalette()
+{
+	qPaletteValid = true;
+	for (auto i : xrange(256)) {
+		qPalette[i] = {
+			palette16[ 0 +  (i >> 6)     ],
+			palette16[16 + ((i >> 4) & 3)],
+			palette16[ 0 + ((i >> 2) & 3)],
+			palette16[16 + ((i >> 0) & 3)],
+		};
+	}
+}
+
 void BitmapConverter::convertLine(std::span<Pixel> buf, std::span<const uint8_t, 128> vramPtr)
 {
 	switch (mode.getByte()) {
@@ -144,15 +162,23 @@ void BitmapConverter::renderGraphic4(
 
 void BitmapConverter::renderGraphic5(
 	std::span<Pixel, 512> buf,
-	std::span<const uint8_t, 128> vramPtr0) const
+	std::span<const uint8_t, 128> vramPtr0)
 {
+	/*for (auto i : xrange(128)) {
+		unsigned data = vramPtr0[i];
+		buf[4 * i + 0] = palette16[ 0 +  (data >> 6)     ];
+		buf[4 * i + 1] = palette16[16 + ((data >> 4) & 3)];
+		buf[4 * i + 2] = palette16[ 0 + ((data >> 2) & 3)];
+		buf[4 * i + 3] = palette16[16 + ((data >> 0) & 3)];
+	}*/
+	if (!qPaletteValid) [[unlikely]] {
+		calcQPalette();
+	}
+
+	// 4 pixels per byte, copied as one (SSE) word
 	Pixel* __restrict pixelPtr = buf.data();
 	for (auto i : xrange(128)) {
-		unsigned data = vramPtr0[i];
-		pixelPtr[4 * i + 0] = palette16[ 0 +  (data >> 6)     ];
-		pixelPtr[4 * i + 1] = palette16[16 + ((data >> 4) & 3)];
-		pixelPtr[4 * i + 2] = palette16[ 0 + ((data >> 2) & 3)];
-		pixelPtr[4 * i + 3] = palette16[16 + ((data >> 0) & 3)];
+		memcpy(&pixelPtr[4 * i], qPalette[vramPtr0[i]].data(), 4 * sizeof(Pixel));
 	}
 }
 
@@ -227,12 +253,65 @@ static constexpr std::tuple<int, int, int> yjk2rgb(int y, int j, int k)
 	return {r, g, b};
 }
 
+#ifdef __SSE2__
+// Load 8 pixels (2 YJK groups) in display order (alternating between both
+// planes) as 16-bit values.
+static inline __m128i loadYJK(const uint8_t* vramPtr0, const uint8_t* vramPtr1)
+{
+	int32_t d0, d1;
+	memcpy(&d0, vramPtr0, sizeof(d0));
+	memcpy(&d1, vramPtr1, sizeof(d1));
+	__m128i bytes = _mm_unpacklo_epi8(_mm_cvtsi32_si128(d0), _mm_cvtsi32_si128(d1));
+	return _mm_unpacklo_epi8(bytes, _mm_setzero_si128());
+}
+
+// SSE2 version of yjk2rgb() for 8 pixels, returns the palette32768 indices.
+static inline __m128i yjk2index(__m128i p)
+{
+	// K is stored in the lower 3 bits of pixels 0 and 1, J in pixels 2 and
+	// 3 of each group. Combine each pixel with its right neighbour, sign
+	// extend from 6 bits, then broadcast to the 4 pixels of the group.
+	__m128i low = _mm_and_si128(p, _mm_set1_epi16(7));
+	__m128i jk = _mm_or_si128(low, _mm_slli_epi16(_mm_srli_si128(low, 2), 3));
+	jk = _mm_srai_epi16(_mm_slli_epi16(jk, 10), 10);
+	__m128i k = _mm_shufflehi_epi16(_mm_shufflelo_epi16(jk, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+	__m128i j = _mm_shufflehi_epi16(_mm_shufflelo_epi16(jk, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 2, 2, 2));
+	__m128i y = _mm_srli_epi16(p, 3);
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i max = _mm_set1_epi16(31);
+	auto clamp = [&](__m128i v) { return _mm_min_epi16(_mm_max_epi16(v, zero), max); };
+	__m128i r = clamp(_mm_add_epi16(y, j));
+	__m128i g = clamp(_mm_add_epi16(y, k));
+	// (5 * y - 2 * j - k + 2) / 4: the arithmetic shift rounds differently
+	// than the division for negative values, but those get clamped to 0.
+	__m128i b5 = _mm_add_epi16(_mm_slli_epi16(y, 2), y);
+	b5 = _mm_sub_epi16(b5, _mm_add_epi16(_mm_add_epi16(j, j), k));
+	__m128i b = clamp(_mm_srai_epi16(_mm_add_epi16(b5, _mm_set1_epi16(2)), 2));
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 10), _mm_slli_epi16(g, 5)), b);
+}
+#endif
+
 void BitmapConverter::renderYJK(
 	std::span<Pixel, 256> buf,
 	std::span<const uint8_t, 128> vramPtr0,
 	std::span<const uint8_t, 128> vramPtr1) const
 {
 	Pixel* __restrict pixelPtr = buf.data();
+#ifdef __SSE2__
+	// SSE2 version: color conversion for 8 pixels in parallel
+	for (auto i : xrange(32)) {
+		__m128i p = loadYJK(&vramPtr0[4 * i], &vramPtr1[4 * i]);
+		alignas(16) std::array<uint16_t, 8> idx;
+		_mm_store_si128(std::bit_cast<__m128i*>(idx.data()), yjk2index(p));
+		for (auto n : xrange(8)) {
+			pixelPtr[8 * i + n] = palette32768[idx[n]];
+		}
+	}
+	return;
+#endif
+
+	// C++ version
 	for (auto i : xrange(64)) {
 		std::array<unsigned, 4> p = {
 			vramPtr0[2 * i + 0],
@@ -258,6 +337,24 @@ void BitmapConverter::renderYAE(
 	std::span<const uint8_t, 128> vramPtr1) const
 {
 	Pixel* __restrict pixelPtr = buf.data();
+#ifdef __SSE2__
+	// SSE2 version: color conversion for 8 pixels in parallel
+	for (auto i : xrange(32)) {
+		__m128i p = loadYJK(&vramPtr0[4 * i], &vramPtr1[4 * i]);
+		alignas(16) std::array<uint16_t, 8> data;
+		alignas(16) std::array<uint16_t, 8> idx;
+		_mm_store_si128(std::bit_cast<__m128i*>(data.data()), p);
+		_mm_store_si128(std::bit_cast<__m128i*>(idx.data()), yjk2index(p));
+		for (auto n : xrange(8)) {
+			pixelPtr[8 * i + n] = (data[n] & 0x08)
+			                    ? palette16[data[n] >> 4] // YAE
+			                    : palette32768[idx[n]]; // YJK
+		}
+	}
+	return;
+#endif
+
+	// C++ version
 	for (auto i : xrange(64)) {
 		std::array<unsigned, 4> p = {
 			vramPtr0[2 * i + 0],
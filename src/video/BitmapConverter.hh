@@ -78,15 +78,17 @@ public:
 	void palette16Changed()
 	{
 		dPaletteValid = false;
+		qPaletteValid = false;
 	}
 
 private:
 	void calcDPalette();
+	void calcQPalette();
 
 	void renderGraphic4(std::span<Pixel, 256> buf,
 	                    std::span<const uint8_t, 128> vramPtr0);
 	void renderGraphic5(std::span<Pixel, 512> buf,
-	                    std::span<const uint8_t, 128> vramPtr0) const;
+	                    std::span<const uint8_t, 128> vramPtr0);
 	void renderGraphic6(std::span<Pixel, 512> buf,
 	                    std::span<const uint8_t, 128> vramPtr0,
 	                    std::span<const uint8_t, 128> vramPtr1);
@@ -107,8 +109,10 @@ private:
 	std::span<const Pixel, 32768>  palette32768;
 
 	std::array<DPixel, 16 * 16> dPalette;
+	std::array<std::array<Pixel, 4>, 256> qPalette; // Graphic5: 1 byte -> 4 pixels
 	DisplayMode mode;
 	bool dPaletteValid = false;
+	bool qPaletteValid = false;
 };
 
 } // namespace openmsx
@@ -19,7 +19,9 @@
 #include "HardwareConfig.hh"
 #include "IntegerSetting.hh"
 #include "MSXMotherBoard.hh"
+#include "Mixer.hh"
 #include "Reactor.hh"
+#include "RealTime.hh"
 #include "TclArgParser.hh"
 #include "Timer.hh"
 #include "Version.hh"
@@ -43,6 +45,7 @@ namespace openmsx {
 Display::Display(Reactor& reactor_)
 	: RTSchedulable(reactor_.getRTScheduler())
 	, screenShotCmd(reactor_.getCommandController())
+	, frameTelemetryCmd(reactor_.getCommandController())
 	, fpsInfo(reactor_.getOpenMSXInfoCommand())
 	, osdGui(reactor_.getCommandController(), *this)
 	, reactor(reactor_)
@@ -160,6 +163,8 @@ bool Display::signalEvent(const Event& event)
 			if (e.needRender()) {
 				repaint();
 				reactor.getEventDistributor().distributeEvent(FrameDrawnEvent());
+			} else if (e.isSkipped() && (e.getSource() == e.getSelectedSource())) {
+				frameTelemetry.frameSkipped();
 			}
 		},
 		[&](const SwitchRendererEvent& e) {
@@ -343,8 +348,19 @@ void Display::repaintImpl()
 	if (!renderFrozen) {
 		assert(videoSystem);
 		if (OutputSurface* surface = videoSystem->getOutputSurface()) {
+			auto renderStart = Timer::getTime();
 			repaintImpl(*surface);
+			auto presentStart = Timer::getTime();
 			videoSystem->flush();
+			auto end = Timer::getTime();
+
+			int64_t drift = 0;
+			if (auto* board = reactor.getMotherBoard()) {
+				drift = board->getRealTime().getSyncDrift(board->getCurrentTime());
+			}
+			frameTelemetry.frameEnd(renderStart, presentStart, end,
+			                        reactor.getMixer().getBufferedTime(),
+			                        narrow_cast<float>(drift) * 0.001f);
 		}
 	}
 
@@ -516,6 +532,88 @@ std::string Display::ScreenShotCmd::help(std::span<const TclObject> /*tokens*/)
 }
 
 
+// FrameTelemetryCmd
+
+Display::FrameTelemetryCmd::FrameTelemetryCmd(CommandController& commandController_)
+	: Command(commandController_, "frame_telemetry")
+{
+}
+
+void Display::FrameTelemetryCmd::execute(std::span<const TclObject> tokens, TclObject& result)
+{
+	checkNumArgs(tokens, Between{1, 2}, "?count|summary|clear?");
+	auto& telemetry = OUTER(Display, frameTelemetryCmd).frameTelemetry;
+	size_t count = FrameTelemetry::CAPACITY;
+	if (tokens.size() == 2) {
+		auto arg = tokens[1].getString();
+		if (arg == "clear") {
+			telemetry.clear();
+			return;
+		} else if (arg == "summary") {
+			auto frames = telemetry.getFrames();
+			auto summary = FrameTelemetry::summarize(frames);
+			auto stat = [](const FrameTelemetry::Stat& st) {
+				return makeTclDict("min", st.min, "avg", st.avg, "max", st.max);
+			};
+			result.addDictKeyValues("frames",       narrow<unsigned>(summary.frames),
+			                        "skipped",      summary.skipped,
+			                        "interval",     stat(summary.interval),
+			                        "emulation",    stat(summary.emulation),
+			                        "sleep",        stat(summary.sleep),
+			                        "render",       stat(summary.render),
+			                        "present",      stat(summary.present),
+			                        "audio_buffer", stat(summary.audioBuffer),
+			                        "sync_drift",   stat(summary.syncDrift));
+			return;
+		}
+		auto n = tokens[1].getInt(getInterpreter());
+		if (n < 0) throw CommandException("Count must be non-negative");
+		count = size_t(n);
+	}
+	for (const auto& f : telemetry.getFrames(count)) {
+		result.addListElement(makeTclDict(
+			"time",         double(f.time) * 1e-6,
+			"interval",     f.interval,
+			"emulation",    f.emulation,
+			"sleep",        f.sleep,
+			"render",       f.render,
+			"present",      f.present,
+			"audio_buffer", f.audioBuffer,
+			"sync_drift",   f.syncDrift,
+			"skipped",      f.skipped));
+	}
+}
+
+std::string Display::FrameTelemetryCmd::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Shows where the time went for the most recently painted frames "
+	       "(at most 256), to tune settings like 'maxframeskip' or the "
+	       "sound buffer size.\n"
+	       "  frame_telemetry [<count>]  list of dicts, oldest frame first\n"
+	       "  frame_telemetry summary    min/avg/max of each field\n"
+	       "  frame_telemetry clear      forget all frames\n"
+	       "All values are in milliseconds, except 'time' (host time in "
+	       "seconds) and 'skipped':\n"
+	       "  interval      since the previous frame was shown\n"
+	       "  emulation     emulating (and handling events) in that interval\n"
+	       "  sleep         sleeping to stay in sync with real time\n"
+	       "  render        painting all layers\n"
+	       "  present       showing the result, e.g. waiting for vsync\n"
+	       "  audio_buffer  sound buffered for the host sound output\n"
+	       "  sync_drift    emulation ahead (>0) or behind (<0) real time\n"
+	       "  skipped       MSX frames not painted since the previous frame\n";
+}
+
+void Display::FrameTelemetryCmd::tabCompletion(std::vector<std::string>& tokens) const
+{
+	using namespace std::literals;
+	if (tokens.size() == 2) {
+		static constexpr std::array options = {"summary"sv, "clear"sv};
+		completeString(tokens, options);
+	}
+}
+
+
 // FpsInfoTopic
 
 Display::FpsInfoTopic::FpsInfoTopic(InfoCommand& openMSXInfoCommand)
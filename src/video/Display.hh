@@ -1,6 +1,7 @@
 #ifndef DISPLAY_HH
 #define DISPLAY_HH
 
+#include "FrameTelemetry.hh"
 #include "RenderSettings.hh"
 
 #include "Command.hh"
@@ -85,6 +86,8 @@ public:
 	// Get the latest fps value
 	[[nodiscard]] float getFps() const;
 
+	[[nodiscard]] FrameTelemetry& getFrameTelemetry() { return frameTelemetry; }
+
 private:
 	void resetVideoSystem();
 
@@ -117,12 +120,21 @@ private:
 	uint64_t frameDurationSum;
 	uint64_t prevTimeStamp;
 
+	FrameTelemetry frameTelemetry;
+
 	struct ScreenShotCmd final : Command {
 		explicit ScreenShotCmd(CommandController& commandController);
 		void execute(std::span<const TclObject> tokens, TclObject& result) override;
 		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
 	} screenShotCmd;
 
+	struct FrameTelemetryCmd final : Command {
+		explicit FrameTelemetryCmd(CommandController& commandController);
+		void execute(std::span<const TclObject> tokens, TclObject& result) override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} frameTelemetryCmd;
+
 	struct FpsInfoTopic final : InfoTopic {
 		explicit FpsInfoTopic(InfoCommand& openMSXInfoCommand);
 		void execute(std::span<const TclObject> tokens,
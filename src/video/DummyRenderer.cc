@@ -68,6 +68,9 @@ void DummyRenderer::updateMultiPage(bool /*multiPage*/, EmuTime /*time*/) {
 void DummyRenderer::updateHorizontalAdjust(int /*adjust*/, EmuTime /*time*/) {
 }
 
+void DummyRenderer::updateLineZero(int /*lineZero*/, EmuTime /*time*/) {
+}
+
 void DummyRenderer::updateDisplayEnabled(bool /*enabled*/, EmuTime /*time*/) {
 }
 
@@ -86,6 +89,15 @@ void DummyRenderer::updateColorBase(unsigned /*addr*/, EmuTime /*time*/) {
 void DummyRenderer::updateSpritesEnabled(bool /*enabled*/, EmuTime /*time*/) {
 }
 
+void DummyRenderer::updateSpriteAttributeBase(unsigned /*addr*/, EmuTime /*time*/) {
+}
+
+void DummyRenderer::updateSpritePatternBase(unsigned /*addr*/, EmuTime /*time*/) {
+}
+
+void DummyRenderer::updateSpriteSizeMag(uint8_t /*sizeMag*/, EmuTime /*time*/) {
+}
+
 void DummyRenderer::updateVRAM(unsigned /*offset*/, EmuTime /*time*/) {
 }
 
@@ -34,12 +34,16 @@ public:
 	void updateBorderMask(bool masked, EmuTime time) override;
 	void updateMultiPage(bool multiPage, EmuTime time) override;
 	void updateHorizontalAdjust(int adjust, EmuTime time) override;
+	void updateLineZero(int lineZero, EmuTime time) override;
 	void updateDisplayEnabled(bool enabled, EmuTime time) override;
 	void updateDisplayMode(DisplayMode mode, EmuTime time) override;
 	void updateNameBase(unsigned addr, EmuTime time) override;
 	void updatePatternBase(unsigned addr, EmuTime time) override;
 	void updateColorBase(unsigned addr, EmuTime time) override;
 	void updateSpritesEnabled(bool enabled, EmuTime time) override;
+	void updateSpriteAttributeBase(unsigned addr, EmuTime time) override;
+	void updateSpritePatternBase(unsigned addr, EmuTime time) override;
+	void updateSpriteSizeMag(uint8_t sizeMag, EmuTime time) override;
 	void updateVRAM(unsigned offset, EmuTime time) override;
 	void updateWindow(bool enabled, EmuTime time) override;
 
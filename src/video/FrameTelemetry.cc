@@ -0,0 +1,83 @@
+#include "FrameTelemetry.hh"
+
+#include <algorithm>
+#include <limits>
+
+namespace openmsx {
+
+void FrameTelemetry::frameEnd(uint64_t renderStart, uint64_t presentStart, uint64_t end,
+                              float audioBuffer, float syncDrift)
+{
+	if (prevEnd == 0 || prevEnd > renderStart) prevEnd = renderStart; // first frame
+	auto ms = [](uint64_t us) { return float(us) * 0.001f; };
+	auto busy = renderStart - prevEnd;
+	auto slept = std::min(sleepSum, busy);
+	Frame frame{
+		.time = end,
+		.interval = ms(end - prevEnd),
+		.emulation = ms(busy - slept),
+		.sleep = ms(slept),
+		.render = ms(presentStart - renderStart),
+		.present = ms(end - presentStart),
+		.audioBuffer = audioBuffer,
+		.syncDrift = syncDrift,
+		.skipped = skippedCount,
+	};
+	prevEnd = end;
+	sleepSum = 0;
+	skippedCount = 0;
+
+	std::scoped_lock lock(mutex);
+	if (frames.full()) frames.pop_front();
+	frames.push_back(frame);
+}
+
+std::vector<FrameTelemetry::Frame> FrameTelemetry::getFrames(size_t max) const
+{
+	std::scoped_lock lock(mutex);
+	auto num = std::min(max, frames.size());
+	std::vector<Frame> result;
+	result.reserve(num);
+	for (auto i = frames.size() - num; i < frames.size(); ++i) {
+		result.push_back(frames[i]);
+	}
+	return result;
+}
+
+void FrameTelemetry::clear()
+{
+	std::scoped_lock lock(mutex);
+	frames.clear();
+}
+
+FrameTelemetry::Summary FrameTelemetry::summarize(std::span<const Frame> frames)
+{
+	Summary result;
+	result.frames = frames.size();
+	if (frames.empty()) return result;
+
+	auto stat = [&](float Frame::*field) {
+		Stat s{.min = std::numeric_limits<float>::max(),
+		       .avg = 0.0f,
+		       .max = std::numeric_limits<float>::lowest()};
+		for (const auto& f : frames) {
+			auto v = f.*field;
+			s.min = std::min(s.min, v);
+			s.max = std::max(s.max, v);
+			s.avg += v;
+		}
+		s.avg /= float(frames.size());
+		return s;
+	};
+	result.interval    = stat(&Frame::interval);
+	result.emulation   = stat(&Frame::emulation);
+	result.sleep       = stat(&Frame::sleep);
+	result.render      = stat(&Frame::render);
+	result.present     = stat(&Frame::present);
+	result.audioBuffer = stat(&Frame::audioBuffer);
+	result.syncDrift   = stat(&Frame::syncDrift);
+	for (const auto& f : frames) result.skipped += f.skipped;
+	return result;
+}
+
+} // namespace openmsx
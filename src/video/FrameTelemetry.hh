@@ -0,0 +1,94 @@
+#ifndef FRAMETELEMETRY_HH
+#define FRAMETELEMETRY_HH
+
+#include "CircularBuffer.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace openmsx {
+
+/** Records, for the last CAPACITY frames painted on the host, where the
+  * time went (emulation, sleeping, rendering, presenting) together with the
+  * state of the audio buffer and of the real time synchronization. This is
+  * meant to tune things like 'maxframeskip' or the sound buffer size by
+  * measurement instead of by ear. See 'frame_telemetry', the '/telemetry'
+  * page of the debug HTTP server and the 'Frame telemetry' ImGui window.
+  *
+  * The record methods are called from the main thread, the frames can be
+  * retrieved from any thread.
+  */
+class FrameTelemetry
+{
+public:
+	static constexpr size_t CAPACITY = 256;
+
+	/** All durations are in milliseconds. */
+	struct Frame {
+		uint64_t time = 0;       // host time (us) when the frame was presented
+		float interval = 0.0f;   // since the previous frame was presented
+		float emulation = 0.0f;  // emulation (and event handling) in that interval
+		float sleep = 0.0f;      // sleeping to stay in sync with real time
+		float render = 0.0f;     // painting all layers
+		float present = 0.0f;    // VideoSystem::flush(), e.g. waiting for vsync
+		float audioBuffer = 0.0f; // sound buffered for the host sound output
+		float syncDrift = 0.0f;  // emulation ahead (>0) or behind (<0) real time
+		unsigned skipped = 0;    // MSX frames not painted since the previous frame
+	};
+
+	struct Stat {
+		float min = 0.0f;
+		float avg = 0.0f;
+		float max = 0.0f;
+	};
+	struct Summary {
+		size_t frames = 0;
+		unsigned skipped = 0; // total
+		Stat interval, emulation, sleep, render, present, audioBuffer, syncDrift;
+	};
+
+	FrameTelemetry() = default;
+	FrameTelemetry(const FrameTelemetry&) = delete;
+	FrameTelemetry(FrameTelemetry&&) = delete;
+	FrameTelemetry& operator=(const FrameTelemetry&) = delete;
+	FrameTelemetry& operator=(FrameTelemetry&&) = delete;
+
+	/** Time spent sleeping (us), to be subtracted from the emulation time
+	  * of the next frame. */
+	void addSleep(uint64_t us) { sleepSum += us; }
+
+	/** An MSX frame was finished, but not painted (frame skip). */
+	void frameSkipped() { ++skippedCount; }
+
+	/** A frame was painted (render) and shown (present).
+	  * @param renderStart Host time (us) when painting started.
+	  * @param presentStart Host time (us) when painting ended.
+	  * @param end Host time (us) when the frame was shown.
+	  * @param audioBuffer Sound buffered at that moment (ms).
+	  * @param syncDrift See RealTime::getSyncDrift() (ms).
+	  */
+	void frameEnd(uint64_t renderStart, uint64_t presentStart, uint64_t end,
+	              float audioBuffer, float syncDrift);
+
+	/** Get (at most) the 'max' most recent frames, oldest first. */
+	[[nodiscard]] std::vector<Frame> getFrames(size_t max = CAPACITY) const;
+	void clear();
+
+	[[nodiscard]] static Summary summarize(std::span<const Frame> frames);
+
+private:
+	mutable std::mutex mutex; // protects 'frames'
+	CircularBuffer<Frame, CAPACITY> frames;
+
+	// only accessed from the main thread
+	uint64_t prevEnd = 0;
+	uint64_t sleepSum = 0;
+	unsigned skippedCount = 0;
+};
+
+} // namespace openmsx
+
+#endif
@@ -68,20 +68,81 @@ void PixelRenderer::draw(
 		assert(0 <= displayX);
 		assert(displayX + displayWidth <= 512);
 
-		rasterizer->drawDisplay(
-			startX, startY,
-			displayX - vdp.getHorizontalScrollLow() * 2, displayY,
-			displayWidth, displayHeight
-			);
-		if (vdp.spritesEnabled() && !renderSettings.getDisableSprites()) {
-			rasterizer->drawSprites(
-				startX, startY,
-				displayX / 2, displayY,
-				(displayWidth + 1) / 2, displayHeight);
+		if (!canReuseLines()) {
+			drawDisplay(startX, startY, displayX, displayY,
+			            displayWidth, displayHeight);
+			return;
+		}
+		// Copy the lines that didn't change since the previous frame
+		// from that frame, only render the others.
+		bool bitmap = vdp.getDisplayMode().isBitmapMode();
+		auto isClean = [&](int i) {
+			// In character modes all VRAM changes set 'allDirty'.
+			auto vramLine = size_t((displayY + i) & 255);
+			return !bitmap || !(dirtyLines[vramLine] || prevDirtyLines[vramLine]);
+		};
+		int i = 0;
+		while (i < displayHeight) {
+			bool clean = isClean(i);
+			int j = i + 1;
+			while ((j < displayHeight) && (isClean(j) == clean)) ++j;
+			if (!clean || !rasterizer->copyDisplay(
+					startX, startY + i,
+					displayX - vdp.getHorizontalScrollLow() * 2, (displayY + i) & 255,
+					displayWidth, j - i)) {
+				drawDisplay(startX, startY + i, displayX, (displayY + i) & 255,
+				            displayWidth, j - i);
+			}
+			i = j;
 		}
 	}
 }
 
+void PixelRenderer::drawDisplay(
+	int startX, int startY, int displayX, int displayY,
+	int displayWidth, int displayHeight)
+{
+	rasterizer->drawDisplay(
+		startX, startY,
+		displayX - vdp.getHorizontalScrollLow() * 2, displayY,
+		displayWidth, displayHeight
+		);
+	if (vdp.spritesEnabled() && !disableSprites) {
+		rasterizer->drawSprites(
+			startX, startY,
+			displayX / 2, displayY,
+			(displayWidth + 1) / 2, displayHeight);
+	}
+}
+
+bool PixelRenderer::canReuseLines() const
+{
+	// Nothing (except possibly the content of specific VRAM lines)
+	// changed since the start of the previous (rendered) frame. In
+	// interlace mode or with (fast) blink the content can change from
+	// frame to frame without any notification.
+	return !allDirty && !prevAllDirty &&
+	       !vdp.isInterlaced() && !vdp.isFastBlinkEnabled();
+}
+
+void PixelRenderer::markVRAMDirty(unsigned offset)
+{
+	if (allDirty) return;
+	DisplayMode mode = vdp.getDisplayMode();
+	if (vram.spriteAttribTable.isInside(offset) ||
+	    vram.spritePatternTable.isInside(offset)) {
+		allDirty = true;
+	} else if (mode.isBitmapMode()) {
+		// One VRAM line is 128 bytes in Graphic4/5 and 2x128 bytes
+		// (interleaved) in Graphic6/7. Mark the same line in all pages.
+		dirtyLines.set((offset >> 7) & 255);
+	} else if (vram.nameTable.isInside(offset) ||
+	           vram.colorTable.isInside(offset) ||
+	           vram.patternTable.isInside(offset)) {
+		allDirty = true;
+	}
+}
+
 void PixelRenderer::subdivide(
 	int startX, int startY, int endX, int endY, int clipL, int clipR,
 	DrawType drawType)
@@ -169,12 +230,14 @@ void PixelRenderer::reInit()
 
 	rasterizer->reset();
 	displayEnabled = vdp.isDisplayEnabled();
+	allDirty = true;
 }
 
 void PixelRenderer::updateDisplayEnabled(bool enabled, EmuTime time)
 {
 	sync(time, true);
 	displayEnabled = enabled;
+	allDirty = true;
 }
 
 void PixelRenderer::frameStart(EmuTime time)
@@ -220,6 +283,15 @@ void PixelRenderer::frameStart(EmuTime time)
 	}
 	renderFrame = true;
 
+	// Changes since the start of the previous rendered frame, see
+	// canReuseLines(). Toggling the disable-sprites setting also requires
+	// to render all lines again.
+	prevDirtyLines = dirtyLines;
+	prevAllDirty = allDirty || (disableSprites != renderSettings.getDisableSprites());
+	dirtyLines.reset();
+	allDirty = false;
+	disableSprites = renderSettings.getDisableSprites();
+
 	rasterizer->frameStart(time);
 
 	accuracy = renderSettings.getAccuracy();
@@ -270,12 +342,14 @@ void PixelRenderer::updateHorizontalScrollLow(
 {
 	if (displayEnabled) sync(time);
 	rasterizer->setHorizontalScrollLow(scroll);
+	allDirty = true;
 }
 
 void PixelRenderer::updateHorizontalScrollHigh(
 	uint8_t /*scroll*/, EmuTime time)
 {
 	if (displayEnabled) sync(time);
+	allDirty = true;
 }
 
 void PixelRenderer::updateBorderMask(
@@ -283,12 +357,14 @@ void PixelRenderer::updateBorderMask(
 {
 	if (displayEnabled) sync(time);
 	rasterizer->setBorderMask(masked);
+	allDirty = true;
 }
 
 void PixelRenderer::updateMultiPage(
 	bool /*multiPage*/, EmuTime time)
 {
 	if (displayEnabled) sync(time);
+	allDirty = true;
 }
 
 void PixelRenderer::updateTransparency(
@@ -296,6 +372,7 @@ void PixelRenderer::updateTransparency(
 {
 	if (displayEnabled) sync(time);
 	rasterizer->setTransparency(enabled);
+	allDirty = true;
 }
 
 void PixelRenderer::updateSuperimposing(
@@ -303,12 +380,14 @@ void PixelRenderer::updateSuperimposing(
 {
 	if (displayEnabled) sync(time);
 	rasterizer->setSuperimposeVideoFrame(videoSource);
+	allDirty = true;
 }
 
 void PixelRenderer::updateForegroundColor(
 	uint8_t /*color*/, EmuTime time)
 {
 	if (displayEnabled) sync(time);
+	allDirty = true;
 }
 
 void PixelRenderer::updateBackgroundColor(
@@ -316,18 +395,21 @@ void PixelRenderer::updateBackgroundColor(
 {
 	sync(time);
 	rasterizer->setBackgroundColor(color);
+	allDirty = true;
 }
 
 void PixelRenderer::updateBlinkForegroundColor(
 	uint8_t /*color*/, EmuTime time)
 {
 	if (displayEnabled) sync(time);
+	allDirty = true;
 }
 
 void PixelRenderer::updateBlinkBackgroundColor(
 	uint8_t /*color*/, EmuTime time)
 {
 	if (displayEnabled) sync(time);
+	allDirty = true;
 }
 
 void PixelRenderer::updateBlinkState(
@@ -338,6 +420,7 @@ void PixelRenderer::updateBlinkState(
 	//       I don't know why exactly, but it's probably related to
 	//       being called at frame start.
 	//sync(time);
+	allDirty = true;
 }
 
 void PixelRenderer::updatePalette(
@@ -360,12 +443,14 @@ void PixelRenderer::updatePalette(
 		}
 	}
 	rasterizer->setPalette(index, grb);
+	allDirty = true;
 }
 
 void PixelRenderer::updateVerticalScroll(
 	int /*scroll*/, EmuTime time)
 {
 	if (displayEnabled) sync(time);
+	allDirty = true;
 }
 
 void PixelRenderer::updateHorizontalAdjust(
@@ -373,6 +458,16 @@ void PixelRenderer::updateHorizontalAdjust(
 {
 	if (displayEnabled) sync(time);
 	rasterizer->setHorizontalAdjust(adjust);
+	allDirty = true;
+}
+
+void PixelRenderer::updateLineZero(
+	int /*lineZero*/, EmuTime /*time*/)
+{
+	// No sync: nothing was drawn yet using the old value (this is
+	// called before display start, see Renderer::updateLineZero()).
+	// But the same screen line now shows a different VRAM line.
+	allDirty = true;
 }
 
 void PixelRenderer::updateDisplayMode(
@@ -388,30 +483,56 @@ void PixelRenderer::updateDisplayMode(
 		sync(time, true);
 	}
 	rasterizer->setDisplayMode(mode);
+	allDirty = true;
 }
 
 void PixelRenderer::updateNameBase(
 	unsigned /*addr*/, EmuTime time)
 {
 	if (displayEnabled) sync(time);
+	allDirty = true;
 }
 
 void PixelRenderer::updatePatternBase(
 	unsigned /*addr*/, EmuTime time)
 {
 	if (displayEnabled) sync(time);
+	allDirty = true;
 }
 
 void PixelRenderer::updateColorBase(
 	unsigned /*addr*/, EmuTime time)
 {
 	if (displayEnabled) sync(time);
+	allDirty = true;
 }
 
 void PixelRenderer::updateSpritesEnabled(
 	bool /*enabled*/, EmuTime time
 ) {
 	if (displayEnabled) sync(time);
+	allDirty = true;
+}
+
+void PixelRenderer::updateSpriteAttributeBase(
+	unsigned /*addr*/, EmuTime time)
+{
+	if (displayEnabled) sync(time);
+	allDirty = true;
+}
+
+void PixelRenderer::updateSpritePatternBase(
+	unsigned /*addr*/, EmuTime time)
+{
+	if (displayEnabled) sync(time);
+	allDirty = true;
+}
+
+void PixelRenderer::updateSpriteSizeMag(
+	uint8_t /*sizeMag*/, EmuTime time)
+{
+	if (displayEnabled) sync(time);
+	allDirty = true;
 }
 
 static constexpr bool overlap(
@@ -524,6 +645,8 @@ bool PixelRenderer::checkSync(unsigned offset, EmuTime time) const
 
 void PixelRenderer::updateVRAM(unsigned offset, EmuTime time)
 {
+	markVRAMDirty(offset);
+
 	// Note: No need to sync if display is disabled, because then the
 	//       output does not depend on VRAM (only on background color).
 	if (renderFrame && displayEnabled && checkSync(offset, time)) {
@@ -537,6 +660,7 @@ void PixelRenderer::updateWindow(bool /*enabled*/, EmuTime /*time*/)
 	// This update is redundant: Renderer will be notified in another way
 	// as well (updateDisplayEnabled or updateNameBase, for example).
 	// TODO: Can this be used as the main update method instead?
+	allDirty = true;
 }
 
 void PixelRenderer::sync(EmuTime time, bool force)
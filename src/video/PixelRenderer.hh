@@ -6,6 +6,7 @@
 
 #include "Observer.hh"
 
+#include <bitset>
 #include <cstdint>
 #include <memory>
 
@@ -54,12 +55,16 @@ public:
 	void updatePalette(unsigned index, int grb, EmuTime time) override;
 	void updateVerticalScroll(int scroll, EmuTime time) override;
 	void updateHorizontalAdjust(int adjust, EmuTime time) override;
+	void updateLineZero(int lineZero, EmuTime time) override;
 	void updateDisplayEnabled(bool enabled, EmuTime time) override;
 	void updateDisplayMode(DisplayMode mode, EmuTime time) override;
 	void updateNameBase(unsigned addr, EmuTime time) override;
 	void updatePatternBase(unsigned addr, EmuTime time) override;
 	void updateColorBase(unsigned addr, EmuTime time) override;
 	void updateSpritesEnabled(bool enabled, EmuTime time) override;
+	void updateSpriteAttributeBase(unsigned addr, EmuTime time) override;
+	void updateSpritePatternBase(unsigned addr, EmuTime time) override;
+	void updateSpriteSizeMag(uint8_t sizeMag, EmuTime time) override;
 	void updateVRAM(unsigned offset, EmuTime time) override;
 	void updateWindow(bool enabled, EmuTime time) override;
 
@@ -77,6 +82,20 @@ private:
 		int startX, int startY, int endX, int endY, DrawType drawType,
 		bool atEnd);
 
+	/** Render (part of) the display area of some lines, including the
+	  * sprites. Parameters are in the same units as in draw().
+	  */
+	void drawDisplay(int startX, int startY, int displayX, int displayY,
+	                 int displayWidth, int displayHeight);
+
+	/** Can the (clean) lines of the previous frame be reused?
+	  * @see dirtyLines
+	  */
+	[[nodiscard]] bool canReuseLines() const;
+
+	/** Register a VRAM change for the line-level dirty tracking. */
+	void markVRAMDirty(unsigned offset);
+
 	/** Subdivide an area specified by two scan positions into a series of
 	  * rectangles.
 	  * Clips the rectangles to { (x,y) | clipL <= x < clipR }.
@@ -169,6 +188,24 @@ private:
 	  * Used to force a minimal paint rate when throttle is off.
 	  */
 	uint64_t lastPaintTime = 0;
+
+	/** Line-level dirty tracking. Lines whose input didn't change since
+	  * the previous rendered frame are copied from that frame instead of
+	  * rendered again (that's the common case for static screens).
+	  * 'dirtyLines' is indexed by VRAM line (bitmap modes only), changes
+	  * that can affect any line (registers, palette, sprites, character
+	  * mode tables) set 'allDirty' instead. The 'prev' variants hold the
+	  * changes during the previous rendered frame (and any skipped frames
+	  * after it), the others the changes since the start of the current
+	  * frame.
+	  */
+	std::bitset<256> dirtyLines;
+	std::bitset<256> prevDirtyLines;
+	bool allDirty = true;
+	bool prevAllDirty = true;
+
+	/** Value of the disable-sprites setting for the current frame. */
+	bool disableSprites = false;
 };
 
 } // namespace openmsx
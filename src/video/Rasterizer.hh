@@ -105,6 +105,19 @@ public:
 		int displayX, int displayY,
 		int displayWidth, int displayHeight) = 0;
 
+	/** Instead of drawDisplay() and drawSprites(), copy the rectangle
+	  * from the previous frame. The caller must make sure the VDP state
+	  * that's relevant for this rectangle didn't change since then.
+	  * Parameters are the same as for drawDisplay().
+	  * @result false (and nothing is copied) when the previous frame
+	  *         can't be used, e.g. because the host colors changed. Then
+	  *         the caller must draw the rectangle instead.
+	  */
+	[[nodiscard]] virtual bool copyDisplay(
+		int fromX, int fromY,
+		int displayX, int displayY,
+		int displayWidth, int displayHeight) = 0;
+
 	/** Is video recording active?
 	  */
 	[[nodiscard]] virtual bool isRecording() const = 0;
@@ -0,0 +1,276 @@
+#include "RawAVWriter.hh"
+
+#include "FrameSource.hh"
+#include "MSXException.hh"
+#include "PixelOperations.hh"
+
+#include "endian.hh"
+#include "narrow.hh"
+#include "ranges.hh"
+#include "small_buffer.hh"
+#include "stl.hh"
+#include "strCat.hh"
+#include "unreachable.hh"
+#include "xrange.hh"
+
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace openmsx {
+
+// class RawAVWriter::Stream
+
+RawAVWriter::Stream::Stream(const Filename& filename_)
+	: filename(filename_)
+{
+	thread = std::thread([this] { writerLoop(); });
+}
+
+RawAVWriter::Stream::~Stream()
+{
+	// finish writing all queued buffers
+	std::unique_lock lock(mutex);
+	quit = true;
+	condition.notify_all();
+#ifndef _WIN32
+	// The writer thread may still be blocked opening a named pipe that
+	// has no reader. Briefly act as a reader to unblock it, the (failing)
+	// writes that follow don't block.
+	while (!opened) {
+		lock.unlock();
+		int fd = ::open(filename.getResolved().c_str(), O_RDONLY | O_NONBLOCK);
+		if (fd != -1) ::close(fd);
+		lock.lock();
+		condition.wait_for(lock, std::chrono::milliseconds(10), [&] { return opened; });
+	}
+#endif
+	lock.unlock();
+	thread.join();
+}
+
+std::vector<uint8_t> RawAVWriter::Stream::getBuffer()
+{
+	std::scoped_lock lock(mutex);
+	if (freeBuffers.empty()) return {};
+	auto result = std::move(freeBuffers.back());
+	freeBuffers.pop_back();
+	result.clear();
+	return result;
+}
+
+void RawAVWriter::Stream::write(std::vector<uint8_t>&& buffer)
+{
+	{
+		std::unique_lock lock(mutex);
+		// back-pressure: wait till the reader catches up
+		auto hasRoom = [&] {
+			return error || ((queue.size() + busy) < MAX_QUEUED_CHUNKS);
+		};
+		// but don't wait forever for a reader that never shows up
+		if (!condition.wait_for(lock, OPEN_TIMEOUT, [&] { return opened || hasRoom(); })) {
+			throw MSXException("Nobody opened ", filename.getOriginal(),
+			                   " for reading.");
+		}
+		condition.wait(lock, hasRoom);
+		if (error) {
+			throw MSXException(*error);
+		}
+		queue.push_back(std::move(buffer));
+	}
+	condition.notify_all();
+}
+
+unsigned RawAVWriter::Stream::getQueueDepth() const
+{
+	std::scoped_lock lock(mutex);
+	return narrow<unsigned>(queue.size()) + busy;
+}
+
+void RawAVWriter::Stream::writerLoop()
+{
+#ifndef _WIN32
+	// Writing to a pipe without reader raises SIGPIPE, which by default
+	// terminates the process. Block it on this thread, then the write
+	// fails with EPIPE instead.
+	sigset_t sigPipe;
+	sigemptyset(&sigPipe);
+	sigaddset(&sigPipe, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &sigPipe, nullptr);
+#endif
+
+	// Reported in the next write() call. Drop the remaining buffers, the
+	// reader is probably gone.
+	auto setError = [&](std::string err) {
+		error = std::move(err);
+		std::ranges::move(queue, std::back_inserter(freeBuffers));
+		queue.clear();
+	};
+
+	std::optional<std::string> err;
+	try {
+		file = File(filename, "wb"); // blocks till a named pipe has a reader
+	} catch (MSXException& e) {
+		err = e.getMessage();
+	}
+	{
+		std::scoped_lock lock(mutex);
+		opened = true;
+		if (err) setError(std::move(*err));
+	}
+	condition.notify_all();
+
+	while (true) {
+		std::vector<uint8_t> buffer;
+		{
+			std::unique_lock lock(mutex);
+			condition.wait(lock, [&] { return quit || !queue.empty(); });
+			if (queue.empty()) break; // quit, and all buffers are written
+			buffer = std::move(queue.front());
+			queue.pop_front();
+			++busy;
+		}
+		err.reset();
+		try {
+			file.write(buffer);
+			file.flush(); // don't keep the reader waiting
+		} catch (MSXException& e) {
+			err = e.getMessage();
+#ifndef _WIN32
+			// A write that fails with EPIPE also raised SIGPIPE (it's
+			// pending, because it's blocked). Check for that instead
+			// of 'errno', which may have been overwritten while the
+			// exception was thrown. This also removes the signal, it
+			// must not be delivered when it gets unblocked.
+			timespec noWait = {0, 0};
+			if (sigtimedwait(&sigPipe, nullptr, &noWait) == SIGPIPE) {
+				err = strCat("The reader of ", filename.getOriginal(), " has stopped.");
+			}
+#endif
+		}
+		{
+			std::scoped_lock lock(mutex);
+			--busy;
+			freeBuffers.push_back(std::move(buffer));
+			if (err) setError(std::move(*err));
+		}
+		condition.notify_all();
+	}
+
+	// Also the final flush must happen with SIGPIPE blocked.
+	file.close();
+}
+
+
+// class RawAVWriter
+
+RawAVWriter::RawAVWriter(const Filename& videoFilename, const Filename& audioFilename,
+                         unsigned width_, unsigned height_, float fps_, bool recordAudio)
+	: video(videoFilename)
+	, audio(recordAudio ? std::make_unique<Stream>(audioFilename) : nullptr)
+	, fps(fps_)
+	, width(width_)
+	, height(height_)
+{
+	assert((width % 2) == 0);
+	assert((height % 2) == 0);
+
+	// Store the frame rate as a fraction, e.g. NTSC is 59.92Hz.
+	auto fpsNum = narrow_cast<unsigned>(std::lround(fps * 1000.0f));
+	auto header = strCat("YUV4MPEG2 W", width, " H", height,
+	                     " F", fpsNum, ":1000 Ip A1:1 C420jpeg\n");
+	auto buf = video.getBuffer();
+	append(buf, std::span{std::bit_cast<const uint8_t*>(header.data()), header.size()});
+	video.write(std::move(buf));
+}
+
+void RawAVWriter::convertFrame(const FrameSource* frame, std::span<uint8_t> out) const
+{
+	auto getScaledLine = [&](unsigned y, std::span<Pixel, 960> buf) -> std::span<const Pixel> {
+		switch (height) {
+		case 240: return frame->getLinePtr320_240(y, buf.first<320>());
+		case 480: return frame->getLinePtr640_480(y, buf.first<640>());
+		case 720: return frame->getLinePtr960_720(y, buf);
+		default: UNREACHABLE;
+		}
+	};
+
+	// BT.601, limited range, in 8.8 fixed point
+	PixelOperations pixelOps;
+	auto Y = [&](Pixel p) {
+		int r = pixelOps.red(p), g = pixelOps.green(p), b = pixelOps.blue(p);
+		return uint8_t((( 66 * r + 129 * g +  25 * b + 128) >> 8) +  16);
+	};
+	auto U = [&](int r, int g, int b) {
+		return uint8_t(((-38 * r -  74 * g + 112 * b + 128) >> 8) + 128);
+	};
+	auto V = [&](int r, int g, int b) {
+		return uint8_t(((112 * r -  94 * g -  18 * b + 128) >> 8) + 128);
+	};
+
+	size_t cw = width / 2;
+	auto yPlane = out.first(size_t(width) * height);
+	auto uPlane = out.subspan(yPlane.size(), cw * (height / 2));
+	auto vPlane = out.subspan(yPlane.size() + uPlane.size(), uPlane.size());
+
+	std::array<Pixel, 960> buf0, buf1;
+	for (unsigned y = 0; y < height; y += 2) {
+		auto line0 = getScaledLine(y + 0, buf0);
+		auto line1 = getScaledLine(y + 1, buf1);
+		auto y0 = yPlane.subspan(size_t(y + 0) * width, width);
+		auto y1 = yPlane.subspan(size_t(y + 1) * width, width);
+		auto u = uPlane.subspan((y / 2) * cw, cw);
+		auto v = vPlane.subspan((y / 2) * cw, cw);
+		for (auto x : xrange(cw)) {
+			auto p00 = line0[2 * x + 0], p01 = line0[2 * x + 1];
+			auto p10 = line1[2 * x + 0], p11 = line1[2 * x + 1];
+			y0[2 * x + 0] = Y(p00); y0[2 * x + 1] = Y(p01);
+			y1[2 * x + 0] = Y(p10); y1[2 * x + 1] = Y(p11);
+			// chroma of the average of the 2x2 block
+			int r = int(pixelOps.red  (p00) + pixelOps.red  (p01) + pixelOps.red  (p10) + pixelOps.red  (p11) + 2) / 4;
+			int g = int(pixelOps.green(p00) + pixelOps.green(p01) + pixelOps.green(p10) + pixelOps.green(p11) + 2) / 4;
+			int b = int(pixelOps.blue (p00) + pixelOps.blue (p01) + pixelOps.blue (p10) + pixelOps.blue (p11) + 2) / 4;
+			u[x] = U(r, g, b);
+			v[x] = V(r, g, b);
+		}
+	}
+}
+
+void RawAVWriter::addFrame(const FrameSource* frame, std::span<const int16_t> audioData)
+{
+	// Convert the frame now, 'frame' gets reused as soon as we return.
+	static constexpr std::string_view FRAME_HEADER = "FRAME\n";
+	auto buf = video.getBuffer();
+	buf.resize(FRAME_HEADER.size() + size_t(width) * height * 3 / 2);
+	copy_to_range(FRAME_HEADER, buf);
+	convertFrame(frame, std::span{buf}.subspan(FRAME_HEADER.size()));
+
+	video.write(std::move(buf));
+
+	if (audio && !audioData.empty()) {
+		auto aBuf = audio->getBuffer();
+		if constexpr (Endian::BIG) {
+			small_buffer<Endian::L16, 4096> le(audioData);
+			append(aBuf, as_byte_span(std::span{le}));
+		} else {
+			append(aBuf, as_byte_span(audioData));
+		}
+		audio->write(std::move(aBuf));
+	}
+}
+
+unsigned RawAVWriter::getQueueDepth() const
+{
+	return video.getQueueDepth();
+}
+
+} // namespace openmsx
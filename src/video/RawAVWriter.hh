@@ -0,0 +1,119 @@
+#ifndef RAWAVWRITER_HH
+#define RAWAVWRITER_HH
+
+#include "File.hh"
+#include "Filename.hh"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace openmsx {
+
+class FrameSource;
+
+/** Writes uncompressed video and audio, meant to be piped into an external
+  * encoder (e.g. ffmpeg or x264) instead of encoding twice.
+  *
+  * - Video is written as a YUV4MPEG2 (y4m) stream, 4:2:0 (C420jpeg),
+  *   BT.601 limited range. This format is self-describing, so encoders
+  *   can read it without extra options.
+  * - Audio is written as raw signed 16-bit little endian PCM (interleaved
+  *   when stereo). Raw PCM (instead of wav) because a wav header can only
+  *   be completed by seeking back, which isn't possible on a pipe.
+  *
+  * Both streams can be (named) pipes, or something like /dev/fd/<n>. The
+  * files are opened and written on one thread per stream, so that a reader
+  * can open and consume the streams in any order (opening a named pipe
+  * blocks till the other side is opened as well). Unlike AviWriter, frames
+  * are never dropped: when the reader can't keep up, addFrame() blocks
+  * until there is room in the queue. Before the reader opened the stream,
+  * it waits at most OPEN_TIMEOUT for that, then the recording fails.
+  *
+  * When the reader goes away, the next write results in an error (instead
+  * of a SIGPIPE signal, which would terminate openMSX).
+  */
+class RawAVWriter
+{
+public:
+	static constexpr size_t MAX_QUEUED_CHUNKS = 8;
+	static constexpr auto OPEN_TIMEOUT = std::chrono::seconds(10);
+
+	/** @param audioFilename Ignored when recordAudio is false.
+	  * @param fps Frame rate stored in the y4m header, that's written
+	  *            right away (a reader may wait for it).
+	  */
+	RawAVWriter(const Filename& videoFilename, const Filename& audioFilename,
+	            unsigned width, unsigned height, float fps, bool recordAudio);
+	RawAVWriter(const RawAVWriter&) = delete;
+	RawAVWriter(RawAVWriter&&) = delete;
+	RawAVWriter& operator=(const RawAVWriter&) = delete;
+	RawAVWriter& operator=(RawAVWriter&&) = delete;
+	~RawAVWriter() = default;
+
+	/** @throws MSXException when an earlier open or write failed. */
+	void addFrame(const FrameSource* video, std::span<const int16_t> audio);
+	[[nodiscard]] float getFps() const { return fps; }
+
+	/** Number of video frames that are queued but not yet written. */
+	[[nodiscard]] unsigned getQueueDepth() const;
+
+private:
+	class Stream {
+	public:
+		explicit Stream(const Filename& filename);
+		Stream(const Stream&) = delete;
+		Stream(Stream&&) = delete;
+		Stream& operator=(const Stream&) = delete;
+		Stream& operator=(Stream&&) = delete;
+		~Stream();
+
+		/** Get an (empty) buffer, possibly recycled from an earlier write. */
+		[[nodiscard]] std::vector<uint8_t> getBuffer();
+		/** Queue the buffer for writing, blocks while the queue is full.
+		  * @throws MSXException when an earlier open or write failed, or
+		  *         when the file wasn't opened within OPEN_TIMEOUT. */
+		void write(std::vector<uint8_t>&& buffer);
+		[[nodiscard]] unsigned getQueueDepth() const;
+
+	private:
+		void writerLoop();
+
+	private:
+		const Filename filename;
+		File file; // only accessed by the writer thread
+
+		mutable std::mutex mutex;
+		std::condition_variable condition; // signals: buffer queued, or room in queue, or quit
+		std::deque<std::vector<uint8_t>> queue;
+		std::vector<std::vector<uint8_t>> freeBuffers;
+		unsigned busy = 0; // number of buffers taken from 'queue' but not yet written
+		std::optional<std::string> error;
+		bool opened = false;
+		bool quit = false;
+
+		std::thread thread; // must be constructed last
+	};
+
+	void convertFrame(const FrameSource* frame, std::span<uint8_t> out) const;
+
+private:
+	Stream video;
+	std::unique_ptr<Stream> audio; // nullptr when not recording audio
+
+	const float fps;
+	const unsigned width;
+	const unsigned height;
+};
+
+} // namespace openmsx
+
+#endif
@@ -144,6 +144,16 @@ public:
 	  */
 	virtual void updateHorizontalAdjust(int adjust, EmuTime time) = 0;
 
+	/** Informs the renderer that display line zero moved to a different
+	  * absolute line. This depends on the vertical set-adjust, the number
+	  * of display lines (192/212) and PAL/NTSC timing. The renderer is
+	  * only informed before display start (usually at start of frame),
+	  * when no display lines of the current frame were drawn yet.
+	  * @param lineZero The new absolute line number of display line zero.
+	  * @param time The moment in emulated time this change occurs.
+	  */
+	virtual void updateLineZero(int lineZero, EmuTime time) = 0;
+
 	/** Informs the renderer of a VDP display enabled change.
 	  * Both the regular border start/end and forced blanking by clearing
 	  * the display enable bit are considered display enabled changes.
@@ -182,6 +192,24 @@ public:
 	  */
 	virtual void updateSpritesEnabled(bool enabled, EmuTime time) = 0;
 
+	/** Informs the renderer of a VDP sprite attribute table base change.
+	  * @param addr The new base address.
+	  * @param time The moment in emulated time this change occurs.
+	  */
+	virtual void updateSpriteAttributeBase(unsigned addr, EmuTime time) = 0;
+
+	/** Informs the renderer of a VDP sprite pattern table base change.
+	  * @param addr The new base address.
+	  * @param time The moment in emulated time this change occurs.
+	  */
+	virtual void updateSpritePatternBase(unsigned addr, EmuTime time) = 0;
+
+	/** Informs the renderer of a VDP sprite size or magnification change.
+	  * @param sizeMag The new value of R#1 (bit 1 is size, bit 0 is mag).
+	  * @param time The moment in emulated time this change occurs.
+	  */
+	virtual void updateSpriteSizeMag(uint8_t sizeMag, EmuTime time) = 0;
+
 	/** Sprite palette in Graphic 7 mode.
           * See page 98 of the V9938 data book.
 	  * Each palette entry is a word in GRB format:
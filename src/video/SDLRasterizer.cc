@@ -157,6 +157,9 @@ void SDLRasterizer::reset()
 	spriteConverter.setTransparency(vdp.getTransparency());
 
 	resetPalette();
+	// the current frame (possibly partially rendered) can't be reused
+	hostColorsChanged = true;
+	lastFrameReusable = false;
 }
 
 void SDLRasterizer::resetPalette()
@@ -189,7 +192,11 @@ void SDLRasterizer::frameStart(EmuTime time)
 	// 240 - 212 = 28 lines available for top/bottom border; 14 each.
 	// NTSC: display at [32..244),
 	// PAL:  display at [59..271).
-	lineRenderTop = vdp.isPalTiming() ? 59 - 14 : 32 - 14;
+	int newLineRenderTop = vdp.isPalTiming() ? 59 - 14 : 32 - 14;
+
+	lastFrameReusable = !hostColorsChanged && (newLineRenderTop == lineRenderTop);
+	hostColorsChanged = false;
+	lineRenderTop = newLineRenderTop;
 }
 
 void SDLRasterizer::frameEnd()
@@ -628,6 +635,39 @@ void SDLRasterizer::drawSprites(
 	}
 }
 
+bool SDLRasterizer::copyDisplay(
+	int /*fromX*/, int fromY,
+	int displayX, int /*displayY*/,
+	int displayWidth, int displayHeight)
+{
+	const RawFrame* lastFrame = postProcessor->getLastRawFrame();
+	if (!lastFrameReusable || !lastFrame) return false;
+
+	// Same coordinate calculations as in drawDisplay().
+	unsigned lineWidth = vdp.getDisplayMode().getLineWidth();
+	if (lineWidth == 256) {
+		int endX = displayX + displayWidth;
+		displayX /= 2;
+		displayWidth = endX / 2 - displayX;
+	}
+	int screenLimitY = std::min(fromY + displayHeight - lineRenderTop, 240);
+	int screenY = std::max(fromY - lineRenderTop, 0);
+	if (screenLimitY <= screenY) return true;
+	int leftBackground =
+		translateX(vdp.getLeftBackground(), lineWidth == 512);
+
+	// The previous version of these lines must have the same width.
+	unsigned width = (lineWidth == 512) ? 640 : 320;
+	for (auto y : xrange(screenY, screenLimitY)) {
+		if (lastFrame->getLineWidthDirect(y) != width) return false;
+	}
+	for (auto y : xrange(screenY, screenLimitY)) {
+		auto src = lastFrame->getLineDirect(y).subspan(leftBackground + displayX, displayWidth);
+		copy_to_range(src, workFrame->getLineDirect(y).subspan(leftBackground + displayX));
+	}
+	return true;
+}
+
 bool SDLRasterizer::isRecording() const
 {
 	return postProcessor->isRecording();
@@ -641,6 +681,8 @@ void SDLRasterizer::update(const Setting& setting) noexcept
 	                       &renderSettings.getColorMatrixSetting())) {
 		precalcPalette();
 		resetPalette();
+		hostColorsChanged = true;
+		lastFrameReusable = false;
 	}
 }
 
@@ -66,6 +66,10 @@ public:
 		int fromX, int fromY,
 		int displayX, int displayY,
 		int displayWidth, int displayHeight) override;
+	[[nodiscard]] bool copyDisplay(
+		int fromX, int fromY,
+		int displayX, int displayY,
+		int displayWidth, int displayHeight) override;
 	[[nodiscard]] bool isRecording() const override;
 
 private:
@@ -135,7 +139,16 @@ private:
 	/** Line to render at top of display.
 	  * After all, our screen is 240 lines while display is 262 or 313.
 	  */
-	int lineRenderTop;
+	int lineRenderTop = 0;
+
+	/** Can copyDisplay() use the last frame of the PostProcessor? Not
+	  * when it was rendered with different host colors or a different
+	  * vertical layout.
+	  */
+	bool lastFrameReusable = false;
+
+	/** Did the host colors change since the start of the current frame? */
+	bool hostColorsChanged = true;
 
 	/** Host colors corresponding to each VDP palette entry.
 	  * palFg has entry 0 set to the current background color.
@@ -11,6 +11,7 @@ TODO:
 #include "SpriteChecker.hh"
 
 #include "RenderSettings.hh"
+#include "SpriteScan.hh"
 
 #include "BooleanSetting.hh"
 #include "serialize.hh"
@@ -117,10 +118,12 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	int fifthSpriteNum  = -1;  // no 5th sprite detected yet
 	int fifthSpriteLine = 999; // larger than any possible valid line
 
-	int sprite = 0;
-	for (/**/; sprite < 32; ++sprite) {
+	// Only visit the sprites that are visible somewhere in [minLine, maxLine).
+	auto [visible, numSprites] = SpriteScan::visibleSprites<4>(
+		attributePtr, 208, minLine + displayDelta, maxLine - minLine, magSize);
+	for (/**/; visible; visible &= visible - 1) {
+		int sprite = std::countr_zero(visible);
 		int y = attributePtr[4 * sprite + 0];
-		if (y == 208) break;
 
 		for (int line = minLine; line < maxLine; ++line) { // 'line' changes in loop
 			// Calculate line number within the sprite.
@@ -167,7 +170,7 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	}
 	if (~status & 0x40) {
 		// No 5th sprite detected, store number of latest sprite processed.
-		status = (status & 0x20) | uint8_t(std::min(sprite, 31));
+		status = (status & 0x20) | uint8_t(std::min(numSprites, 31));
 	}
 	vdp.setSpriteStatus(status);
 
@@ -190,45 +193,18 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	  they can collide in the V9958 extra border mask. This behaviour is
 	  the same in sprite mode 1 and 2.
 
-	Implemented by checking every pair for collisions.
-	For large numbers of sprites that would be slow,
-	but there are max 4 sprites and therefore max 6 pairs.
+	Implemented with a bitmask of the pixels covered by the sprites
+	processed so far on the line (see SpriteScan::firstCollision()).
 	If any collision is found, method returns at once.
 	*/
 	bool can0collide = vdp.canSpriteColor0Collide();
+	auto canCollide = [&](const SpriteInfo& info) {
+		return can0collide || ((info.colorAttrib & 0xf) != 0);
+	};
 	for (auto line : xrange(minLine, maxLine)) {
-		int minXCollision = 999;
-		for (int i = std::min<int>(4, spriteCount[line]); --i >= 1; /**/) {
-			auto color1 = spriteBuffer[line][i].colorAttrib & 0xf;
-			if (!can0collide && (color1 == 0)) continue;
-			int x_i = spriteBuffer[line][i].x;
-			SpritePattern pattern_i = spriteBuffer[line][i].pattern;
-			for (int j = i; --j >= 0; /**/) {
-				auto color2 = spriteBuffer[line][j].colorAttrib & 0xf;
-				if (!can0collide && (color2 == 0)) continue;
-				// Do sprite i and sprite j collide?
-				int x_j = spriteBuffer[line][j].x;
-				int dist = x_j - x_i;
-				if ((-magSize < dist) && (dist < magSize)) {
-					SpritePattern pattern_j = spriteBuffer[line][j].pattern;
-					if (dist < 0) {
-						pattern_j <<= -dist;
-					} else {
-						pattern_j >>= dist;
-					}
-					SpritePattern colPat = pattern_i & pattern_j;
-					if (x_i < 0) {
-						assert(x_i >= -32);
-						colPat &= (1 << (32 + x_i)) - 1;
-					}
-					if (colPat) {
-						int xCollision = x_i + std::countl_zero(colPat);
-						assert(xCollision >= 0);
-						minXCollision = std::min(minXCollision, xCollision);
-					}
-				}
-			}
-		}
+		auto sprites = std::span<const SpriteInfo>(spriteBuffer[line]).first(
+			std::min<size_t>(4, spriteCount[line]));
+		int minXCollision = SpriteScan::firstCollision(sprites, canCollide);
 		if (minXCollision < 256) {
 			vdp.setSpriteStatus(vdp.getStatusReg0() | 0x20);
 			// verified: collision coords are also filled
@@ -280,14 +256,20 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 
 	// Because it gave a measurable performance boost, we duplicated the
 	// code for planar and non-planar modes.
-	int sprite = 0;
+	// Only visit the sprites that are visible somewhere in [minLine, maxLine).
+	int firstLine = minLine + displayDelta;
+	int numLines = maxLine - minLine;
+	int numSprites = 0;
 	if (planar) {
 		auto [attributePtr0, attributePtr1] =
 			vram.spriteAttribTable.getReadAreaPlanar<32 * 4>(512);
+		auto [visible, num] = SpriteScan::visibleSprites<2>(
+			attributePtr0, 216, firstLine, numLines, magSize);
+		numSprites = num;
 		// TODO: Verify CC implementation.
-		for (/**/; sprite < 32; ++sprite) {
+		for (/**/; visible; visible &= visible - 1) {
+			int sprite = std::countr_zero(visible);
 			int y = attributePtr0[2 * sprite + 0];
-			if (y == 216) break;
 
 			for (int line = minLine; line < maxLine; ++line) { // 'line' changes in loop
 				// Calculate line number within the sprite.
@@ -329,10 +311,13 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 	} else {
 		auto attributePtr0 =
 			vram.spriteAttribTable.getReadArea<32 * 4>(512);
+		auto [visible, num] = SpriteScan::visibleSprites<4>(
+			attributePtr0, 216, firstLine, numLines, magSize);
+		numSprites = num;
 		// TODO: Verify CC implementation.
-		for (/**/; sprite < 32; ++sprite) {
+		for (/**/; visible; visible &= visible - 1) {
+			int sprite = std::countr_zero(visible);
 			int y = attributePtr0[4 * sprite + 0];
-			if (y == 216) break;
 
 			for (int line = minLine; line < maxLine; ++line) { // 'line' changes in loop
 				// Calculate line number within the sprite.
@@ -398,7 +383,7 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 	}
 	if (~status & 0x40) {
 		// No 9th sprite detected, store number of latest sprite processed.
-		status = (status & 0x20) | uint8_t(std::min(sprite, 31));
+		status = (status & 0x20) | uint8_t(std::min(numSprites, 31));
 	}
 	vdp.setSpriteStatus(status);
 
@@ -422,53 +407,19 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 	  they can collide in the V9958 extra border mask. This behaviour is
 	  the same in sprite mode 1 and 2.
 
-	Implemented by checking every pair for collisions.
-	For large numbers of sprites that would be slow.
-	There are max 8 sprites and therefore max 42 pairs.
-	  TODO: Maybe this is slow... Think of something faster.
-	        Probably new approach is needed anyway for OR-ing.
+	Implemented with a bitmask of the pixels covered by the sprites
+	processed so far on the line (see SpriteScan::firstCollision()).
 	*/
 	bool can0collide = vdp.canSpriteColor0Collide();
+	auto canCollide = [&](const SpriteInfo& info) {
+		if (!can0collide && ((info.colorAttrib & 0xf) == 0)) return false;
+		// If CC or IC is set, this sprite cannot collide.
+		return (info.colorAttrib & 0x60) == 0;
+	};
 	for (auto line : xrange(minLine, maxLine)) {
-		int minXCollision = 999; // no collision
-		std::span<SpriteInfo, 32 + 1> visibleSprites = spriteBuffer[line];
-		for (int i = std::min<int>(8, spriteCount[line]); --i >= 1; /**/) {
-			auto colorAttrib1 = visibleSprites[i].colorAttrib;
-			if (!can0collide && ((colorAttrib1 & 0xf) == 0)) continue;
-			// If CC or IC is set, this sprite cannot collide.
-			if (colorAttrib1 & 0x60) continue;
-
-			int x_i = visibleSprites[i].x;
-			SpritePattern pattern_i = visibleSprites[i].pattern;
-			for (int j = i; --j >= 0; /**/) {
-				auto colorAttrib2 = visibleSprites[j].colorAttrib;
-				if (!can0collide && ((colorAttrib2 & 0xf) == 0)) continue;
-				// If CC or IC is set, this sprite cannot collide.
-				if (colorAttrib2 & 0x60) continue;
-
-				// Do sprite i and sprite j collide?
-				int x_j = visibleSprites[j].x;
-				int dist = x_j - x_i;
-				if ((-magSize < dist) && (dist < magSize)) {
-					SpritePattern pattern_j = visibleSprites[j].pattern;
-					if (dist < 0) {
-						pattern_j <<= -dist;
-					} else {
-						pattern_j >>= dist;
-					}
-					SpritePattern colPat = pattern_i & pattern_j;
-					if (x_i < 0) {
-						assert(x_i >= -32);
-						colPat &= (1 << (32 + x_i)) - 1;
-					}
-					if (colPat) {
-						int xCollision = x_i + std::countl_zero(colPat);
-						assert(xCollision >= 0);
-						minXCollision = std::min(minXCollision, xCollision);
-					}
-				}
-			}
-		}
+		auto sprites = std::span<const SpriteInfo>(spriteBuffer[line]).first(
+			std::min<size_t>(8, spriteCount[line]));
+		int minXCollision = SpriteScan::firstCollision(sprites, canCollide);
 		if (minXCollision < 256) {
 			vdp.setSpriteStatus(vdp.getStatusReg0() | 0x20);
 			// x-coord should be increased by 12
@@ -0,0 +1,149 @@
+#ifndef SPRITESCAN_HH
+#define SPRITESCAN_HH
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <span>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace openmsx {
+
+/** Helper functions for SpriteChecker: these handle all 32 sprites (or all
+  * sprites on a line) at once instead of one at a time.
+  */
+namespace SpriteScan {
+
+struct Visible {
+	uint32_t mask; // bit n is set when sprite n is visible
+	int count;     // number of sprites before the terminator (0-32)
+};
+
+/** Which sprites are visible on at least one of the display lines in the
+  * range [firstLine, firstLine + numLines)?
+  * @param attr The sprite attribute table. The y-coordinate of sprite n is
+  *             stored at 'attr[n * STRIDE]'.
+  * @param terminator A sprite with this y-coordinate (208 or 216) ends the
+  *                   sprite list. The mask only contains sprites before it.
+  * @param firstLine Display line (this already includes the vertical scroll).
+  * @param numLines Number of lines in the range.
+  * @param magSize Height of the sprites in pixels (8, 16 or 32).
+  */
+template<int STRIDE>
+[[nodiscard]] inline Visible visibleSprites(
+	std::span<const uint8_t, 32 * STRIDE> attr, uint8_t terminator,
+	int firstLine, int numLines, int magSize)
+{
+	static_assert((STRIDE == 2) || (STRIDE == 4));
+	assert((8 <= magSize) && (magSize <= 32));
+
+	// The line within a sprite is '(line - y) & 0xFF', for consecutive
+	// lines that's 's0, s0 + 1, ...' (modulo 256). So a sprite is visible
+	// when 's0 < magSize' or when that sequence wraps around to 0.
+	auto first = uint8_t(firstLine);
+	bool all = numLines >= 256;
+	bool wraps = numLines >= 2; // only used when !all
+	auto wrapStart = uint8_t(257 - numLines); // s0 >= wrapStart wraps
+
+	uint32_t mask = 0;
+	uint32_t term = 0;
+#ifdef __SSE2__
+	auto loadY = [&](int i) { // y-coordinates of sprites 16*i ... 16*i+15
+		const auto* p = std::bit_cast<const __m128i*>(attr.data()) + i * STRIDE;
+		if constexpr (STRIDE == 2) {
+			auto m = _mm_set1_epi16(0x00FF);
+			return _mm_packus_epi16(_mm_and_si128(_mm_loadu_si128(p + 0), m),
+			                        _mm_and_si128(_mm_loadu_si128(p + 1), m));
+		} else {
+			auto m = _mm_set1_epi32(0x000000FF);
+			auto a = _mm_packs_epi32(_mm_and_si128(_mm_loadu_si128(p + 0), m),
+			                         _mm_and_si128(_mm_loadu_si128(p + 1), m));
+			auto b = _mm_packs_epi32(_mm_and_si128(_mm_loadu_si128(p + 2), m),
+			                         _mm_and_si128(_mm_loadu_si128(p + 3), m));
+			return _mm_packus_epi16(a, b);
+		}
+	};
+	auto vFirst = _mm_set1_epi8(char(first));
+	auto vLast  = _mm_set1_epi8(char(magSize - 1));
+	auto vWrap  = _mm_set1_epi8(char(wrapStart));
+	auto vTerm  = _mm_set1_epi8(char(terminator));
+	for (int i : {0, 1}) {
+		auto y = loadY(i);
+		auto s0 = _mm_sub_epi8(vFirst, y);
+		// unsigned compares: s0 <= magSize - 1, s0 >= wrapStart
+		auto vis = _mm_cmpeq_epi8(_mm_min_epu8(s0, vLast), s0);
+		if (wraps) {
+			vis = _mm_or_si128(vis, _mm_cmpeq_epi8(_mm_max_epu8(s0, vWrap), s0));
+		}
+		mask |= uint32_t(_mm_movemask_epi8(vis)) << (16 * i);
+		term |= uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(y, vTerm))) << (16 * i);
+	}
+#else
+	for (int sprite = 0; sprite < 32; ++sprite) {
+		uint8_t y = attr[sprite * STRIDE];
+		auto s0 = uint8_t(first - y);
+		bool vis = (s0 < magSize) || (wraps && (s0 >= wrapStart));
+		mask |= uint32_t(vis) << sprite;
+		term |= uint32_t(y == terminator) << sprite;
+	}
+#endif
+	if (all) mask = ~0u;
+	if (numLines <= 0) mask = 0;
+
+	int count = term ? std::countr_zero(term) : 32;
+	if (count < 32) mask &= (1u << count) - 1;
+	return {mask, count};
+}
+
+/** Returned by firstCollision() when no sprites overlap. */
+static constexpr int NO_COLLISION = 999;
+
+/** Find the leftmost pixel where (at least) two of the given sprites overlap.
+  * Instead of checking every pair of sprites, this keeps a bitmask of the
+  * pixels covered so far on the line.
+  * @param sprites The sprites on one line. Each has an 'x' (in the range
+  *                [-32, 255]) and a 'pattern' (32 pixels, MSB is leftmost).
+  * @param canCollide Predicate to filter the sprites that can collide.
+  * @return The x-coordinate of the leftmost overlapping pixel, pixels with
+  *         x < 0 don't count. Or NO_COLLISION. Note that the result can be
+  *         in the (invisible) range [256, 287).
+  */
+template<typename SpriteInfo, typename Pred>
+[[nodiscard]] inline int firstCollision(std::span<const SpriteInfo> sprites, Pred canCollide)
+{
+	// Bit-position 'x + 32' represents pixel 'x', MSB first in each word.
+	std::array<uint64_t, 6> covered = {};
+	int result = NO_COLLISION;
+	for (const auto& s : sprites) {
+		if (!canCollide(s)) continue;
+		assert((-32 <= s.x) && (s.x < 256));
+		auto pos = unsigned(s.x + 32);
+		unsigned w = pos / 64;
+		unsigned shift = pos % 64;
+		uint64_t pattern = uint64_t(s.pattern) << 32;
+		uint64_t bits0 = pattern >> shift;
+		uint64_t bits1 = shift ? (pattern << (64 - shift)) : 0;
+
+		uint64_t col0 = covered[w + 0] & bits0;
+		if (w == 0) col0 &= 0xFFFFFFFF; // pixels with x < 0 can't collide
+		uint64_t col1 = covered[w + 1] & bits1;
+		if (col0) {
+			result = std::min(result, int(64 * w + std::countl_zero(col0)) - 32);
+		} else if (col1) {
+			result = std::min(result, int(64 * (w + 1) + std::countl_zero(col1)) - 32);
+		}
+		covered[w + 0] |= bits0;
+		covered[w + 1] |= bits1;
+	}
+	return result;
+}
+
+} // namespace SpriteScan
+} // namespace openmsx
+
+#endif
@@ -472,6 +472,7 @@ void VDP::scheduleDisplayStart(EmuTime time)
 	}
 
 	// Calculate when (lines and time) display starts.
+	int oldLineZero = getLineZero();
 	int lineZero =
 		// sync + top erase:
 		3 + 13 +
@@ -483,6 +484,9 @@ void VDP::scheduleDisplayStart(EmuTime time)
 		lineZero * TICKS_PER_LINE
 		+ 100 + 102; // VR flips at start of left border
 	displayStartSyncTime = frameStartTime + displayStart;
+	if (lineZero != oldLineZero) {
+		renderer->updateLineZero(lineZero, time);
+	}
 	//cerr << "new DISPLAY_START is " << (displayStart / TICKS_PER_LINE) << "\n";
 
 	// Register new DISPLAY_START sync point.
@@ -1071,6 +1075,7 @@ void VDP::changeRegister(uint8_t reg, uint8_t val, EmuTime time)
 	case 1:
 		if (change & 0x03) {
 			// Update sprites on size and mag changes.
+			renderer->updateSpriteSizeMag(val, time);
 			spriteChecker->updateSpriteSizeMag(val, time);
 		}
 		// TODO: Reset vertical IRQ if IE0 is reset?
@@ -1201,6 +1206,9 @@ void VDP::changeRegister(uint8_t reg, uint8_t val, EmuTime time)
 			// see VDPVRAM for details on the remapping itself
 			vram->change4k8kMapping((val & 0x80) != 0);
 		}
+		if (change & 0x04) { // fast blink
+			updateDisplayedPages(time);
+		}
 		break;
 	case 2:
 		updateNameBase(time);
@@ -1244,6 +1252,12 @@ void VDP::changeRegister(uint8_t reg, uint8_t val, EmuTime time)
 				scheduleVScan(time);
 			}
 		}
+		if (change & 0x04) { // even/odd
+			updateDisplayedPages(time);
+		}
+		break;
+	case 13:
+		updateDisplayedPages(time);
 		break;
 	case 19:
 	case 23:
@@ -1294,6 +1308,29 @@ void VDP::updateNameBase(EmuTime time)
 		indexMask &= ~0x8000;
 	}
 	vram->nameTable.setMask(base, indexMask, time);
+	updateDisplayedPages(time);
+}
+
+void VDP::updateDisplayedPages(EmuTime time)
+{
+	// A command that is still executing wrote (up to 'time') to the pages
+	// that were displayed till now, the renderer must be synced for those
+	// writes.
+	cmdEngine->sync(time);
+	vram->setDisplayedPages(calcDisplayedPages());
+}
+
+DisplayedPages VDP::calcDisplayedPages() const
+{
+	if (!displayMode.isBitmapMode()) {
+		return DisplayedPages::all();
+	}
+	// Even/odd, blink and multi-page scrolling show the even page instead
+	// of the odd page on some frames or lines.
+	bool alternate = (controlRegs[9] & 4) || (controlRegs[13] != 0) ||
+	                 isFastBlinkEnabled() || (controlRegs[25] & 1);
+	return DisplayedPages::bitmap(
+		displayMode.isPlanar(), controlRegs[2] << 10, alternate);
 }
 
 void VDP::updateColorBase(EmuTime time)
@@ -1362,6 +1399,7 @@ void VDP::updateSpriteAttributeBase(EmuTime time)
 		return;
 	}
 	unsigned baseMask = (controlRegs[11] << 15) | (controlRegs[5] << 7) | ~(~0u << 7);
+	renderer->updateSpriteAttributeBase(baseMask, time);
 	unsigned indexMask = mode == 1 ? ~0u << 7 : ~0u << 10;
 	if (displayMode.isPlanar()) {
 		baseMask = ((baseMask << 16) | (baseMask >> 1)) & 0x1FFFF;
@@ -1377,6 +1415,7 @@ void VDP::updateSpritePatternBase(EmuTime time)
 		return;
 	}
 	unsigned baseMask = (controlRegs[6] << 11) | ~(~0u << 11);
+	renderer->updateSpritePatternBase(baseMask, time);
 	unsigned indexMask = ~0u << 11;
 	if (displayMode.isPlanar()) {
 		baseMask = ((baseMask << 16) | (baseMask >> 1)) & 0x1FFFF;
@@ -1990,6 +2029,7 @@ void VDP::serialize(Archive& ar, unsigned serVersion)
 	if constexpr (Archive::IS_LOADER) {
 		pendingCpuAccess = syncCpuVramAccess.isPending().has_value();
 		update(tooFastAccess);
+		vram->setDisplayedPages(calcDisplayedPages());
 	}
 
 	if (ar.versionAtLeast(serVersion, 2)) {
@@ -24,6 +24,7 @@
 
 namespace openmsx {
 
+struct DisplayedPages;
 class PostProcessor;
 class Renderer;
 class VDPCmdEngine;
@@ -1022,6 +1023,12 @@ private:
 	  */
 	void updateNameBase(EmuTime time);
 
+	/** Display mode, page or page alternation has changed.
+	  * Inform the VRAM which pages can be displayed.
+	  */
+	void updateDisplayedPages(EmuTime time);
+	[[nodiscard]] DisplayedPages calcDisplayedPages() const;
+
 	/** Color base mask has changed.
 	  * Inform the renderer and the VRAM.
 	  */
@@ -1059,6 +1066,7 @@ private:
 		explicit RegDebug(const VDP& vdp);
 		[[nodiscard]] uint8_t read(unsigned address, EmuTime time) override;
 		void write(unsigned address, uint8_t value, EmuTime time) override;
+		[[nodiscard]] bool includeInStateHash() const override { return true; }
 	} vdpRegDebug;
 
 	struct StatusRegDebug final : SimpleDebuggable {
@@ -1070,6 +1078,7 @@ private:
 		explicit PaletteDebug(const VDP& vdp);
 		[[nodiscard]] uint8_t read(unsigned address) override;
 		void write(unsigned address, uint8_t value, EmuTime time) override;
+		[[nodiscard]] bool includeInStateHash() const override { return true; }
 	} vdpPaletteDebug;
 
 	struct VRAMPointerDebug final : SimpleDebuggable {
@@ -1226,7 +1235,7 @@ private:
 
 	/** VDP ticks between start of frame and start of display.
 	  */
-	int displayStart;
+	int displayStart = 0;
 
 	/** VDP ticks between start of frame and the moment horizontal
 	  * scan match occurs.
@@ -41,6 +41,7 @@ TODO:
 #include "serialize.hh"
 
 #include "unreachable.hh"
+#include "xrange.hh"
 
 #include <algorithm>
 #include <array>
@@ -164,10 +165,11 @@ struct Graphic4Mode
 	static constexpr uint8_t PIXELS_PER_BYTE = 2;
 	static constexpr uint8_t PIXELS_PER_BYTE_SHIFT = 1;
 	static constexpr unsigned PIXELS_PER_LINE = 256;
+	static constexpr bool PLANAR = false; // consecutive bytes alternate between two VRAM banks
 	static unsigned addressOf(unsigned x, unsigned y, bool extVRAM);
 	static uint8_t point(const VDPVRAM& vram, unsigned x, unsigned y, bool extVRAM);
-	template<typename LogOp>
-	static void pset(EmuTime time, VDPVRAM& vram,
+	template<typename VRAM, typename LogOp>
+	static void pset(EmuTime time, VRAM& vram,
 		unsigned x, unsigned addr, uint8_t src, uint8_t color, LogOp op);
 	static uint8_t duplicate(uint8_t color);
 };
@@ -189,9 +191,9 @@ inline uint8_t Graphic4Mode::point(
 		>> (((~x) & 1) << 2)) & 15;
 }
 
-template<typename LogOp>
+template<typename VRAM, typename LogOp>
 inline void Graphic4Mode::pset(
-	EmuTime time, VDPVRAM& vram, unsigned x, unsigned addr,
+	EmuTime time, VRAM& vram, unsigned x, unsigned addr,
 	uint8_t src, uint8_t color, LogOp op)
 {
 	auto sh = uint8_t(((~x) & 1) << 2);
@@ -216,10 +218,11 @@ struct Graphic5Mode
 	static constexpr uint8_t PIXELS_PER_BYTE = 4;
 	static constexpr uint8_t PIXELS_PER_BYTE_SHIFT = 2;
 	static constexpr unsigned PIXELS_PER_LINE = 512;
+	static constexpr bool PLANAR = false; // consecutive bytes alternate between two VRAM banks
 	static unsigned addressOf(unsigned x, unsigned y, bool extVRAM);
 	static uint8_t point(const VDPVRAM& vram, unsigned x, unsigned y, bool extVRAM);
-	template<typename LogOp>
-	static void pset(EmuTime time, VDPVRAM& vram,
+	template<typename VRAM, typename LogOp>
+	static void pset(EmuTime time, VRAM& vram,
 		unsigned x, unsigned addr, uint8_t src, uint8_t color, LogOp op);
 	static uint8_t duplicate(uint8_t color);
 };
@@ -241,9 +244,9 @@ inline uint8_t Graphic5Mode::point(
 		>> (((~x) & 3) << 1)) & 3;
 }
 
-template<typename LogOp>
+template<typename VRAM, typename LogOp>
 inline void Graphic5Mode::pset(
-	EmuTime time, VDPVRAM& vram, unsigned x, unsigned addr,
+	EmuTime time, VRAM& vram, unsigned x, unsigned addr,
 	uint8_t src, uint8_t color, LogOp op)
 {
 	auto sh = uint8_t(((~x) & 3) << 1);
@@ -270,10 +273,11 @@ struct Graphic6Mode
 	static constexpr uint8_t PIXELS_PER_BYTE = 2;
 	static constexpr uint8_t PIXELS_PER_BYTE_SHIFT = 1;
 	static constexpr unsigned PIXELS_PER_LINE = 512;
+	static constexpr bool PLANAR = true; // consecutive bytes alternate between two VRAM banks
 	static unsigned addressOf(unsigned x, unsigned y, bool extVRAM);
 	static uint8_t point(const VDPVRAM& vram, unsigned x, unsigned y, bool extVRAM);
-	template<typename LogOp>
-	static void pset(EmuTime time, VDPVRAM& vram,
+	template<typename VRAM, typename LogOp>
+	static void pset(EmuTime time, VRAM& vram,
 		unsigned x, unsigned addr, uint8_t src, uint8_t color, LogOp op);
 	static uint8_t duplicate(uint8_t color);
 };
@@ -295,9 +299,9 @@ inline uint8_t Graphic6Mode::point(
 		>> (((~x) & 1) << 2)) & 15;
 }
 
-template<typename LogOp>
+template<typename VRAM, typename LogOp>
 inline void Graphic6Mode::pset(
-	EmuTime time, VDPVRAM& vram, unsigned x, unsigned addr,
+	EmuTime time, VRAM& vram, unsigned x, unsigned addr,
 	uint8_t src, uint8_t color, LogOp op)
 {
 	auto sh = uint8_t(((~x) & 1) << 2);
@@ -322,10 +326,11 @@ struct Graphic7Mode
 	static constexpr uint8_t PIXELS_PER_BYTE = 1;
 	static constexpr uint8_t PIXELS_PER_BYTE_SHIFT = 0;
 	static constexpr unsigned PIXELS_PER_LINE = 256;
+	static constexpr bool PLANAR = true; // consecutive bytes alternate between two VRAM banks
 	static unsigned addressOf(unsigned x, unsigned y, bool extVRAM);
 	static uint8_t point(const VDPVRAM& vram, unsigned x, unsigned y, bool extVRAM);
-	template<typename LogOp>
-	static void pset(EmuTime time, VDPVRAM& vram,
+	template<typename VRAM, typename LogOp>
+	static void pset(EmuTime time, VRAM& vram,
 		unsigned x, unsigned addr, uint8_t src, uint8_t color, LogOp op);
 	static uint8_t duplicate(uint8_t color);
 };
@@ -346,9 +351,9 @@ inline uint8_t Graphic7Mode::point(
 	return vram.cmdReadWindow.readNP(addressOf(x, y, extVRAM));
 }
 
-template<typename LogOp>
+template<typename VRAM, typename LogOp>
 inline void Graphic7Mode::pset(
-	EmuTime time, VDPVRAM& vram, unsigned /*x*/, unsigned addr,
+	EmuTime time, VRAM& vram, unsigned /*x*/, unsigned addr,
 	uint8_t src, uint8_t color, LogOp op)
 {
 	op(time, vram, addr, src, color, 0);
@@ -372,10 +377,11 @@ struct NonBitmapMode
 	static constexpr uint8_t PIXELS_PER_BYTE = 1;
 	static constexpr uint8_t PIXELS_PER_BYTE_SHIFT = 0;
 	static constexpr unsigned PIXELS_PER_LINE = 256;
+	static constexpr bool PLANAR = false; // consecutive bytes alternate between two VRAM banks
 	static unsigned addressOf(unsigned x, unsigned y, bool extVRAM);
 	static uint8_t point(const VDPVRAM& vram, unsigned x, unsigned y, bool extVRAM);
-	template<typename LogOp>
-	static void pset(EmuTime time, VDPVRAM& vram,
+	template<typename VRAM, typename LogOp>
+	static void pset(EmuTime time, VRAM& vram,
 		unsigned x, unsigned addr, uint8_t src, uint8_t color, LogOp op);
 	static uint8_t duplicate(uint8_t color);
 };
@@ -396,9 +402,9 @@ inline uint8_t NonBitmapMode::point(
 	return vram.cmdReadWindow.readNP(addressOf(x, y, extVRAM));
 }
 
-template<typename LogOp>
+template<typename VRAM, typename LogOp>
 inline void NonBitmapMode::pset(
-	EmuTime time, VDPVRAM& vram, unsigned /*x*/, unsigned addr,
+	EmuTime time, VRAM& vram, unsigned /*x*/, unsigned addr,
 	uint8_t src, uint8_t color, LogOp op)
 {
 	op(time, vram, addr, src, color, 0);
@@ -655,7 +661,8 @@ struct IncrShift7
 // Logical operations:
 
 struct DummyOp {
-	void operator()(EmuTime /*time*/, VDPVRAM& /*vram*/, unsigned /*addr*/,
+	template<typename VRAM>
+	void operator()(EmuTime /*time*/, VRAM& /*vram*/, unsigned /*addr*/,
 	                uint8_t /*src*/, uint8_t /*color*/, uint8_t /*mask*/) const
 	{
 		// Undefined logical operations do nothing.
@@ -663,7 +670,8 @@ struct DummyOp {
 };
 
 struct ImpOp {
-	void operator()(EmuTime time, VDPVRAM& vram, unsigned addr,
+	template<typename VRAM>
+	void operator()(EmuTime time, VRAM& vram, unsigned addr,
 	                uint8_t src, uint8_t color, uint8_t mask) const
 	{
 		vram.cmdWrite(addr, (src & mask) | color, time);
@@ -671,7 +679,8 @@ struct ImpOp {
 };
 
 struct AndOp {
-	void operator()(EmuTime time, VDPVRAM& vram, unsigned addr,
+	template<typename VRAM>
+	void operator()(EmuTime time, VRAM& vram, unsigned addr,
 	                uint8_t src, uint8_t color, uint8_t mask) const
 	{
 		vram.cmdWrite(addr, src & (color | mask), time);
@@ -679,7 +688,8 @@ struct AndOp {
 };
 
 struct OrOp {
-	void operator()(EmuTime time, VDPVRAM& vram, unsigned addr,
+	template<typename VRAM>
+	void operator()(EmuTime time, VRAM& vram, unsigned addr,
 	                uint8_t src, uint8_t color, uint8_t /*mask*/) const
 	{
 		vram.cmdWrite(addr, src | color, time);
@@ -687,7 +697,8 @@ struct OrOp {
 };
 
 struct XorOp {
-	void operator()(EmuTime time, VDPVRAM& vram, unsigned addr,
+	template<typename VRAM>
+	void operator()(EmuTime time, VRAM& vram, unsigned addr,
 	                uint8_t src, uint8_t color, uint8_t /*mask*/) const
 	{
 		vram.cmdWrite(addr, src ^ color, time);
@@ -695,7 +706,8 @@ struct XorOp {
 };
 
 struct NotOp {
-	void operator()(EmuTime time, VDPVRAM& vram, unsigned addr,
+	template<typename VRAM>
+	void operator()(EmuTime time, VRAM& vram, unsigned addr,
 	                uint8_t src, uint8_t color, uint8_t mask) const
 	{
 		vram.cmdWrite(addr, (src & mask) | ~(color | mask), time);
@@ -704,7 +716,8 @@ struct NotOp {
 
 template<typename Op>
 struct TransparentOp : Op {
-	void operator()(EmuTime time, VDPVRAM& vram, unsigned addr,
+	template<typename VRAM>
+	void operator()(EmuTime time, VRAM& vram, unsigned addr,
 	                uint8_t src, uint8_t color, uint8_t mask) const
 	{
 		// TODO does this skip the write or re-write the original value
@@ -720,6 +733,58 @@ using TXorOp = TransparentOp<XorOp>;
 using TNotOp = TransparentOp<NotOp>;
 
 
+// Bulk execution:
+//
+// Normally each VRAM access of a command is executed at its exact moment in
+// time. When none of the written addresses is observed (e.g. drawing in a
+// non-visible page) that's not needed: the CPU can only observe the result
+// after synchronizing the command engine. So then the part of a line that
+// fits before the sync-limit can be executed in one go.
+
+/** Used instead of VDPVRAM for the bulk writes. */
+struct UnobservedVRAM {
+	VDPVRAM& vram;
+	void cmdWrite(unsigned addr, uint8_t value, EmuTime /*time*/) {
+		vram.cmdWriteUnobserved(addr, value);
+	}
+};
+
+/** Is the VRAM for the byte range [x0, x1] (or [x1, x0]) on line y observed? */
+template<typename Mode>
+[[nodiscard]] static bool isObserved(const VDPVRAM& vram, unsigned x0, unsigned x1, unsigned y)
+{
+	// in planar modes the bytes alternate between both banks
+	static constexpr unsigned mask = Mode::PLANAR ? 0xFFFF : 0x1FFFF;
+	auto [lo, hi] = std::minmax(Mode::addressOf(x0, y, false) & mask,
+	                            Mode::addressOf(x1, y, false) & mask);
+	if constexpr (Mode::PLANAR) {
+		return vram.isObserved(lo, hi) ||
+		       vram.isObserved(lo | 0x10000, hi | 0x10000);
+	} else {
+		return vram.isObserved(lo, hi);
+	}
+}
+
+/** How many complete 'units' (one or more VRAM accesses, separated by the
+  * given deltas) fit before the limit of the calculator, with a maximum of
+  * 'max'. The calculator is advanced over those units.
+  */
+template<Delta... deltas>
+[[nodiscard]] static unsigned bulkUnits(VDPAccessSlots::Calculator& calculator, unsigned max)
+{
+	static constexpr std::array unit = {deltas...};
+	for (auto n : xrange(max)) {
+		auto c = calculator;
+		for (auto d : unit) {
+			if (c.limitReached()) return n;
+			c.next(d);
+		}
+		calculator = c;
+	}
+	return max;
+}
+
+
 // Commands
 
 void VDPCmdEngine::setStatusChangeTime(EmuTime t)
@@ -993,12 +1058,27 @@ void VDPCmdEngine::executeLmmv(EmuTime limit)
 	uint8_t CL = COL & Mode::COLOR_MASK;
 	bool dstExt = (ARG & MXD) != 0;
 	bool doPset = !dstExt || hasExtendedVRAM;
+	bool tryBulk = !dstExt;
 	unsigned addr = Mode::addressOf(ADX, DY, dstExt);
 	auto calculator = getSlotCalculator(limit);
 
 	switch (phase) {
 	case 0:
-loop:		if (calculator.limitReached()) [[unlikely]] { phase = 0; break; }
+loop:		if (tryBulk && (ANX > 1)) {
+			tryBulk = false;
+			if (!isObserved<Mode>(vram, ADX, ADX + (ANX - 2) * TX, DY)) {
+				auto n = bulkUnits<Delta::D24, Delta::D72>(calculator, ANX - 1);
+				UnobservedVRAM uv{vram};
+				repeat(n, [&] {
+					uint8_t dst = vram.cmdWriteWindow.readNP(addr);
+					Mode::pset(EmuTime::dummy(), uv, ADX, addr, dst, CL, LogOp());
+					ADX += TX;
+					addr = Mode::addressOf(ADX, DY, false);
+				});
+				ANX -= n;
+			}
+		}
+		if (calculator.limitReached()) [[unlikely]] { phase = 0; break; }
 		if (doPset) [[likely]] {
 			tmpDst = vram.cmdWriteWindow.readNP(addr);
 		}
@@ -1020,6 +1100,7 @@ loop:		if (calculator.limitReached()) [[unlikely]] { phase = 0; break; }
 				commandDone(calculator.getTime());
 				break;
 			}
+			tryBulk = !dstExt;
 		}
 		addr = Mode::addressOf(ADX, DY, dstExt);
 		calculator.next(delta);
@@ -1119,12 +1200,29 @@ void VDPCmdEngine::executeLmmm(EmuTime limit)
 	bool dstExt  = (ARG & MXD) != 0;
 	bool doPoint = !srcExt || hasExtendedVRAM;
 	bool doPset  = !dstExt || hasExtendedVRAM;
+	bool bulk = !srcExt && !dstExt;
+	bool tryBulk = bulk;
 	unsigned dstAddr = Mode::addressOf(ADX, DY, dstExt);
 	auto calculator = getSlotCalculator(limit);
 
 	switch (phase) {
 	case 0:
-loop:		if (calculator.limitReached()) [[unlikely]] { phase = 0; break; }
+loop:		if (tryBulk && (ANX > 1)) {
+			tryBulk = false;
+			if (!isObserved<Mode>(vram, ADX, ADX + (ANX - 2) * TX, DY)) {
+				auto n = bulkUnits<Delta::D32, Delta::D24, Delta::D64>(calculator, ANX - 1);
+				UnobservedVRAM uv{vram};
+				repeat(n, [&] {
+					uint8_t src = Mode::point(vram, ASX, SY, false);
+					uint8_t dst = vram.cmdWriteWindow.readNP(dstAddr);
+					Mode::pset(EmuTime::dummy(), uv, ADX, dstAddr, dst, src, LogOp());
+					ASX += TX; ADX += TX;
+					dstAddr = Mode::addressOf(ADX, DY, false);
+				});
+				ANX -= n;
+			}
+		}
+		if (calculator.limitReached()) [[unlikely]] { phase = 0; break; }
 		if (doPoint) [[likely]] {
 		       tmpSrc = Mode::point(vram, ASX, SY, srcExt);
 		} else {
@@ -1155,6 +1253,7 @@ loop:		if (calculator.limitReached()) [[unlikely]] { phase = 0; break; }
 				commandDone(calculator.getTime());
 				break;
 			}
+			tryBulk = bulk;
 		}
 		dstAddr = Mode::addressOf(ADX, DY, dstExt);
 		calculator.next(delta);
@@ -1378,9 +1477,25 @@ void VDPCmdEngine::executeHmmv(EmuTime limit)
 		ADX, ANX << Mode::PIXELS_PER_BYTE_SHIFT, ARG);
 	bool dstExt = (ARG & MXD) != 0;
 	bool doPset = !dstExt || hasExtendedVRAM;
+	bool tryBulk = !dstExt;
 	auto calculator = getSlotCalculator(limit);
 
-	while (!calculator.limitReached()) {
+	while (true) {
+		if (tryBulk && (ANX > 1)) {
+			// all but the last byte of this line (that one needs
+			// the end-of-line handling below)
+			tryBulk = false;
+			if (!isObserved<Mode>(vram, ADX, ADX + (ANX - 2) * TX, DY)) {
+				auto n = bulkUnits<Delta::D48>(calculator, ANX - 1);
+				UnobservedVRAM uv{vram};
+				repeat(n, [&] {
+					uv.cmdWrite(Mode::addressOf(ADX, DY, false), COL, EmuTime::dummy());
+					ADX += TX;
+				});
+				ANX -= n;
+			}
+		}
+		if (calculator.limitReached()) break;
 		if (doPset) [[likely]] {
 			vram.cmdWrite(Mode::addressOf(ADX, DY, dstExt),
 			              COL, calculator.getTime());
@@ -1395,6 +1510,7 @@ void VDPCmdEngine::executeHmmv(EmuTime limit)
 				commandDone(calculator.getTime());
 				break;
 			}
+			tryBulk = !dstExt;
 		}
 		calculator.next(delta);
 	}
@@ -1486,11 +1602,26 @@ void VDPCmdEngine::executeHmmm(EmuTime limit)
 	bool dstExt  = (ARG & MXD) != 0;
 	bool doPoint = !srcExt || hasExtendedVRAM;
 	bool doPset  = !dstExt || hasExtendedVRAM;
+	bool bulk = !srcExt && !dstExt;
+	bool tryBulk = bulk;
 	auto calculator = getSlotCalculator(limit);
 
 	switch (phase) {
 	case 0:
-loop:		if (calculator.limitReached()) [[unlikely]] { phase = 0; break; }
+loop:		if (tryBulk && (ANX > 1)) {
+			tryBulk = false;
+			if (!isObserved<Mode>(vram, ADX, ADX + (ANX - 2) * TX, DY)) {
+				auto n = bulkUnits<Delta::D24, Delta::D64>(calculator, ANX - 1);
+				UnobservedVRAM uv{vram};
+				repeat(n, [&] {
+					uint8_t p = vram.cmdReadWindow.readNP(Mode::addressOf(ASX, SY, false));
+					uv.cmdWrite(Mode::addressOf(ADX, DY, false), p, EmuTime::dummy());
+					ASX += TX; ADX += TX;
+				});
+				ANX -= n;
+			}
+		}
+		if (calculator.limitReached()) [[unlikely]] { phase = 0; break; }
 		if (doPoint) [[likely]] {
 			tmpSrc = vram.cmdReadWindow.readNP(Mode::addressOf(ASX, SY, srcExt));
 		} else {
@@ -1514,6 +1645,7 @@ loop:		if (calculator.limitReached()) [[unlikely]] { phase = 0; break; }
 				commandDone(calculator.getTime());
 				break;
 			}
+			tryBulk = bulk;
 		}
 		calculator.next(delta);
 		goto loop;
@@ -1624,11 +1756,25 @@ void VDPCmdEngine::executeYmmm(EmuTime limit)
 	//  OTOH YMMM also uses DX for both read and write
 	bool dstExt = (ARG & MXD) != 0;
 	bool doPset  = !dstExt || hasExtendedVRAM;
+	bool tryBulk = !dstExt;
 	auto calculator = getSlotCalculator(limit);
 
 	switch (phase) {
 	case 0:
-loop:		if (calculator.limitReached()) [[unlikely]] { phase = 0; break; }
+loop:		if (tryBulk && (ANX > 1)) {
+			tryBulk = false;
+			if (!isObserved<Mode>(vram, ADX, ADX + (ANX - 2) * TX, DY)) {
+				auto n = bulkUnits<Delta::D24, Delta::D40>(calculator, ANX - 1);
+				UnobservedVRAM uv{vram};
+				repeat(n, [&] {
+					uint8_t p = vram.cmdReadWindow.readNP(Mode::addressOf(ADX, SY, false));
+					uv.cmdWrite(Mode::addressOf(ADX, DY, false), p, EmuTime::dummy());
+					ADX += TX;
+				});
+				ANX -= n;
+			}
+		}
+		if (calculator.limitReached()) [[unlikely]] { phase = 0; break; }
 		if (doPset) [[likely]] {
 			tmpSrc = vram.cmdReadWindow.readNP(
 			       Mode::addressOf(ADX, SY, dstExt));
@@ -1650,6 +1796,7 @@ loop:		if (calculator.limitReached()) [[unlikely]] { phase = 0; break; }
 				commandDone(calculator.getTime());
 				break;
 			}
+			tryBulk = !dstExt;
 		}
 		calculator.next(Delta::D40);
 		goto loop;
@@ -90,6 +90,16 @@ void VDPVRAM::PhysicalVRAMDebuggable::write(
 	vram.cpuWrite(address, value, time);
 }
 
+void VDPVRAM::PhysicalVRAMDebuggable::readBlock(
+	unsigned start, std::span<uint8_t> output)
+{
+	// Unlike read() this doesn't steal access slots from the command
+	// engine, so reading a (large) block has no influence on the emulation.
+	auto& vram = OUTER(VDPVRAM, physicalVRAMDebug);
+	vram.cmdEngine->sync(getMotherBoard().getCurrentTime());
+	copy_to_range(std::span{vram.data}.subspan(start, output.size()), output);
+}
+
 
 // class VDPVRAM
 
@@ -216,6 +226,8 @@ void VDPVRAM::updateVRMode(bool newVRmode, EmuTime time)
 			std::swap(data[i], data[swapAddr(i)]);
 		}
 	}
+	// the content of all windows has changed
+	renderer->updateWindow(true, time);
 }
 
 void VDPVRAM::setRenderer(Renderer* newRenderer, EmuTime time)
@@ -10,6 +10,7 @@
 
 #include "Math.hh"
 
+#include <bit>
 #include <cassert>
 #include <cstdint>
 
@@ -312,6 +313,25 @@ public:
 		return (address & combiMask) == baseAddr;
 	}
 
+	/** Is at least one address in the range [begin, end] inside this
+	  * window? Might conservatively return true for large ranges.
+	  */
+	[[nodiscard]] bool intersects(unsigned begin, unsigned end) const {
+		assert(begin <= end);
+		if (!isEnabled()) return false;
+		// Addresses that only differ in the bits below the lowest
+		// 1-bit of 'combiMask' are either all inside or all outside.
+		// So it's sufficient to test one address per such block.
+		unsigned blockBits = combiMask ? std::countr_zero(combiMask) : 31;
+		unsigned first = begin >> blockBits;
+		unsigned last  = end   >> blockBits;
+		if ((last - first) >= 16) return true;
+		for (unsigned b = first; b <= last; ++b) {
+			if (isInside(b << blockBits)) return true;
+		}
+		return false;
+	}
+
 	/** Notifies the observer of this window of a VRAM change,
 	  * if the changes address is inside this window.
 	  * @param address The address to test.
@@ -394,6 +414,49 @@ private:
 	static inline DummyVRAMObserver dummyObserver;
 };
 
+/** The 32kB pages of VRAM the renderer can display. Outside bitmap modes
+  * (tables can be anywhere) or when the VDP alternates between two pages
+  * this is conservatively more than what's displayed right now.
+  * A (physical) address is in a displayed page iff (address & mask) == value.
+  */
+struct DisplayedPages {
+	unsigned mask = 0;
+	unsigned value = 0;
+
+	/** All of VRAM. */
+	[[nodiscard]] static constexpr DisplayedPages all() { return {}; }
+
+	/** The page(s) displayed in a bitmap mode.
+	  * @param planar Graphic6/7 instead of Graphic4/5.
+	  * @param nameBase Physical page address: name table base register
+	  *     (R#2) shifted left 10 bits.
+	  * @param alternate Is the odd page replaced by the even page on some
+	  *     frames or lines (even/odd, blink, multi-page scrolling)?
+	  */
+	[[nodiscard]] static constexpr DisplayedPages bitmap(
+		bool planar, unsigned nameBase, bool alternate)
+	{
+		// In Graphic4/5 address bits 16-15 select the page. In
+		// Graphic6/7 bit 16 selects the plane, both are displayed.
+		unsigned m = planar ? 0x08000 : 0x18000;
+		if (alternate) m &= ~0x08000;
+		return {.mask = m | 0x20000, // extended VRAM is never displayed
+		        .value = nameBase & m};
+	}
+
+	/** Is any address in [begin, end] (with VRAM mirroring applied by
+	  * 'sizeMask') part of a displayed page? */
+	[[nodiscard]] constexpr bool intersects(unsigned begin, unsigned end, unsigned sizeMask) const {
+		assert(begin <= end);
+		unsigned m = mask & sizeMask;
+		unsigned v = value & sizeMask;
+		for (unsigned page = begin >> 15; page <= (end >> 15); ++page) {
+			if (((page << 15) & m) == v) return true;
+		}
+		return false;
+	}
+};
+
 /** Manages VRAM contents and synchronizes the various users of the VRAM.
   * VDPVRAM does not apply planar remapping to addresses, this is the
   * responsibility of the caller.
@@ -447,6 +510,38 @@ public:
 		writeCommon(address, value, time);
 	}
 
+	/** Is there an observer (renderer, sprite checker) that must be
+	  * notified about command engine writes in the address range
+	  * [begin, end]? Might conservatively return true.
+	  */
+	[[nodiscard]] bool isObserved(unsigned begin, unsigned end) const {
+		assert(begin <= end);
+		if (((end & sizeMask) - (begin & sizeMask)) != (end - begin)) {
+			return true; // range wraps around, don't bother
+		}
+		begin &= sizeMask;
+		end   &= sizeMask;
+		auto check = [&](const VRAMWindow& w) {
+			return w.hasObserver() && w.intersects(begin, end);
+		};
+		// In bitmap modes the renderer only reads the displayed page(s).
+		return (check(bitmapVisibleWindow) &&
+		        displayedPages.intersects(begin, end, sizeMask)) ||
+		       check(spriteAttribTable) ||
+		       check(spritePatternTable);
+	}
+
+	/** Same as cmdWrite(), but for an address where isObserved() returned
+	  * false. The write doesn't need the exact moment in time then, this
+	  * allows the command engine to process (part of) a command in bulk.
+	  */
+	void cmdWriteUnobserved(unsigned address, uint8_t value) {
+		address &= sizeMask;
+		if (address >= actualSize) [[unlikely]] return;
+		assert(!isObserved(address, address));
+		data[address] = value;
+	}
+
 	/** Write a byte to VRAM through the CPU interface.
 	  * @param address The address to write.
 	  * @param value The value to write.
@@ -539,6 +634,14 @@ public:
 
 	void setRenderer(Renderer* renderer, EmuTime time);
 
+	/** Set by the VDP on page and display mode changes. Command engine
+	  * writes outside these pages don't have to be synchronized with the
+	  * renderer, see isObserved().
+	  */
+	void setDisplayedPages(DisplayedPages pages) {
+		displayedPages = pages;
+	}
+
 	/** Returns the size of VRAM in bytes
 	  */
 	[[nodiscard]] unsigned getSize() const {
@@ -653,6 +756,8 @@ private:
 		PhysicalVRAMDebuggable(const VDP& vdp, unsigned actualSize);
 		[[nodiscard]] uint8_t read(unsigned address, EmuTime time) override;
 		void write(unsigned address, uint8_t value, EmuTime time) override;
+		void readBlock(unsigned start, std::span<uint8_t> output) override;
+		[[nodiscard]] bool includeInStateHash() const override { return true; }
 	} physicalVRAMDebug;
 
 	// TODO: Renderer field can be removed, if updateDisplayMode
@@ -686,6 +791,8 @@ private:
 	  */
 	bool vrMode;
 
+	DisplayedPages displayedPages = DisplayedPages::all();
+
 public:
 	VRAMWindow cmdReadWindow;
 	VRAMWindow cmdWriteWindow;
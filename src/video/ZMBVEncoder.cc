@@ -20,6 +20,10 @@
 #include <cstring>
 #include <tuple>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace openmsx {
 
 static constexpr uint8_t DBZV_VERSION_HIGH = 0;
@@ -119,6 +123,7 @@ static inline void writePixel(
 ZMBVEncoder::ZMBVEncoder(unsigned width_, unsigned height_)
 	: width(width_)
 	, height(height_)
+	, workerPool(WorkerPool::defaultNumThreads(3))
 {
 	setupBuffers();
 	memset(&zstream, 0, sizeof(zstream));
@@ -163,6 +168,7 @@ void ZMBVEncoder::setupBuffers()
 	size_t xBlocks = width / BLOCK_WIDTH;
 	size_t yBlocks = height / BLOCK_HEIGHT;
 	blockOffsets.resize(xBlocks * yBlocks);
+	blockVectors.resize(xBlocks * yBlocks);
 	for (auto y : xrange(yBlocks)) {
 		for (auto x : xrange(xBlocks)) {
 			blockOffsets[y * xBlocks + x] =
@@ -179,7 +185,7 @@ unsigned ZMBVEncoder::neededSize() const
 	return f + f / 1000;
 }
 
-unsigned ZMBVEncoder::possibleBlock(int vx, int vy, size_t offset)
+unsigned ZMBVEncoder::possibleBlock(int vx, int vy, size_t offset) const
 {
 	int ret = 0;
 	const auto* pOld = &(std::bit_cast<const Pixel*>(oldFrame.data()))[offset + (vy * pitch) + vx];
@@ -194,11 +200,30 @@ unsigned ZMBVEncoder::possibleBlock(int vx, int vy, size_t offset)
 	return ret;
 }
 
-unsigned ZMBVEncoder::compareBlock(int vx, int vy, size_t offset)
+unsigned ZMBVEncoder::compareBlock(int vx, int vy, size_t offset) const
 {
-	int ret = 0;
 	const auto* pOld = &(std::bit_cast<const Pixel*>(oldFrame.data()))[offset + (vy * pitch) + vx];
 	const auto* pNew = &(std::bit_cast<const Pixel*>(newFrame.data()))[offset];
+#ifdef __SSE2__
+	// Count the equal pixels, 4 at a time: a matching lane in the
+	// comparison result is -1, so subtracting it increments that lane.
+	static_assert((BLOCK_WIDTH % 4) == 0);
+	__m128i equal = _mm_setzero_si128();
+	repeat(BLOCK_HEIGHT, [&] {
+		for (unsigned x = 0; x < BLOCK_WIDTH; x += 4) {
+			auto o = _mm_loadu_si128(std::bit_cast<const __m128i*>(pOld + x));
+			auto n = _mm_loadu_si128(std::bit_cast<const __m128i*>(pNew + x));
+			equal = _mm_sub_epi32(equal, _mm_cmpeq_epi32(o, n));
+		}
+		pOld += pitch;
+		pNew += pitch;
+	});
+	equal = _mm_add_epi32(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(1, 0, 3, 2)));
+	equal = _mm_add_epi32(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+	return BLOCK_WIDTH * BLOCK_HEIGHT - unsigned(_mm_cvtsi128_si32(equal));
+#endif
+	// C++ version
+	int ret = 0;
 	repeat(BLOCK_HEIGHT, [&] {
 		for (auto x : xrange(BLOCK_WIDTH)) {
 			if (pOld[x] != pNew[x]) ++ret;
@@ -226,20 +251,15 @@ void ZMBVEncoder::addXorBlock(int vx, int vy, size_t offset, unsigned& workUsed)
 	});
 }
 
-void ZMBVEncoder::addXorFrame(unsigned& workUsed)
+void ZMBVEncoder::findBlockVectors(size_t blockRow)
 {
-	auto* vectors = std::bit_cast<int8_t*>(&work[workUsed]);
-
-	unsigned xBlocks = width / BLOCK_WIDTH;
-	unsigned yBlocks = height / BLOCK_HEIGHT;
-	unsigned blockCount = xBlocks * yBlocks;
-
-	// Align the following xor data on 4 byte boundary
-	workUsed = (workUsed + blockCount * 2 + 3) & ~3;
-
+	// Search each row independently (the initial guess for the first
+	// block is the zero vector), so that the rows can be processed in
+	// parallel and the result doesn't depend on the number of threads.
+	size_t xBlocks = width / BLOCK_WIDTH;
 	int bestVx = 0;
 	int bestVy = 0;
-	for (auto b : xrange(blockCount)) {
+	for (auto b : xrange(blockRow * xBlocks, (blockRow + 1) * xBlocks)) {
 		auto offset = blockOffsets[b];
 		// first try best vector of previous block
 		unsigned bestChange = compareBlock(bestVx, bestVy, offset);
@@ -259,11 +279,35 @@ void ZMBVEncoder::addXorFrame(unsigned& workUsed)
 				}
 			}
 		}
-		vectors[b * 2 + 0] = narrow<int8_t>(bestVx << 1);
-		vectors[b * 2 + 1] = narrow<int8_t>(bestVy << 1);
-		if (bestChange) {
+		blockVectors[b] = {.x = narrow<int8_t>(bestVx),
+		                   .y = narrow<int8_t>(bestVy),
+		                   .changed = bestChange != 0};
+	}
+}
+
+void ZMBVEncoder::addXorFrame(unsigned& workUsed)
+{
+	auto* vectors = std::bit_cast<int8_t*>(&work[workUsed]);
+
+	unsigned xBlocks = width / BLOCK_WIDTH;
+	unsigned yBlocks = height / BLOCK_HEIGHT;
+	unsigned blockCount = xBlocks * yBlocks;
+
+	// Align the following xor data on 4 byte boundary
+	workUsed = (workUsed + blockCount * 2 + 3) & ~3;
+
+	// The motion search is the expensive part, this only reads
+	// 'oldFrame' and 'newFrame', so it can run on multiple threads.
+	workerPool.parallelFor(yBlocks, [&](size_t row) { findBlockVectors(row); });
+
+	// Writing the result must be done in order.
+	for (auto b : xrange(blockCount)) {
+		const auto& v = blockVectors[b];
+		vectors[b * 2 + 0] = narrow<int8_t>(v.x << 1);
+		vectors[b * 2 + 1] = narrow<int8_t>(v.y << 1);
+		if (v.changed) {
 			vectors[b * 2 + 0] |= 1;
-			addXorBlock(bestVx, bestVy, offset, workUsed);
+			addXorBlock(v.x, v.y, blockOffsets[b], workUsed);
 		}
 	}
 }
@@ -300,8 +344,20 @@ const ZMBVEncoder::Pixel* ZMBVEncoder::getScaledLine(const FrameSource* frame, u
 	}
 }
 
-std::span<const uint8_t> ZMBVEncoder::compressFrame(bool keyFrame, const FrameSource* frame)
+void ZMBVEncoder::scaleFrame(const FrameSource* frame, std::span<Pixel> dest) const
 {
+	assert(dest.size() == size_t(width) * height);
+	for (auto y : xrange(height)) {
+		auto line = dest.subspan(size_t(y) * width, width);
+		const auto* scaled = getScaledLine(frame, y, line.data());
+		if (scaled != line.data()) memcpy(line.data(), scaled, line.size_bytes());
+	}
+}
+
+std::span<const uint8_t> ZMBVEncoder::compressFrame(bool keyFrame, std::span<const Pixel> frame)
+{
+	assert(frame.size() == size_t(width) * height);
+
 	std::swap(newFrame, oldFrame); // replace oldFrame with newFrame
 
 	// Reset the work buffer
@@ -333,9 +389,7 @@ std::span<const uint8_t> ZMBVEncoder::compressFrame(bool keyFrame, const FrameSo
 	uint8_t* dest =
 		&newFrame[pixelSize * (MAX_VECTOR + MAX_VECTOR * pitch)];
 	for (auto i : xrange(height)) {
-		const auto* scaled = std::bit_cast<const uint8_t*>(
-			getScaledLine(frame, i, std::bit_cast<Pixel*>(dest)));
-		if (scaled != dest) memcpy(dest, scaled, lineWidth);
+		memcpy(dest, &frame[size_t(i) * width], lineWidth);
 		dest += linePitch;
 	}
 
@@ -3,6 +3,8 @@
 #ifndef ZMBVENCODER_HH
 #define ZMBVENCODER_HH
 
+#include "WorkerPool.hh"
+
 #include "MemBuffer.hh"
 #include "aligned.hh"
 
@@ -29,15 +31,27 @@ public:
 	ZMBVEncoder& operator=(ZMBVEncoder&&) = delete;
 	~ZMBVEncoder() = default;
 
-	[[nodiscard]] std::span<const uint8_t> compressFrame(bool keyFrame, const FrameSource* frame);
+	[[nodiscard]] unsigned getWidth()  const { return width; }
+	[[nodiscard]] unsigned getHeight() const { return height; }
+
+	/** Scale the given frame to the size of this encoder and store the
+	  * result in 'dest' (width * height pixels, no padding between lines).
+	  * This only depends on the (fixed) frame dimensions, so it's safe to
+	  * call concurrently with compressFrame().
+	  */
+	void scaleFrame(const FrameSource* frame, std::span<Pixel> dest) const;
+
+	/** Compress a frame that was previously scaled with scaleFrame(). */
+	[[nodiscard]] std::span<const uint8_t> compressFrame(bool keyFrame, std::span<const Pixel> frame);
 
 private:
 	void setupBuffers();
 	[[nodiscard]] unsigned neededSize() const;
 	void addFullFrame(unsigned& workUsed);
 	void addXorFrame (unsigned& workUsed);
-	[[nodiscard]] unsigned possibleBlock(int vx, int vy, size_t offset);
-	[[nodiscard]] unsigned compareBlock(int vx, int vy, size_t offset);
+	void findBlockVectors(size_t blockRow);
+	[[nodiscard]] unsigned possibleBlock(int vx, int vy, size_t offset) const;
+	[[nodiscard]] unsigned compareBlock(int vx, int vy, size_t offset) const;
 	void addXorBlock(int vx, int vy, size_t offset, unsigned& workUsed);
 	[[nodiscard]] const Pixel* getScaledLine(const FrameSource* frame, unsigned y, Pixel* workBuf) const;
 
@@ -47,13 +61,21 @@ private:
 	MemBuffer<uint8_t, SSE_ALIGNMENT> work;
 	MemBuffer<uint8_t> output;
 	MemBuffer<size_t> blockOffsets;
+	struct BlockVector {
+		int8_t x, y;
+		bool changed;
+	};
+	MemBuffer<BlockVector> blockVectors; // result of the motion search
 	unsigned outputSize;
 
 	z_stream zstream;
 
-	unsigned width;
-	unsigned height;
+	const unsigned width;
+	const unsigned height;
 	size_t pitch;
+
+	// The motion search is done in parallel for all rows of blocks.
+	WorkerPool workerPool;
 };
 
 } // namespace openmsx
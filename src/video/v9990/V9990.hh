@@ -523,6 +523,7 @@ private:
 		[[nodiscard]] uint8_t read(unsigned address) override;
 		void write(unsigned address, uint8_t value, EmuTime time) override;
 		void readBlock(unsigned start, std::span<uint8_t> output) override;
+		[[nodiscard]] bool includeInStateHash() const override { return true; }
 	} v9990RegDebug;
 
 	struct PalDebug final : SimpleDebuggable {
@@ -530,6 +531,7 @@ private:
 		[[nodiscard]] uint8_t read(unsigned address) override;
 		void write(unsigned address, uint8_t value, EmuTime time) override;
 		void readBlock(unsigned start, std::span<uint8_t> output) override;
+		[[nodiscard]] bool includeInStateHash() const override { return true; }
 	} v9990PalDebug;
 
 	IRQHelper irq;
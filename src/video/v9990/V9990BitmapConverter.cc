@@ -2,14 +2,21 @@
 
 #include "V9990.hh"
 #include "V9990VRAM.hh"
+#include "V9990YUVKernels.hh"
 
 #include "narrow.hh"
 #include "unreachable.hh"
 
 #include <array>
+#include <bit>
 #include <cassert>
 #include <concepts>
 #include <cstdint>
+#include <cstring>
+
+#ifdef __SSE2__
+#include "emmintrin.h" // SSE2
+#endif
 
 namespace openmsx {
 
@@ -36,24 +43,44 @@ static inline void draw_YJK_YUV_PAL(
 		d = vram.readVRAMBx(address++);
 	}
 
-	int u = (data[2] & 7) + ((data[3] & 3) << 3) - ((data[3] & 4) << 3);
-	int v = (data[0] & 7) + ((data[1] & 3) << 3) - ((data[1] & 4) << 3);
-
+	auto idx = V9990YUVKernels::toIndex4<YJK>(data);
 	for (auto i : xrange(SKIP ? firstX : 0, 4)) {
-		if (PAL && (data[i] & 0x08)) {
-			*out++ = color.lookup64(data[i] >> 4);
-		} else {
-			int y = (data[i] & 0xF8) >> 3;
-			int r = std::clamp(y + u,                   0, 31);
-			int g = std::clamp((5 * y - 2 * u - v) / 4, 0, 31);
-			int b = std::clamp(y + v,                   0, 31);
-			// The only difference between YUV and YJK is that
-			// green and blue are swapped.
-			if constexpr (YJK) std::swap(g, b);
-			*out++ = color.lookup32768((g << 10) + (r << 5) + b);
+		*out++ = (PAL && (data[i] & 0x08)) ? color.lookup64(data[i] >> 4)
+		                                   : color.lookup32768(idx[i]);
+	}
+}
+
+#ifdef __SSE2__
+// Draw 8 pixels per iteration as long as possible ('address' must be a
+// multiple of 4). The even and odd VRAM bytes are stored in separate banks
+// (see V9990VRAM::transformBx()), so the bytes can be read directly from
+// both banks as long as the address doesn't wrap.
+template<bool YJK, bool PAL, std::unsigned_integral Pixel, typename ColorLookup>
+static inline void draw_YJK_YUV_PAL_x8(
+	ColorLookup color, const V9990VRAM& vram,
+	Pixel* __restrict& out, unsigned& address, int& nrPixels)
+{
+	assert((address & 3) == 0);
+	while ((nrPixels >= 8) && ((address & 0x7FFFF) <= (0x80000 - 8))) {
+		int32_t d0, d1;
+		memcpy(&d0, vram.readVRAMDirect(V9990VRAM::transformBx(address + 0), 4).data(), 4);
+		memcpy(&d1, vram.readVRAMDirect(V9990VRAM::transformBx(address + 1), 4).data(), 4);
+		__m128i bytes = _mm_unpacklo_epi8(_mm_cvtsi32_si128(d0), _mm_cvtsi32_si128(d1));
+		__m128i p = _mm_unpacklo_epi8(bytes, _mm_setzero_si128());
+
+		alignas(16) std::array<uint16_t, 8> data;
+		alignas(16) std::array<uint16_t, 8> idx;
+		_mm_store_si128(std::bit_cast<__m128i*>(data.data()), p);
+		_mm_store_si128(std::bit_cast<__m128i*>(idx.data()), V9990YUVKernels::toIndex8<YJK>(p));
+		for (auto i : xrange(8)) {
+			*out++ = (PAL && (data[i] & 0x08)) ? color.lookup64(data[i] >> 4)
+			                                   : color.lookup32768(idx[i]);
 		}
+		address += 8;
+		nrPixels -= 8;
 	}
 }
+#endif
 
 template<std::unsigned_integral Pixel, typename ColorLookup>
 static void rasterBYUV(
@@ -68,6 +95,9 @@ static void rasterBYUV(
 			color, vram, out, address, x & 3);
 		nrPixels -= narrow<int>(4 - (x & 3));
 	}
+#ifdef __SSE2__
+	draw_YJK_YUV_PAL_x8<false, false>(color, vram, out, address, nrPixels);
+#endif
 	for (/**/; nrPixels > 0; nrPixels -= 4) {
 		draw_YJK_YUV_PAL<false, false, false>(
 			color, vram, out, address);
@@ -90,6 +120,9 @@ static void rasterBYUVP(
 			color, vram, out, address, x & 3);
 		nrPixels -= narrow<int>(4 - (x & 3));
 	}
+#ifdef __SSE2__
+	draw_YJK_YUV_PAL_x8<false, true>(color, vram, out, address, nrPixels);
+#endif
 	for (/**/; nrPixels > 0; nrPixels -= 4) {
 		draw_YJK_YUV_PAL<false, true, false>(
 			color, vram, out, address);
@@ -110,6 +143,9 @@ static void rasterBYJK(
 			color, vram, out, address, x & 3);
 		nrPixels -= narrow<int>(4 - (x & 3));
 	}
+#ifdef __SSE2__
+	draw_YJK_YUV_PAL_x8<true, false>(color, vram, out, address, nrPixels);
+#endif
 	for (/**/; nrPixels > 0; nrPixels -= 4) {
 		draw_YJK_YUV_PAL<true, false, false>(
 			color, vram, out, address);
@@ -132,6 +168,9 @@ static void rasterBYJKP(
 			color, vram, out, address, x & 3);
 		nrPixels -= narrow<int>(4 - (x & 3));
 	}
+#ifdef __SSE2__
+	draw_YJK_YUV_PAL_x8<true, true>(color, vram, out, address, nrPixels);
+#endif
 	for (/**/; nrPixels > 0; nrPixels -= 4) {
 		draw_YJK_YUV_PAL<true, true, false>(
 			color, vram, out, address);
@@ -289,6 +289,45 @@ static constexpr uint8_t DIX = 0x04;
 static constexpr uint8_t NEQ = 0x02;
 static constexpr uint8_t MAJ = 0x01;
 
+// Bulk execution:
+//
+// Commands are executed in chunks: all pixels of the current line that
+// start before the sync-limit are done in one go. Only the time at the end
+// of the chunk is calculated (instead of stepping the time per pixel), so
+// the result (including the moment the command ends) is the same as
+// executing them one at a time.
+//
+// The most common case, a copy or fill with logical operation IMP, without
+// transparency and with all bits of the write mask set, doesn't need to read
+// the destination or apply a logical operation. In that case whole VRAM
+// bytes are written at once (instead of per pixel, 2 or 4 per byte).
+
+/** How many steps (pixels, bytes) of duration 'delta' start before 'limit',
+  * with a maximum of 'max'.
+  */
+[[nodiscard]] static unsigned numSteps(EmuTime time, EmuTime limit, EmuDuration delta, unsigned max)
+{
+	if (time >= limit) return 0;
+	if (delta == EmuDuration::zero()) return max;
+	auto dur = limit - time;
+	if (dur >= delta * max) return max;
+	return dur.divUp(delta);
+}
+
+/** Logical operation IMP, no transparency, all bits writable. */
+[[nodiscard]] static constexpr bool isPlainCopy(uint8_t log, uint16_t writeMask)
+{
+	return ((log & 0x1F) == 0x0C) && (writeMask == 0xFFFF);
+}
+
+/** Is pixel 'x' the first one of its VRAM byte, when going in direction 'dx'? */
+template<typename Mode>
+[[nodiscard]] static constexpr bool startsByte(unsigned x, uint16_t dx)
+{
+	constexpr unsigned PPB = Mode::PIXELS_PER_BYTE;
+	return (x % PPB) == ((dx == 1) ? 0 : (PPB - 1));
+}
+
 // P1 --------------------------------------------------------------
 inline unsigned V9990CmdEngine::V9990P1::getPitch(unsigned width)
 {
@@ -701,6 +740,82 @@ inline void V9990CmdEngine::V9990Bpp16::psetColor(
 	vram.writeVRAMDirect(addr + 0x40000, narrow_cast<uint8_t>(result >> 8));
 }
 
+// Bulk helpers ---------------------------------------------------------
+
+/** Part of LMMV: fill 'n' pixels, starting at (x, y), for a plain copy (see
+  * isPlainCopy()).
+  */
+template<typename Mode>
+static void fillLine(V9990VRAM& vram, uint16_t x, uint16_t y, unsigned pitch,
+                     unsigned n, uint16_t dx, uint16_t color,
+                     std::span<const uint8_t, 256 * 256> lut, uint8_t op)
+{
+	auto lo = narrow_cast<uint8_t>(color & 0xFF);
+	auto hi = narrow_cast<uint8_t>(color >> 8);
+	if constexpr (Mode::BITS_PER_PIXEL == 16) {
+		repeat(n, [&] {
+			auto addr = Mode::addressOf(x, y, pitch);
+			vram.writeVRAMDirect(addr + 0x00000, lo);
+			vram.writeVRAMDirect(addr + 0x40000, hi);
+			x += dx;
+		});
+	} else {
+		constexpr unsigned PPB = Mode::PIXELS_PER_BYTE;
+		while (n) {
+			if ((n >= PPB) && startsByte<Mode>(x, dx)) {
+				auto addr = Mode::addressOf(x, y, pitch);
+				vram.writeVRAMDirect(addr, (addr & 0x40000) ? hi : lo);
+				x += uint16_t(PPB * dx);
+				n -= PPB;
+			} else {
+				Mode::psetColor(vram, x, y, pitch, color, 0xFFFF, lut, op);
+				x += dx;
+				--n;
+			}
+		}
+	}
+}
+
+/** Part of LMMM: copy 'n' pixels from (sx, sy) to (dx, dy), for a plain copy
+  * (see isPlainCopy()).
+  */
+template<typename Mode>
+static void copyLine(V9990VRAM& vram, uint16_t sx, uint16_t sy, uint16_t x, uint16_t y,
+                     unsigned pitch, unsigned n, uint16_t dx,
+                     std::span<const uint8_t, 256 * 256> lut, uint8_t op)
+{
+	auto copyPixel = [&] {
+		auto src = Mode::point(vram, sx, sy, pitch);
+		src = Mode::shift(src, sx, x);
+		Mode::pset(vram, x, y, pitch, src, 0xFFFF, lut, op);
+		sx += dx;
+		x += dx;
+	};
+	if constexpr (Mode::BITS_PER_PIXEL == 16) {
+		repeat(n, copyPixel);
+	} else {
+		// Whole bytes can only be copied when source and destination
+		// have the same alignment within a byte.
+		constexpr unsigned PPB = Mode::PIXELS_PER_BYTE;
+		if ((sx % PPB) != (x % PPB)) {
+			repeat(n, copyPixel);
+			return;
+		}
+		while (n) {
+			if ((n >= PPB) && startsByte<Mode>(x, dx)) {
+				vram.writeVRAMDirect(Mode::addressOf(x, y, pitch),
+				                     Mode::point(vram, sx, sy, pitch));
+				sx += uint16_t(PPB * dx);
+				x += uint16_t(PPB * dx);
+				n -= PPB;
+			} else {
+				copyPixel();
+				--n;
+			}
+		}
+	}
+}
+
 // ====================================================================
 /** Constructor
   */
@@ -1046,19 +1161,26 @@ void V9990CmdEngine::startLMMV(EmuTime time)
 template<typename Mode>
 void V9990CmdEngine::executeLMMV(EmuTime limit)
 {
-	// TODO can be optimized a lot
-
 	auto delta = getTiming(*this, LMMV_TIMING);
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	uint16_t dx = (ARG & DIX) ? uint16_t(-1) : 1;
 	uint16_t dy = (ARG & DIY) ? uint16_t(-1) : 1;
 	auto lut = Mode::getLogOpLUT(LOG);
-	while (engineTime < limit) {
-		engineTime += delta;
-		Mode::psetColor(vram, DX, DY, pitch, fgCol, WM, lut, LOG);
+	bool plain = isPlainCopy(LOG, WM);
+	while (unsigned n = numSteps(engineTime, limit, delta, ANX)) {
+		engineTime += delta * n;
+		if (plain) {
+			fillLine<Mode>(vram, DX, DY, pitch, n, dx, fgCol, lut, LOG);
+			DX += uint16_t(n * dx);
+		} else {
+			repeat(n, [&] {
+				Mode::psetColor(vram, DX, DY, pitch, fgCol, WM, lut, LOG);
+				DX += dx;
+			});
+		}
 
-		DX += dx;
-		if (!--ANX) {
+		ANX -= n;
+		if (!ANX) {
 			DX -= uint16_t(NX * dx);
 			DY += dy;
 			if (!--ANY) {
@@ -1139,22 +1261,30 @@ void V9990CmdEngine::startLMMM(EmuTime time)
 template<typename Mode>
 void V9990CmdEngine::executeLMMM(EmuTime limit)
 {
-	// TODO can be optimized a lot
-
 	auto delta = getTiming(*this, LMMM_TIMING);
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	uint16_t dx = (ARG & DIX) ? uint16_t(-1) : 1;
 	uint16_t dy = (ARG & DIY) ? uint16_t(-1) : 1;
 	auto lut = Mode::getLogOpLUT(LOG);
-	while (engineTime < limit) {
-		engineTime += delta;
-		auto src = Mode::point(vram, SX, SY, pitch);
-		src = Mode::shift(src, SX, DX);
-		Mode::pset(vram, DX, DY, pitch, src, WM, lut, LOG);
+	bool plain = isPlainCopy(LOG, WM);
+	while (unsigned n = numSteps(engineTime, limit, delta, ANX)) {
+		engineTime += delta * n;
+		if (plain) {
+			copyLine<Mode>(vram, SX, SY, DX, DY, pitch, n, dx, lut, LOG);
+			DX += uint16_t(n * dx);
+			SX += uint16_t(n * dx);
+		} else {
+			repeat(n, [&] {
+				auto src = Mode::point(vram, SX, SY, pitch);
+				src = Mode::shift(src, SX, DX);
+				Mode::pset(vram, DX, DY, pitch, src, WM, lut, LOG);
+				DX += dx;
+				SX += dx;
+			});
+		}
 
-		DX += dx;
-		SX += dx;
-		if (!--ANX) {
+		ANX -= n;
+		if (!ANX) {
 			DX -= uint16_t(NX * dx);
 			SX -= uint16_t(NX * dx);
 			DY += dy;
@@ -1435,22 +1565,30 @@ void V9990CmdEngine::executeBMLL<V9990CmdEngine::V9990Bpp16>(EmuTime limit)
 	auto delta = getTiming(*this, BMLL_TIMING) * 2;
 	auto lut = V9990Bpp16::getLogOpLUT(LOG);
 	bool transp = (LOG & 0x10) != 0;
-	while (engineTime < limit) {
-		engineTime += delta;
-		// VRAM always mapped as in Bx modes
-		auto srcColor = uint16_t(vram.readVRAMDirect(srcAddress + 0x00000) +
-		                         vram.readVRAMDirect(srcAddress + 0x40000) * 256);
-		auto dstColor = uint16_t(vram.readVRAMDirect(dstAddress + 0x00000) +
-		                         vram.readVRAMDirect(dstAddress + 0x40000) * 256);
-		uint16_t newColor = V9990Bpp16::logOp(lut, srcColor, dstColor, transp);
-		uint16_t result = (dstColor & ~WM) | (newColor & WM);
-		vram.writeVRAMDirect(dstAddress + 0x00000, narrow_cast<uint8_t>(result & 0xFF));
-		vram.writeVRAMDirect(dstAddress + 0x40000, narrow_cast<uint8_t>(result >> 8));
-		srcAddress = (srcAddress + 1) & 0x3FFFF;
-		dstAddress = (dstAddress + 1) & 0x3FFFF;
-		if (!--nbBytes) {
+	bool plain = isPlainCopy(LOG, WM);
+	if (unsigned n = numSteps(engineTime, limit, delta, nbBytes)) {
+		engineTime += delta * n;
+		repeat(n, [&] {
+			// VRAM always mapped as in Bx modes
+			if (plain) {
+				vram.writeVRAMDirect(dstAddress + 0x00000, vram.readVRAMDirect(srcAddress + 0x00000));
+				vram.writeVRAMDirect(dstAddress + 0x40000, vram.readVRAMDirect(srcAddress + 0x40000));
+			} else {
+				auto srcColor = uint16_t(vram.readVRAMDirect(srcAddress + 0x00000) +
+				                         vram.readVRAMDirect(srcAddress + 0x40000) * 256);
+				auto dstColor = uint16_t(vram.readVRAMDirect(dstAddress + 0x00000) +
+				                         vram.readVRAMDirect(dstAddress + 0x40000) * 256);
+				uint16_t newColor = V9990Bpp16::logOp(lut, srcColor, dstColor, transp);
+				uint16_t result = (dstColor & ~WM) | (newColor & WM);
+				vram.writeVRAMDirect(dstAddress + 0x00000, narrow_cast<uint8_t>(result & 0xFF));
+				vram.writeVRAMDirect(dstAddress + 0x40000, narrow_cast<uint8_t>(result >> 8));
+			}
+			srcAddress = (srcAddress + 1) & 0x3FFFF;
+			dstAddress = (dstAddress + 1) & 0x3FFFF;
+		});
+		nbBytes -= n;
+		if (!nbBytes) {
 			cmdReady(engineTime);
-			return;
 		}
 	}
 }
@@ -1461,21 +1599,28 @@ void V9990CmdEngine::executeBMLL(EmuTime limit)
 	// TODO DIX DIY?
 	auto delta = getTiming(*this, BMLL_TIMING);
 	auto lut = Mode::getLogOpLUT(LOG);
-	while (engineTime < limit) {
-		engineTime += delta;
-		// VRAM always mapped as in Bx modes
-		auto srcColor = vram.readVRAMBx(srcAddress);
-		auto addr = V9990VRAM::transformBx(dstAddress);
-		auto dstColor = vram.readVRAMDirect(addr);
-		auto newColor = Mode::logOp(lut, srcColor, dstColor);
-		auto mask = narrow_cast<uint8_t>((addr & 0x40000) ? (WM >> 8) : (WM & 0xFF));
-		uint8_t result = (dstColor & ~mask) | (newColor & mask);
-		vram.writeVRAMDirect(addr, result);
-		srcAddress = (srcAddress + 1) & 0x7FFFF;
-		dstAddress = (dstAddress + 1) & 0x7FFFF;
-		if (!--nbBytes) {
+	bool plain = isPlainCopy(LOG, WM);
+	if (unsigned n = numSteps(engineTime, limit, delta, nbBytes)) {
+		engineTime += delta * n;
+		repeat(n, [&] {
+			// VRAM always mapped as in Bx modes
+			auto srcColor = vram.readVRAMBx(srcAddress);
+			auto addr = V9990VRAM::transformBx(dstAddress);
+			if (plain) {
+				vram.writeVRAMDirect(addr, srcColor);
+			} else {
+				auto dstColor = vram.readVRAMDirect(addr);
+				auto newColor = Mode::logOp(lut, srcColor, dstColor);
+				auto mask = narrow_cast<uint8_t>((addr & 0x40000) ? (WM >> 8) : (WM & 0xFF));
+				uint8_t result = (dstColor & ~mask) | (newColor & mask);
+				vram.writeVRAMDirect(addr, result);
+			}
+			srcAddress = (srcAddress + 1) & 0x7FFFF;
+			dstAddress = (dstAddress + 1) & 0x7FFFF;
+		});
+		nbBytes -= n;
+		if (!nbBytes) {
 			cmdReady(engineTime);
-			return;
 		}
 	}
 }
@@ -6,7 +6,9 @@
 #include "EmuTime.hh"
 #include "TrackedRam.hh"
 
+#include <cassert>
 #include <cstdint>
+#include <span>
 
 namespace openmsx {
 
@@ -76,6 +78,13 @@ public:
 	[[nodiscard]] uint8_t readVRAMDirect(unsigned address) const {
 		return data[address];
 	}
+	/** Read 'num' consecutive bytes of the physical VRAM (the address is
+	  * not transformed and doesn't wrap).
+	  */
+	[[nodiscard]] std::span<const uint8_t> readVRAMDirect(unsigned address, size_t num) const {
+		assert((address + num) <= data.size());
+		return {&data[address], num};
+	}
 	void writeVRAMDirect(unsigned address, uint8_t value) {
 		data.write(address, value);
 	}
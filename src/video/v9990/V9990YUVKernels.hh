@@ -0,0 +1,81 @@
+#ifndef V9990YUVKERNELS_HH
+#define V9990YUVKERNELS_HH
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace openmsx {
+
+/** Color conversion of the V9990 YUV and YJK bitmap modes: a group of 4
+  * VRAM bytes becomes 4 indices in the 32768-color palette. Each byte holds
+  * a 5-bit Y value, the lower 3 bits of the 4 bytes together hold V (bytes
+  * 0 and 1) and U (bytes 2 and 3).
+  *
+  * SSE2 is part of the x86-64 baseline, so (unlike the wider kernels in
+  * ResampleHQKernels.hh) the SSE2 version is selected at compile time. The
+  * palette lookups that follow the conversion are scalar anyway, so wider
+  * vectors wouldn't gain much.
+  */
+namespace V9990YUVKernels {
+
+// c++ version, one group of 4 pixels
+template<bool YJK>
+[[nodiscard]] constexpr std::array<uint16_t, 4> toIndex4(std::array<uint8_t, 4> data)
+{
+	int u = (data[2] & 7) + ((data[3] & 3) << 3) - ((data[3] & 4) << 3);
+	int v = (data[0] & 7) + ((data[1] & 3) << 3) - ((data[1] & 4) << 3);
+
+	std::array<uint16_t, 4> result = {};
+	for (int i = 0; i < 4; ++i) {
+		int y = (data[i] & 0xF8) >> 3;
+		int r = std::clamp(y + u,                   0, 31);
+		int g = std::clamp((5 * y - 2 * u - v) / 4, 0, 31);
+		int b = std::clamp(y + v,                   0, 31);
+		// The only difference between YUV and YJK is that
+		// green and blue are swapped.
+		if constexpr (YJK) std::swap(g, b);
+		result[i] = uint16_t((g << 10) + (r << 5) + b);
+	}
+	return result;
+}
+
+#ifdef __SSE2__
+// SSE2 version, 8 pixels (2 groups of 4), 'p' contains the VRAM bytes as
+// 16-bit values.
+template<bool YJK>
+[[nodiscard]] inline __m128i toIndex8(__m128i p)
+{
+	// V is stored in the lower 3 bits of pixels 0 and 1, U in pixels 2 and
+	// 3 of each group. Combine each pixel with its right neighbour, sign
+	// extend from 6 bits, then broadcast to the 4 pixels of the group.
+	__m128i low = _mm_and_si128(p, _mm_set1_epi16(7));
+	__m128i uv = _mm_or_si128(low, _mm_slli_epi16(_mm_srli_si128(low, 2), 3));
+	uv = _mm_srai_epi16(_mm_slli_epi16(uv, 10), 10);
+	__m128i v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+	__m128i u = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 2, 2, 2));
+	__m128i y = _mm_srli_epi16(p, 3);
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i max = _mm_set1_epi16(31);
+	auto clamp = [&](__m128i x) { return _mm_min_epi16(_mm_max_epi16(x, zero), max); };
+	__m128i r = clamp(_mm_add_epi16(y, u));
+	__m128i b = clamp(_mm_add_epi16(y, v));
+	// (5 * y - 2 * u - v) / 4: the arithmetic shift rounds differently
+	// than the division for negative values, but those get clamped to 0.
+	__m128i g5 = _mm_add_epi16(_mm_slli_epi16(y, 2), y);
+	__m128i g = clamp(_mm_srai_epi16(_mm_sub_epi16(g5, _mm_add_epi16(_mm_add_epi16(u, u), v)), 2));
+	if constexpr (YJK) std::swap(g, b);
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(g, 10), _mm_slli_epi16(r, 5)), b);
+}
+#endif
+
+} // namespace V9990YUVKernels
+} // namespace openmsx
+
+#endif